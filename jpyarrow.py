@@ -0,0 +1,155 @@
+"""
+Optional exchange of Apache Arrow data between the Java Arrow library and pyarrow through the Arrow C Data Interface.
+
+Arrays and record batches cross the boundary without copying their buffers: the exporting side fills an
+'ArrowArray' and an 'ArrowSchema' C struct, whose raw addresses are passed through jpy as Python ints / Java longs,
+and the importing side takes over the buffers together with their release callback. A transfer costs a handful of
+JNI calls, independent of the number of rows and columns.
+
+Requires pyarrow and the Java modules 'arrow-vector', 'arrow-memory-netty' (or another allocator) and
+'arrow-c-data' on the JVM class path:
+
+    import jpyutil
+    jpyutil.init_jvm(jvm_classpath=[...arrow jars...])
+    import jpyarrow
+
+    root = jpyarrow.to_java(record_batch)   # org.apache.arrow.vector.VectorSchemaRoot
+    batch = jpyarrow.from_java(root)        # pyarrow.RecordBatch
+
+The Java objects returned by to_java() own memory of the Java allocator and should be closed when no longer needed.
+The pyarrow objects returned by from_java() keep the exported Java buffers alive until they are garbage collected,
+also if the Java vectors are closed before.
+"""
+
+import pyarrow
+
+__author__ = "Norman Fomferra (Brockmann Consult GmbH) and contributors"
+__copyright__ = "Copyright 2015-2018 Brockmann Consult GmbH and contributors"
+__license__ = "Apache 2.0"
+
+
+_ROOT_ALLOCATOR = None
+
+
+def _jpy():
+    # Imported on first use, so that jpyutil.init_jvm() may be called after importing this module
+    import jpy
+    return jpy
+
+
+def _is_instance(obj, java_type_name):
+    jpy = _jpy()
+    # Other Python objects would be converted to Java objects by isInstance(), or fail to convert
+    return isinstance(obj, jpy.get_type('java.lang.Object')) and jpy.get_type(java_type_name).jclass.isInstance(obj)
+
+
+def allocator():
+    """
+    Returns the org.apache.arrow.memory.RootAllocator used by default for the Java side of transfers.
+    It is created on first use and lives as long as the JVM.
+    """
+    global _ROOT_ALLOCATOR
+    if _ROOT_ALLOCATOR is None:
+        _ROOT_ALLOCATOR = _jpy().get_type('org.apache.arrow.memory.RootAllocator')()
+    return _ROOT_ALLOCATOR
+
+
+class _CStructs:
+    """
+    A pair of Java allocated ArrowArray and ArrowSchema C structs, freed when the block exits.
+    Closing the structs frees only their own memory: after a successful import, the release callback
+    and with it the ownership of the data buffers have been moved to the importing side. If the block
+    exits with an error, the structs which have been exported but not imported are released first.
+    """
+
+    def __init__(self, java_allocator):
+        jpy = _jpy()
+        self.array = jpy.get_type('org.apache.arrow.c.ArrowArray').allocateNew(java_allocator)
+        try:
+            self.schema = jpy.get_type('org.apache.arrow.c.ArrowSchema').allocateNew(java_allocator)
+        except BaseException:
+            self.array.close()
+            raise
+        self.array_address = self.array.memoryAddress()
+        self.schema_address = self.schema.memoryAddress()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        try:
+            if exc_type is not None:
+                # No-op for structs which have not been exported or have been moved by an import
+                try:
+                    self.array.release()
+                finally:
+                    self.schema.release()
+        finally:
+            self.schema.close()
+            self.array.close()
+        return False
+
+
+def to_java(obj, java_allocator=None):
+    """
+    Moves a pyarrow.Array into a new org.apache.arrow.vector.FieldVector, a pyarrow.RecordBatch into a new
+    org.apache.arrow.vector.VectorSchemaRoot, or a pyarrow.Table into a Python list with a VectorSchemaRoot
+    per record batch of the table. The data buffers are shared, not copied.
+
+    :param obj: A pyarrow.Array, pyarrow.RecordBatch or pyarrow.Table.
+    :param java_allocator: The Java BufferAllocator accounting for the imported buffers, defaults to allocator().
+    :return: The Java vector, the Java vector schema root, or a list of them.
+    """
+    if isinstance(obj, pyarrow.Table):
+        return [to_java(batch, java_allocator=java_allocator) for batch in obj.to_batches()]
+    if not isinstance(obj, (pyarrow.Array, pyarrow.RecordBatch)):
+        raise TypeError('to_java: argument 1 (obj) must be a pyarrow.Array, pyarrow.RecordBatch or pyarrow.Table')
+
+    if java_allocator is None:
+        java_allocator = allocator()
+    Data = _jpy().get_type('org.apache.arrow.c.Data')
+    with _CStructs(java_allocator) as structs:
+        obj._export_to_c(structs.array_address, structs.schema_address)
+        if isinstance(obj, pyarrow.RecordBatch):
+            return Data.importVectorSchemaRoot(java_allocator, structs.array, structs.schema, None)
+        return Data.importVector(java_allocator, structs.array, structs.schema, None)
+
+
+def from_java(obj, java_allocator=None):
+    """
+    Exports an org.apache.arrow.vector.FieldVector as a pyarrow.Array or an org.apache.arrow.vector.VectorSchemaRoot
+    as a pyarrow.RecordBatch. The data buffers are shared, not copied.
+
+    :param obj: A Java FieldVector or VectorSchemaRoot.
+    :param java_allocator: The Java BufferAllocator for the C structs, defaults to allocator().
+    :return: The pyarrow.Array or pyarrow.RecordBatch.
+    """
+    if _is_instance(obj, 'org.apache.arrow.vector.VectorSchemaRoot'):
+        is_root = True
+    elif _is_instance(obj, 'org.apache.arrow.vector.FieldVector'):
+        is_root = False
+    else:
+        raise TypeError('from_java: argument 1 (obj) must be a Java FieldVector or VectorSchemaRoot')
+
+    if java_allocator is None:
+        java_allocator = allocator()
+    Data = _jpy().get_type('org.apache.arrow.c.Data')
+    with _CStructs(java_allocator) as structs:
+        if is_root:
+            Data.exportVectorSchemaRoot(java_allocator, obj, None, structs.array, structs.schema)
+            return pyarrow.RecordBatch._import_from_c(structs.array_address, structs.schema_address)
+        Data.exportVector(java_allocator, obj, None, structs.array, structs.schema)
+        return pyarrow.Array._import_from_c(structs.array_address, structs.schema_address)
+
+
+def table_from_java(roots, java_allocator=None):
+    """
+    Exports Java VectorSchemaRoots of the same schema as the record batches of a pyarrow.Table.
+
+    :param roots: A Java VectorSchemaRoot or an iterable of them, e.g. a Python list or a java.util.List.
+    :param java_allocator: The Java BufferAllocator for the C structs, defaults to allocator().
+    :return: The pyarrow.Table.
+    """
+    if _is_instance(roots, 'org.apache.arrow.vector.VectorSchemaRoot'):
+        roots = [roots]
+    return pyarrow.Table.from_batches([from_java(root, java_allocator=java_allocator) for root in roots])
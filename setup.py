@@ -48,6 +48,20 @@ sources = [
     os.path.join(src_main_c_dir, 'jpy_module.c'),
     os.path.join(src_main_c_dir, 'jpy_diag.c'),
     os.path.join(src_main_c_dir, 'jpy_verboseexcept.c'),
+    os.path.join(src_main_c_dir, 'jpy_mapproxy.c'),
+    os.path.join(src_main_c_dir, 'jpy_relqueue.c'),
+    os.path.join(src_main_c_dir, 'jpy_metrics.c'),
+    os.path.join(src_main_c_dir, 'jpy_profiler.c'),
+    os.path.join(src_main_c_dir, 'jpy_memstats.c'),
+    os.path.join(src_main_c_dir, 'jpy_idcache.c'),
+    os.path.join(src_main_c_dir, 'jpy_jweakobj.c'),
+    os.path.join(src_main_c_dir, 'jpy_typetrans.c'),
+    os.path.join(src_main_c_dir, 'jpy_jiterator.c'),
+    os.path.join(src_main_c_dir, 'jpy_jcollection.c'),
+    os.path.join(src_main_c_dir, 'jpy_jfieldproj.c'),
+    os.path.join(src_main_c_dir, 'jpy_numpy.c'),
+    os.path.join(src_main_c_dir, 'jpy_async.c'),
+    os.path.join(src_main_c_dir, 'jpy_jexception.c'),
     os.path.join(src_main_c_dir, 'jpy_conv.c'),
     os.path.join(src_main_c_dir, 'jpy_compat.c'),
     os.path.join(src_main_c_dir, 'jpy_jtype.c'),
@@ -61,6 +75,20 @@ sources = [
 headers = [
     os.path.join(src_main_c_dir, 'jpy_module.h'),
     os.path.join(src_main_c_dir, 'jpy_diag.h'),
+    os.path.join(src_main_c_dir, 'jpy_mapproxy.h'),
+    os.path.join(src_main_c_dir, 'jpy_relqueue.h'),
+    os.path.join(src_main_c_dir, 'jpy_metrics.h'),
+    os.path.join(src_main_c_dir, 'jpy_profiler.h'),
+    os.path.join(src_main_c_dir, 'jpy_memstats.h'),
+    os.path.join(src_main_c_dir, 'jpy_idcache.h'),
+    os.path.join(src_main_c_dir, 'jpy_jweakobj.h'),
+    os.path.join(src_main_c_dir, 'jpy_typetrans.h'),
+    os.path.join(src_main_c_dir, 'jpy_jiterator.h'),
+    os.path.join(src_main_c_dir, 'jpy_jcollection.h'),
+    os.path.join(src_main_c_dir, 'jpy_jfieldproj.h'),
+    os.path.join(src_main_c_dir, 'jpy_numpy.h'),
+    os.path.join(src_main_c_dir, 'jpy_async.h'),
+    os.path.join(src_main_c_dir, 'jpy_jexception.h'),
     os.path.join(src_main_c_dir, 'jpy_conv.h'),
     os.path.join(src_main_c_dir, 'jpy_compat.h'),
     os.path.join(src_main_c_dir, 'jpy_jtype.h'),
@@ -76,7 +104,9 @@ python_java_rt_tests = [
     os.path.join(src_test_py_dir, 'jpy_rt_test.py'),
     os.path.join(src_test_py_dir, 'jpy_mt_test.py'),
     os.path.join(src_test_py_dir, 'jpy_diag_test.py'),
-    # os.path.join(src_test_py_dir, 'jpy_perf_test.py'),
+    os.path.join(src_test_py_dir, 'jpy_arrow_test.py'),
+    os.path.join(src_test_py_dir, 'jpy_numpy_test.py'),
+    os.path.join(src_test_py_dir, 'jpy_async_test.py'),
 ]
 
 # Python unit tests that require target/test-classes or target/classes
@@ -96,6 +126,8 @@ python_java_jpy_tests = [
     os.path.join(src_test_py_dir, 'jpy_java_embeddable_test.py'),
     os.path.join(src_test_py_dir, 'jpy_obj_test.py'),
     os.path.join(src_test_py_dir, 'jpy_eval_exec_test.py'),
+    os.path.join(src_test_py_dir, 'jpy_benchmark_test.py'),
+    # os.path.join(src_test_py_dir, 'jpy_perf_test.py'),
 ]
 
 # e.g. jdk_home_dir = '/home/marta/jdk1.7.0_15'
@@ -250,10 +282,10 @@ def _write_jpy_config(target_dir=None, install_dir=None):
 
 
 def _copy_jpyutil():
-    src = os.path.relpath(jpyutil.__file__)
     dest = _build_dir()
-    log.info('Copying %s to %s' % (src, dest))
-    shutil.copy(src, dest)
+    for src in [os.path.relpath(jpyutil.__file__), os.path.join(base_dir, 'jpyarrow.py')]:
+        log.info('Copying %s to %s' % (src, dest))
+        shutil.copy(src, dest)
 
 
 def _build_jpy():
@@ -336,7 +368,7 @@ setup(name='jpy',
       license=__license__,
       url='https://github.com/jpy-consortium/jpy',
       download_url='https://pypi.python.org/pypi/jpy/' + __version__,
-      py_modules=['jpyutil'],
+      py_modules=['jpyutil', 'jpyarrow'],
       ext_modules=[Extension('jpy',
                              sources=sources,
                              depends=headers,
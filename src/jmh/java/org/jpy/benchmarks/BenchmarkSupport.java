@@ -0,0 +1,28 @@
+package org.jpy.benchmarks;
+
+import java.io.File;
+import java.io.IOException;
+import java.io.UncheckedIOException;
+import org.jpy.PyLib;
+import org.jpy.PyModule;
+
+/**
+ * Starts Python once per benchmark JVM and imports the Python fixture module
+ * src/test/python/fixtures/benchmark_fixture.py.
+ */
+final class BenchmarkSupport {
+
+    private BenchmarkSupport() {
+    }
+
+    static synchronized PyModule startPython() {
+        if (!PyLib.isPythonRunning()) {
+            try {
+                PyLib.startPython(new File("src/test/python/fixtures").getCanonicalPath());
+            } catch (IOException e) {
+                throw new UncheckedIOException(e);
+            }
+        }
+        return PyModule.importModule("benchmark_fixture");
+    }
+}
@@ -0,0 +1,72 @@
+package org.jpy.benchmarks;
+
+import java.util.HashMap;
+import java.util.Map;
+import java.util.concurrent.TimeUnit;
+import org.jpy.PyInputMode;
+import org.jpy.PyLib;
+import org.jpy.PyObject;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * {@link PyObject#executeCode(String, PyInputMode, Object, Object)} with and without Java Maps as globals.
+ */
+@State(Scope.Benchmark)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+public class ExecuteCodeBenchmark {
+
+    @Param({"10", "1000"})
+    public int globalsSize;
+
+    @Param({"false", "true"})
+    public boolean lazyMapNamespaces;
+
+    private Map<String, Object> globals;
+
+    @Setup
+    public void setUp() {
+        BenchmarkSupport.startPython();
+        PyLib.setLazyMapNamespaces(lazyMapNamespaces);
+        globals = new HashMap<>();
+        for (int i = 0; i < globalsSize; i++) {
+            globals.put("v" + i, i);
+        }
+        globals.put("a", 1);
+        globals.put("b", 2);
+    }
+
+    @Benchmark
+    public int expression() {
+        try (PyObject result = PyObject.executeCode("1 + 2", PyInputMode.EXPRESSION)) {
+            return result.getIntValue();
+        }
+    }
+
+    @Benchmark
+    public int expressionWithMapGlobals() {
+        try (PyObject result = PyObject.executeCode("a + b", PyInputMode.EXPRESSION, globals, null)) {
+            return result.getIntValue();
+        }
+    }
+
+    @Benchmark
+    public Object scriptWithMapGlobals() {
+        try (PyObject result = PyObject.executeCode("c = a + b\n", PyInputMode.SCRIPT, globals, null)) {
+            return globals.get("c");
+        }
+    }
+}
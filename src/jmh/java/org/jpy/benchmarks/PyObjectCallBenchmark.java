@@ -0,0 +1,79 @@
+package org.jpy.benchmarks;
+
+import java.util.concurrent.TimeUnit;
+import org.jpy.PyModule;
+import org.jpy.PyObject;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Calls of Python functions and methods from Java through {@link PyObject#call(String, Object...)} and friends.
+ */
+@State(Scope.Benchmark)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+public class PyObjectCallBenchmark {
+
+    private PyModule module;
+    private PyObject counter;
+
+    @Setup
+    public void setUp() {
+        module = BenchmarkSupport.startPython();
+        counter = module.call("Counter");
+    }
+
+    @Benchmark
+    public boolean callNoArgs() {
+        try (PyObject result = module.callScoped("nop")) {
+            return result.isNone();
+        }
+    }
+
+    @Benchmark
+    public int callOneIntArg() {
+        return module.callForInt("identity", 42);
+    }
+
+    @Benchmark
+    public int callThreeIntArgs() {
+        return module.callForInt("add3", 1, 2, 3);
+    }
+
+    @Benchmark
+    public String callStringArg() {
+        try (PyObject result = module.callScoped("greet", "world")) {
+            return result.getStringValue();
+        }
+    }
+
+    @Benchmark
+    public int callTrackedResult() {
+        // the returned wrapper is registered for cleanup, see ReferenceCleanupBenchmark
+        PyObject result = module.call("identity", 42);
+        int value = result.getIntValue();
+        result.close();
+        return value;
+    }
+
+    @Benchmark
+    public int callMethod() {
+        return counter.callMethodForInt("increment");
+    }
+
+    @Benchmark
+    public int getAttribute() {
+        return counter.getIntAttribute("value");
+    }
+}
@@ -0,0 +1,49 @@
+package org.jpy.benchmarks;
+
+import java.util.concurrent.TimeUnit;
+import java.util.function.Function;
+import java.util.function.IntBinaryOperator;
+import org.jpy.PyModule;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Calls of Java interface methods implemented by Python objects through {@code createProxy()}.
+ */
+@State(Scope.Benchmark)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+public class PyProxyBenchmark {
+
+    private IntBinaryOperator adder;
+    private Function<String, String> greeter;
+
+    @Setup
+    @SuppressWarnings("unchecked")
+    public void setUp() {
+        PyModule module = BenchmarkSupport.startPython();
+        adder = module.call("Adder").createProxy(IntBinaryOperator.class);
+        greeter = module.call("Greeter").createProxy(Function.class);
+    }
+
+    @Benchmark
+    public int primitiveArgs() {
+        return adder.applyAsInt(1, 2);
+    }
+
+    @Benchmark
+    public String stringArg() {
+        return greeter.apply("world");
+    }
+}
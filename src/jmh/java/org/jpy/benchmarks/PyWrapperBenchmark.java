@@ -0,0 +1,122 @@
+package org.jpy.benchmarks;
+
+import java.util.List;
+import java.util.Map;
+import java.util.concurrent.TimeUnit;
+import org.jpy.KeyError;
+import org.jpy.PyDictWrapper;
+import org.jpy.PyModule;
+import org.jpy.PyObject;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Access to Python lists and dicts through {@link PyObject#asList()} and {@link PyObject#asDict()}.
+ */
+@State(Scope.Benchmark)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+public class PyWrapperBenchmark {
+
+    @Param({"10", "1000"})
+    public int size;
+
+    private List<PyObject> list;
+    private PyObject dictObject;
+    private PyDictWrapper dict;
+
+    @Setup
+    public void setUp() {
+        PyModule module = BenchmarkSupport.startPython();
+        list = module.call("make_list", size).asList();
+        dictObject = module.call("make_dict", size);
+        dict = dictObject.asDict();
+    }
+
+    @Benchmark
+    public long listGet() {
+        long sum = 0;
+        for (int i = 0; i < size; i++) {
+            try (PyObject item = list.get(i)) {
+                sum += item.getIntValue();
+            }
+        }
+        return sum;
+    }
+
+    @Benchmark
+    public long listIterate() {
+        long sum = 0;
+        for (PyObject item : list) {
+            sum += item.getIntValue();
+            item.close();
+        }
+        return sum;
+    }
+
+    @Benchmark
+    public int listToArray() {
+        PyObject[] items = list.toArray(new PyObject[0]);
+        for (PyObject item : items) {
+            item.close();
+        }
+        return items.length;
+    }
+
+    @Benchmark
+    public int dictGet() {
+        int found = 0;
+        for (int i = 0; i < size; i++) {
+            try (PyObject value = dict.get("key" + i)) {
+                found += value != null ? 1 : 0;
+            }
+        }
+        return found;
+    }
+
+    @Benchmark
+    public int dictGetMiss() {
+        int missed = 0;
+        for (int i = 0; i < size; i++) {
+            missed += dict.get("missing") == null ? 1 : 0;
+        }
+        return missed;
+    }
+
+    @Benchmark
+    public int dictGetItemMiss() {
+        // the KeyError is thrown into Java without formatting its traceback
+        int missed = 0;
+        for (int i = 0; i < size; i++) {
+            try {
+                dictObject.callMethod("__getitem__", "missing");
+            } catch (KeyError e) {
+                missed++;
+            }
+        }
+        return missed;
+    }
+
+    @Benchmark
+    public long dictEntrySet() {
+        long sum = 0;
+        for (Map.Entry<PyObject, PyObject> entry : dict.entrySet()) {
+            sum += entry.getValue().getIntValue();
+            entry.getKey().close();
+            entry.getValue().close();
+        }
+        return sum;
+    }
+}
@@ -0,0 +1,79 @@
+package org.jpy.benchmarks;
+
+import java.util.concurrent.TimeUnit;
+import org.jpy.PyModule;
+import org.jpy.PyObject;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Threads;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Creating and releasing Python object references from Java, with and without the release queue.
+ */
+@State(Scope.Benchmark)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+public class ReferenceCleanupBenchmark {
+
+    @Param({"false", "true"})
+    public boolean releaseQueue;
+
+    private PyObject counter;
+
+    @Setup
+    public void setUp() {
+        PyModule module = BenchmarkSupport.startPython();
+        PyObject.setReleaseQueueEnabled(releaseQueue);
+        counter = module.call("Counter");
+    }
+
+    @TearDown
+    public void tearDown() {
+        PyObject.drainReleaseQueue();
+        PyObject.setReleaseQueueEnabled(false);
+    }
+
+    @Benchmark
+    public long closeExplicitly() {
+        PyObject value = counter.getAttribute("value");
+        long pointer = value.getPointer();
+        value.close();
+        return pointer;
+    }
+
+    @Benchmark
+    public long closeScoped() {
+        try (PyObject value = counter.getAttributeScoped("value")) {
+            return value.getPointer();
+        }
+    }
+
+    @Benchmark
+    @Threads(4)
+    public long closeConcurrently() {
+        // contended GIL acquisitions without the queue, contended queue pushes with it
+        PyObject value = counter.getAttribute("value");
+        long pointer = value.getPointer();
+        value.close();
+        return pointer;
+    }
+
+    @Benchmark
+    public long leaveToGarbageCollector() {
+        // released by PyObject.cleanup() once the wrapper has been collected
+        return counter.getAttribute("value").getPointer();
+    }
+}
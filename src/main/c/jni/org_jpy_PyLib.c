@@ -26,6 +26,12 @@
 #include "jpy_jtype.h"
 #include "jpy_jobj.h"
 #include "jpy_conv.h"
+#include "jpy_mapproxy.h"
+#include "jpy_relqueue.h"
+#include "jpy_metrics.h"
+#include "jpy_profiler.h"
+#include "jpy_memstats.h"
+#include "jpy_async.h"
 
 #include "org_jpy_PyLib.h"
 #include "org_jpy_PyLib_Diag.h"
@@ -42,9 +48,11 @@ void PyLib_ThrowUOE(JNIEnv* jenv, const char *message);
 void PyLib_ThrowRTE(JNIEnv* jenv, const char *message);
 void PyLib_RedirectStdOut(void);
 int copyPythonDictToJavaMap(JNIEnv *jenv, PyObject *pyDict, jobject jMap);
+int flushMapProxyToJavaMap(JNIEnv *jenv, PyObject *pyProxy, jobject jMap);
 
 static PyThreadState *_save = NULL;
 
+static PyObject* PyLib_NewArgTuple(JNIEnv *jenv, const char* nameChars, jint argCount, jobjectArray jArgs, jobjectArray jParamClasses);
 static int python_traceback_report(PyObject *tb, char **buf, int* bufLen);
 
 //#define JPy_JNI_DEBUG 1
@@ -58,8 +66,14 @@ static int python_traceback_report(PyObject *tb, char **buf, int* bufLen);
 #define JPy_GIL_AWARE
 
 #ifdef JPy_GIL_AWARE
-    #define JPy_BEGIN_GIL_STATE  { PyGILState_STATE gilState = PyGILState_Ensure();
-    #define JPy_END_GIL_STATE    PyGILState_Release(gilState); }
+    // The time spent waiting for the GIL is recorded if metrics are enabled, see jpy_metrics.h.
+    // Before giving up the GIL, release some of the references queued by PyObject.close() and the
+    // PyObject cleanup. Skipped while a Java exception is pending, as destructors may call into Java.
+    #define JPy_BEGIN_GIL_STATE  { jlong gilWaitStart = JPy_MetricsEnabled ? JPy_NanoTime() : 0; \
+                                 PyGILState_STATE gilState = PyGILState_Ensure(); \
+                                 if (gilWaitStart != 0) { JPy_Metrics_RecordNativeGILWait(gilWaitStart); }
+    #define JPy_END_GIL_STATE    if (JPy_RelQueue_Depth > 0 && !(*jenv)->ExceptionCheck(jenv)) { JPy_RelQueue_DrainPending(); } \
+                                 PyGILState_Release(gilState); }
 #else
     #define JPy_BEGIN_GIL_STATE
     #define JPy_END_GIL_STATE
@@ -402,6 +416,10 @@ JNIEXPORT void JNICALL Java_org_jpy_PyLib_stopPython0
 
         JPy_BEGIN_GIL_STATE
 
+        // Release the queued references while jpy's types are still alive, then reject further pushes:
+        // whatever got queued since must not be released by the next interpreter
+        JPy_RelQueue_Drain(-1);
+        JPy_RelQueue_Close();
         JPy_free();
 
         JPy_END_GIL_STATE
@@ -733,6 +751,304 @@ error:
     return result == 1 ? JNI_TRUE : JNI_FALSE;
 }
 
+/**
+ * Creates a new Java org.jpy.PyObject holding a new reference to the given Python object.
+ * Unlike JType_CreateJavaPyObject(), the GIL is kept while the Java object is constructed, so that bulk
+ * transfers of many items cost a single GIL round trip.
+ */
+static jobject PyLib_NewJavaPyObject(JNIEnv* jenv, PyObject* pyObject)
+{
+    jobject objectRef;
+
+    JPy_INCREF(pyObject);
+    objectRef = (*jenv)->NewObject(jenv, JPy_PyObject_JClass, JPy_PyObject_Init_MID, (jlong) pyObject, JNI_TRUE);
+    if (objectRef == NULL) {
+        // the Java PyObject takes over the reference only if it has been constructed
+        JPy_DECREF(pyObject);
+    }
+    return objectRef;
+}
+
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_pyListSize
+        (JNIEnv *jenv, jclass libClass, jlong pyList) {
+    jint result = -1;
+    PyObject* src = (PyObject*)pyList;
+
+    JPy_BEGIN_GIL_STATE
+
+    if (!PyList_Check(src)) {
+        PyLib_ThrowUOE(jenv, "Not a list!");
+        goto error;
+    }
+
+    result = (jint) PyList_GET_SIZE(src);
+
+error:
+    JPy_END_GIL_STATE
+    return result;
+}
+
+JNIEXPORT jobject JNICALL Java_org_jpy_PyLib_pyListGetItem
+        (JNIEnv *jenv, jclass libClass, jlong pyList, jint index) {
+    jobject result = NULL;
+    PyObject* item;
+    PyObject* src = (PyObject*)pyList;
+
+    JPy_BEGIN_GIL_STATE
+
+    if (!PyList_Check(src)) {
+        PyLib_ThrowUOE(jenv, "Not a list!");
+        goto error;
+    }
+
+    // Note: item is a borrowed reference
+    item = PyList_GetItem(src, index);
+    if (item == NULL) {
+        PyLib_HandlePythonException(jenv);
+        goto error;
+    }
+
+    result = PyLib_NewJavaPyObject(jenv, item);
+
+error:
+    JPy_END_GIL_STATE
+    return result;
+}
+
+JNIEXPORT jobjectArray JNICALL Java_org_jpy_PyLib_pyListGetItems
+        (JNIEnv *jenv, jclass libClass, jlong pyList, jint start, jint count) {
+    jobjectArray result = NULL;
+    jobject jItem;
+    Py_ssize_t size;
+    jint index;
+    PyObject* slice = NULL;
+    PyObject* src = (PyObject*)pyList;
+
+    JPy_BEGIN_GIL_STATE
+
+    if (!PyList_Check(src)) {
+        PyLib_ThrowUOE(jenv, "Not a list!");
+        goto error;
+    }
+
+    size = PyList_GET_SIZE(src);
+    if (start < 0 || count < 0) {
+        PyLib_ThrowRTE(jenv, "Negative list range");
+        goto error;
+    }
+    if (start >= size) {
+        count = 0;
+    } else if (count > size - start) {
+        count = (jint) (size - start);
+    }
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_pyListGetItems: start=%d, count=%d\n", start, count);
+
+    // Constructing a Java PyObject may release other Python objects (and so run arbitrary Python code),
+    // so we work on a private shallow copy of the range.
+    slice = PyList_GetSlice(src, start, start + count);
+    if (slice == NULL) {
+        PyLib_HandlePythonException(jenv);
+        goto error;
+    }
+
+    result = (*jenv)->NewObjectArray(jenv, count, JPy_PyObject_JClass, NULL);
+    if (result == NULL) {
+        goto error;
+    }
+
+    for (index = 0; index < count; index++) {
+        jItem = PyLib_NewJavaPyObject(jenv, PyList_GET_ITEM(slice, index));
+        if (jItem == NULL) {
+            JPy_DELETE_LOCAL_REF(result);
+            goto error;
+        }
+        (*jenv)->SetObjectArrayElement(jenv, result, index, jItem);
+        JPy_DELETE_LOCAL_REF(jItem);
+    }
+
+error:
+    JPy_XDECREF(slice);
+    JPy_END_GIL_STATE
+    return result;
+}
+
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_pyDictSize
+        (JNIEnv *jenv, jclass libClass, jlong pyDict) {
+    jint result = -1;
+    PyObject* src = (PyObject*)pyDict;
+
+    JPy_BEGIN_GIL_STATE
+
+    if (!PyDict_Check(src)) {
+        PyLib_ThrowUOE(jenv, "Not a dictionary!");
+        goto error;
+    }
+
+    result = (jint) PyDict_Size(src);
+
+error:
+    JPy_END_GIL_STATE
+    return result;
+}
+
+/**
+ * Converts a Java object into a new Python reference, using the given class if it is not null.
+ */
+static PyObject* PyLib_FromJObjectWithClass(JNIEnv *jenv, jobject jObject, jclass jClass)
+{
+    JPy_JType* type;
+    PyObject* pyObject;
+
+    if (jClass == NULL) {
+        return JPy_FromJObject(jenv, jObject);
+    }
+    type = JType_GetType(jenv, jClass, JNI_FALSE);
+    if (type == NULL) {
+        return NULL;
+    }
+    pyObject = JPy_FromJObjectWithType(jenv, jObject, type);
+    JPy_DECREF(type);
+    return pyObject;
+}
+
+JNIEXPORT jobject JNICALL Java_org_jpy_PyLib_pyDictGetItem
+        (JNIEnv *jenv, jclass libClass, jlong pyDict, jobject jKey, jclass jKeyClass) {
+    jobject result = NULL;
+    PyObject* pyKey = NULL;
+    PyObject* pyValue;
+    PyObject* src = (PyObject*)pyDict;
+
+    JPy_BEGIN_GIL_STATE
+
+    if (!PyDict_Check(src)) {
+        PyLib_ThrowUOE(jenv, "Not a dictionary!");
+        goto error;
+    }
+
+    pyKey = PyLib_FromJObjectWithClass(jenv, jKey, jKeyClass);
+    if (pyKey == NULL) {
+        PyLib_HandlePythonException(jenv);
+        goto error;
+    }
+
+    // Note: pyValue is a borrowed reference, a missing key is not an error
+    pyValue = PyDict_GetItemWithError(src, pyKey);
+    if (pyValue == NULL) {
+        if (PyErr_Occurred()) {
+            PyLib_HandlePythonException(jenv);
+        }
+        goto error;
+    }
+
+    result = PyLib_NewJavaPyObject(jenv, pyValue);
+
+error:
+    JPy_XDECREF(pyKey);
+    JPy_END_GIL_STATE
+    return result;
+}
+
+JNIEXPORT jboolean JNICALL Java_org_jpy_PyLib_pyDictContainsValue
+        (JNIEnv *jenv, jclass libClass, jlong pyDict, jobject jValue, jclass jValueClass) {
+    int result = 0;
+    Py_ssize_t pos = 0;
+    PyObject* pyKey;
+    PyObject* pyItem;
+    PyObject* pyValue = NULL;
+    PyObject* src = (PyObject*)pyDict;
+
+    JPy_BEGIN_GIL_STATE
+
+    if (!PyDict_Check(src)) {
+        PyLib_ThrowUOE(jenv, "Not a dictionary!");
+        goto error;
+    }
+
+    pyValue = PyLib_FromJObjectWithClass(jenv, jValue, jValueClass);
+    if (pyValue == NULL) {
+        PyLib_HandlePythonException(jenv);
+        goto error;
+    }
+
+    while (PyDict_Next(src, &pos, &pyKey, &pyItem)) {
+        // PyObject_RichCompareBool() may run Python code which mutates the dictionary, so hold on to the item
+        JPy_INCREF(pyItem);
+        result = PyObject_RichCompareBool(pyItem, pyValue, Py_EQ);
+        JPy_DECREF(pyItem);
+        if (result != 0) {
+            break;
+        }
+    }
+    if (result < 0) {
+        PyLib_HandlePythonException(jenv);
+    }
+
+error:
+    JPy_XDECREF(pyValue);
+    JPy_END_GIL_STATE
+    return result == 1 ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jobjectArray JNICALL Java_org_jpy_PyLib_pyDictItems
+        (JNIEnv *jenv, jclass libClass, jlong pyDict) {
+    jobjectArray result = NULL;
+    jobject jItem;
+    Py_ssize_t pos = 0;
+    Py_ssize_t itemCount = 0;
+    Py_ssize_t index;
+    PyObject** items = NULL;
+    PyObject* pyKey;
+    PyObject* pyValue;
+    PyObject* src = (PyObject*)pyDict;
+
+    JPy_BEGIN_GIL_STATE
+
+    if (!PyDict_Check(src)) {
+        PyLib_ThrowUOE(jenv, "Not a dictionary!");
+        goto error;
+    }
+
+    // Constructing a Java PyObject may release other Python objects (and so run arbitrary Python code),
+    // so we first collect the keys and values interleaved: [k0, v0, k1, v1, ...]
+    items = PyMem_New(PyObject*, 2 * PyDict_Size(src) + 1);
+    if (items == NULL) {
+        PyLib_ThrowOOM(jenv);
+        goto error;
+    }
+    while (PyDict_Next(src, &pos, &pyKey, &pyValue)) {
+        JPy_INCREF(pyKey);
+        JPy_INCREF(pyValue);
+        items[itemCount++] = pyKey;
+        items[itemCount++] = pyValue;
+    }
+
+    result = (*jenv)->NewObjectArray(jenv, (jint) itemCount, JPy_PyObject_JClass, NULL);
+    if (result == NULL) {
+        goto error;
+    }
+
+    for (index = 0; index < itemCount; index++) {
+        jItem = PyLib_NewJavaPyObject(jenv, items[index]);
+        if (jItem == NULL) {
+            JPy_DELETE_LOCAL_REF(result);
+            goto error;
+        }
+        (*jenv)->SetObjectArrayElement(jenv, result, (jint) index, jItem);
+        JPy_DELETE_LOCAL_REF(jItem);
+    }
+
+error:
+    if (items != NULL) {
+        for (index = 0; index < itemCount; index++) {
+            JPy_DECREF(items[index]);
+        }
+        PyMem_Del(items);
+    }
+    JPy_END_GIL_STATE
+    return result;
+}
+
 /**
  * Copies a Java Map<String, Object> into a new Python dictionary.
  */
@@ -804,10 +1120,30 @@ error:
     return NULL;
 }
 
+/**
+ * Tells whether the given key of a globals dictionary is '__builtins__', which Python inserts into the globals
+ * it runs code in. It is not written back to the Java Map.
+ */
+static int isBuiltinsKey(PyObject *pyKey) {
+    const char *name;
+
+    if (!JPy_IS_STR(pyKey)) {
+        return 0;
+    }
+    name = JPy_AS_UTF8(pyKey);
+    if (name == NULL) {
+        // not encodable, the conversion to a Java key reports it
+        PyErr_Clear();
+        return 0;
+    }
+    return strcmp(name, "__builtins__") == 0;
+}
+
 int copyPythonDictToJavaMap(JNIEnv *jenv, PyObject *pyDict, jobject jMap) {
     PyObject *pyKey, *pyValue;
     Py_ssize_t pos = 0;
     Py_ssize_t dictSize;
+    Py_ssize_t count;
     jobject *jValues = NULL;
     jobject *jKeys = NULL;
     int ii;
@@ -839,6 +1175,9 @@ int copyPythonDictToJavaMap(JNIEnv *jenv, PyObject *pyDict, jobject jMap) {
     // first convert everything
     ii = 0;
     while (PyDict_Next(pyDict, &pos, &pyKey, &pyValue)) {
+        if (isBuiltinsKey(pyKey)) {
+            continue;
+        }
         if (JPy_AsJObjectWithClass(jenv, pyKey, &(jKeys[ii]), JPy_String_JClass) < 0) {
             // an error occurred
             goto error;
@@ -849,10 +1188,11 @@ int copyPythonDictToJavaMap(JNIEnv *jenv, PyObject *pyDict, jobject jMap) {
         }
         ii++;
     }
+    count = ii;
 
     // now that we've converted, clear out the map and repopulate it
     (*jenv)->CallVoidMethod(jenv, jMap, JPy_Map_clear_MID);
-    for (ii = 0; ii < dictSize; ++ii) {
+    for (ii = 0; ii < count; ++ii) {
         // since the map is cleared, we want to plow through all of the put operations
         (*jenv)->CallObjectMethod(jenv, jMap, JPy_Map_put_MID, jKeys[ii], jValues[ii]);
     }
@@ -870,6 +1210,86 @@ error:
     return retcode;
 }
 
+/**
+ * Writes back the entries of a MapProxy that have been assigned, rebound or deleted by Python.
+ * Entries that were only read are left untouched in the Java Map.
+ */
+int flushMapProxyToJavaMap(JNIEnv *jenv, PyObject *pyProxy, jobject jMap) {
+    JPy_MapProxy* proxy = (JPy_MapProxy*) pyProxy;
+    PyObject *pyKey, *pyValue;
+    Py_ssize_t pos;
+    jobject jKey, jValue, jPrevious;
+    int putCount = 0, removeCount = 0;
+    jboolean exceptionAlready = JNI_FALSE;
+    jthrowable savedException = NULL;
+    int retcode = -1;
+
+    exceptionAlready = (*jenv)->ExceptionCheck(jenv);
+    if (exceptionAlready) {
+        // save the exception away, because otherwise the conversion methods might spuriously fail
+        savedException = (*jenv)->ExceptionOccurred(jenv);
+        (*jenv)->ExceptionClear(jenv);
+    }
+
+    // put entries which are new or no longer identical to the value loaded from the Java Map
+    pos = 0;
+    while (PyDict_Next(pyProxy, &pos, &pyKey, &pyValue)) {
+        if (PyDict_GetItem(proxy->loaded, pyKey) == pyValue || isBuiltinsKey(pyKey)) {
+            continue;
+        }
+        if (JPy_AsJObjectWithClass(jenv, pyKey, &jKey, JPy_String_JClass) < 0) {
+            goto error;
+        }
+        if (JPy_AsJObject(jenv, pyValue, &jValue, JNI_TRUE) < 0) {
+            JPy_DELETE_LOCAL_REF(jKey);
+            goto error;
+        }
+        jPrevious = (*jenv)->CallObjectMethod(jenv, jMap, JPy_Map_put_MID, jKey, jValue);
+        JPy_DELETE_LOCAL_REF(jKey);
+        JPy_DELETE_LOCAL_REF(jValue);
+        JPy_DELETE_LOCAL_REF(jPrevious);
+        JPy_ON_JAVA_EXCEPTION_GOTO(error);
+        putCount++;
+    }
+
+    // remove loaded entries which have gone (e.g. a 'del' of a global bypasses the proxy) and deleted entries
+    pos = 0;
+    while (PyDict_Next(proxy->loaded, &pos, &pyKey, &pyValue)) {
+        if (PyDict_GetItem(pyProxy, pyKey) == NULL && PyDict_GetItem(proxy->deleted, pyKey) == NULL) {
+            PyDict_SetItem(proxy->deleted, pyKey, Py_None);
+        }
+    }
+    pos = 0;
+    while (PyDict_Next(proxy->deleted, &pos, &pyKey, &pyValue)) {
+        if (PyDict_GetItem(pyProxy, pyKey) != NULL) {
+            // re-assigned by a 'global' statement, which bypasses the proxy
+            continue;
+        }
+        if (JPy_AsJObjectWithClass(jenv, pyKey, &jKey, JPy_String_JClass) < 0) {
+            goto error;
+        }
+        jPrevious = (*jenv)->CallObjectMethod(jenv, jMap, JPy_Map_remove_MID, jKey);
+        JPy_DELETE_LOCAL_REF(jKey);
+        JPy_DELETE_LOCAL_REF(jPrevious);
+        JPy_ON_JAVA_EXCEPTION_GOTO(error);
+        removeCount++;
+    }
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "flushMapProxyToJavaMap: loaded=%d, put=%d, removed=%d\n",
+                   (int) PyDict_Size(proxy->loaded), putCount, removeCount);
+
+    // and we are successful!
+    retcode = 0;
+
+error:
+    if (exceptionAlready) {
+        // restore our original exception
+        (*jenv)->Throw(jenv, savedException);
+    }
+
+    return retcode;
+}
+
 typedef PyObject * (*DoRun)(const void *,int,PyObject*,PyObject*);
 
 /**
@@ -886,18 +1306,23 @@ typedef PyObject * (*DoRun)(const void *,int,PyObject*,PyObject*);
  * they must be a map from String to Object, and will be copied to a new python dictionary.  After execution
  * completes the dictionary entries will be copied back.
  *
+ * If lazy map namespaces are enabled (see PyLib.setLazyMapNamespaces()), a Java Map is wrapped by a MapProxy
+ * instead: entries are converted only when Python looks them up, and only assigned or deleted entries are
+ * written back after execution.
+ *
  */
 jlong executeInternal(JNIEnv* jenv, jclass jLibClass, jint jStart, jobject jGlobals, jobject jLocals, DoRun runFunction, void *runArg) {
     PyObject *pyReturnValue;
     PyObject *pyGlobals;
     PyObject *pyLocals;
     int start;
-    jboolean decGlobals, decLocals, copyGlobals, copyLocals;
+    jboolean decGlobals, decLocals, copyGlobals, copyLocals, flushGlobals, flushLocals;
 
     JPy_BEGIN_GIL_STATE
 
     decGlobals = decLocals = JNI_FALSE;
     copyGlobals = copyLocals = JNI_FALSE;
+    flushGlobals = flushLocals = JNI_FALSE;
     pyGlobals = NULL;
     pyLocals = NULL;
     pyReturnValue = NULL;
@@ -917,6 +1342,19 @@ jlong executeInternal(JNIEnv* jenv, jclass jLibClass, jint jStart, jobject jGlob
         // if we are an instance of a wrapped dictionary, just use the underlying dictionary
         pyGlobals = (PyObject *)((*jenv)->CallLongMethod(jenv, jGlobals, JPy_PyDictWrapper_GetPointer_MID));
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: using PyDictWrapper globals\n");
+    } else if (JPy_LazyMapNamespaces
+               && (jLocals == NULL || (*jenv)->IsSameObject(jenv, jLocals, jGlobals))
+               && (*jenv)->IsInstanceOf(jenv, jGlobals, JPy_Map_JClass)) {
+        // Only if the globals are also the locals: with separate locals, LOAD_NAME and DELETE_GLOBAL access
+        // the globals with the dict API, which bypasses the lazy lookup, so they are copied eagerly below
+        JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: using lazy Java Map globals\n");
+        // wrap the java Map, entries are converted on demand
+        pyGlobals = MapProxy_New(jenv, jGlobals);
+        if (pyGlobals == NULL) {
+            PyLib_HandlePythonException(jenv);
+            goto error;
+        }
+        flushGlobals = decGlobals = JNI_TRUE;
     } else if ((*jenv)->IsInstanceOf(jenv, jGlobals, JPy_Map_JClass)) {
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: using Java Map globals\n");
         // this is a java Map and we need to convert it
@@ -936,7 +1374,7 @@ jlong executeInternal(JNIEnv* jenv, jclass jLibClass, jint jStart, jobject jGlob
     // locals dictionaries as global and local namespace. ... If the locals dictionary is omitted it defaults to the
     // globals dictionary. If both dictionaries are omitted, the expression is executed in the environment where eval()
     // is called. The return value is the result of the evaluated expression.
-    if (jLocals == NULL) {
+    if (jLocals == NULL || (flushGlobals && (*jenv)->IsSameObject(jenv, jLocals, jGlobals))) {
         pyLocals = pyGlobals;
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: using globals for locals\n");
     } else if ((*jenv)->IsInstanceOf(jenv, jLocals, JPy_PyObject_JClass)) {
@@ -947,6 +1385,15 @@ jlong executeInternal(JNIEnv* jenv, jclass jLibClass, jint jStart, jobject jGlob
         // if we are an instance of a wrapped dictionary, just use the underlying dictionary
         pyLocals = (PyObject *)((*jenv)->CallLongMethod(jenv, jLocals, JPy_PyDictWrapper_GetPointer_MID));
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: using PyDictWrapper locals\n");
+    } else if (JPy_LazyMapNamespaces && (*jenv)->IsInstanceOf(jenv, jLocals, JPy_Map_JClass)) {
+        JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: using lazy Java Map locals\n");
+        // wrap the java Map, entries are converted on demand
+        pyLocals = MapProxy_New(jenv, jLocals);
+        if (pyLocals == NULL) {
+            PyLib_HandlePythonException(jenv);
+            goto error;
+        }
+        flushLocals = decLocals = JNI_TRUE;
     } else if ((*jenv)->IsInstanceOf(jenv, jLocals, JPy_Map_JClass)) {
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: using Java Map locals\n");
         // this is a java Map and we need to convert it
@@ -981,6 +1428,14 @@ error:
         copyPythonDictToJavaMap(jenv, pyLocals, jLocals);
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: copied back Java locals\n");
     }
+    if (flushGlobals) {
+        flushMapProxyToJavaMap(jenv, pyGlobals, jGlobals);
+        JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: flushed back Java globals\n");
+    }
+    if (flushLocals) {
+        flushMapProxyToJavaMap(jenv, pyLocals, jLocals);
+        JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: flushed back Java locals\n");
+    }
     if (decGlobals) {
         JPy_XDECREF(pyGlobals);
     }
@@ -1091,17 +1546,39 @@ error:
 }
 
 /*
- * Class:     org_jpy_python_PyLib
- * Method:    incRef
- * Signature: (J)V
+ * Class:     org_jpy_PyLib
+ * Method:    setLazyMapNamespaces
+ * Signature: (Z)V
  */
-JNIEXPORT void JNICALL Java_org_jpy_PyLib_incRef
-  (JNIEnv* jenv, jclass jLibClass, jlong objId)
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_setLazyMapNamespaces
+  (JNIEnv* jenv, jclass jLibClass, jboolean enabled)
 {
-    PyObject* pyObject;
-    Py_ssize_t refCount;
-
-    pyObject = (PyObject*) objId;
+    JPy_LazyMapNamespaces = enabled ? 1 : 0;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    isLazyMapNamespaces
+ * Signature: ()Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jpy_PyLib_isLazyMapNamespaces
+  (JNIEnv* jenv, jclass jLibClass)
+{
+    return JPy_LazyMapNamespaces ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     org_jpy_python_PyLib
+ * Method:    incRef
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_incRef
+  (JNIEnv* jenv, jclass jLibClass, jlong objId)
+{
+    PyObject* pyObject;
+    Py_ssize_t refCount;
+
+    pyObject = (PyObject*) objId;
 
     if (Py_IsInitialized()) {
         JPy_BEGIN_GIL_STATE
@@ -1180,6 +1657,166 @@ JNIEXPORT void JNICALL Java_org_jpy_PyLib_decRefs
     }
 }
 
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    enqueueDecRef
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_enqueueDecRef
+  (JNIEnv* jenv, jclass jLibClass, jlong objId)
+{
+    Py_ssize_t depth;
+
+    // Doesn't need the GIL, but the references must not outlive the interpreter
+    if (!Py_IsInitialized()) {
+        return -1;
+    }
+    depth = JPy_RelQueue_Push(&objId, 1);
+    if (depth < 0) {
+        JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "Java_org_jpy_PyLib_enqueueDecRef: error: failed to queue pyObject=%p\n", (PyObject*) objId);
+        return -1;
+    }
+    return depth > INT_MAX ? INT_MAX : (jint) depth;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    enqueueDecRefs
+ * Signature: ([JI)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_enqueueDecRefs
+  (JNIEnv* jenv, jclass jLibClass, jlongArray objIds, jint len)
+{
+    Py_ssize_t depth;
+    jlong* buf;
+
+    if (!Py_IsInitialized()) {
+        return -1;
+    }
+
+    // Nothing is called back while the elements are pinned, so a critical array is fine here
+    buf = (*jenv)->GetPrimitiveArrayCritical(jenv, objIds, NULL);
+    if (buf == NULL) {
+        return -1;
+    }
+    depth = JPy_RelQueue_Push(buf, len);
+    (*jenv)->ReleasePrimitiveArrayCritical(jenv, objIds, buf, JNI_ABORT);
+    if (depth < 0) {
+        JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "Java_org_jpy_PyLib_enqueueDecRefs: error: failed to queue %d references\n", len);
+        return -1;
+    }
+    return depth > INT_MAX ? INT_MAX : (jint) depth;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    drainDecRefs
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_drainDecRefs
+  (JNIEnv* jenv, jclass jLibClass)
+{
+    Py_ssize_t released = 0;
+
+    if (Py_IsInitialized()) {
+        JPy_BEGIN_GIL_STATE
+        released = JPy_RelQueue_Drain(-1);
+        JPy_END_GIL_STATE
+    } else {
+        JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "Java_org_jpy_PyLib_drainDecRefs: error: no interpreter\n");
+    }
+    return released > INT_MAX ? INT_MAX : (jint) released;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    getReleaseQueueStats
+ * Signature: ([J)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_getReleaseQueueStats
+  (JNIEnv* jenv, jclass jLibClass, jlongArray jStats)
+{
+    jlong stats[JPy_RELQUEUE_STAT_COUNT];
+    jsize len;
+
+    JPy_RelQueue_GetStats(stats);
+    len = (*jenv)->GetArrayLength(jenv, jStats);
+    (*jenv)->SetLongArrayRegion(jenv, jStats, 0, len < JPy_RELQUEUE_STAT_COUNT ? len : JPy_RELQUEUE_STAT_COUNT, stats);
+}
+
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    runAsyncCall
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_runAsyncCall
+  (JNIEnv* jenv, jclass jLibClass, jlong call)
+{
+    JPy_AsyncCall_Run(jenv, (JPy_AsyncCall*) call);
+}
+
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    completeAsyncCall
+ * Signature: (JLjava/lang/Object;Ljava/lang/Throwable;)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_completeAsyncCall
+  (JNIEnv* jenv, jclass jLibClass, jlong call, jobject value, jthrowable error)
+{
+    JPy_AsyncCall_Complete(jenv, (JPy_AsyncCall*) call, value, error);
+}
+
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callAsync
+ * Signature: (JLjava/lang/String;I[Ljava/lang/Object;[Ljava/lang/Class;Ljava/util/concurrent/CompletableFuture;)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_callAsync
+  (JNIEnv* jenv, jclass jLibClass, jlong objId, jstring jName, jint argCount, jobjectArray jArgs, jobjectArray jParamClasses, jobject jFuture)
+{
+    PyObject* pyObject = (PyObject*) objId;
+    PyObject* pyCallable = NULL;
+    PyObject* pyArgs = NULL;
+    const char* nameChars = NULL;
+
+    JPy_BEGIN_GIL_STATE
+
+    if (jName != NULL) {
+        nameChars = (*jenv)->GetStringUTFChars(jenv, jName, NULL);
+        if (nameChars == NULL) {
+            PyLib_ThrowOOM(jenv);
+            goto error;
+        }
+        JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_callAsync: objId=%p, name='%s', argCount=%d\n", pyObject, nameChars, argCount);
+        pyCallable = PyObject_GetAttrString(pyObject, nameChars);
+        if (pyCallable == NULL) {
+            PyLib_HandlePythonException(jenv);
+            goto error;
+        }
+        pyArgs = PyLib_NewArgTuple(jenv, nameChars, argCount, jArgs, jParamClasses);
+        if (pyArgs == NULL) {
+            goto error;
+        }
+    }
+
+    // Without a name, the object itself is awaited
+    if (JPy_AsyncTask_Submit(jenv, pyCallable != NULL ? pyCallable : pyObject, pyArgs, jFuture) < 0) {
+        PyLib_HandlePythonException(jenv);
+    }
+
+error:
+    if (nameChars != NULL) {
+        (*jenv)->ReleaseStringUTFChars(jenv, jName, nameChars);
+    }
+    JPy_XDECREF(pyCallable);
+    JPy_XDECREF(pyArgs);
+
+    JPy_END_GIL_STATE
+}
+
 
 /*
  * Class:     org_jpy_python_PyLib
@@ -2216,6 +2853,157 @@ error:
     return jReturnValue;
 }
 
+/**
+ * Converts a Python int into a Java long, or into a Java int if isInt is set. Throws a Java
+ * exception and returns 0 if the conversion fails. Steals the reference to pyValue, which
+ * may be NULL if a Java exception has already been thrown.
+ */
+static jlong PyLib_StealAsJLong(JNIEnv* jenv, PyObject* pyValue, jboolean isInt)
+{
+    PY_LONG_LONG value;
+
+    if (pyValue == NULL) {
+        return 0;
+    }
+
+    value = JPy_AS_CLONGLONG(pyValue);
+    JPy_DECREF(pyValue);
+    if (value == -1 && PyErr_Occurred()) {
+        PyLib_HandlePythonException(jenv);
+        return 0;
+    }
+    if (isInt && (value < INT_MIN || value > INT_MAX)) {
+        PyErr_SetString(PyExc_OverflowError, "Python int too large to convert to Java int");
+        PyLib_HandlePythonException(jenv);
+        return 0;
+    }
+    return (jlong) value;
+}
+
+/**
+ * Converts a Python float (or any object implementing __float__) into a Java double. Throws a Java
+ * exception and returns 0 if the conversion fails. Steals the reference to pyValue, which may be
+ * NULL if a Java exception has already been thrown.
+ */
+static jdouble PyLib_StealAsJDouble(JNIEnv* jenv, PyObject* pyValue)
+{
+    double value;
+
+    if (pyValue == NULL) {
+        return 0;
+    }
+
+    value = PyFloat_AsDouble(pyValue);
+    JPy_DECREF(pyValue);
+    if (value == -1.0 && PyErr_Occurred()) {
+        PyLib_HandlePythonException(jenv);
+        return 0;
+    }
+    return (jdouble) value;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    getAttributeInt
+ * Signature: (JLjava/lang/String;)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_getAttributeInt
+  (JNIEnv* jenv, jclass jLibClass, jlong objId, jstring jName)
+{
+    jint value;
+
+    JPy_BEGIN_GIL_STATE
+    value = (jint) PyLib_StealAsJLong(jenv, PyLib_GetAttributeObject(jenv, (PyObject*) objId, jName), JNI_TRUE);
+    JPy_END_GIL_STATE
+
+    return value;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    getAttributeLong
+ * Signature: (JLjava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_getAttributeLong
+  (JNIEnv* jenv, jclass jLibClass, jlong objId, jstring jName)
+{
+    jlong value;
+
+    JPy_BEGIN_GIL_STATE
+    value = PyLib_StealAsJLong(jenv, PyLib_GetAttributeObject(jenv, (PyObject*) objId, jName), JNI_FALSE);
+    JPy_END_GIL_STATE
+
+    return value;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    getAttributeDouble
+ * Signature: (JLjava/lang/String;)D
+ */
+JNIEXPORT jdouble JNICALL Java_org_jpy_PyLib_getAttributeDouble
+  (JNIEnv* jenv, jclass jLibClass, jlong objId, jstring jName)
+{
+    jdouble value;
+
+    JPy_BEGIN_GIL_STATE
+    value = PyLib_StealAsJDouble(jenv, PyLib_GetAttributeObject(jenv, (PyObject*) objId, jName));
+    JPy_END_GIL_STATE
+
+    return value;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callForInt
+ * Signature: (JZLjava/lang/String;I[Ljava/lang/Object;[Ljava/lang/Class;)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_callForInt
+  (JNIEnv *jenv, jclass jLibClass, jlong objId, jboolean isMethodCall, jstring jName, jint argCount, jobjectArray jArgs, jobjectArray jParamClasses)
+{
+    jint value;
+
+    JPy_BEGIN_GIL_STATE
+    value = (jint) PyLib_StealAsJLong(jenv, PyLib_CallAndReturnObject(jenv, (PyObject*) objId, isMethodCall, jName, argCount, jArgs, jParamClasses), JNI_TRUE);
+    JPy_END_GIL_STATE
+
+    return value;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callForLong
+ * Signature: (JZLjava/lang/String;I[Ljava/lang/Object;[Ljava/lang/Class;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_callForLong
+  (JNIEnv *jenv, jclass jLibClass, jlong objId, jboolean isMethodCall, jstring jName, jint argCount, jobjectArray jArgs, jobjectArray jParamClasses)
+{
+    jlong value;
+
+    JPy_BEGIN_GIL_STATE
+    value = PyLib_StealAsJLong(jenv, PyLib_CallAndReturnObject(jenv, (PyObject*) objId, isMethodCall, jName, argCount, jArgs, jParamClasses), JNI_FALSE);
+    JPy_END_GIL_STATE
+
+    return value;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callForDouble
+ * Signature: (JZLjava/lang/String;I[Ljava/lang/Object;[Ljava/lang/Class;)D
+ */
+JNIEXPORT jdouble JNICALL Java_org_jpy_PyLib_callForDouble
+  (JNIEnv *jenv, jclass jLibClass, jlong objId, jboolean isMethodCall, jstring jName, jint argCount, jobjectArray jArgs, jobjectArray jParamClasses)
+{
+    jdouble value;
+
+    JPy_BEGIN_GIL_STATE
+    value = PyLib_StealAsJDouble(jenv, PyLib_CallAndReturnObject(jenv, (PyObject*) objId, isMethodCall, jName, argCount, jArgs, jParamClasses));
+    JPy_END_GIL_STATE
+
+    return value;
+}
+
 
 /*
  * Class:     org_jpy_python_PyLib
@@ -2233,36 +3021,337 @@ JNIEXPORT jint JNICALL Java_org_jpy_PyLib_00024Diag_getFlags
  * Method:    setDiagFlags
  * Signature: (I)V
  */
-JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_setFlags
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_setFlags0
   (JNIEnv *jenv, jclass classRef, jint flags)
 {
     JPy_DiagFlags = flags;
 }
 
-////////////////////////////////////////////////////////////////////////////////////
-// Helpers that also throw Java exceptions
-
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    initJavaFlags
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_initJavaFlags
+  (JNIEnv *jenv, jclass classRef)
+{
+    JPy_Diag_InitJavaFlags(jenv, classRef);
+}
 
-PyObject* PyLib_GetAttributeObject(JNIEnv* jenv, PyObject* pyObject, jstring jName)
+typedef struct PyLib_DiagLines
 {
-    PyObject* pyValue = NULL;
-    const char* nameChars;
+    char** lines;
+    Py_ssize_t count;
+    Py_ssize_t capacity;
+}
+PyLib_DiagLines;
 
-    nameChars = (*jenv)->GetStringUTFChars(jenv, jName, NULL);
-    if (nameChars == NULL) {
-        PyLib_ThrowOOM(jenv);
-        goto error;
+static int PyLib_CollectDiagEvent(void* arg, long long time, unsigned long threadId, int flags, const char* message)
+{
+    PyLib_DiagLines* lines = (PyLib_DiagLines*) arg;
+    char** grown;
+    size_t len;
+
+    if (lines->count == lines->capacity) {
+        lines->capacity = 2 * lines->capacity + 256;
+        grown = (char**) realloc(lines->lines, lines->capacity * sizeof (char*));
+        if (grown == NULL) {
+            return -1;
+        }
+        lines->lines = grown;
     }
-    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "PyLib_GetAttributeObject: objId=%p, name='%s'\n", pyObject, nameChars);
-    /* Note: pyValue is a new reference */
-    pyValue = PyObject_GetAttrString(pyObject, nameChars);
-    if (pyValue == NULL) {
-        JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "PyLib_GetAttributeObject: error: attribute not found '%s'\n", nameChars);
-        PyLib_HandlePythonException(jenv);
+    len = strlen(message) + 64;
+    lines->lines[lines->count] = (char*) malloc(len);
+    if (lines->lines[lines->count] == NULL) {
+        return -1;
     }
-error:
-    if (nameChars != NULL) {
-        (*jenv)->ReleaseStringUTFChars(jenv, jName, nameChars);
+    PyOS_snprintf(lines->lines[lines->count], len, "%lld [%lu] %s", time, threadId, message);
+    lines->count++;
+    return 0;
+}
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    drainEvents
+ * Signature: ()[Ljava/lang/String;
+ */
+JNIEXPORT jobjectArray JNICALL Java_org_jpy_PyLib_00024Diag_drainEvents
+  (JNIEnv *jenv, jclass classRef)
+{
+    PyLib_DiagLines lines = {NULL, 0, 0};
+    jobjectArray result = NULL;
+    jclass stringClass;
+    jstring jLine;
+    Py_ssize_t i;
+
+    // Lines collected before a failure are still returned
+    JPy_Diag_DrainEvents(PyLib_CollectDiagEvent, &lines);
+
+    stringClass = (*jenv)->FindClass(jenv, "java/lang/String");
+    if (stringClass != NULL) {
+        result = (*jenv)->NewObjectArray(jenv, (jsize) lines.count, stringClass, NULL);
+        JPy_DELETE_LOCAL_REF(stringClass);
+    }
+    for (i = 0; i < lines.count; i++) {
+        if (result != NULL) {
+            jLine = (*jenv)->NewStringUTF(jenv, lines.lines[i]);
+            if (jLine == NULL) {
+                result = NULL;
+            } else {
+                (*jenv)->SetObjectArrayElement(jenv, result, (jsize) i, jLine);
+                JPy_DELETE_LOCAL_REF(jLine);
+            }
+        }
+        free(lines.lines[i]);
+    }
+    free(lines.lines);
+    return result;
+}
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    dumpEvents
+ * Signature: (Ljava/lang/String;)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_00024Diag_dumpEvents
+  (JNIEnv *jenv, jclass classRef, jstring jPath)
+{
+    const char* pathChars;
+    Py_ssize_t count;
+
+    pathChars = (*jenv)->GetStringUTFChars(jenv, jPath, NULL);
+    if (pathChars == NULL) {
+        PyLib_ThrowOOM(jenv);
+        return -1;
+    }
+    count = JPy_Diag_DumpEvents(pathChars);
+    if (count < 0) {
+        PyLib_ThrowFNFE(jenv, pathChars);
+    }
+    (*jenv)->ReleaseStringUTFChars(jenv, jPath, pathChars);
+    return (jint) count;
+}
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    setStdout
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_setStdout
+  (JNIEnv *jenv, jclass classRef, jboolean enabled)
+{
+    JPy_DiagStdout = enabled ? 1 : 0;
+}
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    isMetricsEnabled
+ * Signature: ()Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jpy_PyLib_00024Diag_isMetricsEnabled
+  (JNIEnv *jenv, jclass classRef)
+{
+    return JPy_MetricsEnabled ? JNI_TRUE : JNI_FALSE;
+}
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    setMetricsEnabled
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_setMetricsEnabled
+  (JNIEnv *jenv, jclass classRef, jboolean enabled)
+{
+    JPy_MetricsEnabled = enabled ? 1 : 0;
+}
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    getMetrics
+ * Signature: (Z)Lorg/jpy/PyObject;
+ */
+JNIEXPORT jobject JNICALL Java_org_jpy_PyLib_00024Diag_getMetrics
+  (JNIEnv *jenv, jclass classRef, jboolean reset)
+{
+    PyObject* pyStats;
+    jobject result = NULL;
+
+    if (!Py_IsInitialized()) {
+        PyLib_ThrowRTE(jenv, "getMetrics: Python is not running");
+        return NULL;
+    }
+
+    JPy_BEGIN_GIL_STATE
+
+    pyStats = JPy_Metrics_GetStats(reset);
+    if (pyStats == NULL) {
+        PyLib_HandlePythonException(jenv);
+    } else {
+        result = PyLib_NewJavaPyObject(jenv, pyStats);
+        JPy_DECREF(pyStats);
+    }
+
+    JPy_END_GIL_STATE
+
+    return result;
+}
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    getMemoryStats
+ * Signature: (Z)Lorg/jpy/PyObject;
+ */
+JNIEXPORT jobject JNICALL Java_org_jpy_PyLib_00024Diag_getMemoryStats
+  (JNIEnv *jenv, jclass classRef, jboolean resetPeaks)
+{
+    PyObject* pyStats;
+    jobject result = NULL;
+
+    if (!Py_IsInitialized()) {
+        PyLib_ThrowRTE(jenv, "getMemoryStats: Python is not running");
+        return NULL;
+    }
+
+    JPy_BEGIN_GIL_STATE
+
+    pyStats = JPy_MemStats_Get(resetPeaks);
+    if (pyStats == NULL) {
+        PyLib_HandlePythonException(jenv);
+    } else {
+        result = PyLib_NewJavaPyObject(jenv, pyStats);
+        JPy_DECREF(pyStats);
+    }
+
+    JPy_END_GIL_STATE
+
+    return result;
+}
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    getGlobalRefCount
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_00024Diag_getGlobalRefCount
+  (JNIEnv *jenv, jclass classRef)
+{
+    return JPy_MemStats_GetGlobalRefCount();
+}
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    setGlobalRefLimit
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_setGlobalRefLimit
+  (JNIEnv *jenv, jclass classRef, jlong limit)
+{
+    JPy_GlobalRefLimit = limit > 0 ? limit : 0;
+}
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    setBufferBytesLimit
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_setBufferBytesLimit
+  (JNIEnv *jenv, jclass classRef, jlong limit)
+{
+    JPy_BufferBytesLimit = limit > 0 ? limit : 0;
+}
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    startProfiler
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_startProfiler
+  (JNIEnv *jenv, jclass classRef, jint capacity)
+{
+    if (!Py_IsInitialized()) {
+        PyLib_ThrowRTE(jenv, "startProfiler: Python is not running");
+        return;
+    }
+
+    JPy_BEGIN_GIL_STATE
+
+    if (JPy_Profiler_Start(capacity) < 0) {
+        PyLib_HandlePythonException(jenv);
+    }
+
+    JPy_END_GIL_STATE
+}
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    stopProfiler
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_stopProfiler
+  (JNIEnv *jenv, jclass classRef)
+{
+    JPy_Profiler_Stop();
+}
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    dumpProfile
+ * Signature: (Ljava/lang/String;)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_00024Diag_dumpProfile
+  (JNIEnv *jenv, jclass classRef, jstring jPath)
+{
+    const char* pathChars;
+    Py_ssize_t count = -1;
+
+    if (!Py_IsInitialized()) {
+        PyLib_ThrowRTE(jenv, "dumpProfile: Python is not running");
+        return -1;
+    }
+
+    pathChars = (*jenv)->GetStringUTFChars(jenv, jPath, NULL);
+    if (pathChars == NULL) {
+        PyLib_ThrowOOM(jenv);
+        return -1;
+    }
+
+    JPy_BEGIN_GIL_STATE
+
+    count = JPy_Profiler_Dump(pathChars);
+    if (count < 0) {
+        PyLib_HandlePythonException(jenv);
+    }
+
+    JPy_END_GIL_STATE
+
+    (*jenv)->ReleaseStringUTFChars(jenv, jPath, pathChars);
+    return (jint) count;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Helpers that also throw Java exceptions
+
+
+PyObject* PyLib_GetAttributeObject(JNIEnv* jenv, PyObject* pyObject, jstring jName)
+{
+    PyObject* pyValue = NULL;
+    const char* nameChars;
+
+    nameChars = (*jenv)->GetStringUTFChars(jenv, jName, NULL);
+    if (nameChars == NULL) {
+        PyLib_ThrowOOM(jenv);
+        goto error;
+    }
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "PyLib_GetAttributeObject: objId=%p, name='%s'\n", pyObject, nameChars);
+    /* Note: pyValue is a new reference */
+    pyValue = PyObject_GetAttrString(pyObject, nameChars);
+    if (pyValue == NULL) {
+        JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "PyLib_GetAttributeObject: error: attribute not found '%s'\n", nameChars);
+        PyLib_HandlePythonException(jenv);
+    }
+error:
+    if (nameChars != NULL) {
+        (*jenv)->ReleaseStringUTFChars(jenv, jName, nameChars);
     }
     return pyValue;
 }
@@ -2305,18 +3394,53 @@ error:
 }
 
 
+/**
+ * Converts the Java arguments of a call of the Python callable 'nameChars' into a new Python tuple.
+ * Returns NULL and throws a Java exception on failure.
+ */
+static PyObject* PyLib_NewArgTuple(JNIEnv *jenv, const char* nameChars, jint argCount, jobjectArray jArgs, jobjectArray jParamClasses)
+{
+    PyObject* pyArgs;
+    PyObject* pyArg;
+    jint i;
+    jobject jArg;
+    jclass jParamClass = NULL;
+
+    pyArgs = PyTuple_New(argCount);
+    if (pyArgs == NULL) {
+        PyLib_HandlePythonException(jenv);
+        return NULL;
+    }
+    for (i = 0; i < argCount; i++) {
+        // get the implicit java type (the real type of the object)
+        jArg = (*jenv)->GetObjectArrayElement(jenv, jArgs, i);
+        if (jParamClasses != NULL) {
+            jParamClass = (*jenv)->GetObjectArrayElement(jenv, jParamClasses, i);
+        }
+        pyArg = PyLib_FromJObjectForTuple(jenv, jArg, jParamClass, (char*) nameChars, i);
+        if (jParamClass != NULL) {
+            JPy_DELETE_LOCAL_REF(jParamClass);
+        }
+        JPy_DELETE_LOCAL_REF(jArg);
+        if (pyArg == NULL) {
+            JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "PyLib_NewArgTuple: error: callable '%s': argument %d: failed to convert Java into Python object\n", nameChars, i);
+            PyLib_HandlePythonException(jenv);
+            JPy_DECREF(pyArgs);
+            return NULL;
+        }
+        // pyArg reference stolen here
+        PyTuple_SetItem(pyArgs, i, pyArg);
+    }
+    return pyArgs;
+}
+
 PyObject* PyLib_CallAndReturnObject(JNIEnv *jenv, PyObject* pyObject, jboolean isMethodCall, jstring jName, jint argCount, jobjectArray jArgs, jobjectArray jParamClasses)
 {
     PyObject* pyCallable = NULL;
     PyObject* pyArgs = NULL;
-    PyObject* pyArg;
     PyObject* pyReturnValue = NULL;
     const char* nameChars;
-    jint i;
-    jobject jArg;
-    jclass jParamClass = NULL;
-    JPy_JType* explicitParamType = NULL;
-    JPy_JType* jArgParamType;
+    jlong profileStart = JPy_ProfilerEnabled ? JPy_NanoTime() : 0;
 
     nameChars = (*jenv)->GetStringUTFChars(jenv, jName, NULL);
     if (nameChars == NULL) {
@@ -2340,25 +3464,9 @@ PyObject* PyLib_CallAndReturnObject(JNIEnv *jenv, PyObject* pyObject, jboolean i
         goto error;
     }
 
-    pyArgs = PyTuple_New(argCount);
-    for (i = 0; i < argCount; i++) {
-        // get the implicit java type (the real type of the object)
-        jArg = (*jenv)->GetObjectArrayElement(jenv, jArgs, i);
-        if (jParamClasses != NULL) {
-            jParamClass = (*jenv)->GetObjectArrayElement(jenv, jParamClasses, i);
-        }
-        pyArg = PyLib_FromJObjectForTuple(jenv, jArg, jParamClass, nameChars, i);
-        if (jParamClass != NULL) {
-            JPy_DELETE_LOCAL_REF(jParamClass);
-        }
-        JPy_DELETE_LOCAL_REF(jArg);
-        if (pyArg == NULL) {
-            JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "PyLib_CallAndReturnObject: error: callable '%s': argument %d: failed to convert Java into Python object\n", nameChars, i);
-            PyLib_HandlePythonException(jenv);
-            goto error;
-        }
-        // pyArg reference stolen here
-        PyTuple_SetItem(pyArgs, i, pyArg);
+    pyArgs = PyLib_NewArgTuple(jenv, nameChars, argCount, jArgs, jParamClasses);
+    if (pyArgs == NULL) {
+        goto error;
     }
 
     // Check why: for some reason, we don't need the following code to invoke object methods.
@@ -2388,6 +3496,9 @@ error:
     if (nameChars != NULL) {
         (*jenv)->ReleaseStringUTFChars(jenv, jName, nameChars);
     }
+    if (profileStart != 0) {
+        JPy_Profiler_Record(JPy_PROFILER_JAVA_TO_PYTHON, pyCallable, profileStart);
+    }
     JPy_XDECREF(pyCallable);
     JPy_XDECREF(pyArgs);
 
@@ -2440,12 +3551,14 @@ char* PyLib_ObjToChars(PyObject* pyObj, PyObject** pyNewRef)
 #define JPY_NO_INFO_MSG JPY_ERR_BASE_MSG ", no information available"
 #define JPY_INFO_ALLOC_FAILED_MSG JPY_ERR_BASE_MSG ", failed to allocate information text"
 
-void PyLib_HandlePythonException(JNIEnv* jenv)
+/**
+ * Formats the message of a Python exception: type, value, the location it was raised at and the
+ * traceback. Returns a buffer allocated with PyMem_New, or NULL and sets *fallbackMessage if no
+ * information is available or the buffer could not be allocated. Python errors raised while
+ * formatting are left for the caller to clear.
+ */
+static char* PyLib_FormatPythonException(PyObject* pyType, PyObject* pyValue, PyTracebackObject* pyTraceback, const char** fallbackMessage)
 {
-    PyObject* pyType = NULL;
-    PyObject* pyValue = NULL;
-    PyTracebackObject* pyTraceback = NULL;
-
     PyObject* pyTypeUtf8 = NULL;
     PyObject* pyValueUtf8 = NULL;
     PyObject* pyLinenoUtf8 = NULL;
@@ -2456,29 +3569,10 @@ void PyLib_HandlePythonException(JNIEnv* jenv)
     char* linenoChars = NULL;
     char* filenameChars = NULL;
     char* namespaceChars = NULL;
-
-    jclass jExceptionClass;
-
-    if (PyErr_Occurred() == NULL) {
-        return;
-    }
-
-    PyErr_Fetch(&pyType, &pyValue, &pyTraceback);
-    //printf("M1: pyType=%p, pyValue=%p, pyTraceback=%p\n", pyType, pyValue, pyTraceback);
-    //printf("U1: pyType=%s, pyValue=%s, pyTraceback=%s\n", Py_TYPE(pyType)->tp_name, Py_TYPE(pyValue)->tp_name, pyTraceback != NULL ? Py_TYPE(pyTraceback)->tp_name : "?");
-    PyErr_NormalizeException(&pyType, &pyValue, &pyTraceback);
-    //printf("M2: pyType=%p, pyValue=%p, pyTraceback=%p\n", pyType, pyValue, pyTraceback);
-    //printf("U2: pyType=%s, pyValue=%s, pyTraceback=%s\n", Py_TYPE(pyType)->tp_name, Py_TYPE(pyValue)->tp_name, pyTraceback != NULL ? Py_TYPE(pyTraceback)->tp_name : "?");
+    char* javaMessage = NULL;
 
     typeChars = PyLib_ObjToChars(pyType, &pyTypeUtf8);
     valueChars = PyLib_ObjToChars(pyValue, &pyValueUtf8);
-    if (PyObject_TypeCheck(pyValue, (PyTypeObject*) PyExc_KeyError)) {
-        jExceptionClass = JPy_KeyError_JClass;
-    } else if (PyObject_TypeCheck(pyValue, (PyTypeObject*) PyExc_StopIteration)) {
-        jExceptionClass = JPy_StopIteration_JClass;
-    } else {
-        jExceptionClass = JPy_RuntimeException_JClass;
-    }
 
     PyTracebackObject* topPyTraceback = pyTraceback;
     while (pyTraceback && pyTraceback->tb_next)
@@ -2507,7 +3601,6 @@ void PyLib_HandlePythonException(JNIEnv* jenv)
 
     if (typeChars != NULL || valueChars != NULL
         || linenoChars != NULL || filenameChars != NULL || namespaceChars != NULL) {
-        char* javaMessage;
         int bufLen = (typeChars != NULL ? strlen(typeChars) : JPY_NOT_AVAILABLE_MSG_LEN)
                                + (valueChars != NULL ? strlen(valueChars) : JPY_NOT_AVAILABLE_MSG_LEN)
                                + (linenoChars != NULL ? strlen(linenoChars) : JPY_NOT_AVAILABLE_MSG_LEN)
@@ -2529,28 +3622,142 @@ void PyLib_HandlePythonException(JNIEnv* jenv)
                     filenameChars != NULL ? filenameChars : JPY_NOT_AVAILABLE_MSG);
             int err = python_traceback_report(pyTraceback, &javaMessage, &bufLen);
             if (err != 0) {
-                (*jenv)->ThrowNew(jenv, jExceptionClass, JPY_INFO_ALLOC_FAILED_MSG);
-            } else {
-                (*jenv)->ThrowNew(jenv, jExceptionClass, javaMessage);
+                PyMem_Del(javaMessage);
+                javaMessage = NULL;
             }
-            PyMem_Del(javaMessage);
-        } else {
-            (*jenv)->ThrowNew(jenv, jExceptionClass, JPY_INFO_ALLOC_FAILED_MSG);
+        }
+        if (javaMessage == NULL) {
+            *fallbackMessage = JPY_INFO_ALLOC_FAILED_MSG;
         }
     } else {
-        (*jenv)->ThrowNew(jenv, jExceptionClass, JPY_NO_INFO_MSG);
+        *fallbackMessage = JPY_NO_INFO_MSG;
     }
 
-    JPy_XDECREF(pyType);
-    JPy_XDECREF(pyValue);
-    JPy_XDECREF(pyTraceback);
     JPy_XDECREF(pyTypeUtf8);
     JPy_XDECREF(pyValueUtf8);
     JPy_XDECREF(pyLinenoUtf8);
     JPy_XDECREF(pyFilenameUtf8);
     JPy_XDECREF(pyNamespaceUtf8);
 
+    return javaMessage;
+}
+
+/**
+ * Translates the current Python error into a Java exception: KeyError and StopIteration map to
+ * org.jpy.KeyError and org.jpy.StopIteration, everything else to org.jpy.PyException.
+ *
+ * The Java exception just takes over a reference to the Python exception object; its message and
+ * the traceback are formatted by PyLib.formatPythonException() once getMessage() is called. Lookups
+ * that miss and iterators that end are common enough that they must not pay for the formatting.
+ */
+void PyLib_HandlePythonException(JNIEnv* jenv)
+{
+    PyObject* pyType = NULL;
+    PyObject* pyValue = NULL;
+    PyTracebackObject* pyTraceback = NULL;
+    jclass jExceptionClass;
+    jmethodID jExceptionInitMID;
+    char* javaMessage;
+    const char* fallbackMessage = NULL;
+
+    if (PyErr_Occurred() == NULL) {
+        return;
+    }
+
+    PyErr_Fetch(&pyType, &pyValue, &pyTraceback);
+    //printf("M1: pyType=%p, pyValue=%p, pyTraceback=%p\n", pyType, pyValue, pyTraceback);
+    //printf("U1: pyType=%s, pyValue=%s, pyTraceback=%s\n", Py_TYPE(pyType)->tp_name, Py_TYPE(pyValue)->tp_name, pyTraceback != NULL ? Py_TYPE(pyTraceback)->tp_name : "?");
+    PyErr_NormalizeException(&pyType, &pyValue, &pyTraceback);
+    //printf("M2: pyType=%p, pyValue=%p, pyTraceback=%p\n", pyType, pyValue, pyTraceback);
+    //printf("U2: pyType=%s, pyValue=%s, pyTraceback=%s\n", Py_TYPE(pyType)->tp_name, Py_TYPE(pyValue)->tp_name, pyTraceback != NULL ? Py_TYPE(pyTraceback)->tp_name : "?");
+
+    if (PyObject_TypeCheck(pyValue, (PyTypeObject*) PyExc_KeyError)) {
+        jExceptionClass = JPy_KeyError_JClass;
+        jExceptionInitMID = JPy_KeyError_Init_MID;
+    } else if (PyObject_TypeCheck(pyValue, (PyTypeObject*) PyExc_StopIteration)) {
+        jExceptionClass = JPy_StopIteration_JClass;
+        jExceptionInitMID = JPy_StopIteration_Init_MID;
+    } else if (JPy_PyException_JClass != NULL) {
+        jExceptionClass = JPy_PyException_JClass;
+        jExceptionInitMID = JPy_PyException_Init_MID;
+    } else {
+        jExceptionClass = JPy_RuntimeException_JClass;
+        jExceptionInitMID = NULL;
+    }
+
+#if defined(JPY_COMPAT_33P)
+    // Python 2 exceptions don't carry their traceback, so there they are still formatted up front
+    if (jExceptionInitMID != NULL && pyValue != NULL && PyExceptionInstance_Check(pyValue)) {
+        jthrowable jException;
+        if (pyTraceback != NULL) {
+            PyException_SetTraceback(pyValue, (PyObject*) pyTraceback);
+        }
+        JPy_INCREF(pyValue);
+        jException = (*jenv)->NewObject(jenv, jExceptionClass, jExceptionInitMID, (jlong) pyValue);
+        if (jException != NULL) {
+            (*jenv)->Throw(jenv, jException);
+            JPy_DELETE_LOCAL_REF(jException);
+        } else {
+            // the Java exception takes over the reference only if it has been constructed
+            JPy_DECREF(pyValue);
+        }
+        goto done;
+    }
+#endif
+
+    javaMessage = PyLib_FormatPythonException(pyType, pyValue, pyTraceback, &fallbackMessage);
+    if (javaMessage != NULL) {
+        (*jenv)->ThrowNew(jenv, jExceptionClass, javaMessage);
+        PyMem_Del(javaMessage);
+    } else {
+        (*jenv)->ThrowNew(jenv, jExceptionClass, fallbackMessage);
+    }
+
+done:
+    JPy_XDECREF(pyType);
+    JPy_XDECREF(pyValue);
+    JPy_XDECREF(pyTraceback);
+
+    PyErr_Clear();
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    formatPythonException
+ * Signature: (J)Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL Java_org_jpy_PyLib_formatPythonException
+  (JNIEnv* jenv, jclass jLibClass, jlong objId)
+{
+    PyObject* pyValue;
+    PyObject* pyTraceback = NULL;
+    char* javaMessage;
+    const char* fallbackMessage = NULL;
+    jstring result;
+
+    JPy_BEGIN_GIL_STATE
+
+    pyValue = (PyObject*) objId;
+#if defined(JPY_COMPAT_33P)
+    if (PyExceptionInstance_Check(pyValue)) {
+        pyTraceback = PyException_GetTraceback(pyValue);
+    }
+#endif
+
+    javaMessage = PyLib_FormatPythonException((PyObject*) Py_TYPE(pyValue), pyValue, (PyTracebackObject*) pyTraceback, &fallbackMessage);
+    if (javaMessage != NULL) {
+        result = (*jenv)->NewStringUTF(jenv, javaMessage);
+        PyMem_Del(javaMessage);
+    } else {
+        result = (*jenv)->NewStringUTF(jenv, fallbackMessage);
+    }
+
+    JPy_XDECREF(pyTraceback);
     PyErr_Clear();
+
+    JPy_END_GIL_STATE
+
+    return result;
 }
 
 /**
@@ -79,6 +79,22 @@ JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_executeCode
 JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_executeScript
   (JNIEnv *, jclass, jstring, jint, jobject, jobject);
 
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    setLazyMapNamespaces
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_setLazyMapNamespaces
+  (JNIEnv *, jclass, jboolean);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    isLazyMapNamespaces
+ * Signature: ()Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jpy_PyLib_isLazyMapNamespaces
+  (JNIEnv *, jclass);
+
 /*
  * Class:     org_jpy_PyLib
  * Method:    getMainGlobals
@@ -135,6 +151,70 @@ JNIEXPORT void JNICALL Java_org_jpy_PyLib_decRef
 JNIEXPORT void JNICALL Java_org_jpy_PyLib_decRefs
   (JNIEnv *, jclass, jlongArray, jint);
 
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    enqueueDecRef
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_enqueueDecRef
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    enqueueDecRefs
+ * Signature: ([JI)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_enqueueDecRefs
+  (JNIEnv *, jclass, jlongArray, jint);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    drainDecRefs
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_drainDecRefs
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    getReleaseQueueStats
+ * Signature: ([J)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_getReleaseQueueStats
+  (JNIEnv *, jclass, jlongArray);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    runAsyncCall
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_runAsyncCall
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    completeAsyncCall
+ * Signature: (JLjava/lang/Object;Ljava/lang/Throwable;)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_completeAsyncCall
+  (JNIEnv *, jclass, jlong, jobject, jthrowable);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callAsync
+ * Signature: (JLjava/lang/String;I[Ljava/lang/Object;[Ljava/lang/Class;Ljava/util/concurrent/CompletableFuture;)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_callAsync
+  (JNIEnv *, jclass, jlong, jstring, jint, jobjectArray, jobjectArray, jobject);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    formatPythonException
+ * Signature: (J)Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL Java_org_jpy_PyLib_formatPythonException
+  (JNIEnv *, jclass, jlong);
+
 /*
  * Class:     org_jpy_PyLib
  * Method:    getIntValue
@@ -359,6 +439,62 @@ JNIEXPORT jobject JNICALL Java_org_jpy_PyLib_pyDictValues
 JNIEXPORT jboolean JNICALL Java_org_jpy_PyLib_pyDictContains
   (JNIEnv *, jclass, jlong, jobject, jclass);
 
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    pyDictSize
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_pyDictSize
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    pyDictGetItem
+ * Signature: (JLjava/lang/Object;Ljava/lang/Class;)Lorg/jpy/PyObject;
+ */
+JNIEXPORT jobject JNICALL Java_org_jpy_PyLib_pyDictGetItem
+  (JNIEnv *, jclass, jlong, jobject, jclass);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    pyDictContainsValue
+ * Signature: (JLjava/lang/Object;Ljava/lang/Class;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jpy_PyLib_pyDictContainsValue
+  (JNIEnv *, jclass, jlong, jobject, jclass);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    pyDictItems
+ * Signature: (J)[Lorg/jpy/PyObject;
+ */
+JNIEXPORT jobjectArray JNICALL Java_org_jpy_PyLib_pyDictItems
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    pyListSize
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_pyListSize
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    pyListGetItem
+ * Signature: (JI)Lorg/jpy/PyObject;
+ */
+JNIEXPORT jobject JNICALL Java_org_jpy_PyLib_pyListGetItem
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    pyListGetItems
+ * Signature: (JII)[Lorg/jpy/PyObject;
+ */
+JNIEXPORT jobjectArray JNICALL Java_org_jpy_PyLib_pyListGetItems
+  (JNIEnv *, jclass, jlong, jint, jint);
+
 /*
  * Class:     org_jpy_PyLib
  * Method:    getObjectArrayValue
@@ -447,6 +583,54 @@ JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_callAndReturnObject
 JNIEXPORT jobject JNICALL Java_org_jpy_PyLib_callAndReturnValue
   (JNIEnv *, jclass, jlong, jboolean, jstring, jint, jobjectArray, jobjectArray, jclass);
 
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    getAttributeInt
+ * Signature: (JLjava/lang/String;)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_getAttributeInt
+  (JNIEnv *, jclass, jlong, jstring);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    getAttributeLong
+ * Signature: (JLjava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_getAttributeLong
+  (JNIEnv *, jclass, jlong, jstring);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    getAttributeDouble
+ * Signature: (JLjava/lang/String;)D
+ */
+JNIEXPORT jdouble JNICALL Java_org_jpy_PyLib_getAttributeDouble
+  (JNIEnv *, jclass, jlong, jstring);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callForInt
+ * Signature: (JZLjava/lang/String;I[Ljava/lang/Object;[Ljava/lang/Class;)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_callForInt
+  (JNIEnv *, jclass, jlong, jboolean, jstring, jint, jobjectArray, jobjectArray);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callForLong
+ * Signature: (JZLjava/lang/String;I[Ljava/lang/Object;[Ljava/lang/Class;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_callForLong
+  (JNIEnv *, jclass, jlong, jboolean, jstring, jint, jobjectArray, jobjectArray);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callForDouble
+ * Signature: (JZLjava/lang/String;I[Ljava/lang/Object;[Ljava/lang/Class;)D
+ */
+JNIEXPORT jdouble JNICALL Java_org_jpy_PyLib_callForDouble
+  (JNIEnv *, jclass, jlong, jboolean, jstring, jint, jobjectArray, jobjectArray);
+
 #ifdef __cplusplus
 }
 #endif
@@ -33,12 +33,124 @@ JNIEXPORT jint JNICALL Java_org_jpy_PyLib_00024Diag_getFlags
 
 /*
  * Class:     org_jpy_PyLib_Diag
- * Method:    setFlags
+ * Method:    setFlags0
  * Signature: (I)V
  */
-JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_setFlags
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_setFlags0
   (JNIEnv *, jclass, jint);
 
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    initJavaFlags
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_initJavaFlags
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    drainEvents
+ * Signature: ()[Ljava/lang/String;
+ */
+JNIEXPORT jobjectArray JNICALL Java_org_jpy_PyLib_00024Diag_drainEvents
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    dumpEvents
+ * Signature: (Ljava/lang/String;)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_00024Diag_dumpEvents
+  (JNIEnv *, jclass, jstring);
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    setStdout
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_setStdout
+  (JNIEnv *, jclass, jboolean);
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    isMetricsEnabled
+ * Signature: ()Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jpy_PyLib_00024Diag_isMetricsEnabled
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    setMetricsEnabled
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_setMetricsEnabled
+  (JNIEnv *, jclass, jboolean);
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    getMetrics
+ * Signature: (Z)Lorg/jpy/PyObject;
+ */
+JNIEXPORT jobject JNICALL Java_org_jpy_PyLib_00024Diag_getMetrics
+  (JNIEnv *, jclass, jboolean);
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    getMemoryStats
+ * Signature: (Z)Lorg/jpy/PyObject;
+ */
+JNIEXPORT jobject JNICALL Java_org_jpy_PyLib_00024Diag_getMemoryStats
+  (JNIEnv *, jclass, jboolean);
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    getGlobalRefCount
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_00024Diag_getGlobalRefCount
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    setGlobalRefLimit
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_setGlobalRefLimit
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    setBufferBytesLimit
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_setBufferBytesLimit
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    startProfiler
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_startProfiler
+  (JNIEnv *, jclass, jint);
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    stopProfiler
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_stopProfiler
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     org_jpy_PyLib_Diag
+ * Method:    dumpProfile
+ * Signature: (Ljava/lang/String;)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_00024Diag_dumpProfile
+  (JNIEnv *, jclass, jstring);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,1315 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_jtype.h"
+#include "jpy_jobj.h"
+#include "jpy_jmethod.h"
+#include "jpy_jexception.h"
+#include "jpy_verboseexcept.h"
+#include "jpy_conv.h"
+#include "jpy_memstats.h"
+#include "jpy_async.h"
+#include <pythread.h>
+#include <stdlib.h>
+
+#if defined(_MSC_VER)
+#define JPy_ATOMIC_LOAD_PTR(p)              InterlockedCompareExchangePointer((PVOID volatile*) (p), NULL, NULL)
+#define JPy_ATOMIC_CAS_PTR(p, expected, v)  (InterlockedCompareExchangePointer((PVOID volatile*) (p), (v), (expected)) == (expected))
+#else
+#define JPy_ATOMIC_LOAD_PTR(p)              __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define JPy_ATOMIC_CAS_PTR(p, expected, v)  __sync_bool_compare_and_swap(p, expected, v)
+#endif
+
+
+struct JPy_AsyncCall
+{
+    // Next call on the stack of completed calls of the queue.
+    JPy_AsyncCall* next;
+    // The queue of the event loop the future belongs to.
+    struct JPy_JAsyncQueue* queue;
+    // The asyncio.Future resolved with the result.
+    PyObject* future;
+    // The Java method and its arguments, all NULL for calls created by jpy.as_future().
+    JPy_JMethod* method;
+    // Copies of the method's parameter count and whether it returns an object, which are still available
+    // after the interpreter owning the method has been finalized, see JAsyncCall_FreeOrphan().
+    int paramCount;
+    char objectResult;
+    PyObject* pyArgs;
+    jvalue* jArgs;
+    JPy_ArgDisposer* argDisposers;
+    // Flags for the arguments in jArgs, which have been turned from local into global references.
+    jboolean* globalArgs;
+    // The target object of an instance method, owned by the JObj in pyArgs.
+    jobject objectRef;
+    // The result, a global reference for objects.
+    jvalue result;
+    // Global reference to the Java exception thrown by the method or the CompletionStage, or NULL.
+    jthrowable error;
+    // Whether the result is the value of an awaited CompletionStage.
+    char isStage;
+    // The value of JAsyncCall_Generation when the call was created.
+    long generation;
+};
+
+typedef struct JPy_JAsyncQueue
+{
+    PyObject_HEAD
+    // The asyncio event loop.
+    PyObject* loop;
+    // Completed calls, pushed by Java threads without holding the GIL.
+    JPy_AsyncCall* volatile head;
+    // Number of calls submitted but not yet freed, guarded by the GIL.
+    Py_ssize_t pending;
+}
+JPy_JAsyncQueue;
+
+/**
+ * Maps event loops to their queues.
+ */
+static PyObject* JAsyncQueue_Queues = NULL;
+
+/**
+ * Calls are allocated with malloc(), not the PyMem_* allocators, because a call completing after the interpreter
+ * has been stopped is freed without it, see JAsyncCall_FreeOrphan(). JAsyncCall_Generation is incremented by
+ * JPy_Async_Free(), JAsyncCall_Posting counts the threads waking up an event loop. Both are guarded by JAsyncCall_Lock.
+ */
+static PyThread_type_lock JAsyncCall_Lock = NULL;
+static long JAsyncCall_Generation = 0;
+static int JAsyncCall_Posting = 0;
+
+typedef struct JPy_JAsyncTask
+{
+    PyObject_HEAD
+    // The callable, or the awaitable if args is NULL.
+    PyObject* func;
+    // The argument tuple, or NULL.
+    PyObject* args;
+    // Global reference to the java.util.concurrent.CompletableFuture completed with the outcome.
+    jobject future;
+    // Neighbours on the list of tasks whose future has not been completed yet.
+    struct JPy_JAsyncTask* prev;
+    struct JPy_JAsyncTask* next;
+}
+JPy_JAsyncTask;
+
+/**
+ * The event loop of the "jpy-asyncio" thread running tasks for Java callers, the thread, and the functions used with them.
+ */
+static PyObject* JAsyncTask_Loop = NULL;
+static PyObject* JAsyncTask_Thread = NULL;
+static PyObject* JAsyncTask_EnsureFuture = NULL;
+static PyObject* JAsyncTask_IsAwaitable = NULL;
+
+/**
+ * The tasks whose future has not been completed yet, guarded by the GIL. They are completed exceptionally
+ * when Python is stopped, see JAsyncTask_Shutdown().
+ */
+static JPy_JAsyncTask* JAsyncTask_Pending = NULL;
+
+
+static int JAsyncCall_HasObjectResult(JPy_AsyncCall* call)
+{
+    return call->isStage || call->objectResult;
+}
+
+/**
+ * Frees the given call, the GIL must be held. For a method call this copies back the content of Java arrays
+ * passed for writable Python buffers, as a synchronous call would do.
+ */
+static void JAsyncCall_Free(JNIEnv* jenv, JPy_AsyncCall* call)
+{
+    int i;
+
+    if (call->jArgs != NULL) {
+        for (i = 0; call->globalArgs != NULL && i < call->method->paramCount; i++) {
+            if (call->globalArgs[i]) {
+                jobject globalRef = call->jArgs[i].l;
+                call->jArgs[i].l = (*jenv)->NewLocalRef(jenv, globalRef);
+                JPy_DeleteGlobalRef(jenv, globalRef, JPy_GREF_OBJECT);
+            }
+        }
+        JMethod_DisposeJArgs(jenv, call->method->paramCount, call->jArgs, call->argDisposers);
+    }
+    free(call->globalArgs);
+    // The result and the error are created by Java threads without the GIL, which must not update the
+    // accounting in jpy_memstats.c, see JPy_AsyncCall_Run() and JPy_AsyncCall_Complete()
+    if (JAsyncCall_HasObjectResult(call) && call->result.l != NULL) {
+        (*jenv)->DeleteGlobalRef(jenv, call->result.l);
+    }
+    if (call->error != NULL) {
+        (*jenv)->DeleteGlobalRef(jenv, call->error);
+    }
+    JPy_XDECREF((PyObject*) call->method);
+    JPy_XDECREF(call->pyArgs);
+    JPy_XDECREF(call->future);
+    call->queue->pending--;
+    JPy_DECREF((PyObject*) call->queue);
+    free(call);
+}
+
+/**
+ * Frees a call which completed after the interpreter it was created by has been stopped, called without the GIL.
+ * Only the JNI global references and the call itself are released. The Python objects belong to the finalized
+ * interpreter and must not be touched, so they are leaked, like the arguments' disposers which may hold Python
+ * buffers. The argument references are deleted without updating the accounting, which requires the GIL.
+ */
+static void JAsyncCall_FreeOrphan(JNIEnv* jenv, JPy_AsyncCall* call)
+{
+    int i;
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JAsyncCall_FreeOrphan: call=%p completed after Python has been stopped\n", call);
+
+    for (i = 0; call->globalArgs != NULL && i < call->paramCount; i++) {
+        if (call->globalArgs[i]) {
+            (*jenv)->DeleteGlobalRef(jenv, call->jArgs[i].l);
+        }
+    }
+    free(call->globalArgs);
+    if (JAsyncCall_HasObjectResult(call) && call->result.l != NULL) {
+        (*jenv)->DeleteGlobalRef(jenv, call->result.l);
+    }
+    if (call->error != NULL) {
+        (*jenv)->DeleteGlobalRef(jenv, call->error);
+    }
+    free(call);
+}
+
+/**
+ * Converts the result of the given call into a Python value. Returns a new reference.
+ */
+static PyObject* JAsyncCall_GetResult(JNIEnv* jenv, JPy_AsyncCall* call)
+{
+    JPy_JMethod* method = call->method;
+    JPy_JType* returnType;
+
+    if (call->isStage) {
+        if (call->result.l == NULL) {
+            return JPy_FROM_JVOID();
+        }
+        return JPy_FromJObject(jenv, call->result.l);
+    }
+
+    returnType = method->returnDescriptor->type;
+    if (returnType == JPy_JVoid) {
+        return JPy_FROM_JVOID();
+    } else if (returnType == JPy_JBoolean) {
+        return JPy_FROM_JBOOLEAN(call->result.z);
+    } else if (returnType == JPy_JChar) {
+        return JPy_FROM_JCHAR(call->result.c);
+    } else if (returnType == JPy_JByte) {
+        return JPy_FROM_JBYTE(call->result.b);
+    } else if (returnType == JPy_JShort) {
+        return JPy_FROM_JSHORT(call->result.s);
+    } else if (returnType == JPy_JInt) {
+        return JPy_FROM_JINT(call->result.i);
+    } else if (returnType == JPy_JLong) {
+        return JPy_FROM_JLONG(call->result.j);
+    } else if (returnType == JPy_JFloat) {
+        return JPy_FROM_JFLOAT(call->result.f);
+    } else if (returnType == JPy_JDouble) {
+        return JPy_FROM_JDOUBLE(call->result.d);
+    } else if (returnType == JPy_JString) {
+        if (call->result.l == NULL) {
+            return JPy_FROM_JVOID();
+        }
+        return JPy_FromJString(jenv, call->result.l);
+    }
+    return JMethod_FromJObject(jenv, method, call->pyArgs, call->jArgs, method->isStatic ? 0 : 1, returnType, call->result.l);
+}
+
+/**
+ * Resolves the future of the given call unless it has been cancelled, the GIL must be held.
+ */
+static void JAsyncCall_Resolve(JNIEnv* jenv, JPy_AsyncCall* call)
+{
+    PyObject* cancelled;
+    PyObject* value;
+    PyObject* ret;
+    const char* methodName;
+    int isCancelled;
+
+    cancelled = PyObject_CallMethod(call->future, "cancelled", NULL);
+    isCancelled = cancelled != NULL ? PyObject_IsTrue(cancelled) : -1;
+    JPy_XDECREF(cancelled);
+    if (isCancelled != 0) {
+        if (isCancelled < 0) {
+            PyErr_WriteUnraisable(call->future);
+        }
+        return;
+    }
+
+    if ((*jenv)->PushLocalFrame(jenv, 16) < 0) {
+        JPy_HandleJavaException(jenv);
+        PyErr_WriteUnraisable(call->future);
+        return;
+    }
+
+    if (call->error != NULL) {
+        methodName = "set_exception";
+        value = JException_New(jenv, (*jenv)->NewLocalRef(jenv, call->error), JPy_VerboseExceptions);
+    } else {
+        methodName = "set_result";
+        value = JAsyncCall_GetResult(jenv, call);
+    }
+    if (value == NULL) {
+        // The conversion failed, the future gets the Python exception instead
+        PyObject* type;
+        PyObject* traceback;
+        PyErr_Fetch(&type, &value, &traceback);
+        PyErr_NormalizeException(&type, &value, &traceback);
+        JPy_XDECREF(type);
+        JPy_XDECREF(traceback);
+        if (value == NULL) {
+            // Failed without setting an error
+            value = PyObject_CallFunction(PyExc_RuntimeError, "s", "jpy: failed to convert the result of an asynchronous call");
+        }
+        methodName = "set_exception";
+    }
+
+    ret = value != NULL ? PyObject_CallMethod(call->future, methodName, "O", value) : NULL;
+    if (ret == NULL) {
+        PyErr_WriteUnraisable(call->future);
+    }
+    JPy_XDECREF(ret);
+    JPy_XDECREF(value);
+
+    (*jenv)->PopLocalFrame(jenv, NULL);
+}
+
+/**
+ * Takes all completed calls off the stack of the given queue and resolves their futures in completion order,
+ * or only frees the calls if 'resolve' is false. The GIL must be held.
+ */
+static void JAsyncQueue_Drain(JNIEnv* jenv, JPy_JAsyncQueue* queue, jboolean resolve)
+{
+    JPy_AsyncCall* head;
+    JPy_AsyncCall* next;
+    JPy_AsyncCall* call = NULL;
+
+    do {
+        head = (JPy_AsyncCall*) JPy_ATOMIC_LOAD_PTR(&queue->head);
+    } while (!JPy_ATOMIC_CAS_PTR(&queue->head, head, NULL));
+
+    while (head != NULL) {
+        next = head->next;
+        head->next = call;
+        call = head;
+        head = next;
+    }
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JAsyncQueue_Drain: queue=%p, first=%p, resolve=%d\n", queue, call, resolve);
+
+    // Freeing the last call may release the last reference to the queue
+    JPy_INCREF((PyObject*) queue);
+    while (call != NULL) {
+        next = call->next;
+        if (resolve) {
+            JAsyncCall_Resolve(jenv, call);
+        }
+        JAsyncCall_Free(jenv, call);
+        call = next;
+    }
+    JPy_DECREF((PyObject*) queue);
+}
+
+/**
+ * Pushes a completed call onto the stack of its queue. Called by Java threads without holding the GIL:
+ * only the thread which finds the stack empty takes the GIL and schedules a drain of the queue on the
+ * event loop, the drain takes all calls completed up to then. A call created before Python has been
+ * stopped is freed right away instead.
+ */
+static void JAsyncCall_Post(JNIEnv* jenv, JPy_AsyncCall* call)
+{
+    JPy_JAsyncQueue* queue = call->queue;
+    JPy_AsyncCall* head;
+    PyGILState_STATE gilState;
+    PyObject* handle;
+
+    PyThread_acquire_lock(JAsyncCall_Lock, WAIT_LOCK);
+    if (call->generation != JAsyncCall_Generation) {
+        PyThread_release_lock(JAsyncCall_Lock);
+        JAsyncCall_FreeOrphan(jenv, call);
+        return;
+    }
+    do {
+        head = (JPy_AsyncCall*) JPy_ATOMIC_LOAD_PTR(&queue->head);
+        call->next = head;
+    } while (!JPy_ATOMIC_CAS_PTR(&queue->head, head, call));
+    if (head == NULL) {
+        // JPy_Async_Free() waits for us before the interpreter is finalized
+        JAsyncCall_Posting++;
+    }
+    PyThread_release_lock(JAsyncCall_Lock);
+
+    if (head != NULL) {
+        return;
+    }
+
+    gilState = PyGILState_Ensure();
+    // Calling the queue drains it, see JAsyncQueue_call()
+    handle = PyObject_CallMethod(queue->loop, "call_soon_threadsafe", "O", (PyObject*) queue);
+    if (handle != NULL) {
+        JPy_DECREF(handle);
+    } else {
+        // The loop has been closed, nobody is waiting for the futures anymore
+        PyErr_Clear();
+        JAsyncQueue_Drain(jenv, queue, JNI_FALSE);
+    }
+    PyGILState_Release(gilState);
+
+    PyThread_acquire_lock(JAsyncCall_Lock, WAIT_LOCK);
+    JAsyncCall_Posting--;
+    PyThread_release_lock(JAsyncCall_Lock);
+}
+
+/**
+ * Expands to the calls of a Java method of any return type through the given JNI function family,
+ * e.g. CallStatic<Type>MethodA for KIND 'Static'.
+ */
+#define JPy_ASYNC_CALL_METHOD(KIND, TARGET) \
+    if (returnType == JPy_JVoid) { \
+        (*jenv)->Call##KIND##VoidMethodA(jenv, TARGET, method->mid, call->jArgs); \
+    } else if (returnType == JPy_JBoolean) { \
+        call->result.z = (*jenv)->Call##KIND##BooleanMethodA(jenv, TARGET, method->mid, call->jArgs); \
+    } else if (returnType == JPy_JChar) { \
+        call->result.c = (*jenv)->Call##KIND##CharMethodA(jenv, TARGET, method->mid, call->jArgs); \
+    } else if (returnType == JPy_JByte) { \
+        call->result.b = (*jenv)->Call##KIND##ByteMethodA(jenv, TARGET, method->mid, call->jArgs); \
+    } else if (returnType == JPy_JShort) { \
+        call->result.s = (*jenv)->Call##KIND##ShortMethodA(jenv, TARGET, method->mid, call->jArgs); \
+    } else if (returnType == JPy_JInt) { \
+        call->result.i = (*jenv)->Call##KIND##IntMethodA(jenv, TARGET, method->mid, call->jArgs); \
+    } else if (returnType == JPy_JLong) { \
+        call->result.j = (*jenv)->Call##KIND##LongMethodA(jenv, TARGET, method->mid, call->jArgs); \
+    } else if (returnType == JPy_JFloat) { \
+        call->result.f = (*jenv)->Call##KIND##FloatMethodA(jenv, TARGET, method->mid, call->jArgs); \
+    } else if (returnType == JPy_JDouble) { \
+        call->result.d = (*jenv)->Call##KIND##DoubleMethodA(jenv, TARGET, method->mid, call->jArgs); \
+    } else { \
+        v = (*jenv)->Call##KIND##ObjectMethodA(jenv, TARGET, method->mid, call->jArgs); \
+    }
+
+/**
+ * Keeps the pending Java exception as the call's error. The GIL is not held, so the global reference is not
+ * accounted in jpy_memstats.c.
+ */
+static void JAsyncCall_SetError(JNIEnv* jenv, JPy_AsyncCall* call)
+{
+    jthrowable error = (*jenv)->ExceptionOccurred(jenv);
+    (*jenv)->ExceptionClear(jenv);
+    call->error = (jthrowable) (*jenv)->NewGlobalRef(jenv, error);
+    (*jenv)->DeleteLocalRef(jenv, error);
+}
+
+void JPy_AsyncCall_Run(JNIEnv* jenv, JPy_AsyncCall* call)
+{
+    JPy_JMethod* method = call->method;
+    JPy_JType* returnType = method->returnDescriptor->type;
+    jobject v = NULL;
+
+    // No Python API may be used here, the GIL is not held
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JPy_AsyncCall_Run: calling Java method of %s, call=%p\n", method->declaringClass->javaName, call);
+
+    if (method->isStatic) {
+        JPy_ASYNC_CALL_METHOD(Static, method->declaringClass->classRef)
+    } else {
+        JPy_ASYNC_CALL_METHOD(, call->objectRef)
+    }
+
+    if ((*jenv)->ExceptionCheck(jenv)) {
+        JAsyncCall_SetError(jenv, call);
+    } else if (v != NULL) {
+        if (returnType != JPy_JString && (*jenv)->IsInstanceOf(jenv, v, JPy_CompletionStage_JClass)) {
+            // Await the stage, the call is posted by JPy_AsyncCall_Complete()
+            call->isStage = 1;
+            (*jenv)->CallStaticVoidMethod(jenv, JPy_JavaAsync_JClass, JPy_JavaAsync_WhenComplete_SMID, v, (jlong) call);
+            (*jenv)->DeleteLocalRef(jenv, v);
+            if (!(*jenv)->ExceptionCheck(jenv)) {
+                return;
+            }
+            JAsyncCall_SetError(jenv, call);
+        } else {
+            // Not accounted in jpy_memstats.c, which requires the GIL
+            call->result.l = (*jenv)->NewGlobalRef(jenv, v);
+            (*jenv)->DeleteLocalRef(jenv, v);
+        }
+    }
+
+    JAsyncCall_Post(jenv, call);
+}
+
+void JPy_AsyncCall_Complete(JNIEnv* jenv, JPy_AsyncCall* call, jobject value, jthrowable error)
+{
+    // Called without the GIL, so the references are not accounted in jpy_memstats.c
+    if (error != NULL) {
+        call->error = (jthrowable) (*jenv)->NewGlobalRef(jenv, error);
+    } else if (value != NULL) {
+        call->result.l = (*jenv)->NewGlobalRef(jenv, value);
+    }
+    JAsyncCall_Post(jenv, call);
+}
+
+/**
+ * Gets the queue of the given event loop, creating it if needed. Returns a new reference.
+ */
+static JPy_JAsyncQueue* JAsyncQueue_Get(PyObject* loop)
+{
+    JPy_JAsyncQueue* queue;
+    PyObject* closedLoops;
+    PyObject* key;
+    PyObject* value;
+    Py_ssize_t pos = 0;
+
+    if (JAsyncQueue_Queues == NULL) {
+        JAsyncQueue_Queues = PyDict_New();
+        if (JAsyncQueue_Queues == NULL) {
+            return NULL;
+        }
+    }
+
+    queue = (JPy_JAsyncQueue*) PyDict_GetItem(JAsyncQueue_Queues, loop);
+    if (queue != NULL) {
+        JPy_INCREF((PyObject*) queue);
+        return queue;
+    }
+
+    // A new loop, forget the idle queues of closed loops
+    closedLoops = PyList_New(0);
+    if (closedLoops == NULL) {
+        return NULL;
+    }
+    while (PyDict_Next(JAsyncQueue_Queues, &pos, &key, &value)) {
+        PyObject* closed;
+        if (((JPy_JAsyncQueue*) value)->pending > 0) {
+            continue;
+        }
+        closed = PyObject_CallMethod(key, "is_closed", NULL);
+        if (closed == NULL) {
+            PyErr_Clear();
+        } else {
+            if (PyObject_IsTrue(closed) > 0) {
+                PyList_Append(closedLoops, key);
+            }
+            JPy_DECREF(closed);
+        }
+    }
+    for (pos = 0; pos < PyList_GET_SIZE(closedLoops); pos++) {
+        PyDict_DelItem(JAsyncQueue_Queues, PyList_GET_ITEM(closedLoops, pos));
+    }
+    JPy_DECREF(closedLoops);
+
+    queue = PyObject_New(JPy_JAsyncQueue, &JAsyncQueue_Type);
+    if (queue == NULL) {
+        return NULL;
+    }
+    JPy_INCREF(loop);
+    queue->loop = loop;
+    queue->head = NULL;
+    queue->pending = 0;
+    if (PyDict_SetItem(JAsyncQueue_Queues, loop, (PyObject*) queue) < 0) {
+        JPy_DECREF((PyObject*) queue);
+        return NULL;
+    }
+    return queue;
+}
+
+/**
+ * Creates a new call with a future of the running event loop. Returns NULL and sets a RuntimeError
+ * if there is no running loop or jpy's Java classes are not on the class path.
+ */
+static JPy_AsyncCall* JAsyncCall_New(const char* funcName)
+{
+    PyObject* asyncio;
+    PyObject* loop;
+    JPy_AsyncCall* call;
+
+    if (JPy_JavaAsync_JClass == NULL) {
+        PyErr_Format(PyExc_RuntimeError, "%s: Java class 'org.jpy.JavaAsync' not found, jpy's Java classes must be on the class path", funcName);
+        return NULL;
+    }
+    if (JAsyncCall_Lock == NULL) {
+        JAsyncCall_Lock = PyThread_allocate_lock();
+        if (JAsyncCall_Lock == NULL) {
+            PyErr_NoMemory();
+            return NULL;
+        }
+    }
+
+    asyncio = PyImport_ImportModule("asyncio");
+    if (asyncio == NULL) {
+        return NULL;
+    }
+    if (PyObject_HasAttrString(asyncio, "get_running_loop")) {
+        loop = PyObject_CallMethod(asyncio, "get_running_loop", NULL);
+    } else {
+        loop = PyObject_CallMethod(asyncio, "get_event_loop", NULL);
+    }
+    JPy_DECREF(asyncio);
+    if (loop == NULL) {
+        return NULL;
+    }
+
+    call = (JPy_AsyncCall*) calloc(1, sizeof (JPy_AsyncCall));
+    if (call == NULL) {
+        JPy_DECREF(loop);
+        PyErr_NoMemory();
+        return NULL;
+    }
+    call->generation = JAsyncCall_Generation;
+
+    call->queue = JAsyncQueue_Get(loop);
+    if (call->queue != NULL) {
+        call->queue->pending++;
+        call->future = PyObject_CallMethod(loop, "create_future", NULL);
+    }
+    JPy_DECREF(loop);
+    if (call->queue == NULL) {
+        free(call);
+        return NULL;
+    }
+    return call;
+}
+
+PyObject* JPy_AsyncCall_Submit(JNIEnv* jenv, PyObject* func, PyObject* args)
+{
+    JPy_JOverloadedMethod* overloadedMethod;
+    JPy_JMethod* method;
+    JPy_AsyncCall* call;
+    PyObject* pyArgs;
+    PyObject* future;
+    int isVarArgsArray;
+    int i;
+
+    if (PyMethod_Check(func)
+        && PyObject_TypeCheck(PyMethod_GET_FUNCTION(func), &JOverloadedMethod_Type)
+        && JObj_Check(PyMethod_GET_SELF(func))) {
+        Py_ssize_t argCount = PyTuple_GET_SIZE(args);
+        overloadedMethod = (JPy_JOverloadedMethod*) PyMethod_GET_FUNCTION(func);
+        pyArgs = PyTuple_New(argCount + 1);
+        if (pyArgs == NULL) {
+            return NULL;
+        }
+        JPy_INCREF(PyMethod_GET_SELF(func));
+        PyTuple_SET_ITEM(pyArgs, 0, PyMethod_GET_SELF(func));
+        for (i = 0; i < argCount; i++) {
+            JPy_INCREF(PyTuple_GET_ITEM(args, i));
+            PyTuple_SET_ITEM(pyArgs, i + 1, PyTuple_GET_ITEM(args, i));
+        }
+    } else if (PyObject_TypeCheck(func, &JOverloadedMethod_Type)) {
+        overloadedMethod = (JPy_JOverloadedMethod*) func;
+        JPy_INCREF(args);
+        pyArgs = args;
+    } else {
+        PyErr_SetString(PyExc_ValueError, "call_async: argument 1 (method) must be a method of a Java object or type");
+        return NULL;
+    }
+
+    method = JOverloadedMethod_FindMethod(jenv, overloadedMethod, pyArgs, JNI_TRUE, &isVarArgsArray);
+    if (method == NULL) {
+        JPy_DECREF(pyArgs);
+        return NULL;
+    }
+    if (method->returnDescriptor == NULL) {
+        JPy_DECREF(pyArgs);
+        PyErr_SetString(PyExc_ValueError, "call_async: argument 1 (method) must not be a constructor");
+        return NULL;
+    }
+
+    call = JAsyncCall_New("call_async");
+    if (call == NULL) {
+        JPy_DECREF(pyArgs);
+        return NULL;
+    }
+    JPy_INCREF((PyObject*) method);
+    call->method = method;
+    call->paramCount = method->paramCount;
+    call->objectResult = !method->returnDescriptor->type->isPrimitive;
+    call->pyArgs = pyArgs;
+    if (call->future == NULL) {
+        goto error;
+    }
+    if (!method->isStatic) {
+        // Note it is already ensured that self is a JPy_JObj*
+        call->objectRef = ((JPy_JObj*) PyTuple_GetItem(pyArgs, 0))->objectRef;
+    }
+
+    if (JMethod_CreateJArgs(jenv, method, pyArgs, &call->jArgs, &call->argDisposers, isVarArgsArray) < 0) {
+        goto error;
+    }
+    if (call->jArgs != NULL) {
+        // The arguments created for the call are local references, which are only valid in this thread
+        call->globalArgs = (jboolean*) calloc(method->paramCount, sizeof (jboolean));
+        if (call->globalArgs == NULL) {
+            PyErr_NoMemory();
+            goto error;
+        }
+        for (i = 0; i < method->paramCount; i++) {
+            jobject localRef = call->jArgs[i].l;
+            jobject globalRef;
+            if (method->paramDescriptors[i].type->isPrimitive
+                || localRef == NULL
+                || (*jenv)->GetObjectRefType(jenv, localRef) != JNILocalRefType) {
+                continue;
+            }
+            globalRef = JPy_NewGlobalRef(jenv, localRef, JPy_GREF_OBJECT);
+            if (globalRef == NULL) {
+                PyErr_NoMemory();
+                goto error;
+            }
+            call->jArgs[i].l = globalRef;
+            call->globalArgs[i] = JNI_TRUE;
+            (*jenv)->DeleteLocalRef(jenv, localRef);
+        }
+    }
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JPy_AsyncCall_Submit: submitting Java method %s#%s\n", method->declaringClass->javaName, JPy_AS_UTF8(method->name));
+
+    (*jenv)->CallStaticVoidMethod(jenv, JPy_JavaAsync_JClass, JPy_JavaAsync_Submit_SMID, (jlong) call);
+    JPy_ON_JAVA_EXCEPTION_GOTO(error);
+
+    future = call->future;
+    JPy_INCREF(future);
+    return future;
+
+error:
+    JAsyncCall_Free(jenv, call);
+    return NULL;
+}
+
+PyObject* JPy_AsyncCall_AsFuture(JNIEnv* jenv, PyObject* stage)
+{
+    JPy_AsyncCall* call;
+    jobject objectRef;
+    PyObject* future;
+
+    if (!JObj_Check(stage) || !(*jenv)->IsInstanceOf(jenv, ((JPy_JObj*) stage)->objectRef, JPy_CompletionStage_JClass)) {
+        PyErr_SetString(PyExc_ValueError, "as_future: argument 1 (stage) must be a java.util.concurrent.CompletionStage");
+        return NULL;
+    }
+    objectRef = ((JPy_JObj*) stage)->objectRef;
+
+    call = JAsyncCall_New("as_future");
+    if (call == NULL) {
+        return NULL;
+    }
+    call->isStage = 1;
+    if (call->future == NULL) {
+        JAsyncCall_Free(jenv, call);
+        return NULL;
+    }
+    future = call->future;
+    JPy_INCREF(future);
+
+    // A stage which is already complete calls back immediately, which requires the GIL
+    Py_BEGIN_ALLOW_THREADS
+    (*jenv)->CallStaticVoidMethod(jenv, JPy_JavaAsync_JClass, JPy_JavaAsync_WhenComplete_SMID, objectRef, (jlong) call);
+    Py_END_ALLOW_THREADS
+    if ((*jenv)->ExceptionCheck(jenv)) {
+        JPy_HandleJavaException(jenv);
+        JAsyncCall_Free(jenv, call);
+        JPy_DECREF(future);
+        return NULL;
+    }
+    return future;
+}
+
+/**
+ * The 'JAsyncQueue' type's tp_call slot, called by the event loop after JAsyncCall_Post() has woken it up.
+ */
+static PyObject* JAsyncQueue_call(JPy_JAsyncQueue* self, PyObject* args, PyObject* kw)
+{
+    JNIEnv* jenv;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+    JAsyncQueue_Drain(jenv, self, JNI_TRUE);
+    return JPy_FROM_JVOID();
+}
+
+/**
+ * The 'JAsyncQueue' type's tp_dealloc slot. There are no calls left, as each call holds a reference to its queue.
+ */
+static void JAsyncQueue_dealloc(JPy_JAsyncQueue* self)
+{
+    JPy_DECREF(self->loop);
+    PyObject_Del(self);
+}
+
+static PyObject* JAsyncQueue_repr(JPy_JAsyncQueue* self)
+{
+    return JPy_FROM_FORMAT("JAsyncQueue(pending=%d)", (int) self->pending);
+}
+
+PyTypeObject JAsyncQueue_Type =
+{
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "jpy.JAsyncQueue",                          /* tp_name */
+    sizeof (JPy_JAsyncQueue),                   /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor) JAsyncQueue_dealloc,           /* tp_dealloc */
+    NULL,                                       /* tp_print */
+    NULL,                                       /* tp_getattr */
+    NULL,                                       /* tp_setattr */
+    NULL,                                       /* tp_reserved */
+    (reprfunc) JAsyncQueue_repr,                /* tp_repr */
+    NULL,                                       /* tp_as_number */
+    NULL,                                       /* tp_as_sequence */
+    NULL,                                       /* tp_as_mapping */
+    NULL,                                       /* tp_hash  */
+    (ternaryfunc) JAsyncQueue_call,             /* tp_call */
+    NULL,                                       /* tp_str */
+    NULL,                                       /* tp_getattro */
+    NULL,                                       /* tp_setattro */
+    NULL,                                       /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                         /* tp_flags */
+    "Resolves the futures of completed Java calls of an asyncio event loop, see jpy.call_async()",   /* tp_doc */
+    NULL,                                       /* tp_traverse */
+    NULL,                                       /* tp_clear */
+    NULL,                                       /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    NULL,                                       /* tp_iter */
+    NULL,                                       /* tp_iternext */
+    NULL,                                       /* tp_methods */
+    NULL,                                       /* tp_members */
+    NULL,                                       /* tp_getset */
+    NULL,                                       /* tp_base */
+    NULL,                                       /* tp_dict */
+    NULL,                                       /* tp_descr_get */
+    NULL,                                       /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    NULL,                                       /* tp_init */
+    NULL,                                       /* tp_alloc */
+    NULL,                                       /* tp_new */
+};
+
+
+/**
+ * Gets the event loop for Java callers, starting it in a new daemon thread on first use or after it has been closed.
+ * Returns a borrowed reference.
+ */
+static PyObject* JAsyncTask_GetLoop(void)
+{
+    PyObject* asyncio;
+    PyObject* inspect;
+    PyObject* threading;
+    PyObject* threadType;
+    PyObject* loop;
+    PyObject* noArgs;
+    PyObject* kwargs;
+    PyObject* thread;
+    PyObject* ret;
+
+    if (JAsyncTask_Loop != NULL) {
+        PyObject* closed = PyObject_CallMethod(JAsyncTask_Loop, "is_closed", NULL);
+        int isClosed = closed != NULL ? PyObject_IsTrue(closed) : -1;
+        JPy_XDECREF(closed);
+        if (isClosed < 0) {
+            return NULL;
+        } else if (!isClosed) {
+            return JAsyncTask_Loop;
+        }
+        JPy_DECREF(JAsyncTask_Loop);
+        JAsyncTask_Loop = NULL;
+    }
+
+    if (JAsyncTask_EnsureFuture == NULL) {
+        asyncio = PyImport_ImportModule("asyncio");
+        inspect = PyImport_ImportModule("inspect");
+        if (asyncio != NULL && inspect != NULL) {
+            JAsyncTask_EnsureFuture = PyObject_GetAttrString(asyncio, "ensure_future");
+            JAsyncTask_IsAwaitable = PyObject_GetAttrString(inspect, "isawaitable");
+        }
+        JPy_XDECREF(asyncio);
+        JPy_XDECREF(inspect);
+        if (JAsyncTask_EnsureFuture == NULL || JAsyncTask_IsAwaitable == NULL) {
+            JPy_XDECREF(JAsyncTask_EnsureFuture);
+            JAsyncTask_EnsureFuture = NULL;
+            return NULL;
+        }
+    }
+
+    asyncio = PyImport_ImportModule("asyncio");
+    if (asyncio == NULL) {
+        return NULL;
+    }
+    loop = PyObject_CallMethod(asyncio, "new_event_loop", NULL);
+    JPy_DECREF(asyncio);
+    if (loop == NULL) {
+        return NULL;
+    }
+
+    threading = PyImport_ImportModule("threading");
+    threadType = threading != NULL ? PyObject_GetAttrString(threading, "Thread") : NULL;
+    JPy_XDECREF(threading);
+    if (threadType == NULL) {
+        JPy_DECREF(loop);
+        return NULL;
+    }
+    noArgs = PyTuple_New(0);
+    kwargs = Py_BuildValue("{s:N,s:s,s:O}", "target", PyObject_GetAttrString(loop, "run_forever"), "name", "jpy-asyncio", "daemon", Py_True);
+    thread = noArgs != NULL && kwargs != NULL ? PyObject_Call(threadType, noArgs, kwargs) : NULL;
+    JPy_DECREF(threadType);
+    JPy_XDECREF(noArgs);
+    JPy_XDECREF(kwargs);
+    ret = thread != NULL ? PyObject_CallMethod(thread, "start", NULL) : NULL;
+    if (ret == NULL) {
+        JPy_XDECREF(thread);
+        JPy_DECREF(loop);
+        return NULL;
+    }
+    JPy_DECREF(ret);
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JAsyncTask_GetLoop: started event loop thread, loop=%p\n", loop);
+    JPy_XDECREF(JAsyncTask_Thread);
+    JAsyncTask_Thread = thread;
+    JAsyncTask_Loop = loop;
+    return loop;
+}
+
+/**
+ * Converts the pending Python error into a Java throwable, an org.jpy.PyException if possible. Returns a local reference.
+ */
+static jthrowable JAsyncTask_FetchThrowable(JNIEnv* jenv)
+{
+    PyObject* pyType;
+    PyObject* pyValue;
+    PyObject* pyTraceback;
+    PyObject* message;
+    jthrowable throwable = NULL;
+
+    PyErr_Fetch(&pyType, &pyValue, &pyTraceback);
+    PyErr_NormalizeException(&pyType, &pyValue, &pyTraceback);
+
+#if defined(JPY_COMPAT_33P)
+    if (JPy_PyException_JClass != NULL && pyValue != NULL && PyExceptionInstance_Check(pyValue)) {
+        if (pyTraceback != NULL) {
+            PyException_SetTraceback(pyValue, pyTraceback);
+        }
+        JPy_INCREF(pyValue);
+        throwable = (*jenv)->NewObject(jenv, JPy_PyException_JClass, JPy_PyException_Init_MID, (jlong) pyValue);
+        if (throwable == NULL) {
+            // the Java exception takes over the reference only if it has been constructed
+            JPy_DECREF(pyValue);
+            (*jenv)->ExceptionClear(jenv);
+        }
+    }
+#endif
+
+    if (throwable == NULL) {
+        message = pyValue != NULL ? PyObject_Str(pyValue) : NULL;
+        PyErr_Clear();
+        (*jenv)->ThrowNew(jenv, JPy_RuntimeException_JClass, message != NULL ? JPy_AS_UTF8(message) : "Python error");
+        JPy_XDECREF(message);
+        throwable = (*jenv)->ExceptionOccurred(jenv);
+        (*jenv)->ExceptionClear(jenv);
+    }
+
+    JPy_XDECREF(pyType);
+    JPy_XDECREF(pyValue);
+    JPy_XDECREF(pyTraceback);
+    return throwable;
+}
+
+/**
+ * Removes the given task from the list of pending tasks, if it is on it.
+ */
+static void JAsyncTask_Unlink(JPy_JAsyncTask* self)
+{
+    if (self->prev != NULL) {
+        self->prev->next = self->next;
+    } else if (JAsyncTask_Pending == self) {
+        JAsyncTask_Pending = self->next;
+    }
+    if (self->next != NULL) {
+        self->next->prev = self->prev;
+    }
+    self->prev = NULL;
+    self->next = NULL;
+}
+
+/**
+ * Completes the Java future of a task which won't run to its end exceptionally, with a java.lang.RuntimeException
+ * which, unlike an org.jpy.PyException, doesn't refer to a Python object that may outlive the interpreter.
+ */
+static void JAsyncTask_Abandon(JNIEnv* jenv, JPy_JAsyncTask* self, const char* message)
+{
+    jthrowable error;
+
+    JAsyncTask_Unlink(self);
+    (*jenv)->ThrowNew(jenv, JPy_RuntimeException_JClass, message);
+    error = (*jenv)->ExceptionOccurred(jenv);
+    (*jenv)->ExceptionClear(jenv);
+    if (error == NULL) {
+        return;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    (*jenv)->CallBooleanMethod(jenv, self->future, JPy_CompletableFuture_CompleteExceptionally_MID, error);
+    Py_END_ALLOW_THREADS
+    (*jenv)->ExceptionClear(jenv);
+    JPy_DELETE_LOCAL_REF(error);
+}
+
+/**
+ * Completes the Java future of the given task with the given result, or with the pending Python error if it is NULL.
+ */
+static void JAsyncTask_Complete(JNIEnv* jenv, JPy_JAsyncTask* self, PyObject* result)
+{
+    jobject value = NULL;
+    jthrowable error = NULL;
+
+    JAsyncTask_Unlink(self);
+    if (result == NULL || JType_CreateJavaPyObject(jenv, JPy_JPyObject, result, &value) < 0) {
+        error = JAsyncTask_FetchThrowable(jenv);
+    }
+
+    // Dependent stages registered without an executor run here, they must not wait for the loop
+    Py_BEGIN_ALLOW_THREADS
+    if (error != NULL) {
+        (*jenv)->CallBooleanMethod(jenv, self->future, JPy_CompletableFuture_CompleteExceptionally_MID, error);
+    } else {
+        (*jenv)->CallBooleanMethod(jenv, self->future, JPy_CompletableFuture_Complete_MID, value);
+    }
+    Py_END_ALLOW_THREADS
+
+    if ((*jenv)->ExceptionCheck(jenv)) {
+        JPy_HandleJavaException(jenv);
+        PyErr_WriteUnraisable((PyObject*) self);
+    }
+    if (value != NULL) {
+        JPy_DELETE_LOCAL_REF(value);
+    }
+    if (error != NULL) {
+        JPy_DELETE_LOCAL_REF(error);
+    }
+}
+
+/**
+ * Calls the task's function, passing CompletionStage arguments as futures of the running loop.
+ * Returns a new reference to the result, or to the function itself if there are no arguments to await it.
+ */
+static PyObject* JAsyncTask_Start(JNIEnv* jenv, JPy_JAsyncTask* self)
+{
+    PyObject* callArgs;
+    PyObject* result;
+    Py_ssize_t argCount;
+    Py_ssize_t i;
+
+    if (self->args == NULL) {
+        JPy_INCREF(self->func);
+        return self->func;
+    }
+
+    argCount = PyTuple_GET_SIZE(self->args);
+    callArgs = PyTuple_New(argCount);
+    if (callArgs == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < argCount; i++) {
+        PyObject* arg = PyTuple_GET_ITEM(self->args, i);
+        if (JObj_Check(arg) && (*jenv)->IsInstanceOf(jenv, ((JPy_JObj*) arg)->objectRef, JPy_CompletionStage_JClass)) {
+            arg = JPy_AsyncCall_AsFuture(jenv, arg);
+            if (arg == NULL) {
+                JPy_DECREF(callArgs);
+                return NULL;
+            }
+        } else {
+            JPy_INCREF(arg);
+        }
+        PyTuple_SET_ITEM(callArgs, i, arg);
+    }
+
+    result = PyObject_Call(self->func, callArgs, NULL);
+    JPy_DECREF(callArgs);
+    return result;
+}
+
+/**
+ * Awaits the given awaitable on the running loop, the task is called back with the resulting future when it is done.
+ */
+static int JAsyncTask_Await(JPy_JAsyncTask* self, PyObject* awaitable)
+{
+    PyObject* future;
+    PyObject* ret;
+
+    future = PyObject_CallFunctionObjArgs(JAsyncTask_EnsureFuture, awaitable, NULL);
+    if (future == NULL) {
+        return -1;
+    }
+    ret = PyObject_CallMethod(future, "add_done_callback", "O", (PyObject*) self);
+    JPy_DECREF(future);
+    if (ret == NULL) {
+        return -1;
+    }
+    JPy_DECREF(ret);
+    return 0;
+}
+
+static PyObject* JAsyncTask_call_internal(JNIEnv* jenv, JPy_JAsyncTask* self, PyObject* args)
+{
+    PyObject* result;
+
+    if (self->prev == NULL && JAsyncTask_Pending != self) {
+        // Already abandoned by JAsyncTask_Shutdown()
+        return JPy_FROM_JVOID();
+    }
+
+    if (PyTuple_Size(args) == 0) {
+        // Scheduled by JPy_AsyncTask_Submit()
+        result = JAsyncTask_Start(jenv, self);
+        if (result != NULL) {
+            PyObject* isAwaitable = PyObject_CallFunctionObjArgs(JAsyncTask_IsAwaitable, result, NULL);
+            int awaiting = isAwaitable != NULL ? PyObject_IsTrue(isAwaitable) : -1;
+            JPy_XDECREF(isAwaitable);
+            if (awaiting > 0) {
+                awaiting = JAsyncTask_Await(self, result) < 0 ? -1 : 1;
+            }
+            if (awaiting < 0) {
+                JPy_DECREF(result);
+                result = NULL;
+            } else if (awaiting > 0) {
+                JPy_DECREF(result);
+                return JPy_FROM_JVOID();
+            }
+        }
+    } else {
+        // Done callback of the future awaited for the task
+        result = PyObject_CallMethod(PyTuple_GET_ITEM(args, 0), "result", NULL);
+    }
+
+    JAsyncTask_Complete(jenv, self, result);
+    JPy_XDECREF(result);
+    return JPy_FROM_JVOID();
+}
+
+/**
+ * The 'JAsyncTask' type's tp_call slot, called on the event loop thread.
+ */
+static PyObject* JAsyncTask_call(JPy_JAsyncTask* self, PyObject* args, PyObject* kw)
+{
+    JPy_FRAME(PyObject*, NULL, JAsyncTask_call_internal(jenv, self, args), 16)
+}
+
+int JPy_AsyncTask_Submit(JNIEnv* jenv, PyObject* func, PyObject* args, jobject future)
+{
+    JPy_JAsyncTask* task;
+    PyObject* loop;
+    PyObject* handle;
+
+    loop = JAsyncTask_GetLoop();
+    if (loop == NULL) {
+        return -1;
+    }
+
+    task = PyObject_New(JPy_JAsyncTask, &JAsyncTask_Type);
+    if (task == NULL) {
+        return -1;
+    }
+    JPy_INCREF(func);
+    task->func = func;
+    Py_XINCREF(args);
+    task->args = args;
+    task->prev = NULL;
+    task->next = NULL;
+    task->future = JPy_NewGlobalRef(jenv, future, JPy_GREF_OBJECT);
+    if (task->future == NULL) {
+        JPy_DECREF((PyObject*) task);
+        PyErr_NoMemory();
+        return -1;
+    }
+    task->next = JAsyncTask_Pending;
+    if (task->next != NULL) {
+        task->next->prev = task;
+    }
+    JAsyncTask_Pending = task;
+
+    // The handle keeps the task alive until it is called
+    handle = PyObject_CallMethod(loop, "call_soon_threadsafe", "O", (PyObject*) task);
+    if (handle == NULL) {
+        // The caller completes the future with the error
+        JAsyncTask_Unlink(task);
+    }
+    JPy_DECREF((PyObject*) task);
+    if (handle == NULL) {
+        return -1;
+    }
+    JPy_DECREF(handle);
+    return 0;
+}
+
+/**
+ * The 'JAsyncTask' type's tp_dealloc slot.
+ */
+static void JAsyncTask_dealloc(JPy_JAsyncTask* self)
+{
+    JNIEnv* jenv;
+
+    jenv = JPy_GetJNIEnv();
+    if (jenv != NULL && (self->prev != NULL || JAsyncTask_Pending == self)) {
+        // Dropped by the event loop without having been run, e.g. when the loop is closed
+        JAsyncTask_Abandon(jenv, self, "jpy: the Python task has been dropped by its event loop");
+    }
+    JAsyncTask_Unlink(self);
+    JPy_DECREF(self->func);
+    JPy_XDECREF(self->args);
+    if (jenv != NULL && self->future != NULL) {
+        JPy_DeleteGlobalRef(jenv, self->future, JPy_GREF_OBJECT);
+    }
+    PyObject_Del(self);
+}
+
+PyTypeObject JAsyncTask_Type =
+{
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "jpy.JAsyncTask",                           /* tp_name */
+    sizeof (JPy_JAsyncTask),                    /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor) JAsyncTask_dealloc,            /* tp_dealloc */
+    NULL,                                       /* tp_print */
+    NULL,                                       /* tp_getattr */
+    NULL,                                       /* tp_setattr */
+    NULL,                                       /* tp_reserved */
+    NULL,                                       /* tp_repr */
+    NULL,                                       /* tp_as_number */
+    NULL,                                       /* tp_as_sequence */
+    NULL,                                       /* tp_as_mapping */
+    NULL,                                       /* tp_hash  */
+    (ternaryfunc) JAsyncTask_call,              /* tp_call */
+    NULL,                                       /* tp_str */
+    NULL,                                       /* tp_getattro */
+    NULL,                                       /* tp_setattro */
+    NULL,                                       /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                         /* tp_flags */
+    "Runs a Python call or coroutine for a Java caller, see org.jpy.PyObject.callAsync()",   /* tp_doc */
+    NULL,                                       /* tp_traverse */
+    NULL,                                       /* tp_clear */
+    NULL,                                       /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    NULL,                                       /* tp_iter */
+    NULL,                                       /* tp_iternext */
+    NULL,                                       /* tp_methods */
+    NULL,                                       /* tp_members */
+    NULL,                                       /* tp_getset */
+    NULL,                                       /* tp_base */
+    NULL,                                       /* tp_dict */
+    NULL,                                       /* tp_descr_get */
+    NULL,                                       /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    NULL,                                       /* tp_init */
+    NULL,                                       /* tp_alloc */
+    NULL,                                       /* tp_new */
+};
+
+
+/**
+ * Seconds to wait for the "jpy-asyncio" thread to leave its event loop when Python is stopped.
+ */
+#define JPy_ASYNC_TASK_JOIN_TIMEOUT 5.0
+
+/**
+ * Stops the event loop for Java callers, waits for its thread and closes it, then completes the futures of all tasks
+ * which have not been completed yet exceptionally. The GIL must be held.
+ */
+static void JAsyncTask_Shutdown(JNIEnv* jenv)
+{
+    PyObject* stop;
+    PyObject* threading;
+    PyObject* currentThread;
+    PyObject* ret;
+    PyObject* alive;
+    int isAlive = 1;
+
+    // While the interpreter is being finalized, the loop's thread can't take the GIL anymore to leave the loop
+    if (JAsyncTask_Loop != NULL && Py_IsInitialized()) {
+        stop = PyObject_GetAttrString(JAsyncTask_Loop, "stop");
+        ret = stop != NULL ? PyObject_CallMethod(JAsyncTask_Loop, "call_soon_threadsafe", "O", stop) : NULL;
+        JPy_XDECREF(stop);
+        JPy_XDECREF(ret);
+
+        threading = PyImport_ImportModule("threading");
+        currentThread = threading != NULL ? PyObject_CallMethod(threading, "current_thread", NULL) : NULL;
+        JPy_XDECREF(threading);
+        if (ret != NULL && currentThread != NULL && currentThread != JAsyncTask_Thread) {
+            ret = PyObject_CallMethod(JAsyncTask_Thread, "join", "d", JPy_ASYNC_TASK_JOIN_TIMEOUT);
+            JPy_XDECREF(ret);
+            alive = ret != NULL ? PyObject_CallMethod(JAsyncTask_Thread, "is_alive", NULL) : NULL;
+            isAlive = alive != NULL ? PyObject_IsTrue(alive) : 1;
+            JPy_XDECREF(alive);
+        }
+        JPy_XDECREF(currentThread);
+
+        // Drops the tasks which have been scheduled but not run yet, see JAsyncTask_dealloc()
+        ret = !isAlive ? PyObject_CallMethod(JAsyncTask_Loop, "close", NULL) : NULL;
+        JPy_XDECREF(ret);
+        if (PyErr_Occurred()) {
+            JPy_DIAG_PRINT(JPy_DIAG_F_ERR, "JAsyncTask_Shutdown: error: failed to shut down the event loop\n");
+            PyErr_Clear();
+        }
+        JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JAsyncTask_Shutdown: loop=%p, closed=%d\n", JAsyncTask_Loop, !isAlive);
+    }
+
+    while (jenv != NULL && JAsyncTask_Pending != NULL) {
+        JAsyncTask_Abandon(jenv, JAsyncTask_Pending, "jpy: Python has been stopped before the Python task completed");
+    }
+
+    Py_CLEAR(JAsyncTask_Loop);
+    Py_CLEAR(JAsyncTask_Thread);
+    Py_CLEAR(JAsyncTask_EnsureFuture);
+    Py_CLEAR(JAsyncTask_IsAwaitable);
+}
+
+void JPy_Async_Free(void)
+{
+    JNIEnv* jenv;
+    PyObject* loop;
+    PyObject* queue;
+    Py_ssize_t pos = 0;
+    int posting;
+
+    JAsyncTask_Shutdown(JPy_GetJNIEnv());
+
+    if (JAsyncCall_Lock != NULL) {
+        // Calls completing from now on are freed by JAsyncCall_Post(). The threads already waking up a loop
+        // are waiting for the GIL, which is released until they are done, unless the interpreter is already
+        // being finalized, in which case they can't get it anymore.
+        for (;;) {
+            PyThread_acquire_lock(JAsyncCall_Lock, WAIT_LOCK);
+            posting = JAsyncCall_Posting;
+            if (posting == 0 || !Py_IsInitialized()) {
+                JAsyncCall_Generation++;
+            }
+            PyThread_release_lock(JAsyncCall_Lock);
+            if (posting == 0 || !Py_IsInitialized()) {
+                break;
+            }
+            Py_BEGIN_ALLOW_THREADS
+            Py_END_ALLOW_THREADS
+        }
+    }
+
+    if (JAsyncQueue_Queues != NULL) {
+        // Nobody will wait for the futures of the completed calls anymore
+        jenv = JPy_GetJNIEnv();
+        while (jenv != NULL && PyDict_Next(JAsyncQueue_Queues, &pos, &loop, &queue)) {
+            JAsyncQueue_Drain(jenv, (JPy_JAsyncQueue*) queue, JNI_FALSE);
+        }
+        Py_CLEAR(JAsyncQueue_Queues);
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+#ifndef JPY_ASYNC_H
+#define JPY_ASYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+
+/**
+ * asyncio integration. jpy.call_async() runs a Java method on a thread of the Java pool in
+ * org.jpy.JavaAsync and returns an asyncio.Future of the event loop running in the calling thread.
+ * jpy.as_future() does the same for a java.util.concurrent.CompletionStage, which is also awaited
+ * if it is the result of a call_async() call.
+ *
+ * Completed calls are pushed onto a lock-free stack of the loop's JAsyncQueue by the Java threads.
+ * Only the thread that finds the stack empty takes the GIL to wake the loop with call_soon_threadsafe(),
+ * so that a burst of completions costs a single loop wakeup. The loop then resolves the futures of
+ * all calls on the stack at once.
+ *
+ * In the other direction, org.jpy.PyObject.callAsync() runs Python calls and coroutines for Java callers on a
+ * dedicated event loop thread ("jpy-asyncio") and completes a java.util.concurrent.CompletableFuture with the
+ * outcome, called back from the loop when the coroutine is done.
+ */
+
+/**
+ * A pending call, see jpy_async.c. Its address is passed to Java as a long.
+ */
+typedef struct JPy_AsyncCall JPy_AsyncCall;
+
+/**
+ * The Python 'JAsyncQueue' type, there is one instance per event loop.
+ */
+extern PyTypeObject JAsyncQueue_Type;
+
+/**
+ * The Python 'JAsyncTask' type, a Python call or awaitable run for a Java caller.
+ */
+extern PyTypeObject JAsyncTask_Type;
+
+/**
+ * Implements jpy.call_async(method, *args). Returns a new reference to an asyncio.Future.
+ */
+PyObject* JPy_AsyncCall_Submit(JNIEnv* jenv, PyObject* func, PyObject* args);
+
+/**
+ * Implements jpy.as_future(stage). Returns a new reference to an asyncio.Future.
+ */
+PyObject* JPy_AsyncCall_AsFuture(JNIEnv* jenv, PyObject* stage);
+
+/**
+ * Runs the Java method of the given call on the current (Java) thread, called by org.jpy.JavaAsync without the GIL.
+ */
+void JPy_AsyncCall_Run(JNIEnv* jenv, JPy_AsyncCall* call);
+
+/**
+ * Completes the given call with the value or error of an awaited CompletionStage, called by org.jpy.JavaAsync
+ * without the GIL.
+ */
+void JPy_AsyncCall_Complete(JNIEnv* jenv, JPy_AsyncCall* call, jobject value, jthrowable error);
+
+/**
+ * Schedules the call of 'func' with the Python tuple 'args' on the jpy event loop thread, which is started on first use.
+ * If 'args' is NULL, 'func' is awaited instead of called. A result which is awaitable is awaited on the loop, arguments
+ * which are java.util.concurrent.CompletionStages are passed as futures of the loop, see jpy.as_future(). The given
+ * java.util.concurrent.CompletableFuture is completed with an org.jpy.PyObject for the result, or exceptionally with
+ * an org.jpy.PyException. The GIL must be held. Returns -1 and sets a Python error if the call can't be scheduled.
+ */
+int JPy_AsyncTask_Submit(JNIEnv* jenv, PyObject* func, PyObject* args, jobject future);
+
+/**
+ * Called by JPy_free() before the interpreter is finalized, the GIL must be held. Stops the event loop for Java
+ * callers and completes the futures of its unfinished tasks exceptionally. Frees the completed calls which have
+ * not been resolved yet and forgets the queues of all event loops. Calls still running in Java are freed when
+ * they complete, without resolving their futures.
+ */
+void JPy_Async_Free(void);
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_ASYNC_H */
@@ -18,19 +18,565 @@
 #include "structmember.h"
 #include "jpy_diag.h"
 #include "jpy_compat.h"
+#include "jpy_module.h"
+#include "jpy_metrics.h"
+#include "jpy_memstats.h"
+#include <pythread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
 
 int JPy_DiagFlags = JPy_DIAG_F_OFF;
+int JPy_DiagStdout = 0;
+
+/**
+ * The class org.jpy.PyLib.Diag and its static method setJavaFlags(int), once the class has been initialized.
+ */
+static jclass JPy_Diag_JClass = NULL;
+static jmethodID JPy_Diag_SetJavaFlags_SMID = NULL;
+
+
+/*
+ * Diagnostic messages are recorded as binary events into a ring buffer owned by the calling thread.
+ * The owner is the only writer of 'head', drainers are the only writers of 'tail', so recording needs
+ * neither a lock nor formatting: only the format string pointer (which identifies the event), the
+ * integer/pointer arguments and copies of the string arguments are stored. Formatting is done by
+ * whoever drains the buffers. Events are dropped while a thread's buffer is full.
+ *
+ * Buffers are never freed, because drainers walk the list without a lock. Instead, a thread gives
+ * its buffer up when it exits, and the next new thread takes it over, so that there are never
+ * more buffers than threads having recorded events at the same time.
+ */
+
+#define JPy_DIAG_BUFFER_CAPACITY 1024
+#define JPy_DIAG_MAX_ARGS        8
+#define JPy_DIAG_MAX_CHARS       128
+#define JPy_DIAG_MAX_MESSAGE     1024
+
+#if defined(_MSC_VER)
+#define JPy_THREAD_LOCAL                    __declspec(thread)
+#define JPy_ATOMIC_LOAD(p)                  InterlockedCompareExchange64((volatile LONG64*) (p), 0, 0)
+#define JPy_ATOMIC_STORE(p, v)              InterlockedExchange64((volatile LONG64*) (p), (v))
+#define JPy_ATOMIC_LOAD_PTR(p)              InterlockedCompareExchangePointer((PVOID volatile*) (p), NULL, NULL)
+#define JPy_ATOMIC_CAS_PTR(p, expected, v)  (InterlockedCompareExchangePointer((PVOID volatile*) (p), (v), (expected)) == (expected))
+#else
+#define JPy_THREAD_LOCAL                    __thread
+#define JPy_ATOMIC_LOAD(p)                  __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define JPy_ATOMIC_STORE(p, v)              __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define JPy_ATOMIC_LOAD_PTR(p)              __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define JPy_ATOMIC_CAS_PTR(p, expected, v)  __sync_bool_compare_and_swap(p, expected, v)
+#endif
+
+// Kinds of printf conversions
+#define JPy_DIAG_ARG_INT     1
+#define JPy_DIAG_ARG_UINT    2
+#define JPy_DIAG_ARG_DOUBLE  3
+#define JPy_DIAG_ARG_PTR     4
+#define JPy_DIAG_ARG_STR     5
+
+typedef union JPy_DiagArg
+{
+    long long i;
+    double d;
+    const void* p;
+    // Offset of the copied string in JPy_DiagEvent.chars
+    int s;
+}
+JPy_DiagArg;
+
+typedef struct JPy_DiagEvent
+{
+    // Identifies the event, only string literals are passed to JPy_DIAG_PRINT
+    const char* format;
+    long long time;
+    unsigned long threadId;
+    int flags;
+    int argCount;
+    JPy_DiagArg args[JPy_DIAG_MAX_ARGS];
+    char chars[JPy_DIAG_MAX_CHARS];
+}
+JPy_DiagEvent;
+
+typedef struct JPy_DiagBuffer
+{
+    // All buffers, newest first. Buffers are never removed.
+    struct JPy_DiagBuffer* next;
+    // The buffer itself while a thread records into it, NULL once the thread has exited
+    void* volatile owner;
+    unsigned long threadId;
+    long long head;
+    long long tail;
+    long long dropped;
+    JPy_DiagEvent events[JPy_DIAG_BUFFER_CAPACITY];
+}
+JPy_DiagBuffer;
+
+typedef struct JPy_DiagSpec
+{
+    // JPy_DIAG_ARG_*, or 0 for "%%" and unsupported conversions
+    int kind;
+    // Number of 'l' modifiers, -1 for size modifiers ('z', 'j', 't')
+    int length;
+}
+JPy_DiagSpec;
+
+static JPy_DiagBuffer* volatile JPy_Diag_Buffers = NULL;
+static JPy_THREAD_LOCAL JPy_DiagBuffer* JPy_Diag_ThreadBuffer = NULL;
+// Serializes drainers
+static void* volatile JPy_Diag_Drainer = NULL;
+
+
+#ifdef _WIN32
+static DWORD JPy_Diag_ExitKey = FLS_OUT_OF_INDEXES;
+static INIT_ONCE JPy_Diag_ExitKeyOnce = INIT_ONCE_STATIC_INIT;
+
+static void WINAPI JPy_Diag_ReleaseThreadBuffer(void* buffer)
+{
+    JPy_ATOMIC_CAS_PTR(&((JPy_DiagBuffer*) buffer)->owner, buffer, NULL);
+}
+
+static BOOL CALLBACK JPy_Diag_CreateExitKey(PINIT_ONCE once, void* param, void** context)
+{
+    JPy_Diag_ExitKey = FlsAlloc(JPy_Diag_ReleaseThreadBuffer);
+    return TRUE;
+}
+
+/**
+ * Makes the calling thread give up its buffer when it exits.
+ */
+static void JPy_Diag_ReleaseOnExit(JPy_DiagBuffer* buffer)
+{
+    InitOnceExecuteOnce(&JPy_Diag_ExitKeyOnce, JPy_Diag_CreateExitKey, NULL, NULL);
+    if (JPy_Diag_ExitKey != FLS_OUT_OF_INDEXES) {
+        FlsSetValue(JPy_Diag_ExitKey, buffer);
+    }
+}
+#else
+static pthread_key_t JPy_Diag_ExitKey;
+static pthread_once_t JPy_Diag_ExitKeyOnce = PTHREAD_ONCE_INIT;
+static int JPy_Diag_ExitKeyCreated = 0;
+
+static void JPy_Diag_ReleaseThreadBuffer(void* buffer)
+{
+    JPy_ATOMIC_CAS_PTR(&((JPy_DiagBuffer*) buffer)->owner, buffer, NULL);
+}
+
+static void JPy_Diag_CreateExitKey(void)
+{
+    JPy_Diag_ExitKeyCreated = pthread_key_create(&JPy_Diag_ExitKey, JPy_Diag_ReleaseThreadBuffer) == 0;
+}
+
+/**
+ * Makes the calling thread give up its buffer when it exits.
+ */
+static void JPy_Diag_ReleaseOnExit(JPy_DiagBuffer* buffer)
+{
+    pthread_once(&JPy_Diag_ExitKeyOnce, JPy_Diag_CreateExitKey);
+    if (JPy_Diag_ExitKeyCreated) {
+        pthread_setspecific(JPy_Diag_ExitKey, buffer);
+    }
+}
+#endif
+
+/**
+ * Takes over a buffer given up by an exited thread, returns NULL if there is none.
+ */
+static JPy_DiagBuffer* JPy_Diag_ClaimOrphanedBuffer(void)
+{
+    JPy_DiagBuffer* buffer;
+
+    for (buffer = (JPy_DiagBuffer*) JPy_ATOMIC_LOAD_PTR(&JPy_Diag_Buffers); buffer != NULL; buffer = buffer->next) {
+        if (JPy_ATOMIC_LOAD_PTR(&buffer->owner) == NULL && JPy_ATOMIC_CAS_PTR(&buffer->owner, NULL, buffer)) {
+            return buffer;
+        }
+    }
+    return NULL;
+}
+
+static JPy_DiagBuffer* JPy_Diag_GetThreadBuffer(void)
+{
+    JPy_DiagBuffer* buffer = JPy_Diag_ThreadBuffer;
+    JPy_DiagBuffer* first;
+
+    if (buffer == NULL) {
+        buffer = JPy_Diag_ClaimOrphanedBuffer();
+        if (buffer == NULL) {
+            buffer = (JPy_DiagBuffer*) calloc(1, sizeof (JPy_DiagBuffer));
+            if (buffer == NULL) {
+                return NULL;
+            }
+            buffer->owner = buffer;
+            do {
+                first = (JPy_DiagBuffer*) JPy_ATOMIC_LOAD_PTR(&JPy_Diag_Buffers);
+                buffer->next = first;
+            } while (!JPy_ATOMIC_CAS_PTR(&JPy_Diag_Buffers, first, buffer));
+        }
+        // Events still in a taken over buffer keep the ID of the thread which recorded them
+        buffer->threadId = (unsigned long) PyThread_get_thread_ident();
+        JPy_Diag_ReleaseOnExit(buffer);
+        JPy_Diag_ThreadBuffer = buffer;
+    }
+    return buffer;
+}
+
+/**
+ * Parses the printf conversion specification following a '%' and returns a pointer past it.
+ */
+static const char* JPy_Diag_ParseSpec(const char* p, JPy_DiagSpec* spec)
+{
+    spec->kind = 0;
+    spec->length = 0;
+
+    if (*p == '%') {
+        return p + 1;
+    }
+    p += strspn(p, "-+ #0123456789.");
+    while (*p == 'h' || *p == 'l' || *p == 'z' || *p == 'j' || *p == 't') {
+        if (*p == 'l') {
+            spec->length++;
+        } else if (*p != 'h') {
+            spec->length = -1;
+        }
+        p++;
+    }
+    switch (*p) {
+        case 'd':
+        case 'i':
+        case 'c':
+            spec->kind = JPy_DIAG_ARG_INT;
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            spec->kind = JPy_DIAG_ARG_UINT;
+            break;
+        case 'f':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+            spec->kind = JPy_DIAG_ARG_DOUBLE;
+            break;
+        case 'p':
+            spec->kind = JPy_DIAG_ARG_PTR;
+            break;
+        case 's':
+            spec->kind = JPy_DIAG_ARG_STR;
+            break;
+        default:
+            return p;
+    }
+    return p + 1;
+}
+
+static void JPy_Diag_CaptureArgs(JPy_DiagEvent* event, const char* format, va_list args)
+{
+    const char* p = format;
+    JPy_DiagArg* arg;
+    JPy_DiagSpec spec;
+    const char* str;
+    int charCount = 0;
+    int len;
+
+    event->argCount = 0;
+    while (event->argCount < JPy_DIAG_MAX_ARGS && (p = strchr(p, '%')) != NULL) {
+        p = JPy_Diag_ParseSpec(p + 1, &spec);
+        arg = event->args + event->argCount;
+        if (spec.kind == JPy_DIAG_ARG_INT) {
+            arg->i = spec.length >= 2 ? va_arg(args, long long)
+                   : spec.length == 1 ? va_arg(args, long)
+                   : spec.length < 0 ? (long long) va_arg(args, Py_ssize_t)
+                   : va_arg(args, int);
+        } else if (spec.kind == JPy_DIAG_ARG_UINT) {
+            arg->i = spec.length >= 2 ? (long long) va_arg(args, unsigned long long)
+                   : spec.length == 1 ? (long long) va_arg(args, unsigned long)
+                   : spec.length < 0 ? (long long) va_arg(args, size_t)
+                   : (long long) va_arg(args, unsigned int);
+        } else if (spec.kind == JPy_DIAG_ARG_DOUBLE) {
+            arg->d = va_arg(args, double);
+        } else if (spec.kind == JPy_DIAG_ARG_PTR) {
+            arg->p = va_arg(args, void*);
+        } else if (spec.kind == JPy_DIAG_ARG_STR) {
+            str = va_arg(args, const char*);
+            if (str == NULL) {
+                str = "(null)";
+            }
+            len = (int) strlen(str);
+            if (len > JPy_DIAG_MAX_CHARS - 1 - charCount) {
+                // truncated
+                len = JPy_DIAG_MAX_CHARS - 1 - charCount;
+            }
+            memcpy(event->chars + charCount, str, len);
+            event->chars[charCount + len] = 0;
+            arg->s = charCount;
+            charCount += len + (charCount + len < JPy_DIAG_MAX_CHARS - 1 ? 1 : 0);
+        } else {
+            continue;
+        }
+        event->argCount++;
+    }
+}
 
+/**
+ * Formats the event's message into 'buf', without the trailing newline.
+ */
+static void JPy_Diag_FormatEvent(JPy_DiagEvent* event, char* buf, size_t bufSize)
+{
+    const char* p = event->format;
+    const char* specStart;
+    char specChars[32];
+    JPy_DiagSpec spec;
+    JPy_DiagArg* arg;
+    size_t pos = 0;
+    size_t len;
+    int argIndex = 0;
+
+    buf[0] = 0;
+    while (*p != 0 && pos < bufSize - 1) {
+        if (p[0] == '%' && p[1] == '%') {
+            buf[pos++] = '%';
+            p += 2;
+            continue;
+        }
+        if (*p != '%' || argIndex >= event->argCount) {
+            // arguments beyond JPy_DIAG_MAX_ARGS are not recorded, their conversions are kept as is
+            buf[pos++] = *p++;
+            continue;
+        }
+        specStart = p;
+        p = JPy_Diag_ParseSpec(p + 1, &spec);
+        len = p - specStart;
+        if (spec.kind == 0 || len >= sizeof (specChars)) {
+            continue;
+        }
+        memcpy(specChars, specStart, len);
+        specChars[len] = 0;
+        arg = event->args + argIndex++;
+        if (spec.kind == JPy_DIAG_ARG_INT || spec.kind == JPy_DIAG_ARG_UINT) {
+            if (spec.length >= 2) {
+                PyOS_snprintf(buf + pos, bufSize - pos, specChars, arg->i);
+            } else if (spec.length == 1) {
+                PyOS_snprintf(buf + pos, bufSize - pos, specChars, (long) arg->i);
+            } else if (spec.length < 0) {
+                PyOS_snprintf(buf + pos, bufSize - pos, specChars, (Py_ssize_t) arg->i);
+            } else {
+                PyOS_snprintf(buf + pos, bufSize - pos, specChars, (int) arg->i);
+            }
+        } else if (spec.kind == JPy_DIAG_ARG_DOUBLE) {
+            PyOS_snprintf(buf + pos, bufSize - pos, specChars, arg->d);
+        } else if (spec.kind == JPy_DIAG_ARG_PTR) {
+            PyOS_snprintf(buf + pos, bufSize - pos, specChars, arg->p);
+        } else {
+            PyOS_snprintf(buf + pos, bufSize - pos, specChars, event->chars + arg->s);
+        }
+        pos += strlen(buf + pos);
+    }
+    buf[pos] = 0;
+    while (pos > 0 && (buf[pos - 1] == '\n' || buf[pos - 1] == '\r')) {
+        buf[--pos] = 0;
+    }
+}
 
 void JPy_DiagPrint(int diagFlags, const char * format, ...)
 {
-    if ((JPy_DiagFlags & diagFlags) != 0) {
-        va_list args;
-        va_start(args, format);
+    JPy_DiagBuffer* buffer;
+    JPy_DiagEvent* event;
+    long long head;
+    va_list args;
+
+    if ((JPy_DiagFlags & diagFlags) == 0) {
+        return;
+    }
+
+    va_start(args, format);
+    if (JPy_DiagStdout) {
         vfprintf(stdout, format, args);
         fflush(stdout);
-        va_end(args);
+    } else {
+        buffer = JPy_Diag_GetThreadBuffer();
+        if (buffer != NULL) {
+            head = buffer->head;
+            if (head - JPy_ATOMIC_LOAD(&buffer->tail) >= JPy_DIAG_BUFFER_CAPACITY) {
+                JPy_ATOMIC_STORE(&buffer->dropped, buffer->dropped + 1);
+            } else {
+                event = buffer->events + (head % JPy_DIAG_BUFFER_CAPACITY);
+                event->format = format;
+                event->time = JPy_NanoTime();
+                event->threadId = buffer->threadId;
+                event->flags = diagFlags;
+                JPy_Diag_CaptureArgs(event, format, args);
+                JPy_ATOMIC_STORE(&buffer->head, head + 1);
+            }
+        }
+    }
+    va_end(args);
+}
+
+static int JPy_Diag_CompareEvents(const void* e1, const void* e2)
+{
+    long long t1 = ((const JPy_DiagEvent*) e1)->time;
+    long long t2 = ((const JPy_DiagEvent*) e2)->time;
+    return t1 < t2 ? -1 : t1 > t2 ? 1 : 0;
+}
+
+Py_ssize_t JPy_Diag_DrainEvents(JPy_DiagEventVisitor visitor, void* visitorArg)
+{
+    JPy_DiagBuffer* buffer;
+    JPy_DiagEvent* events = NULL;
+    JPy_DiagEvent* grown;
+    Py_ssize_t count = 0;
+    Py_ssize_t capacity = 0;
+    Py_ssize_t i;
+    long long head;
+    long long tail;
+    char message[JPy_DIAG_MAX_MESSAGE];
+
+    while (!JPy_ATOMIC_CAS_PTR(&JPy_Diag_Drainer, NULL, (void*) &JPy_Diag_Drainer)) {
+        // another thread is draining, it won't take long
+    }
+
+    for (buffer = (JPy_DiagBuffer*) JPy_ATOMIC_LOAD_PTR(&JPy_Diag_Buffers); buffer != NULL; buffer = buffer->next) {
+        head = JPy_ATOMIC_LOAD(&buffer->head);
+        tail = buffer->tail;
+        if (head == tail) {
+            continue;
+        }
+        if (count + (head - tail) > capacity) {
+            capacity = count + (Py_ssize_t) (head - tail) + JPy_DIAG_BUFFER_CAPACITY;
+            grown = (JPy_DiagEvent*) realloc(events, capacity * sizeof (JPy_DiagEvent));
+            if (grown == NULL) {
+                break;
+            }
+            events = grown;
+        }
+        for (; tail < head; tail++) {
+            events[count++] = buffer->events[tail % JPy_DIAG_BUFFER_CAPACITY];
+        }
+        JPy_ATOMIC_STORE(&buffer->tail, tail);
+    }
+
+    JPy_Diag_Drainer = NULL;
+
+    if (count > 0) {
+        qsort(events, count, sizeof (JPy_DiagEvent), JPy_Diag_CompareEvents);
+        for (i = 0; i < count; i++) {
+            JPy_Diag_FormatEvent(events + i, message, sizeof (message));
+            if (visitor(visitorArg, events[i].time, events[i].threadId, events[i].flags, message) < 0) {
+                count = -1;
+                break;
+            }
+        }
+    }
+    free(events);
+    return count;
+}
+
+long long JPy_Diag_GetDroppedCount(void)
+{
+    JPy_DiagBuffer* buffer;
+    long long dropped = 0;
+
+    for (buffer = (JPy_DiagBuffer*) JPy_ATOMIC_LOAD_PTR(&JPy_Diag_Buffers); buffer != NULL; buffer = buffer->next) {
+        dropped += JPy_ATOMIC_LOAD(&buffer->dropped);
+    }
+    return dropped;
+}
+
+static int JPy_Diag_WriteEvent(void* arg, long long time, unsigned long threadId, int flags, const char* message)
+{
+    return fprintf((FILE*) arg, "%lld [%lu] %s\n", time, threadId, message) < 0 ? -1 : 0;
+}
+
+Py_ssize_t JPy_Diag_DumpEvents(const char* path)
+{
+    FILE* file;
+    Py_ssize_t count;
+
+    file = fopen(path, "a");
+    if (file == NULL) {
+        return -1;
+    }
+    count = JPy_Diag_DrainEvents(JPy_Diag_WriteEvent, file);
+    if (fclose(file) != 0) {
+        count = -1;
+    }
+    return count;
+}
+
+static int JPy_Diag_AppendEvent(void* arg, long long time, unsigned long threadId, int flags, const char* message)
+{
+    PyObject* item;
+    int result;
+
+    item = Py_BuildValue("(LkiN)", time, threadId, flags, JPy_FROM_CSTR(message));
+    if (item == NULL) {
+        return -1;
+    }
+    result = PyList_Append((PyObject*) arg, item);
+    JPy_DECREF(item);
+    return result;
+}
+
+PyObject* Diag_drain(JPy_Diag* self)
+{
+    PyObject* events;
+
+    events = PyList_New(0);
+    if (events == NULL) {
+        return NULL;
+    }
+    if (JPy_Diag_DrainEvents(JPy_Diag_AppendEvent, events) < 0) {
+        JPy_DECREF(events);
+        return NULL;
+    }
+    return events;
+}
+
+PyObject* Diag_dump(JPy_Diag* self, PyObject* args)
+{
+    const char* path;
+    Py_ssize_t count;
+
+    if (!PyArg_ParseTuple(args, "s:dump", &path)) {
+        return NULL;
+    }
+    count = JPy_Diag_DumpEvents(path);
+    if (count < 0) {
+        return PyErr_SetFromErrnoWithFilename(PyExc_IOError, path);
+    }
+    return PyLong_FromSsize_t(count);
+}
+
+PyObject* Diag_memory_stats(JPy_Diag* self, PyObject* args, PyObject* kwds)
+{
+    static char* keywords[] = {"reset_peaks", NULL};
+    int resetPeaks = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|i:memory_stats", keywords, &resetPeaks)) {
+        return NULL;
     }
+    return JPy_MemStats_Get(resetPeaks);
+}
+
+static int Diag_SetLimit(PyObject* v, jlong* limit, const char* name)
+{
+    long long value = PyLong_AsLongLong(v);
+    if (value == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+    if (value < 0) {
+        PyErr_Format(PyExc_ValueError, "value for '%s' must not be negative", name);
+        return -1;
+    }
+    *limit = (jlong) value;
+    return 0;
 }
 
 
@@ -58,23 +604,88 @@ PyObject* Diag_getattro(JPy_Diag* self, PyObject *attr_name)
     //printf("Diag_getattro: attr_name=%s\n", JPy_AS_UTF8(attr_name));
     if (strcmp(JPy_AS_UTF8(attr_name), "flags") == 0) {
         return JPy_FROM_CLONG(JPy_DiagFlags);
+    } else if (strcmp(JPy_AS_UTF8(attr_name), "metrics") == 0) {
+        return PyBool_FromLong(JPy_MetricsEnabled);
+    } else if (strcmp(JPy_AS_UTF8(attr_name), "stdout") == 0) {
+        return PyBool_FromLong(JPy_DiagStdout);
+    } else if (strcmp(JPy_AS_UTF8(attr_name), "dropped") == 0) {
+        return PyLong_FromLongLong(JPy_Diag_GetDroppedCount());
+    } else if (strcmp(JPy_AS_UTF8(attr_name), "global_ref_limit") == 0) {
+        return PyLong_FromLongLong(JPy_GlobalRefLimit);
+    } else if (strcmp(JPy_AS_UTF8(attr_name), "buffer_bytes_limit") == 0) {
+        return PyLong_FromLongLong(JPy_BufferBytesLimit);
     } else {
         return PyObject_GenericGetAttr((PyObject*) self, attr_name);
     }
 }
 
 
+void JPy_Diag_InitJavaFlags(JNIEnv* jenv, jclass diagClass)
+{
+    jmethodID setJavaFlags;
+
+    setJavaFlags = (*jenv)->GetStaticMethodID(jenv, diagClass, "setJavaFlags", "(I)V");
+    if (setJavaFlags == NULL) {
+        return;
+    }
+    if (JPy_Diag_JClass == NULL) {
+        JPy_Diag_JClass = (*jenv)->NewGlobalRef(jenv, diagClass);
+    }
+    JPy_Diag_SetJavaFlags_SMID = setJavaFlags;
+    (*jenv)->CallStaticVoidMethod(jenv, diagClass, setJavaFlags, (jint) JPy_DiagFlags);
+}
+
+/**
+ * Sets the flags from Python. If org.jpy.PyLib.Diag has been initialized, its Java-side cache is updated too.
+ */
+static void Diag_SetFlags(int flags)
+{
+    JNIEnv* jenv;
+
+    JPy_DiagFlags = flags;
+    if (JPy_Diag_JClass == NULL) {
+        return;
+    }
+    jenv = JPy_GetJNIEnv();
+    if (jenv == NULL) {
+        PyErr_Clear();
+        return;
+    }
+    (*jenv)->CallStaticVoidMethod(jenv, JPy_Diag_JClass, JPy_Diag_SetJavaFlags_SMID, (jint) flags);
+    (*jenv)->ExceptionClear(jenv);
+}
+
+
 int Diag_setattro(JPy_Diag* self, PyObject *attr_name, PyObject *v)
 {
     //printf("Diag_setattro: attr_name=%s\n", JPy_AS_UTF8(attr_name));
     if (strcmp(JPy_AS_UTF8(attr_name), "flags") == 0) {
         if (JPy_IS_CLONG(v)) {
-            JPy_DiagFlags = self->flags = (int) JPy_AS_CLONG(v);
+            self->flags = (int) JPy_AS_CLONG(v);
+            Diag_SetFlags(self->flags);
         } else {
             PyErr_SetString(PyExc_ValueError, "value for 'flags' must be an integer number");
             return -1;
         }
         return 0;
+    } else if (strcmp(JPy_AS_UTF8(attr_name), "metrics") == 0) {
+        int enabled = PyObject_IsTrue(v);
+        if (enabled < 0) {
+            return -1;
+        }
+        JPy_MetricsEnabled = enabled;
+        return 0;
+    } else if (strcmp(JPy_AS_UTF8(attr_name), "stdout") == 0) {
+        int enabled = PyObject_IsTrue(v);
+        if (enabled < 0) {
+            return -1;
+        }
+        JPy_DiagStdout = enabled;
+        return 0;
+    } else if (strcmp(JPy_AS_UTF8(attr_name), "global_ref_limit") == 0) {
+        return Diag_SetLimit(v, &JPy_GlobalRefLimit, "global_ref_limit");
+    } else if (strcmp(JPy_AS_UTF8(attr_name), "buffer_bytes_limit") == 0) {
+        return Diag_SetLimit(v, &JPy_BufferBytesLimit, "buffer_bytes_limit");
     } else {
         return PyObject_GenericSetAttr((PyObject*) self, attr_name, v);
     }
@@ -83,7 +694,7 @@ int Diag_setattro(JPy_Diag* self, PyObject *attr_name, PyObject *v)
 
 static PyMemberDef Diag_members[] =
 {
-    {"flags",    T_INT, offsetof(JPy_Diag, flags),   READONLY, "Combination of diagnostic flags (F_* constants). If != 0, diagnostic messages are printed out."},
+    {"flags",    T_INT, offsetof(JPy_Diag, flags),   READONLY, "Combination of diagnostic flags (F_* constants). If != 0, diagnostic events are recorded, see drain() and dump()."},
     {"F_OFF",    T_INT, offsetof(JPy_Diag, F_OFF),   READONLY, "Don't print any diagnostic messages"},
     {"F_TYPE",   T_INT, offsetof(JPy_Diag, F_TYPE),  READONLY, "Type resolution: print diagnostic messages while generating Python classes from Java classes"},
     {"F_METH",   T_INT, offsetof(JPy_Diag, F_METH),  READONLY, "Method resolution: print diagnostic messages while resolving Java overloaded methods"},
@@ -96,6 +707,24 @@ static PyMemberDef Diag_members[] =
 };
 
 
+static PyMethodDef Diag_methods[] =
+{
+    {"drain", (PyCFunction) Diag_drain, METH_NOARGS,
+              "drain() - Remove the recorded diagnostic events of all threads and return them as a list of "
+              "(time_ns, thread_id, flags, message) tuples ordered by time."},
+    {"dump",  (PyCFunction) Diag_dump, METH_VARARGS,
+              "dump(path) - Remove the recorded diagnostic events of all threads and append them to the given file, "
+              "one line per event. Returns the number of events written."},
+    {"memory_stats", (PyCFunction) Diag_memory_stats, METH_VARARGS | METH_KEYWORDS,
+              "memory_stats(reset_peaks=False) - Return a dictionary with the number of JNI global references held by jpy "
+              "(in total, by kind and by Java type) and of weak global references (see jpy.weak()), the native bytes held "
+              "by exported Java array buffers and by Python buffers passed as Java arrays, their high-water marks, the limits "
+              "set by 'global_ref_limit' and 'buffer_bytes_limit', the number of limit alerts issued as RuntimeWarning and "
+              "the number of wrappers in the identity cache (see jpy.cache_identity())."},
+    {NULL}  /* Sentinel */
+};
+
+
 PyTypeObject Diag_Type =
 {
     PyVarObject_HEAD_INIT(NULL, 0)
@@ -118,14 +747,14 @@ PyTypeObject Diag_Type =
     (setattrofunc) Diag_setattro, /* tp_setattro */
     NULL,                         /* tp_as_buffer */
     Py_TPFLAGS_DEFAULT,           /* tp_flags */
-    "Controls output of diagnostic information for debugging",   /* tp_doc */
+    "Controls recording of diagnostic events for debugging",   /* tp_doc */
     NULL,                         /* tp_traverse */
     NULL,                         /* tp_clear */
     NULL,                         /* tp_richcompare */
     0,                            /* tp_weaklistoffset */
     NULL,                         /* tp_iter */
     NULL,                         /* tp_iternext */
-    NULL,                         /* tp_methods */
+    Diag_methods,                 /* tp_methods */
     Diag_members,                 /* tp_members */
     NULL,                         /* tp_getset */
     NULL,                         /* tp_base */
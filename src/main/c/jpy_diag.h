@@ -21,6 +21,7 @@
 extern "C" {
 #endif
 
+#include <jni.h>
 #include "jpy_compat.h"
 
 typedef struct JPy_Diag
@@ -50,11 +51,50 @@ JPy_Diag;
 
 extern PyTypeObject Diag_Type;
 extern int JPy_DiagFlags;
+/**
+ * If non-zero, diagnostic messages are printed to stdout right away instead of being recorded.
+ */
+extern int JPy_DiagStdout;
 
 PyObject* Diag_New(void);
 
+/**
+ * Records a diagnostic event if any of the given flags is set in JPy_DiagFlags. The format must be a
+ * string literal, it identifies the event and is only applied to the recorded arguments when the
+ * events are drained. Supports the printf conversions d, i, c, u, x, X, o, f, e, g, p and s with the
+ * l, ll and z length modifiers; only the first 8 arguments are recorded and strings are truncated.
+ */
 void JPy_DiagPrint(int diagFlags, const char * format, ...);
 
+/**
+ * Receives a drained diagnostic event. Returns 0, or -1 to stop draining.
+ */
+typedef int (*JPy_DiagEventVisitor)(void* arg, long long time, unsigned long threadId, int flags, const char* message);
+
+/**
+ * Removes the recorded diagnostic events of all threads and passes them, ordered by time, to the
+ * visitor. The GIL is not required unless the visitor needs it. Returns the number of events, or -1
+ * if the visitor failed.
+ */
+Py_ssize_t JPy_Diag_DrainEvents(JPy_DiagEventVisitor visitor, void* visitorArg);
+
+/**
+ * Drains the recorded diagnostic events and appends them to the file at the given path, one line
+ * per event. Returns the number of events, or -1 if writing failed (errno is set).
+ */
+Py_ssize_t JPy_Diag_DumpEvents(const char* path);
+
+/**
+ * Returns the number of diagnostic events dropped because a thread's buffer was full.
+ */
+long long JPy_Diag_GetDroppedCount(void);
+
+/**
+ * Called once org.jpy.PyLib.Diag has been initialized. Remembers the class so that flags set from Python are
+ * passed to its Java-side cache, and passes the current flags.
+ */
+void JPy_Diag_InitJavaFlags(JNIEnv* jenv, jclass diagClass);
+
 #define JPy_DIAG_PRINT if (JPy_DiagFlags != 0) JPy_DiagPrint
 
 
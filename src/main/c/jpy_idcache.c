@@ -0,0 +1,198 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_jtype.h"
+#include "jpy_jobj.h"
+#include "jpy_idcache.h"
+
+#define JPy_IDCACHE_MIN_CAPACITY 64
+
+typedef struct JPy_IdentityEntry
+{
+    struct JPy_IdentityEntry* next;
+    // Borrowed, the wrapper removes itself from the cache in JObj_dealloc()
+    JPy_JObj* obj;
+}
+JPy_IdentityEntry;
+
+// Hash table with separate chaining, the capacity is always a power of two
+static JPy_IdentityEntry** JPy_IdentityCache_Buckets = NULL;
+static size_t JPy_IdentityCache_Capacity = 0;
+static Py_ssize_t JPy_IdentityCache_Count = 0;
+
+
+static size_t JPy_IdentityCache_Index(jint identityHash, size_t capacity)
+{
+    // Fibonacci hashing spreads the low-entropy bits of some JVMs' identity hash codes
+    return (size_t) (((unsigned int) identityHash * 2654435769U) >> 7) & (capacity - 1);
+}
+
+static int JPy_IdentityCache_Grow(void)
+{
+    JPy_IdentityEntry** buckets;
+    JPy_IdentityEntry* entry;
+    JPy_IdentityEntry* next;
+    size_t capacity;
+    size_t i;
+    size_t index;
+
+    capacity = JPy_IdentityCache_Capacity == 0 ? JPy_IDCACHE_MIN_CAPACITY : 2 * JPy_IdentityCache_Capacity;
+    buckets = PyMem_New(JPy_IdentityEntry*, capacity);
+    if (buckets == NULL) {
+        return -1;
+    }
+    memset(buckets, 0, capacity * sizeof (JPy_IdentityEntry*));
+
+    for (i = 0; i < JPy_IdentityCache_Capacity; i++) {
+        for (entry = JPy_IdentityCache_Buckets[i]; entry != NULL; entry = next) {
+            next = entry->next;
+            index = JPy_IdentityCache_Index(entry->obj->identityHash, capacity);
+            entry->next = buckets[index];
+            buckets[index] = entry;
+        }
+    }
+
+    PyMem_Del(JPy_IdentityCache_Buckets);
+    JPy_IdentityCache_Buckets = buckets;
+    JPy_IdentityCache_Capacity = capacity;
+    return 0;
+}
+
+PyObject* JPy_IdentityCache_Get(JNIEnv* jenv, JPy_JType* type, jobject objectRef, jint* identityHash)
+{
+    JPy_IdentityEntry* entry;
+    jint hash;
+
+    hash = (*jenv)->CallStaticIntMethod(jenv, JPy_System_JClass, JPy_System_IdentityHashCode_SMID, objectRef);
+    JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
+    *identityHash = hash;
+
+    if (JPy_IdentityCache_Count == 0) {
+        return NULL;
+    }
+    for (entry = JPy_IdentityCache_Buckets[JPy_IdentityCache_Index(hash, JPy_IdentityCache_Capacity)]; entry != NULL; entry = entry->next) {
+        if (entry->obj->identityHash == hash
+                && Py_TYPE(entry->obj) == JTYPE_AS_PYTYPE(type)
+                && (*jenv)->IsSameObject(jenv, entry->obj->objectRef, objectRef)) {
+            JPy_INCREF(entry->obj);
+            return (PyObject*) entry->obj;
+        }
+    }
+    return NULL;
+}
+
+void JPy_IdentityCache_Put(JPy_JObj* obj, jint identityHash)
+{
+    JPy_IdentityEntry* entry;
+    size_t index;
+
+    if (obj->identityCached) {
+        return;
+    }
+    // Keep the load factor below 0.75
+    if (4 * (size_t) (JPy_IdentityCache_Count + 1) > 3 * JPy_IdentityCache_Capacity && JPy_IdentityCache_Grow() < 0) {
+        return;
+    }
+    entry = PyMem_New(JPy_IdentityEntry, 1);
+    if (entry == NULL) {
+        return;
+    }
+
+    obj->identityHash = identityHash;
+    obj->identityCached = 1;
+    index = JPy_IdentityCache_Index(identityHash, JPy_IdentityCache_Capacity);
+    entry->obj = obj;
+    entry->next = JPy_IdentityCache_Buckets[index];
+    JPy_IdentityCache_Buckets[index] = entry;
+    JPy_IdentityCache_Count++;
+}
+
+int JPy_IdentityCache_PutNew(JNIEnv* jenv, JPy_JObj* obj)
+{
+    jint hash;
+
+    hash = (*jenv)->CallStaticIntMethod(jenv, JPy_System_JClass, JPy_System_IdentityHashCode_SMID, obj->objectRef);
+    JPy_ON_JAVA_EXCEPTION_RETURN(-1);
+    JPy_IdentityCache_Put(obj, hash);
+    return 0;
+}
+
+void JPy_IdentityCache_Remove(JPy_JObj* obj)
+{
+    JPy_IdentityEntry** link;
+    JPy_IdentityEntry* entry;
+
+    if (!obj->identityCached) {
+        return;
+    }
+    obj->identityCached = 0;
+
+    link = &JPy_IdentityCache_Buckets[JPy_IdentityCache_Index(obj->identityHash, JPy_IdentityCache_Capacity)];
+    for (entry = *link; entry != NULL; link = &entry->next, entry = entry->next) {
+        if (entry->obj == obj) {
+            *link = entry->next;
+            PyMem_Del(entry);
+            JPy_IdentityCache_Count--;
+            return;
+        }
+    }
+}
+
+void JPy_IdentityCache_SetEnabled(JPy_JType* type, int enabled)
+{
+    PyObject* key;
+    PyObject* value;
+    Py_ssize_t pos = 0;
+    JPy_IdentityEntry** link;
+    JPy_IdentityEntry* entry;
+    size_t i;
+
+    type->isIdentityCached = (char) (enabled != 0);
+    if (JPy_Types != NULL) {
+        while (PyDict_Next(JPy_Types, &pos, &key, &value)) {
+            if (JType_Check(value) && JType_IsSubtypeOf((JPy_JType*) value, type)) {
+                ((JPy_JType*) value)->isIdentityCached = type->isIdentityCached;
+            }
+        }
+    }
+
+    if (enabled) {
+        return;
+    }
+    for (i = 0; i < JPy_IdentityCache_Capacity; i++) {
+        link = &JPy_IdentityCache_Buckets[i];
+        while ((entry = *link) != NULL) {
+            if (!((JPy_JType*) Py_TYPE(entry->obj))->isIdentityCached) {
+                entry->obj->identityCached = 0;
+                *link = entry->next;
+                PyMem_Del(entry);
+                JPy_IdentityCache_Count--;
+            } else {
+                link = &entry->next;
+            }
+        }
+    }
+}
+
+Py_ssize_t JPy_IdentityCache_Size(void)
+{
+    return JPy_IdentityCache_Count;
+}
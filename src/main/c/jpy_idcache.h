@@ -0,0 +1,80 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#ifndef JPY_IDCACHE_H
+#define JPY_IDCACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+
+/**
+ * Identity cache of Java object wrappers.
+ *
+ * Normally, every time a Java object crosses into Python a new JObj wrapper and a new JNI global
+ * reference are created. For types enabled with jpy.cache_identity() (and their subclasses), the
+ * live wrapper of the same Java object is returned instead, so that 'is' holds and no new global
+ * reference is needed. The cache is weak: it holds no references to the wrappers, which remove
+ * themselves in JObj_dealloc(). Wrappers are keyed by System.identityHashCode() and confirmed with
+ * IsSameObject(). All functions must be called with the GIL held.
+ */
+
+struct JPy_JType;
+struct JPy_JObj;
+
+/**
+ * Returns a new reference to the cached wrapper of the given Java object with exactly the given type,
+ * or NULL if there is none. In the latter case, *identityHash receives the identity hash code to be
+ * passed to JPy_IdentityCache_Put(). Returns NULL and sets a Python error if a Java exception occurred.
+ */
+PyObject* JPy_IdentityCache_Get(JNIEnv* jenv, struct JPy_JType* type, jobject objectRef, jint* identityHash);
+
+/**
+ * Registers a new wrapper. If memory runs out, the wrapper is simply not cached.
+ */
+void JPy_IdentityCache_Put(struct JPy_JObj* obj, jint identityHash);
+
+/**
+ * Registers a wrapper of a newly constructed Java object. Returns -1 and sets a Python error if a
+ * Java exception occurred.
+ */
+int JPy_IdentityCache_PutNew(JNIEnv* jenv, struct JPy_JObj* obj);
+
+/**
+ * Unregisters a wrapper if it is registered.
+ */
+void JPy_IdentityCache_Remove(struct JPy_JObj* obj);
+
+/**
+ * Enables or disables the identity cache for the given type and its known subclasses. Subclasses
+ * loaded later inherit the setting of their superclass. Disabling unregisters the existing wrappers.
+ */
+void JPy_IdentityCache_SetEnabled(struct JPy_JType* type, int enabled);
+
+/**
+ * The number of registered wrappers.
+ */
+Py_ssize_t JPy_IdentityCache_Size(void);
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_IDCACHE_H */
@@ -17,6 +17,7 @@
 #include "jpy_module.h"
 #include "jpy_diag.h"
 #include "jpy_jarray.h"
+#include "jpy_memstats.h"
 
 
 #define PRINT_FLAG(F) printf("JArray_GetBufferProc: %s = %d\n", #F, (flags & F) != 0);
@@ -93,8 +94,12 @@ int JArray_GetBufferProc(JPy_JArray* self, Py_buffer* view, int flags, char java
             return -1;
         }
         self->buf = buf;
+        self->bufLen = (Py_ssize_t) itemCount * itemSize;
         self->javaType = javaType;
         self->isCopy = isCopy;
+        if (buf != NULL) {
+            JPy_MemStats_AddArrayBuffer(self->bufLen, isCopy);
+        }
         self->bufReadonly = (flags & (PyBUF_WRITE | PyBUF_WRITEABLE)) == 0;
     } else {
         buf = self->buf;
@@ -217,6 +222,7 @@ void JArray_ReleaseJavaArrayElements(JPy_JArray* self, char javaType)
         } else if (javaType == 'D') {
             (*jenv)->ReleaseDoubleArrayElements(jenv, self->objectRef, (jdouble*) self->buf, self->bufReadonly ? JNI_ABORT : 0);
         }
+        JPy_MemStats_RemoveArrayBuffer(self->bufLen, self->isCopy);
     #endif
     }
 
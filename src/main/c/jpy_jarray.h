@@ -26,7 +26,7 @@ extern "C" {
 /**
  * The Java primitive array representation in Python.
  *
- * IMPORTANT: JPy_JArray must only differ from the JPy_JObj structure by the 'bufferExportCount' member
+ * IMPORTANT: JPy_JArray must only differ from the JPy_JObj structure by the members following 'hashEpoch'
  * since we use the same basic type, name JPy_JType for it. DON'T ever change member positions!
  * @see JPy_JObj
  */
@@ -34,11 +34,17 @@ typedef struct JPy_JArray
 {
     PyObject_HEAD
     jobject objectRef;
+    jint identityHash;
+    char identityCached;
+    jint hash;
+    unsigned int hashEpoch;
     jint bufferExportCount;
     void *buf;
     char javaType;
     jint bufReadonly;
     jint isCopy;
+    // Size of 'buf' in bytes
+    Py_ssize_t bufLen;
 }
 JPy_JArray;
 
@@ -0,0 +1,430 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_jtype.h"
+#include "jpy_jobj.h"
+#include "jpy_conv.h"
+#include "jpy_jiterator.h"
+#include "jpy_jcollection.h"
+
+
+/**
+ * Calls the given size() method of a java.util.Collection or java.util.Map.
+ */
+static Py_ssize_t JCollection_Size(PyObject* self, jmethodID sizeMethod)
+{
+    JNIEnv* jenv;
+    jint size;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, -1)
+
+    Py_BEGIN_ALLOW_THREADS
+    size = (*jenv)->CallIntMethod(jenv, ((JPy_JObj*) self)->objectRef, sizeMethod);
+    Py_END_ALLOW_THREADS
+    JPy_ON_JAVA_EXCEPTION_RETURN(-1);
+    return (Py_ssize_t) size;
+}
+
+/**
+ * Calls the given boolean method of a java.util.Collection or java.util.Map with the given Python object
+ * as argument, i.e. contains() or containsKey().
+ */
+static int JCollection_Contains(PyObject* self, PyObject* pyObj, jmethodID containsMethod)
+{
+    JNIEnv* jenv;
+    jobject objectRef;
+    jboolean found;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, -1)
+
+    if (JPy_AsJObject(jenv, pyObj, &objectRef, JNI_FALSE) < 0) {
+        return -1;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    found = (*jenv)->CallBooleanMethod(jenv, ((JPy_JObj*) self)->objectRef, containsMethod, objectRef);
+    Py_END_ALLOW_THREADS
+    if (objectRef != NULL) {
+        JPy_DELETE_LOCAL_REF(objectRef);
+    }
+    JPy_ON_JAVA_EXCEPTION_RETURN(-1);
+    return found ? 1 : 0;
+}
+
+
+static Py_ssize_t JList_sq_length(PyObject* self)
+{
+    return JCollection_Size(self, JPy_Collection_size_MID);
+}
+
+/**
+ * Called for 'item = list[index]'. Python has already added the length to negative indexes, an index out of
+ * range raises the IndexError subclass of java.lang.IndexOutOfBoundsException.
+ */
+static PyObject* JList_sq_item(PyObject* self, Py_ssize_t index)
+{
+    JNIEnv* jenv;
+    jobject itemRef;
+    PyObject* item;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+
+    if (index < 0 || index > 0x7fffffff) {
+        PyErr_SetString(PyExc_IndexError, "Java list index out of range");
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    itemRef = (*jenv)->CallObjectMethod(jenv, ((JPy_JObj*) self)->objectRef, JPy_List_get_MID, (jint) index);
+    Py_END_ALLOW_THREADS
+    JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
+
+    item = JPy_FromJObjectWithType(jenv, itemRef, JPy_JObject);
+    if (itemRef != NULL) {
+        JPy_DELETE_LOCAL_REF(itemRef);
+    }
+    return item;
+}
+
+static int JList_sq_contains(PyObject* self, PyObject* pyItem)
+{
+    return JCollection_Contains(self, pyItem, JPy_Collection_contains_MID);
+}
+
+/**
+ * The tp_as_sequence slot of types assignable to java.util.List.
+ */
+PySequenceMethods JList_as_sequence = {
+    (lenfunc) JList_sq_length,           /* sq_length */
+    NULL,   /* sq_concat */
+    NULL,   /* sq_repeat */
+    (ssizeargfunc) JList_sq_item,        /* sq_item */
+    NULL,   /* was_sq_slice */
+    NULL,   /* sq_ass_item */
+    NULL,   /* was_sq_ass_slice */
+    (objobjproc) JList_sq_contains,      /* sq_contains */
+    NULL,   /* sq_inplace_concat */
+    NULL,   /* sq_inplace_repeat */
+};
+
+
+static Py_ssize_t JMap_mp_length(PyObject* self)
+{
+    return JCollection_Size(self, JPy_Map_size_MID);
+}
+
+/**
+ * Called for 'value = map[key]'. Raises a KeyError if the key is not in the map.
+ */
+static PyObject* JMap_mp_subscript(PyObject* self, PyObject* pyKey)
+{
+    JNIEnv* jenv;
+    jobject mapRef;
+    jobject keyRef;
+    jobject valueRef;
+    jboolean found;
+    PyObject* value;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+
+    if (JPy_AsJObject(jenv, pyKey, &keyRef, JNI_FALSE) < 0) {
+        return NULL;
+    }
+
+    mapRef = ((JPy_JObj*) self)->objectRef;
+    found = JNI_TRUE;
+    Py_BEGIN_ALLOW_THREADS
+    valueRef = (*jenv)->CallObjectMethod(jenv, mapRef, JPy_Map_get_MID, keyRef);
+    if (valueRef == NULL && !(*jenv)->ExceptionCheck(jenv)) {
+        // get() doesn't tell a missing key from a null value
+        found = (*jenv)->CallBooleanMethod(jenv, mapRef, JPy_Map_containsKey_MID, keyRef);
+    }
+    Py_END_ALLOW_THREADS
+    if (keyRef != NULL) {
+        JPy_DELETE_LOCAL_REF(keyRef);
+    }
+    JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
+
+    if (!found) {
+        PyErr_SetObject(PyExc_KeyError, pyKey);
+        return NULL;
+    }
+
+    value = JPy_FromJObjectWithType(jenv, valueRef, JPy_JObject);
+    if (valueRef != NULL) {
+        JPy_DELETE_LOCAL_REF(valueRef);
+    }
+    return value;
+}
+
+static int JMap_sq_contains(PyObject* self, PyObject* pyKey)
+{
+    return JCollection_Contains(self, pyKey, JPy_Map_containsKey_MID);
+}
+
+/**
+ * The tp_as_mapping slot of types assignable to java.util.Map.
+ */
+PyMappingMethods JMap_as_mapping = {
+    (lenfunc) JMap_mp_length,            /* mp_length */
+    (binaryfunc) JMap_mp_subscript,      /* mp_subscript */
+    NULL,                                /* mp_ass_subscript */
+};
+
+/**
+ * The tp_as_sequence slot of types assignable to java.util.Map, only used for 'key in map'.
+ */
+PySequenceMethods JMap_as_sequence = {
+    NULL,   /* sq_length */
+    NULL,   /* sq_concat */
+    NULL,   /* sq_repeat */
+    NULL,   /* sq_item */
+    NULL,   /* was_sq_slice */
+    NULL,   /* sq_ass_item */
+    NULL,   /* was_sq_ass_slice */
+    (objobjproc) JMap_sq_contains,       /* sq_contains */
+    NULL,   /* sq_inplace_concat */
+    NULL,   /* sq_inplace_repeat */
+};
+
+PyObject* JMap_iter(PyObject* self)
+{
+    JNIEnv* jenv;
+    jobject keySetRef;
+    jobject iteratorRef;
+    PyObject* iterator;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+
+    Py_BEGIN_ALLOW_THREADS
+    keySetRef = (*jenv)->CallObjectMethod(jenv, ((JPy_JObj*) self)->objectRef, JPy_Map_keySet_MID);
+    iteratorRef = NULL;
+    if (keySetRef != NULL && !(*jenv)->ExceptionCheck(jenv)) {
+        iteratorRef = (*jenv)->CallObjectMethod(jenv, keySetRef, JPy_Iterable_Iterator_MID);
+    }
+    Py_END_ALLOW_THREADS
+    if (keySetRef != NULL) {
+        JPy_DELETE_LOCAL_REF(keySetRef);
+    }
+    JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
+    if (iteratorRef == NULL) {
+        PyErr_SetString(PyExc_TypeError, "java.util.Map.keySet() returned null");
+        return NULL;
+    }
+
+    iterator = JIterator_New(jenv, iteratorRef, JPy_ITER_CHUNK_SIZE);
+    JPy_DELETE_LOCAL_REF(iteratorRef);
+    return iterator;
+}
+
+
+/**
+ * Converts the elements of the given Object[] into the items of a new Python list.
+ */
+static PyObject* JCollection_ArrayToList(JNIEnv* jenv, jobjectArray arrayRef)
+{
+    PyObject* list;
+    PyObject* item;
+    jobject itemRef;
+    jsize length;
+    jsize i;
+
+    length = (*jenv)->GetArrayLength(jenv, arrayRef);
+    list = PyList_New(length);
+    if (list == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < length; i++) {
+        itemRef = (*jenv)->GetObjectArrayElement(jenv, arrayRef, i);
+        item = JPy_FromJObjectWithType(jenv, itemRef, JPy_JObject);
+        if (itemRef != NULL) {
+            JPy_DELETE_LOCAL_REF(itemRef);
+        }
+        if (item == NULL) {
+            JPy_DECREF(list);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+
+    return list;
+}
+
+PyObject* JPy_CollectionToList(JNIEnv* jenv, jobject collectionRef)
+{
+    jobjectArray arrayRef;
+    PyObject* list;
+
+    Py_BEGIN_ALLOW_THREADS
+    arrayRef = (*jenv)->CallObjectMethod(jenv, collectionRef, JPy_Collection_toArray_MID);
+    Py_END_ALLOW_THREADS
+    JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
+    if (arrayRef == NULL) {
+        PyErr_SetString(PyExc_TypeError, "java.util.Collection.toArray() returned null");
+        return NULL;
+    }
+
+    list = JCollection_ArrayToList(jenv, arrayRef);
+    JPy_DELETE_LOCAL_REF(arrayRef);
+    return list;
+}
+
+/**
+ * Stores a key and value converted from Java into the given dict.
+ */
+static int JCollection_PutEntry(JNIEnv* jenv, PyObject* dict, jobject keyRef, jobject valueRef)
+{
+    PyObject* key;
+    PyObject* value;
+    int result;
+
+    key = JPy_FromJObjectWithType(jenv, keyRef, JPy_JObject);
+    if (key == NULL) {
+        return -1;
+    }
+    value = JPy_FromJObjectWithType(jenv, valueRef, JPy_JObject);
+    if (value == NULL) {
+        JPy_DECREF(key);
+        return -1;
+    }
+    result = PyDict_SetItem(dict, key, value);
+    JPy_DECREF(key);
+    JPy_DECREF(value);
+    return result;
+}
+
+/**
+ * Converts the map entry by entry, used if org.jpy.JavaIteration is not on the classpath.
+ */
+static int JCollection_PutEntries(JNIEnv* jenv, PyObject* dict, jobject mapRef)
+{
+    jobject entrySetRef;
+    jobjectArray entriesRef;
+    jobject entryRef;
+    jobject keyRef;
+    jobject valueRef;
+    jsize length;
+    jsize i;
+    int result;
+
+    Py_BEGIN_ALLOW_THREADS
+    entrySetRef = (*jenv)->CallObjectMethod(jenv, mapRef, JPy_Map_entrySet_MID);
+    entriesRef = NULL;
+    if (entrySetRef != NULL && !(*jenv)->ExceptionCheck(jenv)) {
+        entriesRef = (*jenv)->CallObjectMethod(jenv, entrySetRef, JPy_Collection_toArray_MID);
+    }
+    Py_END_ALLOW_THREADS
+    if (entrySetRef != NULL) {
+        JPy_DELETE_LOCAL_REF(entrySetRef);
+    }
+    JPy_ON_JAVA_EXCEPTION_RETURN(-1);
+    if (entriesRef == NULL) {
+        PyErr_SetString(PyExc_TypeError, "java.util.Map.entrySet() returned null");
+        return -1;
+    }
+
+    result = 0;
+    length = (*jenv)->GetArrayLength(jenv, entriesRef);
+    for (i = 0; i < length && result == 0; i++) {
+        entryRef = (*jenv)->GetObjectArrayElement(jenv, entriesRef, i);
+        keyRef = (*jenv)->CallObjectMethod(jenv, entryRef, JPy_Map_Entry_getKey_MID);
+        valueRef = NULL;
+        if (!(*jenv)->ExceptionCheck(jenv)) {
+            valueRef = (*jenv)->CallObjectMethod(jenv, entryRef, JPy_Map_Entry_getValue_MID);
+        }
+        JPy_DELETE_LOCAL_REF(entryRef);
+        if ((*jenv)->ExceptionCheck(jenv)) {
+            JPy_HandleJavaException(jenv);
+            result = -1;
+        } else {
+            result = JCollection_PutEntry(jenv, dict, keyRef, valueRef);
+        }
+        if (keyRef != NULL) {
+            JPy_DELETE_LOCAL_REF(keyRef);
+        }
+        if (valueRef != NULL) {
+            JPy_DELETE_LOCAL_REF(valueRef);
+        }
+    }
+
+    JPy_DELETE_LOCAL_REF(entriesRef);
+    return result;
+}
+
+PyObject* JPy_MapToDict(JNIEnv* jenv, jobject mapRef)
+{
+    jobjectArray entriesRef;
+    jobject keyRef;
+    jobject valueRef;
+    PyObject* dict;
+    jsize length;
+    jsize i;
+    int result;
+
+    dict = PyDict_New();
+    if (dict == NULL) {
+        return NULL;
+    }
+
+    if (JPy_JavaIteration_Entries_SMID == NULL) {
+        if (JCollection_PutEntries(jenv, dict, mapRef) < 0) {
+            JPy_DECREF(dict);
+            return NULL;
+        }
+        return dict;
+    }
+
+    // The keys and values alternate in the array
+    Py_BEGIN_ALLOW_THREADS
+    entriesRef = (*jenv)->CallStaticObjectMethod(jenv, JPy_JavaIteration_JClass, JPy_JavaIteration_Entries_SMID, mapRef);
+    Py_END_ALLOW_THREADS
+    if ((*jenv)->ExceptionCheck(jenv)) {
+        JPy_HandleJavaException(jenv);
+        goto error;
+    }
+
+    length = (*jenv)->GetArrayLength(jenv, entriesRef);
+    for (i = 0; i + 1 < length; i += 2) {
+        keyRef = (*jenv)->GetObjectArrayElement(jenv, entriesRef, i);
+        valueRef = (*jenv)->GetObjectArrayElement(jenv, entriesRef, i + 1);
+        result = JCollection_PutEntry(jenv, dict, keyRef, valueRef);
+        if (keyRef != NULL) {
+            JPy_DELETE_LOCAL_REF(keyRef);
+        }
+        if (valueRef != NULL) {
+            JPy_DELETE_LOCAL_REF(valueRef);
+        }
+        if (result < 0) {
+            JPy_DELETE_LOCAL_REF(entriesRef);
+            goto error;
+        }
+    }
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JPy_MapToDict: converted %d entries\n", (int) (length / 2));
+
+    JPy_DELETE_LOCAL_REF(entriesRef);
+    return dict;
+
+error:
+    JPy_DECREF(dict);
+    return NULL;
+}
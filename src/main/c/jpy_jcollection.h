@@ -0,0 +1,60 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+#ifndef JPY_JCOLLECTION_H
+#define JPY_JCOLLECTION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+
+/**
+ * The Python protocols of types assignable to java.util.List and java.util.Map, assigned by JType_InitSlots().
+ *
+ * Lists support len(), list[index] and 'item in list'; maps support len(), map[key], 'key in map' and
+ * iteration over their keys. The Java methods are called directly with cached method IDs, without
+ * overload resolution.
+ */
+extern PySequenceMethods JList_as_sequence;
+extern PySequenceMethods JMap_as_sequence;
+extern PyMappingMethods JMap_as_mapping;
+
+/**
+ * The tp_iter slot of types assignable to java.util.Map. Iterates the keys like a Python dict.
+ */
+PyObject* JMap_iter(PyObject* self);
+
+/**
+ * Converts the given java.util.Collection into a new Python list, fetching all elements with a single
+ * call of toArray(). Returns a new reference.
+ */
+PyObject* JPy_CollectionToList(JNIEnv* jenv, jobject collectionRef);
+
+/**
+ * Converts the given java.util.Map into a new Python dict, fetching all entries with a single call of
+ * org.jpy.JavaIteration.entries() (or entry by entry if org.jpy.JavaIteration is not on the
+ * classpath). Returns a new reference.
+ */
+PyObject* JPy_MapToDict(JNIEnv* jenv, jobject mapRef);
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_JCOLLECTION_H */
@@ -0,0 +1,594 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_jtype.h"
+#include "jpy_conv.h"
+#include "jpy_jexception.h"
+#include "jpy_memstats.h"
+
+#define AT_STRING "\tat "
+#define AT_STRLEN 4
+#define CAUSED_BY_STRING "caused by "
+#define CAUSED_BY_STRLEN 10
+#define ELIDED_STRING_MAX_SIZE 30
+
+
+/**
+ * Returns the Python exception that is mixed into the exception class for the given Java class
+ * (and thus into all its subclasses), or NULL. Only exceptions with the base exception layout
+ * qualify, e.g. OSError can't be combined with JException.
+ */
+static PyObject* JException_GetStandardBase(const char* javaName)
+{
+    if (strcmp(javaName, "java.lang.IndexOutOfBoundsException") == 0) {
+        return PyExc_IndexError;
+    } else if (strcmp(javaName, "java.util.NoSuchElementException") == 0) {
+        return PyExc_LookupError;
+    } else if (strcmp(javaName, "java.lang.IllegalArgumentException") == 0) {
+        return PyExc_ValueError;
+    } else if (strcmp(javaName, "java.lang.ClassCastException") == 0) {
+        return PyExc_TypeError;
+    } else if (strcmp(javaName, "java.lang.ArithmeticException") == 0) {
+        return PyExc_ArithmeticError;
+    } else if (strcmp(javaName, "java.lang.UnsupportedOperationException") == 0) {
+        return PyExc_NotImplementedError;
+    } else if (strcmp(javaName, "java.lang.OutOfMemoryError") == 0) {
+        return PyExc_MemoryError;
+    }
+    return NULL;
+}
+
+/**
+ * Creates the Python exception class for the given Java class, deriving from the class of the
+ * Java super class. Returns a new reference.
+ */
+static PyObject* JException_NewType(JNIEnv* jenv, jclass classRef, PyObject* typeKey)
+{
+    jclass superClassRef;
+    PyObject* superType;
+    PyObject* standardBase;
+    PyObject* bases;
+    PyObject* type;
+    const char* javaName;
+    const char* simpleName;
+    char* moduleName;
+
+    superClassRef = (*jenv)->GetSuperclass(jenv, classRef);
+    if (superClassRef == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "jpy internal error: Java exception class without super class");
+        return NULL;
+    }
+    superType = JException_GetType(jenv, superClassRef);
+    JPy_DELETE_LOCAL_REF(superClassRef);
+    if (superType == NULL) {
+        return NULL;
+    }
+
+    javaName = JPy_AS_UTF8(typeKey);
+    standardBase = JException_GetStandardBase(javaName);
+    if (standardBase != NULL) {
+        bases = PyTuple_Pack(2, superType, standardBase);
+    } else {
+        bases = PyTuple_Pack(1, superType);
+    }
+    JPy_DECREF(superType);
+    if (bases == NULL) {
+        return NULL;
+    }
+
+    // e.g. class 'RuntimeException' in module 'java.lang', so that tracebacks show the Java name
+    simpleName = strrchr(javaName, '.');
+    if (simpleName != NULL) {
+        moduleName = PyMem_New(char, simpleName - javaName + 1);
+        if (moduleName == NULL) {
+            JPy_DECREF(bases);
+            return PyErr_NoMemory();
+        }
+        strncpy(moduleName, javaName, simpleName - javaName);
+        moduleName[simpleName - javaName] = 0;
+        simpleName++;
+    } else {
+        moduleName = NULL;
+        simpleName = javaName;
+    }
+
+    type = PyObject_CallFunction((PyObject*) &PyType_Type, "sO{ss}", simpleName, bases, "__module__", moduleName != NULL ? moduleName : "");
+    PyMem_Del(moduleName);
+    JPy_DECREF(bases);
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JException_NewType: javaName='%s', type=%p\n", javaName, type);
+    return type;
+}
+
+PyObject* JException_GetType(JNIEnv* jenv, jclass classRef)
+{
+    PyObject* typeKey;
+    PyObject* type;
+
+    if (JPy_Exception_Types == NULL || (*jenv)->IsSameObject(jenv, classRef, JPy_Throwable_JClass)) {
+        JPy_INCREF(&JException_Type);
+        return (PyObject*) &JException_Type;
+    }
+
+    typeKey = JPy_FromTypeName(jenv, classRef);
+    if (typeKey == NULL) {
+        return NULL;
+    }
+
+    type = PyDict_GetItem(JPy_Exception_Types, typeKey);
+    if (type != NULL) {
+        JPy_INCREF(type);
+    } else {
+        type = JException_NewType(jenv, classRef, typeKey);
+        if (type != NULL && PyDict_SetItem(JPy_Exception_Types, typeKey, type) < 0) {
+            JPy_DECREF(type);
+            type = NULL;
+        }
+    }
+
+    JPy_DECREF(typeKey);
+    return type;
+}
+
+PyObject* JException_New(JNIEnv* jenv, jthrowable throwable, int verbose)
+{
+    JPy_JException* exception;
+    PyObject* type;
+    jclass classRef;
+
+    classRef = (*jenv)->GetObjectClass(jenv, throwable);
+    type = JException_GetType(jenv, classRef);
+    JPy_DELETE_LOCAL_REF(classRef);
+    if (type == NULL) {
+        // Still raise the Java exception, just not as its specific type
+        JPy_DIAG_PRINT(JPy_DIAG_F_ERR, "JException_New: error: failed to create exception type\n");
+        PyErr_Clear();
+        type = (PyObject*) &JException_Type;
+        JPy_INCREF(type);
+    }
+
+    exception = (JPy_JException*) PyObject_CallObject(type, NULL);
+    JPy_DECREF(type);
+    if (exception == NULL) {
+        return NULL;
+    }
+
+    exception->throwableRef = JPy_NewGlobalRef(jenv, throwable, JPy_GREF_EXCEPTION);
+    if (exception->throwableRef == NULL) {
+        JPy_DECREF(exception);
+        return PyErr_NoMemory();
+    }
+    exception->verbose = verbose;
+
+    return (PyObject*) exception;
+}
+
+/**
+ * Formats the throwable, its stack trace and its causes like Throwable.printStackTrace() does.
+ * Returns a string to be released with free(), or NULL if memory allocation failed.
+ */
+static char* JException_FormatVerbose(JNIEnv* jenv, jthrowable throwable)
+{
+    jstring message;
+    int allocError = 0;
+    char *stackTraceString;
+    size_t stackTraceLength = 0;
+    jthrowable cause = throwable;
+    jarray enclosingElements = NULL;
+    jint enclosingSize = 0;
+
+    stackTraceString = strdup("");
+
+    do {
+        /* We want the type and the detail string, which is actually what a Throwable toString() does by
+         * default, as does the default printStackTrace(). */
+        jint ii;
+
+        jarray stackTrace;
+        jint stackTraceElements;
+        jint lastElementToPrint;
+        jint enclosingIndex;
+
+        if (stackTraceLength > 0) {
+            char *newStackString;
+
+            newStackString = realloc(stackTraceString, CAUSED_BY_STRLEN + 1 + stackTraceLength);
+            if (newStackString == NULL) {
+                allocError = 1;
+                break;
+            }
+            stackTraceString = newStackString;
+            strcat(stackTraceString, CAUSED_BY_STRING);
+            stackTraceLength += CAUSED_BY_STRLEN;
+        }
+
+        message = (jstring) (*jenv)->CallObjectMethod(jenv, cause, JPy_Object_ToString_MID);
+        if (message != NULL) {
+            const char *messageChars = (*jenv)->GetStringUTFChars(jenv, message, NULL);
+            if (messageChars != NULL) {
+                char *newStackString;
+                size_t len = strlen(messageChars);
+
+                newStackString = realloc(stackTraceString, len + 2 + stackTraceLength);
+                if (newStackString == NULL) {
+                    (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
+                    allocError = 1;
+                    break;
+                }
+
+                stackTraceString = newStackString;
+                strcat(stackTraceString, messageChars);
+                stackTraceString[stackTraceLength + len] = '\n';
+                stackTraceString[stackTraceLength + len + 1] = '\0';
+                stackTraceLength += (len + 1);
+
+                (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
+            } else {
+                allocError = 1;
+                break;
+            }
+            JPy_DELETE_LOCAL_REF(message);
+        }
+
+        /* We should assemble a string based on the stack trace. */
+        stackTrace = (*jenv)->CallObjectMethod(jenv, cause, JPy_Throwable_getStackTrace_MID);
+        stackTraceElements = (*jenv)->GetArrayLength(jenv, stackTrace);
+        lastElementToPrint = stackTraceElements - 1;
+        enclosingIndex = enclosingSize - 1;
+
+        while (lastElementToPrint >= 0 && enclosingIndex >= 0) {
+            jobject thisElement = (*jenv)->GetObjectArrayElement(jenv, stackTrace, lastElementToPrint);
+            jobject thatElement = (*jenv)->GetObjectArrayElement(jenv, enclosingElements, enclosingIndex);
+
+            // if they are equal, let's decrement, otherwise we break
+            jboolean  equal = (*jenv)->CallBooleanMethod(jenv, thisElement, JPy_Object_Equals_MID, thatElement);
+            if (!equal) {
+                break;
+            }
+
+            lastElementToPrint--;
+            enclosingIndex--;
+        }
+
+        for (ii = 0; ii <= lastElementToPrint; ++ii) {
+            jobject traceElement = (*jenv)->GetObjectArrayElement(jenv, stackTrace, ii);
+            if (traceElement != NULL) {
+                message = (jstring) (*jenv)->CallObjectMethod(jenv, traceElement, JPy_Object_ToString_MID);
+                if (message != NULL) {
+                    size_t len;
+                    char *newStackString;
+                    const char *messageChars = (*jenv)->GetStringUTFChars(jenv, message, NULL);
+                    if (messageChars == NULL) {
+                        allocError = 1;
+                        break;
+                    }
+
+                    len = strlen(messageChars);
+
+                    newStackString = realloc(stackTraceString, len + 2 + AT_STRLEN + stackTraceLength);
+                    if (newStackString == NULL) {
+                        (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
+                        allocError = 1;
+                        break;
+                    }
+
+                    stackTraceString = newStackString;
+                    strcat(stackTraceString, AT_STRING);
+                    strcat(stackTraceString, messageChars);
+                    stackTraceString[stackTraceLength + len + AT_STRLEN] = '\n';
+                    stackTraceString[stackTraceLength + len + AT_STRLEN + 1] = '\0';
+                    stackTraceLength += (len + 1 + AT_STRLEN);
+
+                    (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
+                }
+
+            }
+        }
+
+        if (lastElementToPrint < stackTraceElements - 1) {
+            int written;
+            char *newStackString = realloc(stackTraceString, stackTraceLength + ELIDED_STRING_MAX_SIZE);
+            if (newStackString == NULL) {
+                allocError = 1;
+                break;
+            }
+
+            stackTraceString = newStackString;
+            stackTraceString[stackTraceLength + ELIDED_STRING_MAX_SIZE - 1] = '\0';
+
+            written = snprintf(stackTraceString + stackTraceLength, ELIDED_STRING_MAX_SIZE - 1, "\t... %d more\n", (stackTraceElements - lastElementToPrint) - 1);
+            if (written > (ELIDED_STRING_MAX_SIZE - 1)) {
+                stackTraceLength += (ELIDED_STRING_MAX_SIZE - 1);
+            } else {
+                stackTraceLength += written;
+            }
+        }
+
+        /** So we can eliminate extra entries. */
+        enclosingElements = stackTrace;
+        enclosingSize = stackTraceElements;
+
+        /** Now the next cause. */
+        cause = (*jenv)->CallObjectMethod(jenv, cause, JPy_Throwable_getCause_MID);
+    } while (cause != NULL && !allocError);
+
+    if (allocError != 0) {
+        free(stackTraceString);
+        return NULL;
+    }
+    return stackTraceString;
+}
+
+/**
+ * Formats the message of the given throwable. Returns a new reference.
+ */
+static PyObject* JException_Format(JNIEnv* jenv, jthrowable throwable, int verbose)
+{
+    PyObject* pyMessage = NULL;
+    jstring message;
+    const char* messageChars;
+    char* stackTraceString;
+
+    // The JNI calls below create many local references, and __str__ may run on a thread
+    // that never returns to Java
+    if ((*jenv)->PushLocalFrame(jenv, 16) < 0) {
+        (*jenv)->ExceptionClear(jenv);
+        return PyErr_NoMemory();
+    }
+
+    if (verbose) {
+        stackTraceString = JException_FormatVerbose(jenv, throwable);
+        if (stackTraceString != NULL) {
+            pyMessage = JPy_FROM_CSTR(stackTraceString);
+            free(stackTraceString);
+        } else {
+            pyMessage = JPy_FROM_CSTR("Java VM exception occurred, but failed to allocate message text");
+        }
+    } else {
+        message = (jstring) (*jenv)->CallObjectMethod(jenv, throwable, JPy_Object_ToString_MID);
+        if (message != NULL) {
+            messageChars = (*jenv)->GetStringUTFChars(jenv, message, NULL);
+            if (messageChars != NULL) {
+                pyMessage = JPy_FROM_CSTR(messageChars);
+                (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
+            } else {
+                pyMessage = JPy_FROM_CSTR("Java VM exception occurred, but failed to allocate message text");
+            }
+        } else {
+            pyMessage = JPy_FROM_CSTR("Java VM exception occurred, no message");
+        }
+    }
+
+    // A failing toString() must not leave a pending Java exception behind
+    (*jenv)->ExceptionClear(jenv);
+    (*jenv)->PopLocalFrame(jenv, NULL);
+    return pyMessage;
+}
+
+/**
+ * Returns the (cached) message of the exception as borrowed reference.
+ */
+static PyObject* JException_GetMessage(JPy_JException* self)
+{
+    JNIEnv* jenv;
+
+    if (self->message == NULL) {
+        if (self->throwableRef == NULL) {
+            return NULL;
+        }
+        jenv = JPy_GetJNIEnv();
+        if (jenv == NULL) {
+            PyErr_SetString(PyExc_RuntimeError, "jpy: the Java VM is not running");
+            return NULL;
+        }
+        self->message = JException_Format(jenv, self->throwableRef, self->verbose);
+    }
+    return self->message;
+}
+
+static PyObject* JException_str(JPy_JException* self)
+{
+    PyObject* message;
+
+    if (self->throwableRef == NULL) {
+        // not raised by jpy, e.g. jpy.JException('...')
+        return ((PyTypeObject*) PyExc_RuntimeError)->tp_str((PyObject*) self);
+    }
+    message = JException_GetMessage(self);
+    Py_XINCREF(message);
+    return message;
+}
+
+static PyObject* JException_repr(JPy_JException* self)
+{
+    PyTypeObject* type;
+    PyObject* moduleName;
+    PyObject* typeName;
+    PyObject* message;
+    PyObject* messageRepr;
+    PyObject* repr;
+
+    if (self->throwableRef == NULL) {
+        return ((PyTypeObject*) PyExc_RuntimeError)->tp_repr((PyObject*) self);
+    }
+
+    // Show the qualified Java class name of the generated exception classes, e.g.
+    // java.lang.RuntimeException('java.lang.RuntimeException: Evil!')
+    type = Py_TYPE(self);
+    moduleName = NULL;
+    if (PyType_HasFeature(type, Py_TPFLAGS_HEAPTYPE)) {
+        moduleName = PyObject_GetAttrString((PyObject*) type, "__module__");
+        if (moduleName == NULL) {
+            return NULL;
+        }
+    }
+    if (moduleName != NULL && JPy_IS_STR(moduleName) && PyObject_IsTrue(moduleName)) {
+        typeName = JPy_FROM_FORMAT("%s.%s", JPy_AS_UTF8(moduleName), type->tp_name);
+    } else {
+        typeName = JPy_FROM_CSTR(type->tp_name);
+    }
+    JPy_XDECREF(moduleName);
+    if (typeName == NULL) {
+        return NULL;
+    }
+
+    message = JException_GetMessage(self);
+    if (message == NULL) {
+        JPy_DECREF(typeName);
+        return NULL;
+    }
+    messageRepr = PyObject_Repr(message);
+    if (messageRepr == NULL) {
+        JPy_DECREF(typeName);
+        return NULL;
+    }
+    repr = JPy_FROM_FORMAT("%s(%s)", JPy_AS_UTF8(typeName), JPy_AS_UTF8(messageRepr));
+    JPy_DECREF(messageRepr);
+    JPy_DECREF(typeName);
+    return repr;
+}
+
+static PyObject* JException_get_args(JPy_JException* self, void* closure)
+{
+    PyObject* message;
+
+    if (self->base.args != NULL && (PyTuple_Size(self->base.args) > 0 || self->throwableRef == NULL)) {
+        JPy_INCREF(self->base.args);
+        return self->base.args;
+    }
+    message = JException_GetMessage(self);
+    if (message == NULL) {
+        return NULL;
+    }
+    return PyTuple_Pack(1, message);
+}
+
+static int JException_set_args(JPy_JException* self, PyObject* value, void* closure)
+{
+    PyObject* args;
+
+    if (value == NULL) {
+        PyErr_SetString(PyExc_TypeError, "args may not be deleted");
+        return -1;
+    }
+    args = PySequence_Tuple(value);
+    if (args == NULL) {
+        return -1;
+    }
+    JPy_XDECREF(self->base.args);
+    self->base.args = args;
+    return 0;
+}
+
+static PyObject* JException_get_java_exception(JPy_JException* self, void* closure)
+{
+    JNIEnv* jenv;
+
+    if (self->throwableRef == NULL) {
+        return JPy_FROM_JNULL();
+    }
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+    return JPy_FromJObject(jenv, self->throwableRef);
+}
+
+static int JException_traverse(JPy_JException* self, visitproc visit, void* arg)
+{
+    Py_VISIT(self->message);
+    return ((PyTypeObject*) PyExc_RuntimeError)->tp_traverse((PyObject*) self, visit, arg);
+}
+
+static int JException_clear(JPy_JException* self)
+{
+    Py_CLEAR(self->message);
+    return ((PyTypeObject*) PyExc_RuntimeError)->tp_clear((PyObject*) self);
+}
+
+static void JException_dealloc(JPy_JException* self)
+{
+    JNIEnv* jenv;
+
+    PyObject_GC_UnTrack(self);
+    Py_CLEAR(self->message);
+
+    if (self->throwableRef != NULL) {
+        jenv = JPy_GetJNIEnv();
+        if (jenv != NULL) {
+            JPy_DeleteGlobalRef(jenv, self->throwableRef, JPy_GREF_EXCEPTION);
+        }
+        self->throwableRef = NULL;
+    }
+
+    ((PyTypeObject*) PyExc_RuntimeError)->tp_dealloc((PyObject*) self);
+}
+
+static PyGetSetDef JException_getset[] = {
+    {"args", (getter) JException_get_args, (setter) JException_set_args, "The exception arguments; the formatted Java exception if not given", NULL},
+    {"java_exception", (getter) JException_get_java_exception, NULL, "The java.lang.Throwable that caused this exception", NULL},
+    {NULL}  /* Sentinel */
+};
+
+PyTypeObject JException_Type =
+{
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "jpy.JException",                           /* tp_name */
+    sizeof (JPy_JException),                    /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor) JException_dealloc,            /* tp_dealloc */
+    NULL,                                       /* tp_print */
+    NULL,                                       /* tp_getattr */
+    NULL,                                       /* tp_setattr */
+    NULL,                                       /* tp_reserved */
+    (reprfunc) JException_repr,                 /* tp_repr */
+    NULL,                                       /* tp_as_number */
+    NULL,                                       /* tp_as_sequence */
+    NULL,                                       /* tp_as_mapping */
+    NULL,                                       /* tp_hash  */
+    NULL,                                       /* tp_call */
+    (reprfunc) JException_str,                  /* tp_str */
+    NULL,                                       /* tp_getattro */
+    NULL,                                       /* tp_setattro */
+    NULL,                                       /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC,   /* tp_flags */
+    "Raised for Java exceptions. The message is only formatted when the exception is displayed.",   /* tp_doc */
+    (traverseproc) JException_traverse,         /* tp_traverse */
+    (inquiry) JException_clear,                 /* tp_clear */
+    NULL,                                       /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    NULL,                                       /* tp_iter */
+    NULL,                                       /* tp_iternext */
+    NULL,                                       /* tp_methods */
+    NULL,                                       /* tp_members */
+    JException_getset,                          /* tp_getset */
+    NULL,                                       /* tp_base (RuntimeError, set in JException_InitType()) */
+    NULL,                                       /* tp_dict */
+    NULL,                                       /* tp_descr_get */
+    NULL,                                       /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    NULL,                                       /* tp_init */
+    NULL,                                       /* tp_alloc */
+    NULL,                                       /* tp_new */
+};
+
+int JException_InitType(void)
+{
+    JException_Type.tp_base = (PyTypeObject*) PyExc_RuntimeError;
+    return PyType_Ready(&JException_Type);
+}
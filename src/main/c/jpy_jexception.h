@@ -0,0 +1,73 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#ifndef JPY_JEXCEPTION_H
+#define JPY_JEXCEPTION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+
+/**
+ * The Python exception raised for Java exceptions, a subclass of RuntimeError.
+ *
+ * Raising it only creates a global reference to the Java throwable. The message (and, if
+ * jpy.VerboseExceptions.enabled was set when the exception was raised, the Java stack trace)
+ * is formatted on first use by str(), repr() or args, so exceptions which are caught and
+ * discarded cost no string work.
+ */
+typedef struct JPy_JException
+{
+    PyBaseExceptionObject base;
+    // Global reference to the java.lang.Throwable, NULL if not raised by jpy
+    jthrowable throwableRef;
+    int verbose;
+    // The formatted message, NULL until requested
+    PyObject* message;
+}
+JPy_JException;
+
+extern PyTypeObject JException_Type;
+
+/**
+ * Readies JException_Type. Returns 0 on success, -1 otherwise.
+ */
+int JException_InitType(void);
+
+/**
+ * Returns the Python exception class for the given java.lang.Throwable class. The classes are
+ * created on first use and cached in JPy_Exception_Types (module attribute 'jpy.exception_types').
+ * They mirror the Java class hierarchy with JException standing for java.lang.Throwable, and
+ * some also derive from a standard Python exception, e.g. java.lang.IndexOutOfBoundsException
+ * from IndexError. Returns a new reference.
+ */
+PyObject* JException_GetType(JNIEnv* jenv, jclass classRef);
+
+/**
+ * Creates a new exception for the given Java throwable, an instance of the class returned by
+ * JException_GetType(). Returns a new reference.
+ */
+PyObject* JException_New(JNIEnv* jenv, jthrowable throwable, int verbose);
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_JEXCEPTION_H */
@@ -23,12 +23,86 @@
 #include "jpy_compat.h"
 
 
+/**
+ * Defines the getter and setter of instance fields of a primitive type.
+ * The Python value is converted by the JPy_AS_<T> macros, which set a Python error if it is not a number.
+ */
+#define JField_DEFINE_PRIMITIVE_ACCESSORS(T, JTYPE, GET_FIELD, SET_FIELD, FROM_JTYPE, AS_JTYPE) \
+static PyObject* JField_Get##T(JNIEnv* jenv, jobject objectRef, JPy_JField* field) \
+{ \
+    JTYPE item = (*jenv)->GET_FIELD(jenv, objectRef, field->fid); \
+    JPy_ON_JAVA_EXCEPTION_RETURN(NULL); \
+    return FROM_JTYPE(item); \
+} \
+static int JField_Set##T(JNIEnv* jenv, jobject objectRef, JPy_JField* field, PyObject* value) \
+{ \
+    JTYPE item = AS_JTYPE(value); \
+    if (PyErr_Occurred()) { \
+        return -1; \
+    } \
+    (*jenv)->SET_FIELD(jenv, objectRef, field->fid, item); \
+    JPy_ON_JAVA_EXCEPTION_RETURN(-1); \
+    return 0; \
+}
+
+JField_DEFINE_PRIMITIVE_ACCESSORS(Boolean, jboolean, GetBooleanField, SetBooleanField, JPy_FROM_JBOOLEAN, JPy_AS_JBOOLEAN)
+JField_DEFINE_PRIMITIVE_ACCESSORS(Char, jchar, GetCharField, SetCharField, JPy_FROM_JCHAR, JPy_AS_JCHAR)
+JField_DEFINE_PRIMITIVE_ACCESSORS(Byte, jbyte, GetByteField, SetByteField, JPy_FROM_JBYTE, JPy_AS_JBYTE)
+JField_DEFINE_PRIMITIVE_ACCESSORS(Short, jshort, GetShortField, SetShortField, JPy_FROM_JSHORT, JPy_AS_JSHORT)
+JField_DEFINE_PRIMITIVE_ACCESSORS(Int, jint, GetIntField, SetIntField, JPy_FROM_JINT, JPy_AS_JINT)
+JField_DEFINE_PRIMITIVE_ACCESSORS(Long, jlong, GetLongField, SetLongField, JPy_FROM_JLONG, JPy_AS_JLONG)
+JField_DEFINE_PRIMITIVE_ACCESSORS(Float, jfloat, GetFloatField, SetFloatField, JPy_FROM_JFLOAT, JPy_AS_JFLOAT)
+JField_DEFINE_PRIMITIVE_ACCESSORS(Double, jdouble, GetDoubleField, SetDoubleField, JPy_FROM_JDOUBLE, JPy_AS_JDOUBLE)
+
+static PyObject* JField_GetString(JNIEnv* jenv, jobject objectRef, JPy_JField* field)
+{
+    PyObject* returnValue;
+    jstring item = (*jenv)->GetObjectField(jenv, objectRef, field->fid);
+    JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
+    if (item == NULL) {
+        return JPy_FROM_JNULL();
+    }
+    returnValue = JPy_FromJString(jenv, item);
+    JPy_DELETE_LOCAL_REF(item);
+    return returnValue;
+}
+
+static PyObject* JField_GetObject(JNIEnv* jenv, jobject objectRef, JPy_JField* field)
+{
+    PyObject* returnValue;
+    jobject item = (*jenv)->GetObjectField(jenv, objectRef, field->fid);
+    JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
+    returnValue = JPy_FromJObjectWithType(jenv, item, field->type);
+    if (item != NULL) {
+        JPy_DELETE_LOCAL_REF(item);
+    }
+    return returnValue;
+}
+
+static int JField_SetObject(JNIEnv* jenv, jobject objectRef, JPy_JField* field, PyObject* value)
+{
+    jobject item;
+    if (JPy_AsJObjectWithType(jenv, value, &item, field->type) < 0) {
+        return -1;
+    }
+    (*jenv)->SetObjectField(jenv, objectRef, field->fid, item);
+    if (item != NULL) {
+        JPy_DELETE_LOCAL_REF(item);
+    }
+    JPy_ON_JAVA_EXCEPTION_RETURN(-1);
+    return 0;
+}
+
+
 JPy_JField* JField_New(JPy_JType* declaringClass, PyObject* fieldName, JPy_JType* fieldType, jboolean isStatic, jboolean isFinal, jfieldID fid)
 {
     PyTypeObject* type = &JField_Type;
     JPy_JField* field;
 
     field = (JPy_JField*) type->tp_alloc(type, 0);
+    if (field == NULL) {
+        return NULL;
+    }
     field->declaringClass = declaringClass;
     field->name = fieldName;
     field->type = fieldType;
@@ -36,6 +110,39 @@ JPy_JField* JField_New(JPy_JType* declaringClass, PyObject* fieldName, JPy_JType
     field->isFinal = isFinal;
     field->fid = fid;
 
+    // Choose the accessors once, instead of on every access
+    if (fieldType == JPy_JBoolean) {
+        field->getter = JField_GetBoolean;
+        field->setter = JField_SetBoolean;
+    } else if (fieldType == JPy_JChar) {
+        field->getter = JField_GetChar;
+        field->setter = JField_SetChar;
+    } else if (fieldType == JPy_JByte) {
+        field->getter = JField_GetByte;
+        field->setter = JField_SetByte;
+    } else if (fieldType == JPy_JShort) {
+        field->getter = JField_GetShort;
+        field->setter = JField_SetShort;
+    } else if (fieldType == JPy_JInt) {
+        field->getter = JField_GetInt;
+        field->setter = JField_SetInt;
+    } else if (fieldType == JPy_JLong) {
+        field->getter = JField_GetLong;
+        field->setter = JField_SetLong;
+    } else if (fieldType == JPy_JFloat) {
+        field->getter = JField_GetFloat;
+        field->setter = JField_SetFloat;
+    } else if (fieldType == JPy_JDouble) {
+        field->getter = JField_GetDouble;
+        field->setter = JField_SetDouble;
+    } else if (fieldType == JPy_JString) {
+        field->getter = JField_GetString;
+        field->setter = JField_SetObject;
+    } else {
+        field->getter = JField_GetObject;
+        field->setter = JField_SetObject;
+    }
+
     JPy_INCREF(field->name);
     JPy_INCREF(field->type);
 
@@ -82,6 +189,50 @@ PyObject* JField_str(JPy_JField* self)
 }
 
 
+/**
+ * The JField type's tp_descr_get slot. Python: obj.name
+ */
+static PyObject* JField_descr_get(JPy_JField* self, PyObject* obj, PyObject* type)
+{
+    JNIEnv* jenv;
+
+    // Accessed on the class, e.g. by dir() or help()
+    if (obj == NULL) {
+        JPy_INCREF(self);
+        return (PyObject*) self;
+    }
+    if (!PyObject_TypeCheck(obj, JTYPE_AS_PYTYPE(self->declaringClass))) {
+        PyErr_Format(PyExc_TypeError, "Java field '%s' of %s can't be read from a %s object",
+                     JPy_AS_UTF8(self->name), self->declaringClass->javaName, Py_TYPE(obj)->tp_name);
+        return NULL;
+    }
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+    return self->getter(jenv, ((JPy_JObj*) obj)->objectRef, self);
+}
+
+/**
+ * The JField type's tp_descr_set slot. Python: obj.name = value
+ */
+static int JField_descr_set(JPy_JField* self, PyObject* obj, PyObject* value)
+{
+    JNIEnv* jenv;
+
+    if (!PyObject_TypeCheck(obj, JTYPE_AS_PYTYPE(self->declaringClass))) {
+        PyErr_Format(PyExc_TypeError, "Java field '%s' of %s can't be written to a %s object",
+                     JPy_AS_UTF8(self->name), self->declaringClass->javaName, Py_TYPE(obj)->tp_name);
+        return -1;
+    }
+    if (value == NULL) {
+        PyErr_Format(PyExc_AttributeError, "Java field '%s' can't be deleted", JPy_AS_UTF8(self->name));
+        return -1;
+    }
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, -1)
+    return self->setter(jenv, ((JPy_JObj*) obj)->objectRef, self, value);
+}
+
+
 static PyMemberDef JField_members[] =
 {
     {"name",        T_OBJECT_EX, offsetof(JPy_JField, name),       READONLY, "Field name"},
@@ -127,8 +278,8 @@ PyTypeObject JField_Type = {
     NULL,                         /* tp_getset */
     NULL,                         /* tp_base */
     NULL,                         /* tp_dict */
-    NULL,                         /* tp_descr_get */
-    NULL,                         /* tp_descr_set */
+    (descrgetfunc)JField_descr_get, /* tp_descr_get */
+    (descrsetfunc)JField_descr_set, /* tp_descr_set */
     0,                            /* tp_dictoffset */
     NULL,                         /* tp_init */
     NULL,                         /* tp_alloc */
@@ -23,10 +23,26 @@ extern "C" {
 
 #include "jpy_compat.h"
 
+struct JPy_JField;
+
+/**
+ * Reads the field of the given Java object and returns it as a new Python reference.
+ */
+typedef PyObject* (*JPy_FieldGetter)(JNIEnv* jenv, jobject objectRef, struct JPy_JField* field);
+
 /**
- * Python object representing a Java method. It's type is 'JMethod'.
+ * Writes the given Python value into the field of the given Java object. Returns -1 and sets a Python error on failure.
+ */
+typedef int (*JPy_FieldSetter)(JNIEnv* jenv, jobject objectRef, struct JPy_JField* field, PyObject* value);
+
+/**
+ * Python object representing a Java instance field. It's type is 'JField'.
+ *
+ * JField is a data descriptor: it is stored in the tp_dict of the declaring JType, so that 'obj.name'
+ * calls its tp_descr_get and 'obj.name = value' its tp_descr_set slot. The getter and setter for the
+ * field's type are chosen once by JField_New().
  */
-typedef struct
+typedef struct JPy_JField
 {
     PyObject_HEAD
 
@@ -42,11 +58,14 @@ typedef struct
     char isFinal;
     // Field ID retrieved from JNI.
     jfieldID fid;
+    // Accessors for the field type.
+    JPy_FieldGetter getter;
+    JPy_FieldSetter setter;
 }
 JPy_JField;
 
 /**
- * The Python 'JMethod' type singleton.
+ * The Python 'JField' type singleton.
  */
 extern PyTypeObject JField_Type;
 
@@ -0,0 +1,411 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_jtype.h"
+#include "jpy_jobj.h"
+#include "jpy_jfield.h"
+#include "jpy_conv.h"
+#include "jpy_jfieldproj.h"
+
+
+/**
+ * Returns the memoryview format of columns of the given field type, or '\0' if values are converted to Python objects.
+ */
+static char JFieldProjection_GetFormat(JPy_JType* fieldType)
+{
+    if (fieldType == JPy_JBoolean) {
+        return '?';
+    } else if (fieldType == JPy_JChar) {
+        return 'H';
+    } else if (fieldType == JPy_JByte) {
+        return 'b';
+    } else if (fieldType == JPy_JShort) {
+        return 'h';
+    } else if (fieldType == JPy_JInt) {
+        return 'i';
+    } else if (fieldType == JPy_JLong) {
+        return 'q';
+    } else if (fieldType == JPy_JFloat) {
+        return 'f';
+    } else if (fieldType == JPy_JDouble) {
+        return 'd';
+    }
+    return '\0';
+}
+
+static size_t JFieldProjection_GetItemSize(char format)
+{
+    switch (format) {
+        case '?': return sizeof (jboolean);
+        case 'H': return sizeof (jchar);
+        case 'b': return sizeof (jbyte);
+        case 'h': return sizeof (jshort);
+        case 'i': return sizeof (jint);
+        case 'q': return sizeof (jlong);
+        case 'f': return sizeof (jfloat);
+        case 'd': return sizeof (jdouble);
+        default: return 0;
+    }
+}
+
+PyObject* JFieldProjection_New(JNIEnv* jenv, JPy_JType* type, PyObject* names)
+{
+    JPy_JFieldProjection* self;
+    PyObject* nameSeq;
+    PyObject* name;
+    PyObject* field;
+    Py_ssize_t count;
+    Py_ssize_t i;
+
+    if (JPy_IS_STR(names)) {
+        PyErr_SetString(PyExc_ValueError, "fields: argument 2 (names) must be a sequence of field names");
+        return NULL;
+    }
+    nameSeq = PySequence_Fast(names, "fields: argument 2 (names) must be a sequence of field names");
+    if (nameSeq == NULL) {
+        return NULL;
+    }
+
+    // The fields are added to the type's dictionary when it is resolved
+    if (!type->isResolved && JType_ResolveType(jenv, type) < 0) {
+        JPy_DECREF(nameSeq);
+        return NULL;
+    }
+
+    self = PyObject_New(JPy_JFieldProjection, &JFieldProjection_Type);
+    if (self == NULL) {
+        JPy_DECREF(nameSeq);
+        return NULL;
+    }
+    JPy_INCREF(type);
+    self->type = type;
+    self->formats = NULL;
+    count = PySequence_Fast_GET_SIZE(nameSeq);
+    self->fields = PyTuple_New(count);
+    if (self->fields == NULL) {
+        goto error;
+    }
+    self->formats = PyMem_New(char, count + 1);
+    if (self->formats == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    for (i = 0; i < count; i++) {
+        name = PySequence_Fast_GET_ITEM(nameSeq, i);
+        if (!JPy_IS_STR(name)) {
+            PyErr_SetString(PyExc_ValueError, "fields: argument 2 (names) must be a sequence of field names");
+            goto error;
+        }
+        // Instance fields are JField descriptors, which return themselves when accessed on the type
+        field = PyObject_GetAttr((PyObject*) type, name);
+        if (field == NULL || !PyObject_TypeCheck(field, &JField_Type)) {
+            Py_XDECREF(field);
+            PyErr_Clear();
+            PyErr_Format(PyExc_ValueError, "fields: '%s' is not an instance field of %s", JPy_AS_UTF8(name), type->javaName);
+            goto error;
+        }
+        self->formats[i] = JFieldProjection_GetFormat(((JPy_JField*) field)->type);
+        PyTuple_SET_ITEM(self->fields, i, field);
+    }
+    self->formats[count] = '\0';
+
+    JPy_DECREF(nameSeq);
+    return (PyObject*) self;
+
+error:
+    JPy_DECREF(nameSeq);
+    JPy_DECREF(self);
+    return NULL;
+}
+
+/**
+ * Reads the fields of 'count' objects, taken from the Java Object[] 'arrayRef' if it is not NULL, otherwise from
+ * the PySequence_Fast 'seq' of wrappers. Returns a new dict mapping the field names to the columns.
+ */
+static PyObject* JFieldProjection_Read(JNIEnv* jenv, JPy_JFieldProjection* self, jobjectArray arrayRef, PyObject* seq, Py_ssize_t count)
+{
+    PyObject* result = NULL;
+    PyObject** columns;
+    char** data;
+    PyObject* value;
+    PyObject* view;
+    PyObject* column;
+    JPy_JField* field;
+    jobject objectRef;
+    Py_ssize_t fieldCount;
+    Py_ssize_t i;
+    Py_ssize_t j;
+    size_t itemSize;
+    char format[2];
+
+    fieldCount = PyTuple_GET_SIZE(self->fields);
+    columns = PyMem_New(PyObject*, fieldCount + 1);
+    data = PyMem_New(char*, fieldCount + 1);
+    if (columns == NULL || data == NULL) {
+        PyMem_Del(columns);
+        PyMem_Del(data);
+        return PyErr_NoMemory();
+    }
+
+    for (j = 0; j < fieldCount; j++) {
+        itemSize = JFieldProjection_GetItemSize(self->formats[j]);
+        if (itemSize > 0) {
+            columns[j] = PyByteArray_FromStringAndSize(NULL, count * (Py_ssize_t) itemSize);
+            data[j] = columns[j] != NULL ? PyByteArray_AS_STRING(columns[j]) : NULL;
+        } else {
+            columns[j] = PyList_New(count);
+            data[j] = NULL;
+        }
+        if (columns[j] == NULL) {
+            goto cleanup;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        if (arrayRef != NULL) {
+            objectRef = (*jenv)->GetObjectArrayElement(jenv, arrayRef, (jsize) i);
+            // Reading a field of an object of another class may crash the JVM
+            if (objectRef == NULL || !(*jenv)->IsInstanceOf(jenv, objectRef, self->type->classRef)) {
+                PyErr_Format(PyExc_ValueError, "JFieldProjection: element %d is not a %s", (int) i, self->type->javaName);
+                if (objectRef != NULL) {
+                    JPy_DELETE_LOCAL_REF(objectRef);
+                }
+                goto cleanup;
+            }
+        } else {
+            value = PySequence_Fast_GET_ITEM(seq, i);
+            if (!PyObject_TypeCheck(value, JTYPE_AS_PYTYPE(self->type))) {
+                PyErr_Format(PyExc_ValueError, "JFieldProjection: element %d is not a %s", (int) i, self->type->javaName);
+                goto cleanup;
+            }
+            objectRef = ((JPy_JObj*) value)->objectRef;
+        }
+
+        for (j = 0; j < fieldCount; j++) {
+            field = (JPy_JField*) PyTuple_GET_ITEM(self->fields, j);
+            switch (self->formats[j]) {
+                case '?': ((jboolean*) data[j])[i] = (*jenv)->GetBooleanField(jenv, objectRef, field->fid); break;
+                case 'H': ((jchar*) data[j])[i] = (*jenv)->GetCharField(jenv, objectRef, field->fid); break;
+                case 'b': ((jbyte*) data[j])[i] = (*jenv)->GetByteField(jenv, objectRef, field->fid); break;
+                case 'h': ((jshort*) data[j])[i] = (*jenv)->GetShortField(jenv, objectRef, field->fid); break;
+                case 'i': ((jint*) data[j])[i] = (*jenv)->GetIntField(jenv, objectRef, field->fid); break;
+                case 'q': ((jlong*) data[j])[i] = (*jenv)->GetLongField(jenv, objectRef, field->fid); break;
+                case 'f': ((jfloat*) data[j])[i] = (*jenv)->GetFloatField(jenv, objectRef, field->fid); break;
+                case 'd': ((jdouble*) data[j])[i] = (*jenv)->GetDoubleField(jenv, objectRef, field->fid); break;
+                default:
+                    value = field->getter(jenv, objectRef, field);
+                    if (value == NULL) {
+                        if (arrayRef != NULL) {
+                            JPy_DELETE_LOCAL_REF(objectRef);
+                        }
+                        goto cleanup;
+                    }
+                    PyList_SET_ITEM(columns[j], i, value);
+            }
+        }
+
+        if (arrayRef != NULL) {
+            JPy_DELETE_LOCAL_REF(objectRef);
+        }
+    }
+
+    result = PyDict_New();
+    if (result == NULL) {
+        goto cleanup;
+    }
+    format[1] = '\0';
+    for (j = 0; j < fieldCount; j++) {
+        field = (JPy_JField*) PyTuple_GET_ITEM(self->fields, j);
+        if (data[j] != NULL) {
+            format[0] = self->formats[j];
+            view = PyMemoryView_FromObject(columns[j]);
+            column = view != NULL ? PyObject_CallMethod(view, "cast", "s", format) : NULL;
+            Py_XDECREF(view);
+        } else {
+            column = columns[j];
+            JPy_INCREF(column);
+        }
+        if (column == NULL || PyDict_SetItem(result, field->name, column) < 0) {
+            Py_XDECREF(column);
+            Py_CLEAR(result);
+            goto cleanup;
+        }
+        JPy_DECREF(column);
+    }
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JFieldProjection_Read: read %d fields of %d objects\n", (int) fieldCount, (int) count);
+
+cleanup:
+    for (j = 0; j < fieldCount; j++) {
+        if (columns[j] == NULL) {
+            break;
+        }
+        JPy_DECREF(columns[j]);
+    }
+    PyMem_Del(columns);
+    PyMem_Del(data);
+    return result;
+}
+
+static PyObject* JFieldProjection_call_internal(JNIEnv* jenv, JPy_JFieldProjection* self, PyObject* args)
+{
+    PyObject* objects;
+    PyObject* seq;
+    PyObject* result;
+    JPy_JType* objectsType;
+    jobject arrayRef;
+
+    if (!PyArg_ParseTuple(args, "O:JFieldProjection", &objects)) {
+        return NULL;
+    }
+
+    if (JObj_Check(objects)) {
+        objectsType = (JPy_JType*) Py_TYPE(objects);
+        if (objectsType->componentType != NULL && !objectsType->componentType->isPrimitive) {
+            arrayRef = (*jenv)->NewLocalRef(jenv, ((JPy_JObj*) objects)->objectRef);
+        } else if ((*jenv)->IsInstanceOf(jenv, ((JPy_JObj*) objects)->objectRef, JPy_Collection_JClass)) {
+            Py_BEGIN_ALLOW_THREADS
+            arrayRef = (*jenv)->CallObjectMethod(jenv, ((JPy_JObj*) objects)->objectRef, JPy_Collection_toArray_MID);
+            Py_END_ALLOW_THREADS
+            JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
+        } else {
+            PyErr_SetString(PyExc_ValueError, "JFieldProjection: argument 1 (objects) must be a Java object array, a java.util.Collection or a sequence of Java objects");
+            return NULL;
+        }
+        if (arrayRef == NULL) {
+            return PyErr_NoMemory();
+        }
+        result = JFieldProjection_Read(jenv, self, arrayRef, NULL, (*jenv)->GetArrayLength(jenv, arrayRef));
+        JPy_DELETE_LOCAL_REF(arrayRef);
+        return result;
+    }
+
+    seq = PySequence_Fast(objects, "JFieldProjection: argument 1 (objects) must be a Java object array, a java.util.Collection or a sequence of Java objects");
+    if (seq == NULL) {
+        return NULL;
+    }
+    result = JFieldProjection_Read(jenv, self, NULL, seq, PySequence_Fast_GET_SIZE(seq));
+    JPy_DECREF(seq);
+    return result;
+}
+
+/**
+ * The JFieldProjection type's tp_call slot. Python: projection(objects)
+ */
+static PyObject* JFieldProjection_call(JPy_JFieldProjection* self, PyObject* args, PyObject* kwds)
+{
+    JPy_FRAME(PyObject*, NULL, JFieldProjection_call_internal(jenv, self, args), 16)
+}
+
+static PyObject* JFieldProjection_get_type(JPy_JFieldProjection* self, void* closure)
+{
+    JPy_INCREF(self->type);
+    return (PyObject*) self->type;
+}
+
+static PyObject* JFieldProjection_get_names(JPy_JFieldProjection* self, void* closure)
+{
+    PyObject* names;
+    PyObject* name;
+    Py_ssize_t i;
+
+    names = PyTuple_New(PyTuple_GET_SIZE(self->fields));
+    if (names == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < PyTuple_GET_SIZE(self->fields); i++) {
+        name = ((JPy_JField*) PyTuple_GET_ITEM(self->fields, i))->name;
+        JPy_INCREF(name);
+        PyTuple_SET_ITEM(names, i, name);
+    }
+    return names;
+}
+
+static PyObject* JFieldProjection_repr(JPy_JFieldProjection* self)
+{
+    PyObject* names;
+    PyObject* repr;
+
+    names = JFieldProjection_get_names(self, NULL);
+    if (names == NULL) {
+        return NULL;
+    }
+    repr = JPy_FROM_FORMAT("%s(type=%s, names=%R)", Py_TYPE(self)->tp_name, self->type->javaName, names);
+    JPy_DECREF(names);
+    return repr;
+}
+
+static void JFieldProjection_dealloc(JPy_JFieldProjection* self)
+{
+    Py_XDECREF(self->type);
+    Py_XDECREF(self->fields);
+    PyMem_Del(self->formats);
+    PyObject_Del(self);
+}
+
+static PyGetSetDef JFieldProjection_getset[] = {
+    {"type",  (getter) JFieldProjection_get_type,  NULL, "The Java type of the objects", NULL},
+    {"names", (getter) JFieldProjection_get_names, NULL, "The names of the projected fields", NULL},
+    {NULL}  /* Sentinel */
+};
+
+PyTypeObject JFieldProjection_Type =
+{
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "jpy.JFieldProjection",                     /* tp_name */
+    sizeof (JPy_JFieldProjection),              /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor) JFieldProjection_dealloc,      /* tp_dealloc */
+    NULL,                                       /* tp_print */
+    NULL,                                       /* tp_getattr */
+    NULL,                                       /* tp_setattr */
+    NULL,                                       /* tp_reserved */
+    (reprfunc) JFieldProjection_repr,           /* tp_repr */
+    NULL,                                       /* tp_as_number */
+    NULL,                                       /* tp_as_sequence */
+    NULL,                                       /* tp_as_mapping */
+    NULL,                                       /* tp_hash  */
+    (ternaryfunc) JFieldProjection_call,        /* tp_call */
+    NULL,                                       /* tp_str */
+    NULL,                                       /* tp_getattro */
+    NULL,                                       /* tp_setattro */
+    NULL,                                       /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                         /* tp_flags */
+    "Reads instance fields of many Java objects into columns, see jpy.fields()",   /* tp_doc */
+    NULL,                                       /* tp_traverse */
+    NULL,                                       /* tp_clear */
+    NULL,                                       /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    NULL,                                       /* tp_iter */
+    NULL,                                       /* tp_iternext */
+    NULL,                                       /* tp_methods */
+    NULL,                                       /* tp_members */
+    JFieldProjection_getset,                    /* tp_getset */
+    NULL,                                       /* tp_base */
+    NULL,                                       /* tp_dict */
+    NULL,                                       /* tp_descr_get */
+    NULL,                                       /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    NULL,                                       /* tp_init */
+    NULL,                                       /* tp_alloc */
+    NULL,                                       /* tp_new */
+};
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+#ifndef JPY_JFIELDPROJ_H
+#define JPY_JFIELDPROJ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+
+/**
+ * A reusable extractor of instance fields created by jpy.fields(type, names). Calling it with many
+ * Java objects reads the named fields of all objects in a single native loop into columns:
+ * fields of primitive types into typed memoryviews over a bytearray, so that they can be used
+ * without copying by array consumers such as numpy, other fields into lists.
+ */
+typedef struct JPy_JFieldProjection
+{
+    PyObject_HEAD
+    // The declaring type of the fields, or a subclass of it
+    JPy_JType* type;
+    // Tuple of the JPy_JField objects
+    PyObject* fields;
+    // The buffer format of each field, '\0' for fields converted to Python objects
+    char* formats;
+}
+JPy_JFieldProjection;
+
+extern PyTypeObject JFieldProjection_Type;
+
+/**
+ * Creates a new projection of the named instance fields (a sequence of str) of the given type.
+ * Returns a new reference.
+ */
+PyObject* JFieldProjection_New(JNIEnv* jenv, JPy_JType* type, PyObject* names);
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_JFIELDPROJ_H */
@@ -0,0 +1,242 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_jtype.h"
+#include "jpy_jobj.h"
+#include "jpy_conv.h"
+#include "jpy_memstats.h"
+#include "jpy_jiterator.h"
+
+
+/**
+ * Returns the next element of the Java iterator, or NULL without an error set if there is none.
+ */
+static PyObject* JIterator_NextElement(JNIEnv* jenv, jobject iteratorRef)
+{
+    jboolean hasNext;
+    jobject elementRef = NULL;
+    PyObject* element;
+
+    Py_BEGIN_ALLOW_THREADS
+    hasNext = (*jenv)->CallBooleanMethod(jenv, iteratorRef, JPy_Iterator_hasNext_MID);
+    if (hasNext && !(*jenv)->ExceptionCheck(jenv)) {
+        elementRef = (*jenv)->CallObjectMethod(jenv, iteratorRef, JPy_Iterator_next_MID);
+    }
+    Py_END_ALLOW_THREADS
+    JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
+    if (!hasNext) {
+        return NULL;
+    }
+
+    element = JPy_FromJObjectWithType(jenv, elementRef, JPy_JObject);
+    JPy_DELETE_LOCAL_REF(elementRef);
+    return element;
+}
+
+/**
+ * Fills the buffer with the next chunk of elements. Returns -1 and sets a Python error on failure.
+ */
+static int JIterator_FillChunk(JNIEnv* jenv, JPy_JIterator* self)
+{
+    jobjectArray chunkRef;
+    jint count;
+
+    if (self->chunkRef == NULL) {
+        chunkRef = (*jenv)->NewObjectArray(jenv, self->chunkSize, JPy_Object_JClass, NULL);
+        if (chunkRef == NULL) {
+            (*jenv)->ExceptionClear(jenv);
+            PyErr_NoMemory();
+            return -1;
+        }
+        self->chunkRef = JPy_NewGlobalRef(jenv, chunkRef, JPy_GREF_OBJECT);
+        JPy_DELETE_LOCAL_REF(chunkRef);
+        if (self->chunkRef == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    count = (*jenv)->CallStaticIntMethod(jenv, JPy_JavaIteration_JClass, JPy_JavaIteration_Fill_SMID, self->iteratorRef, self->chunkRef);
+    Py_END_ALLOW_THREADS
+    JPy_ON_JAVA_EXCEPTION_RETURN(-1);
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JIterator_FillChunk: fetched %d elements\n", count);
+
+    self->chunkCount = count;
+    self->chunkIndex = 0;
+    self->exhausted = (char) (count < self->chunkSize);
+    return 0;
+}
+
+PyObject* JIterator_New(JNIEnv* jenv, jobject iteratorRef, jint chunkSize)
+{
+    JPy_JIterator* self;
+
+    self = PyObject_New(JPy_JIterator, &JIterator_Type);
+    if (self == NULL) {
+        return NULL;
+    }
+
+    self->chunkRef = NULL;
+    // Without the Java helper, fall back to element-by-element mode
+    self->chunkSize = JPy_JavaIteration_Fill_SMID != NULL && chunkSize > 1 ? chunkSize : 1;
+    self->chunkCount = 0;
+    self->chunkIndex = 0;
+    self->exhausted = 0;
+    self->iteratorRef = JPy_NewGlobalRef(jenv, iteratorRef, JPy_GREF_OBJECT);
+    if (self->iteratorRef == NULL) {
+        JPy_DECREF(self);
+        return PyErr_NoMemory();
+    }
+
+    return (PyObject*) self;
+}
+
+/**
+ * The JIterator type's tp_iternext slot.
+ */
+static PyObject* JIterator_iternext(JPy_JIterator* self)
+{
+    JNIEnv* jenv;
+    jobject elementRef;
+    PyObject* element;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+
+    if (self->chunkSize == 1) {
+        return JIterator_NextElement(jenv, self->iteratorRef);
+    }
+
+    if (self->chunkIndex == self->chunkCount) {
+        if (self->exhausted) {
+            return NULL;
+        }
+        if (JIterator_FillChunk(jenv, self) < 0) {
+            return NULL;
+        }
+        if (self->chunkCount == 0) {
+            return NULL;
+        }
+    }
+
+    elementRef = (*jenv)->GetObjectArrayElement(jenv, self->chunkRef, self->chunkIndex++);
+    element = JPy_FromJObjectWithType(jenv, elementRef, JPy_JObject);
+    JPy_DELETE_LOCAL_REF(elementRef);
+    return element;
+}
+
+static PyObject* JIterator_get_chunk_size(JPy_JIterator* self, void* closure)
+{
+    return PyLong_FromLong(self->chunkSize);
+}
+
+static void JIterator_dealloc(JPy_JIterator* self)
+{
+    JNIEnv* jenv;
+
+    jenv = JPy_GetJNIEnv();
+    if (jenv != NULL) {
+        JPy_DeleteGlobalRef(jenv, self->iteratorRef, JPy_GREF_OBJECT);
+        JPy_DeleteGlobalRef(jenv, self->chunkRef, JPy_GREF_OBJECT);
+    }
+    self->iteratorRef = NULL;
+    self->chunkRef = NULL;
+
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+static PyGetSetDef JIterator_getset[] = {
+    {"chunk_size", (getter) JIterator_get_chunk_size, NULL, "The number of elements fetched per Java call", NULL},
+    {NULL}  /* Sentinel */
+};
+
+PyTypeObject JIterator_Type =
+{
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "jpy.JIterator",                            /* tp_name */
+    sizeof (JPy_JIterator),                     /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor) JIterator_dealloc,             /* tp_dealloc */
+    NULL,                                       /* tp_print */
+    NULL,                                       /* tp_getattr */
+    NULL,                                       /* tp_setattr */
+    NULL,                                       /* tp_reserved */
+    NULL,                                       /* tp_repr */
+    NULL,                                       /* tp_as_number */
+    NULL,                                       /* tp_as_sequence */
+    NULL,                                       /* tp_as_mapping */
+    NULL,                                       /* tp_hash  */
+    NULL,                                       /* tp_call */
+    NULL,                                       /* tp_str */
+    NULL,                                       /* tp_getattro */
+    NULL,                                       /* tp_setattro */
+    NULL,                                       /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                         /* tp_flags */
+    "Iterator over a java.util.Iterator, see jpy.iterate()",   /* tp_doc */
+    NULL,                                       /* tp_traverse */
+    NULL,                                       /* tp_clear */
+    NULL,                                       /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    PyObject_SelfIter,                          /* tp_iter */
+    (iternextfunc) JIterator_iternext,          /* tp_iternext */
+    NULL,                                       /* tp_methods */
+    NULL,                                       /* tp_members */
+    JIterator_getset,                           /* tp_getset */
+    NULL,                                       /* tp_base */
+    NULL,                                       /* tp_dict */
+    NULL,                                       /* tp_descr_get */
+    NULL,                                       /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    NULL,                                       /* tp_init */
+    NULL,                                       /* tp_alloc */
+    NULL,                                       /* tp_new */
+};
+
+PyObject* JObj_iter(JPy_JObj* self)
+{
+    JNIEnv* jenv;
+    jobject iteratorRef;
+    PyObject* iterator;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+
+    Py_BEGIN_ALLOW_THREADS
+    iteratorRef = (*jenv)->CallObjectMethod(jenv, self->objectRef, JPy_Iterable_Iterator_MID);
+    Py_END_ALLOW_THREADS
+    JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
+    if (iteratorRef == NULL) {
+        PyErr_SetString(PyExc_TypeError, "java.lang.Iterable.iterator() returned null");
+        return NULL;
+    }
+
+    iterator = JIterator_New(jenv, iteratorRef, JPy_ITER_CHUNK_SIZE);
+    JPy_DELETE_LOCAL_REF(iteratorRef);
+    return iterator;
+}
+
+PyObject* JObj_iternext(JPy_JObj* self)
+{
+    JNIEnv* jenv;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+    return JIterator_NextElement(jenv, self->objectRef);
+}
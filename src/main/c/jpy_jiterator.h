@@ -0,0 +1,80 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#ifndef JPY_JITERATOR_H
+#define JPY_JITERATOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+
+struct JPy_JObj;
+
+/**
+ * The default number of elements fetched per Java call when iterating a java.lang.Iterable.
+ */
+#define JPy_ITER_CHUNK_SIZE 256
+
+/**
+ * The Python iterator returned by iter() for wrapped java.lang.Iterable objects, and by jpy.iterate().
+ *
+ * If chunkSize is greater than 1 and org.jpy.JavaIteration is on the classpath, the elements are
+ * fetched from the java.util.Iterator into an Object[] buffer of chunkSize elements with a single
+ * Java call per chunk. Otherwise hasNext() and next() are called per element. Either way the methods
+ * are called directly with cached method IDs, without overload resolution.
+ */
+typedef struct JPy_JIterator
+{
+    PyObject_HEAD
+    // Global reference to the java.util.Iterator
+    jobject iteratorRef;
+    // Global reference to the Object[] buffer, NULL in element-by-element mode
+    jobjectArray chunkRef;
+    jint chunkSize;
+    // The number of elements in the buffer and the index of the next one
+    jint chunkCount;
+    jint chunkIndex;
+    // If TRUE, the Java iterator has no more elements than those in the buffer
+    char exhausted;
+}
+JPy_JIterator;
+
+extern PyTypeObject JIterator_Type;
+
+/**
+ * Creates a new iterator over the given java.util.Iterator. Returns a new reference.
+ */
+PyObject* JIterator_New(JNIEnv* jenv, jobject iteratorRef, jint chunkSize);
+
+/**
+ * The tp_iter slot of types assignable to java.lang.Iterable. Returns a chunked JIterator.
+ */
+PyObject* JObj_iter(struct JPy_JObj* self);
+
+/**
+ * The tp_iternext slot of types assignable to java.util.Iterator. Calls hasNext() and next().
+ */
+PyObject* JObj_iternext(struct JPy_JObj* self);
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_JITERATOR_H */
@@ -22,6 +22,9 @@
 #include "jpy_jobj.h"
 #include "jpy_jmethod.h"
 #include "jpy_conv.h"
+#include "jpy_metrics.h"
+#include "jpy_profiler.h"
+#include "jpy_numpy.h"
 #include "jpy_compat.h"
 
 
@@ -46,6 +49,7 @@ JPy_JMethod* JMethod_New(JPy_JType* declaringClass,
     method->isStatic = isStatic;
     method->isVarArgs = isVarArgs;
     method->mid = mid;
+    method->metrics = NULL;
 
     JPy_INCREF(declaringClass);
     JPy_INCREF(method->name);
@@ -75,7 +79,10 @@ void JMethod_dealloc(JPy_JMethod* self)
 
     PyMem_Del(self->paramDescriptors);
     PyMem_Del(self->returnDescriptor);
-    
+    if (self->metrics != NULL) {
+        JPy_Metrics_ReleaseMethod(self->metrics);
+    }
+
     Py_TYPE(self)->tp_free((PyObject*) self);
 }
 
@@ -236,9 +243,23 @@ PyObject* JMethod_FromJObject(JNIEnv* jenv, JPy_JMethod* method, PyObject* pyArg
         }
     }
     #endif
+    if (method->returnDescriptor->isNumpy && jReturnValue != NULL
+        && (returnType->componentType != NULL || (*jenv)->IsInstanceOf(jenv, jReturnValue, JPy_Collection_JClass))) {
+        return JPy_Numpy_FromJObject(jenv, jReturnValue, returnType);
+    }
     return JPy_FromJObjectWithType(jenv, jReturnValue, returnType);
 }
 
+/**
+ * Release the GIL around a Java call in JMethod_InvokeMethod(), taking the timestamps for the
+ * call metrics if enabled.
+ */
+#define JPy_BEGIN_JAVA_CALL Py_BEGIN_ALLOW_THREADS \
+                            if (timed) { times.javaStart = JPy_NanoTime(); }
+#define JPy_END_JAVA_CALL   if (timed) { times.javaEnd = JPy_NanoTime(); } \
+                            Py_END_ALLOW_THREADS \
+                            if (timed) { times.resultStart = JPy_NanoTime(); }
+
 /**
  * Invoke a method. We have already ensured that the Python arguments and expected Java parameters match.
  */
@@ -250,9 +271,24 @@ PyObject* JMethod_InvokeMethod(JNIEnv* jenv, JPy_JMethod* method, PyObject* pyAr
     JPy_JType* declaringClass;
     JPy_JType* returnType;
     jclass classRef;
+    // Metrics are sampled once per call, so that a call is timed completely or not at all
+    int timed = JPy_MetricsEnabled;
+    JPy_CallTimes times;
+    jlong profileStart = JPy_ProfilerEnabled ? JPy_NanoTime() : 0;
+
+    if (timed) {
+        memset(&times, 0, sizeof (times));
+        times.start = JPy_NanoTime();
+    }
 
     //printf("JMethod_InvokeMethod 1: typeCode=%c\n", typeCode);
     if (JMethod_CreateJArgs(jenv, method, pyArgs, &jArgs, &argDisposers, isVarArgsArray) < 0) {
+        if (timed) {
+            JPy_Metrics_RecordCall((PyObject*) method, &times, 1);
+        }
+        if (profileStart != 0) {
+            JPy_Profiler_Record(JPy_PROFILER_PYTHON_TO_JAVA, (PyObject*) method, profileStart);
+        }
         return NULL;
     }
 
@@ -268,80 +304,80 @@ PyObject* JMethod_InvokeMethod(JNIEnv* jenv, JPy_JMethod* method, PyObject* pyAr
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JMethod_InvokeMethod: calling static Java method %s#%s\n", declaringClass->javaName, JPy_AS_UTF8(method->name));
 
         if (returnType == JPy_JVoid) {
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             (*jenv)->CallStaticVoidMethodA(jenv, classRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JVOID();
         } else if (returnType == JPy_JBoolean) {
             jboolean v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallStaticBooleanMethodA(jenv, classRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JBOOLEAN(v);
         } else if (returnType == JPy_JChar) {
             jchar v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallStaticCharMethodA(jenv, classRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JCHAR(v);
         } else if (returnType == JPy_JByte) {
             jbyte v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallStaticByteMethodA(jenv, classRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JBYTE(v);
         } else if (returnType == JPy_JShort) {
             jshort v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallStaticShortMethodA(jenv, classRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JSHORT(v);
         } else if (returnType == JPy_JInt) {
             jint v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallStaticIntMethodA(jenv, classRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JINT(v);
         } else if (returnType == JPy_JLong) {
             jlong v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallStaticLongMethodA(jenv, classRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JLONG(v);
         } else if (returnType == JPy_JFloat) {
             jfloat v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallStaticFloatMethodA(jenv, classRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JFLOAT(v);
         } else if (returnType == JPy_JDouble) {
             jdouble v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallStaticDoubleMethodA(jenv, classRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JDOUBLE(v);
         } else if (returnType == JPy_JString) {
             jstring v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallStaticObjectMethodA(jenv, classRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FromJString(jenv, v);
             JPy_DELETE_LOCAL_REF(v);
         } else {
             jobject v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallStaticObjectMethodA(jenv, classRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JMethod_FromJObject(jenv, method, pyArgs, jArgs, 0, returnType, v);
             JPy_DELETE_LOCAL_REF(v);
@@ -358,80 +394,80 @@ PyObject* JMethod_InvokeMethod(JNIEnv* jenv, JPy_JMethod* method, PyObject* pyAr
         objectRef = ((JPy_JObj*) self)->objectRef;
 
         if (returnType == JPy_JVoid) {
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             (*jenv)->CallVoidMethodA(jenv, objectRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JVOID();
         } else if (returnType == JPy_JBoolean) {
             jboolean v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallBooleanMethodA(jenv, objectRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JBOOLEAN(v);
         } else if (returnType == JPy_JChar) {
             jchar v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallCharMethodA(jenv, objectRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JCHAR(v);
         } else if (returnType == JPy_JByte) {
             jbyte v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallByteMethodA(jenv, objectRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JBYTE(v);
         } else if (returnType == JPy_JShort) {
             jshort v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallShortMethodA(jenv, objectRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JSHORT(v);
         } else if (returnType == JPy_JInt) {
             jint v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallIntMethodA(jenv, objectRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JINT(v);
         } else if (returnType == JPy_JLong) {
             jlong v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallLongMethodA(jenv, objectRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JLONG(v);
         } else if (returnType == JPy_JFloat) {
             jfloat v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallFloatMethodA(jenv, objectRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JFLOAT(v);
         } else if (returnType == JPy_JDouble) {
             jdouble v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallDoubleMethodA(jenv, objectRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JDOUBLE(v);
         } else if (returnType == JPy_JString) {
             jstring v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallObjectMethodA(jenv, objectRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FromJString(jenv, v);
             JPy_DELETE_LOCAL_REF(v);
         } else {
             jobject v;
-            Py_BEGIN_ALLOW_THREADS;
+            JPy_BEGIN_JAVA_CALL
             v = (*jenv)->CallObjectMethodA(jenv, objectRef, method->mid, jArgs);
-            Py_END_ALLOW_THREADS;
+            JPy_END_JAVA_CALL
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JMethod_FromJObject(jenv, method, pyArgs, jArgs, 1, returnType, v);
             JPy_DELETE_LOCAL_REF(v);
@@ -442,6 +478,12 @@ error:
     if (jArgs != NULL) {
         JMethod_DisposeJArgs(jenv, method->paramCount, jArgs, argDisposers);
     }
+    if (timed) {
+        JPy_Metrics_RecordCall((PyObject*) method, &times, returnValue == NULL);
+    }
+    if (profileStart != 0) {
+        JPy_Profiler_Record(JPy_PROFILER_PYTHON_TO_JAVA, (PyObject*) method, profileStart);
+    }
 
     return returnValue;
 }
@@ -697,6 +739,73 @@ PyObject* JMethod_set_param_return(JPy_JMethod* self, PyObject* args)
     return Py_BuildValue("");
 }
 
+PyObject* JMethod_is_param_numpy(JPy_JMethod* self, PyObject* args)
+{
+    int index = 0;
+    int value = 0;
+    if (!PyArg_ParseTuple(args, "i:is_param_numpy", &index)) {
+        return NULL;
+    }
+    JMethod_CHECK_PARAMETER_INDEX(self, index);
+    value = self->paramDescriptors[index].isNumpy;
+    return PyBool_FromLong(value);
+}
+
+PyObject* JMethod_set_param_numpy(JPy_JMethod* self, PyObject* args)
+{
+    JPy_JType* componentType;
+    int index = 0;
+    int value = 0;
+#if defined(JPY_COMPAT_33P)
+    if (!PyArg_ParseTuple(args, "ip:set_param_numpy", &index, &value)) {
+#elif defined(JPY_COMPAT_27)
+    if (!PyArg_ParseTuple(args, "ii:set_param_numpy", &index, &value)) {
+#else
+#error JPY_VERSION_ERROR
+#endif
+        return NULL;
+    }
+    JMethod_CHECK_PARAMETER_INDEX(self, index);
+    componentType = self->paramDescriptors[index].type->componentType;
+    if (componentType == NULL || !componentType->isPrimitive) {
+        PyErr_SetString(PyExc_ValueError, "set_param_numpy: parameter is not a primitive array");
+        return NULL;
+    }
+    if (value && JPy_Numpy_Import() < 0) {
+        return NULL;
+    }
+    self->paramDescriptors[index].isNumpy = value;
+    return Py_BuildValue("");
+}
+
+PyObject* JMethod_is_return_numpy(JPy_JMethod* self)
+{
+    return PyBool_FromLong(self->returnDescriptor != NULL && self->returnDescriptor->isNumpy);
+}
+
+PyObject* JMethod_set_return_numpy(JPy_JMethod* self, PyObject* args)
+{
+    int value = 0;
+#if defined(JPY_COMPAT_33P)
+    if (!PyArg_ParseTuple(args, "p:set_return_numpy", &value)) {
+#elif defined(JPY_COMPAT_27)
+    if (!PyArg_ParseTuple(args, "i:set_return_numpy", &value)) {
+#else
+#error JPY_VERSION_ERROR
+#endif
+        return NULL;
+    }
+    if (self->returnDescriptor == NULL || self->returnDescriptor->type->isPrimitive) {
+        PyErr_SetString(PyExc_ValueError, "set_return_numpy: method does not return an object");
+        return NULL;
+    }
+    if (value && JPy_Numpy_Import() < 0) {
+        return NULL;
+    }
+    self->returnDescriptor->isNumpy = value;
+    return Py_BuildValue("");
+}
+
 
 static PyMethodDef JMethod_methods[] =
 {
@@ -707,6 +816,11 @@ static PyMethodDef JMethod_methods[] =
     {"set_param_mutable", (PyCFunction) JMethod_set_param_mutable, METH_VARARGS, "Sets whether the method parameter given by index is mutable"},
     {"set_param_output",  (PyCFunction) JMethod_set_param_output,  METH_VARARGS, "Sets whether the method parameter given by index is a mere output value (and not read from)"},
     {"set_param_return",  (PyCFunction) JMethod_set_param_return,  METH_VARARGS, "Sets whether the method parameter given by index is the return value"},
+    {"is_param_numpy",    (PyCFunction) JMethod_is_param_numpy,    METH_VARARGS, "Tests if arguments of the primitive array parameter given by index are cast with numpy"},
+    {"set_param_numpy",   (PyCFunction) JMethod_set_param_numpy,   METH_VARARGS, "Sets whether arguments of the primitive array parameter given by index, e.g. numpy arrays of any dtype "
+                                                                                  "or sequences, are cast with numpy.ascontiguousarray() to the parameter's component type"},
+    {"is_return_numpy",   (PyCFunction) JMethod_is_return_numpy,   METH_NOARGS,  "Tests if array and collection return values are converted to numpy arrays"},
+    {"set_return_numpy",  (PyCFunction) JMethod_set_return_numpy,  METH_VARARGS, "Sets whether array and collection return values are converted to numpy arrays like jpy.to_numpy() does"},
     {NULL}  /* Sentinel */
 };
 
@@ -981,8 +1095,12 @@ PyObject* JOverloadedMethod_call_internal(JNIEnv* jenv, JPy_JOverloadedMethod* s
 {
     JPy_JMethod* method;
     int isVarArgsArray;
+    jlong startTime = JPy_MetricsEnabled ? JPy_NanoTime() : 0;
 
     method = JOverloadedMethod_FindMethod(jenv, self, args, JNI_TRUE, &isVarArgsArray);
+    if (startTime != 0) {
+        JPy_Metrics_RecordOverload((PyObject*) method, startTime);
+    }
     if (method == NULL) {
         return NULL;
     }
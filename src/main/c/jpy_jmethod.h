@@ -48,6 +48,8 @@ typedef struct
     JPy_ReturnDescriptor* returnDescriptor;
     // The JNI method ID obtained from the declaring class.
     jmethodID mid;
+    // Call metrics, NULL until the method is called while metrics are enabled, see jpy_metrics.h
+    struct JPy_MethodMetrics* metrics;
 }
 JPy_JMethod;
 
@@ -97,6 +99,7 @@ int JMethod_ConvertToJavaValues(JNIEnv* jenv, JPy_JMethod* jMethod, int argCount
 
 int  JMethod_CreateJArgs(JNIEnv* jenv, JPy_JMethod* jMethod, PyObject* argTuple, jvalue** jValues, JPy_ArgDisposer** jDisposers, int isVarArgsArray);
 void JMethod_DisposeJArgs(JNIEnv* jenv, int paramCount, jvalue* jValues, JPy_ArgDisposer* jDisposers);
+PyObject* JMethod_FromJObject(JNIEnv* jenv, JPy_JMethod* method, PyObject* pyArgs, jvalue* jArgs, int argOffset, JPy_JType* returnType, jobject jReturnValue);
 
 #ifdef __cplusplus
 }  /* extern "C" */
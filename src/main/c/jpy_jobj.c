@@ -25,6 +25,11 @@
 #include "jpy_jmethod.h"
 #include "jpy_jfield.h"
 #include "jpy_conv.h"
+#include "jpy_memstats.h"
+#include "jpy_idcache.h"
+#include "jpy_typetrans.h"
+#include "jpy_jiterator.h"
+#include "jpy_jcollection.h"
 
 PyObject* JObj_New(JNIEnv* jenv, jobject objectRef)
 {
@@ -36,11 +41,11 @@ PyObject* JObj_New(JNIEnv* jenv, jobject objectRef)
     return JObj_FromType(jenv, type, objectRef);
 }
 
-PyObject* JObj_FromType(JNIEnv* jenv, JPy_JType* type, jobject objectRef)
+/**
+ * Creates a new wrapper owning a new global reference to the given object.
+ */
+static JPy_JObj* JObj_NewWrapper(JNIEnv* jenv, JPy_JType* type, jobject objectRef, jint identityHash)
 {
-    PyObject* callable;
-    PyObject* callableResult;
-
     JPy_JObj* obj;
 
     obj = (JPy_JObj*) PyObject_New(JPy_JObj, JTYPE_AS_PYTYPE(type));
@@ -48,13 +53,16 @@ PyObject* JObj_FromType(JNIEnv* jenv, JPy_JType* type, jobject objectRef)
         return NULL;
     }
 
-    objectRef = (*jenv)->NewGlobalRef(jenv, objectRef);
+    objectRef = JPy_NewGlobalRef(jenv, objectRef, JPy_GREF_OBJECT);
     if (objectRef == NULL) {
         PyErr_NoMemory();
         return NULL;
     }
 
     obj->objectRef = objectRef;
+    obj->identityCached = 0;
+    obj->hashEpoch = 0;
+    type->globalRefCount++;
 
     // For special treatment of primitive array refer to JType_InitSlots()
     if (type->componentType != NULL && type->componentType->isPrimitive) {
@@ -65,18 +73,53 @@ PyObject* JObj_FromType(JNIEnv* jenv, JPy_JType* type, jobject objectRef)
         array->buf = NULL;
     }
 
-    // we check the type translations dictionary for a callable for this java type name,
-    // and apply the returned callable to the wrapped object
-    callable = PyDict_GetItemString(JPy_Type_Translations, type->javaName);
+    if (type->isIdentityCached) {
+        JPy_IdentityCache_Put(obj, identityHash);
+    }
+
+    return obj;
+}
+
+PyObject* JObj_FromType(JNIEnv* jenv, JPy_JType* type, jobject objectRef)
+{
+    PyObject* callable;
+    PyObject* callableResult;
+
+    JPy_JObj* obj;
+    jint identityHash = 0;
+
+    obj = NULL;
+    if (type->isIdentityCached) {
+        // Returns the live wrapper of the same Java object, if any, see jpy.cache_identity()
+        obj = (JPy_JObj*) JPy_IdentityCache_Get(jenv, type, objectRef, &identityHash);
+        if (obj == NULL && PyErr_Occurred()) {
+            return NULL;
+        }
+    }
+
+    if (obj == NULL) {
+        obj = JObj_NewWrapper(jenv, type, objectRef, identityHash);
+        if (obj == NULL) {
+            return NULL;
+        }
+    }
+
+    // we check the type translations dictionary for a callable for this java type (or one of its
+    // supertypes), and apply the returned callable to the wrapped object
+    callable = JType_GetTranslation(jenv, type);
     if (callable != NULL) {
-        if (PyCallable_Check(callable)) {
-            callableResult = PyObject_CallFunction(callable, "OO", type, obj);
-            if (callableResult == NULL) {
-                return Py_None;
-            } else {
-                return callableResult;
-            }
+        // the callable may modify jpy.type_translations, which releases the cached reference
+        JPy_INCREF(callable);
+        callableResult = PyObject_CallFunction(callable, "OO", type, obj);
+        JPy_DECREF(callable);
+        if (callableResult == NULL) {
+            return Py_None;
+        } else {
+            return callableResult;
         }
+    } else if (PyErr_Occurred()) {
+        JPy_DECREF(obj);
+        return NULL;
     }
 
     return (PyObject *)obj;
@@ -136,7 +179,7 @@ int JObj_init_internal(JNIEnv* jenv, JPy_JObj* self, PyObject* args, PyObject* k
         JMethod_DisposeJArgs(jenv, jMethod->paramCount, jArgs, jDisposers);
     }
 
-    globalObjectRef = (*jenv)->NewGlobalRef(jenv, localObjectRef);
+    globalObjectRef = JPy_NewGlobalRef(jenv, localObjectRef, JPy_GREF_OBJECT);
     if (globalObjectRef == NULL) {
         PyErr_NoMemory();
         return -1;
@@ -145,10 +188,18 @@ int JObj_init_internal(JNIEnv* jenv, JPy_JObj* self, PyObject* args, PyObject* k
 
     // Note:  __init__ may be called multiple times, so we have to release the old objectRef
     if (self->objectRef != NULL) {
-        (*jenv)->DeleteGlobalRef(jenv, self->objectRef);
+        JPy_IdentityCache_Remove(self);
+        JPy_DeleteGlobalRef(jenv, self->objectRef, JPy_GREF_OBJECT);
+    } else {
+        jType->globalRefCount++;
     }
 
     self->objectRef = globalObjectRef;
+    self->hashEpoch = 0;
+
+    if (jType->isIdentityCached && JPy_IdentityCache_PutNew(jenv, self) < 0) {
+        return -1;
+    }
 
     JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "JObj_init: self->objectRef=%p\n", self->objectRef);
 
@@ -174,6 +225,8 @@ void JObj_dealloc(JPy_JObj* self)
     JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "JObj_dealloc: releasing instance of %s, self->objectRef=%p\n", Py_TYPE(self)->tp_name, self->objectRef);
 
     jtype = (JPy_JType *)Py_TYPE(self);
+    JPy_IdentityCache_Remove(self);
+
     if (jtype->componentType != NULL && jtype->componentType->isPrimitive) {
         JPy_JArray* array;
         array = (JPy_JArray*) self;
@@ -187,7 +240,8 @@ void JObj_dealloc(JPy_JObj* self)
     jenv = JPy_GetJNIEnv();
     if (jenv != NULL) {
         if (self->objectRef != NULL) {
-            (*jenv)->DeleteGlobalRef(jenv, self->objectRef);
+            JPy_DeleteGlobalRef(jenv, self->objectRef, JPy_GREF_OBJECT);
+            jtype->globalRefCount--;
         }
     }
 
@@ -215,6 +269,15 @@ int JObj_CompareTo(JNIEnv* jenv, JPy_JObj* obj1, JPy_JObj* obj2)
     return (value == 0) ? 0 : (value < 0) ? -1 : +1;
 }
 
+/**
+ * Returns non-zero if the object's hash code has been cached and is still valid.
+ */
+static int JObj_HasCachedHash(JPy_JObj* self)
+{
+    JPy_JType* type = (JPy_JType*) Py_TYPE(self);
+    return type->isHashCached && self->hashEpoch == type->hashEpoch;
+}
+
 int JObj_Equals(JNIEnv* jenv, JPy_JObj* obj1, JPy_JObj* obj2)
 {
     jobject ref1;
@@ -224,6 +287,11 @@ int JObj_Equals(JNIEnv* jenv, JPy_JObj* obj1, JPy_JObj* obj2)
     ref1 = obj1->objectRef;
     ref2 = obj2->objectRef;
 
+    // Equal objects have equal hash codes, so differing cached ones tell without calling equals()
+    if (JObj_HasCachedHash(obj1) && JObj_HasCachedHash(obj2) && obj1->hash != obj2->hash) {
+        return 0;
+    }
+
     if ((*jenv)->IsSameObject(jenv, ref1, ref2) || (*jenv)->CallBooleanMethod(jenv, ref1, JPy_Object_Equals_MID, ref2)) {
         returnValue = 1;
     } else {
@@ -244,6 +312,16 @@ PyObject* JObj_richcompare(PyObject* obj1, PyObject* obj2, int opid)
         Py_RETURN_FALSE;
     }
 
+    // The same wrapper or global reference is always equal, e.g. for wrappers from the identity cache
+    if ((opid == Py_EQ || opid == Py_NE)
+        && (obj1 == obj2 || ((JPy_JObj*) obj1)->objectRef == ((JPy_JObj*) obj2)->objectRef)) {
+        if (opid == Py_EQ) {
+            Py_RETURN_TRUE;
+        } else {
+            Py_RETURN_FALSE;
+        }
+    }
+
     JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL);
 
     if (opid == Py_LT) {
@@ -312,13 +390,29 @@ PyObject* JObj_richcompare(PyObject* obj1, PyObject* obj2, int opid)
 long JObj_hash(JPy_JObj* self)
 {
     JNIEnv* jenv;
-    jenv = JPy_GetJNIEnv();
-    if (jenv != NULL) {
-        int returnValue = (*jenv)->CallIntMethod(jenv, self->objectRef, JPy_Object_HashCode_MID);
-        (*jenv)->ExceptionClear(jenv); // we can't deal with exceptions here, so clear any
-        return returnValue;
+    jint hash;
+    JPy_JType* type;
+
+    // Immutable types compute the hash code only once, see jpy.cache_hash()
+    type = (JPy_JType*) Py_TYPE(self);
+    if (JObj_HasCachedHash(self)) {
+        hash = self->hash;
+    } else {
+        jenv = JPy_GetJNIEnv();
+        if (jenv == NULL) {
+            return -1;
+        }
+        hash = (*jenv)->CallIntMethod(jenv, self->objectRef, JPy_Object_HashCode_MID);
+        if ((*jenv)->ExceptionCheck(jenv)) {
+            (*jenv)->ExceptionClear(jenv); // we can't deal with exceptions here, so clear any
+            hash = 0;
+        } else if (type->isHashCached) {
+            self->hash = hash;
+            self->hashEpoch = type->hashEpoch;
+        }
     }
-    return -1;
+    // -1 tells Python that an error occurred
+    return hash == -1 ? -2 : hash;
 }
 
 
@@ -362,65 +456,22 @@ error:
  */
 int JObj_setattro(JPy_JObj* self, PyObject* name, PyObject* value)
 {
-    PyObject* oldValue;
+    JPy_JType* selfType;
 
     //printf("JObj_setattro: %s.%s\n", Py_TYPE(self)->tp_name, JPy_AS_UTF8(name));
 
-    oldValue = PyObject_GenericGetAttr((PyObject*) self, name);
-    if (oldValue != NULL && PyObject_TypeCheck(oldValue, &JField_Type)) {
+    // Make sure that the Java type is resolved, otherwise we won't find any fields at all.
+    selfType = (JPy_JType*) Py_TYPE(self);
+    if (!selfType->isResolved) {
         JNIEnv* jenv;
-        JPy_JField* field;
-        JPy_JType* type;
-
-        field = (JPy_JField*) oldValue;
-        type = field->type;
-
         JPy_GET_JNI_ENV_OR_RETURN(jenv, -1)
-
-        if (type == JPy_JBoolean) {
-            jboolean item = JPy_AS_JBOOLEAN(value);
-            (*jenv)->SetBooleanField(jenv, self->objectRef, field->fid, item);
-            JPy_ON_JAVA_EXCEPTION_RETURN(-1);
-        } else if (type == JPy_JChar) {
-            jchar item = JPy_AS_JCHAR(value);
-            (*jenv)->SetCharField(jenv, self->objectRef, field->fid, item);
-            JPy_ON_JAVA_EXCEPTION_RETURN(-1);
-        } else if (type == JPy_JByte) {
-            jbyte item = JPy_AS_JBYTE(value);
-            (*jenv)->SetByteField(jenv, self->objectRef, field->fid, item);
-            JPy_ON_JAVA_EXCEPTION_RETURN(-1);
-        } else if (type == JPy_JShort) {
-            jshort item = JPy_AS_JSHORT(value);
-            (*jenv)->SetShortField(jenv, self->objectRef, field->fid, item);
-            JPy_ON_JAVA_EXCEPTION_RETURN(-1);
-        } else if (type == JPy_JInt) {
-            jint item = JPy_AS_JINT(value);
-            (*jenv)->SetIntField(jenv, self->objectRef, field->fid, item);
-            JPy_ON_JAVA_EXCEPTION_RETURN(-1);
-        } else if (type == JPy_JLong) {
-            jlong item = JPy_AS_JLONG(value);
-            (*jenv)->SetLongField(jenv, self->objectRef, field->fid, item);
-            JPy_ON_JAVA_EXCEPTION_RETURN(-1);
-        } else if (type == JPy_JFloat) {
-            jfloat item = JPy_AS_JFLOAT(value);
-            (*jenv)->SetFloatField(jenv, self->objectRef, field->fid, item);
-            JPy_ON_JAVA_EXCEPTION_RETURN(-1);
-        } else if (type == JPy_JDouble) {
-            jdouble item = JPy_AS_JDOUBLE(value);
-            (*jenv)->SetDoubleField(jenv, self->objectRef, field->fid, item);
-            JPy_ON_JAVA_EXCEPTION_RETURN(-1);
-        } else {
-            jobject objectRef;
-            if (JPy_AsJObjectWithType(jenv, value, &objectRef, field->type) < 0) {
-                return -1;
-            }
-            (*jenv)->SetObjectField(jenv, self->objectRef, field->fid, objectRef);
-            JPy_ON_JAVA_EXCEPTION_RETURN(-1);
+        if (JType_ResolveType(jenv, selfType) < 0) {
+            return -1;
         }
-        return 0;
-    } else {
-        return PyObject_GenericSetAttr((PyObject*) self, name, value);
     }
+
+    // Instance fields are JField data descriptors, whose tp_descr_set slot writes the Java field
+    return PyObject_GenericSetAttr((PyObject*) self, name, value);
 }
 
 /**
@@ -464,59 +515,8 @@ PyObject* JObj_getattro(JPy_JObj* self, PyObject* name)
 #else
 #error JPY_VERSION_ERROR
 #endif
-    } else if (PyObject_TypeCheck(value, &JField_Type)) {
-        JNIEnv* jenv;
-        JPy_JField* field;
-        JPy_JType* type;
-
-        field = (JPy_JField*) value;
-        type = field->type;
-
-        JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
-
-        if (type == JPy_JBoolean) {
-            jboolean item = (*jenv)->GetBooleanField(jenv, self->objectRef, field->fid);
-            JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
-            return JPy_FROM_JBOOLEAN(item);
-        } else if (type == JPy_JChar) {
-            jchar item = (*jenv)->GetCharField(jenv, self->objectRef, field->fid);
-            JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
-            return JPy_FROM_JCHAR(item);
-        } else if (type == JPy_JByte) {
-            jbyte item = (*jenv)->GetByteField(jenv, self->objectRef, field->fid);
-            JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
-            return JPy_FROM_JBYTE(item);
-        } else if (type == JPy_JShort) {
-            jshort item = (*jenv)->GetShortField(jenv, self->objectRef, field->fid);
-            JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
-            return JPy_FROM_JSHORT(item);
-        } else if (type == JPy_JInt) {
-            jint item = (*jenv)->GetIntField(jenv, self->objectRef, field->fid);
-            JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
-            return JPy_FROM_JINT(item);
-        } else if (type == JPy_JLong) {
-            jlong item = (*jenv)->GetLongField(jenv, self->objectRef, field->fid);
-            JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
-            return JPy_FROM_JLONG(item);
-        } else if (type == JPy_JFloat) {
-            jfloat item = (*jenv)->GetFloatField(jenv, self->objectRef, field->fid);
-            JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
-            return JPy_FROM_JFLOAT(item);
-        } else if (type == JPy_JDouble) {
-            jdouble item = (*jenv)->GetDoubleField(jenv, self->objectRef, field->fid);
-            JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
-            return JPy_FROM_JDOUBLE(item);
-        } else {
-            PyObject* returnValue;
-            jobject item = (*jenv)->GetObjectField(jenv, self->objectRef, field->fid);
-            JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
-            returnValue = JPy_FromJObjectWithType(jenv, item, field->type);
-            JPy_DELETE_LOCAL_REF(item);
-            return returnValue;
-        }
-    } else {
-        //printf("JObj_getattro: passing through\n");
     }
+    // Instance fields are JField data descriptors, PyObject_GenericGetAttr() has already read the Java field
     return value;
 }
 
@@ -745,12 +745,13 @@ int JType_InitSlots(JPy_JType* type)
     typeObj->tp_getattro = (getattrofunc) JObj_getattro;
     typeObj->tp_setattro = (setattrofunc) JObj_setattro;
 
-    // Note: we may later want to add  <sequence> protocol to 'java.lang.String' and 'java.util.List' types.
+    // Note: we may later want to add  <sequence> protocol to 'java.lang.String' types.
     // However, we cannot check directly against these global variable 'JPy_JString' and 'JPy_JList' here because
     // the current function (JType_InitSlots) is called to compute the actual values for the global
     // 'JPy_JString' and 'JPy_JList' variables!
-    // So we actually have to check against the Java Object types in order to create and assign slots for the
-    // Python protocols: java.lang.String --> sequence, java.util.Map --> dict, java.util.List --> list, java.util.Set --> set.
+    // So we actually have to check against the Java classes in order to create and assign slots for the
+    // Python protocols: java.util.Map --> dict and java.util.List --> list are done below, java.lang.String --> sequence
+    // and java.util.Set --> set are not.
 
 
     // If this type is an array type, add support for the <sequence> protocol
@@ -758,6 +759,29 @@ int JType_InitSlots(JPy_JType* type)
         typeObj->tp_as_sequence = &JObj_as_sequence;
     }
 
+    // If this type is assignable to java.util.Iterator or java.lang.Iterable, add support for the <iterator> protocol
+    if (!isArray && !type->isPrimitive && JPy_Iterable_JClass != NULL) {
+        JNIEnv* jenv = JPy_GetJNIEnv();
+        if (jenv == NULL) {
+            return -1;
+        }
+        if ((*jenv)->IsAssignableFrom(jenv, type->classRef, JPy_Iterator_JClass)) {
+            typeObj->tp_iter = PyObject_SelfIter;
+            typeObj->tp_iternext = (iternextfunc) JObj_iternext;
+        } else if ((*jenv)->IsAssignableFrom(jenv, type->classRef, JPy_Iterable_JClass)) {
+            typeObj->tp_iter = (getiterfunc) JObj_iter;
+        }
+
+        // If this type is assignable to java.util.List or java.util.Map, add support for the <sequence> or <mapping> protocol
+        if ((*jenv)->IsAssignableFrom(jenv, type->classRef, JPy_List_JClass)) {
+            typeObj->tp_as_sequence = &JList_as_sequence;
+        } else if ((*jenv)->IsAssignableFrom(jenv, type->classRef, JPy_Map_JClass)) {
+            typeObj->tp_as_sequence = &JMap_as_sequence;
+            typeObj->tp_as_mapping = &JMap_as_mapping;
+            typeObj->tp_iter = (getiterfunc) JMap_iter;
+        }
+    }
+
     if (isPrimitiveArray) {
         const char* componentTypeName = type->componentType->javaName;
         if (strcmp(componentTypeName, "boolean") == 0) {
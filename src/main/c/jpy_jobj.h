@@ -34,6 +34,14 @@ typedef struct JPy_JObj
 {
     PyObject_HEAD
     jobject objectRef;
+    // System.identityHashCode() of the object, only valid if 'identityCached' is set
+    jint identityHash;
+    // If TRUE, this wrapper is registered in the identity cache, see jpy_idcache.h
+    char identityCached;
+    // Object.hashCode() of the object, only valid if 'hashEpoch' is the type's
+    jint hash;
+    // The JPy_JType.hashEpoch at the time 'hash' has been computed, 0 if it hasn't, see JPy_JType.isHashCached
+    unsigned int hashEpoch;
 }
 JPy_JObj;
 
@@ -25,6 +25,9 @@
 #include "jpy_jobj.h"
 #include "jpy_conv.h"
 #include "jpy_compat.h"
+#include "jpy_memstats.h"
+#include "jpy_jweakobj.h"
+#include "jpy_numpy.h"
 
 
 JPy_JType* JType_New(JNIEnv* jenv, jclass classRef, jboolean resolve);
@@ -51,6 +54,44 @@ static int JType_MatchVarArgPyArgAsFPType(const JPy_ParamDescriptor *paramDescri
 static int JType_MatchVarArgPyArgIntType(const JPy_ParamDescriptor *paramDescriptor, PyObject *pyArg, int idx,
                                   struct JPy_JType *expectedComponentType);
 
+/**
+ * Immutable JDK types whose hash codes are cached by default, see JType_SetHashCached().
+ */
+static const char* JType_HashCachedTypeNames[] = {
+    "java.lang.String",
+    "java.lang.Boolean",
+    "java.lang.Character",
+    "java.lang.Byte",
+    "java.lang.Short",
+    "java.lang.Integer",
+    "java.lang.Long",
+    "java.lang.Float",
+    "java.lang.Double",
+    "java.lang.Class",
+    "java.math.BigInteger",
+    "java.math.BigDecimal",
+    "java.util.UUID",
+    "java.time.Duration",
+    "java.time.Instant",
+    "java.time.LocalDate",
+    "java.time.LocalDateTime",
+    "java.time.LocalTime",
+    "java.time.ZonedDateTime",
+    NULL
+};
+
+static char JType_IsHashCachedTypeName(const char* javaName)
+{
+    const char** name;
+
+    for (name = JType_HashCachedTypeNames; *name != NULL; name++) {
+        if (strcmp(*name, javaName) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 JPy_JType* JType_GetTypeForObject(JNIEnv* jenv, jobject objectRef, jboolean resolve)
 {
     JPy_JType* type;
@@ -262,7 +303,7 @@ JPy_JType* JType_New(JNIEnv* jenv, jclass classRef, jboolean resolve)
     // tp_init is used to identify objects instances of type jpy.JType. Make sure it is initially NULL.
     type->typeObj.tp_init = NULL;
 
-    type->classRef = (*jenv)->NewGlobalRef(jenv, classRef);
+    type->classRef = JPy_NewGlobalRef(jenv, classRef, JPy_GREF_CLASS);
     if (type->classRef == NULL) {
         PyMem_Del(type->javaName);
         type->javaName = NULL;
@@ -288,6 +329,9 @@ JPy_JType* JType_New(JNIEnv* jenv, jclass classRef, jboolean resolve)
         return NULL;
     }
 
+    type->isHashCached = JType_IsHashCachedTypeName(type->javaName);
+    type->hashEpoch = 1;
+
     JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JType_New: javaName=\"%s\", resolve=%d, type=%p\n", type->javaName, resolve, type);
 
     return type;
@@ -871,6 +915,21 @@ int JType_ConvertPythonToJavaObject(JNIEnv* jenv, JPy_JType* type, PyObject* pyA
         JPy_DELETE_LOCAL_REF(jobjclass);
     }
 
+    // A weak reference (jpy.weak()) is resolved into a strong local reference
+    if (JWeakObj_Check(pyArg)) {
+        jobject jobj = JWeakObj_NewLocalRef(jenv, (JPy_JWeakObj*) pyArg);
+        if (jobj == NULL) {
+            PyErr_Format(PyExc_ReferenceError, "weakly referenced Java object of type '%s' no longer exists",
+                         ((JPy_JWeakObj*) pyArg)->type->javaName);
+            return -1;
+        }
+        if ((*jenv)->IsInstanceOf(jenv, jobj, type->classRef)) {
+            *objectRef = jobj;
+            return 0;
+        }
+        JPy_DELETE_LOCAL_REF(jobj);
+    }
+
     // If it is already a Java type wrapper JType, and assignable, then we are done
     if (JType_Check(pyArg)) {
         jclass jobj = ((JPy_JType*)pyArg)->classRef;
@@ -1093,6 +1152,9 @@ int JType_InitSuperType(JNIEnv* jenv, JPy_JType* type, jboolean resolve)
         }
         JPy_INCREF(type->superType);
         JPy_DELETE_LOCAL_REF(superClassRef);
+        // Classes loaded after jpy.cache_identity() or jpy.cache_hash() was called for a superclass use the cache too
+        type->isIdentityCached = type->superType->isIdentityCached;
+        type->isHashCached = type->isHashCached || type->superType->isHashCached;
     } else if (type->isInterface && JPy_JObject != NULL) {
         // This solves the problems that java.lang.Object methods can not be called on interfaces (https://github.com/bcdev/jpy/issues/57)
         type->superType = JPy_JObject;
@@ -1104,6 +1166,48 @@ int JType_InitSuperType(JNIEnv* jenv, JPy_JType* type, jboolean resolve)
     return 0;
 }
 
+int JType_IsSubtypeOf(JPy_JType* type, JPy_JType* baseType)
+{
+    while (type != NULL) {
+        if (type == baseType) {
+            return 1;
+        }
+        // Interfaces have java.lang.Object as superType, but don't inherit settings from it
+        if (type->isInterface) {
+            return 0;
+        }
+        type = type->superType;
+    }
+    return 0;
+}
+
+static void JType_SetHashCachedOf(JPy_JType* type, char enabled)
+{
+    if (!enabled && type->isHashCached) {
+        // The objects may be mutated while the setting is off, see JObj_hash()
+        if (++type->hashEpoch == 0) {
+            type->hashEpoch = 1;
+        }
+    }
+    type->isHashCached = enabled;
+}
+
+void JType_SetHashCached(JPy_JType* type, int enabled)
+{
+    PyObject* key;
+    PyObject* value;
+    Py_ssize_t pos = 0;
+
+    JType_SetHashCachedOf(type, (char) (enabled != 0));
+    if (JPy_Types != NULL) {
+        while (PyDict_Next(JPy_Types, &pos, &key, &value)) {
+            if (JType_Check(value) && (JPy_JType*) value != type && JType_IsSubtypeOf((JPy_JType*) value, type)) {
+                JType_SetHashCachedOf((JPy_JType*) value, (char) (enabled != 0));
+            }
+        }
+    }
+}
+
 
 int JType_ProcessClassConstructors(JNIEnv* jenv, JPy_JType* type)
 {
@@ -1478,6 +1582,7 @@ JPy_ReturnDescriptor* JType_CreateReturnDescriptor(JNIEnv* jenv, jclass returnCl
 
     returnDescriptor->type = type;
     returnDescriptor->paramIndex = -1;
+    returnDescriptor->isNumpy = 0;
     JPy_INCREF((PyObject*) type);
 
     JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JType_ProcessReturnType: type->javaName=\"%s\", type=%p\n", type->javaName, type);
@@ -1516,6 +1621,7 @@ JPy_ParamDescriptor* JType_CreateParamDescriptors(JNIEnv* jenv, int paramCount,
         paramDescriptor->isMutable = 0;
         paramDescriptor->isOutput = 0;
         paramDescriptor->isReturn = 0;
+        paramDescriptor->isNumpy = 0;
         paramDescriptor->MatchPyArg = NULL;
         paramDescriptor->MatchVarArgPyArg = NULL;
         paramDescriptor->ConvertPyArg = NULL;
@@ -1674,7 +1780,16 @@ int JType_MatchPyArgAsJPyObjectParam(JNIEnv* jenv, JPy_ParamDescriptor* paramDes
 
 int JType_MatchPyArgAsJObjectParam(JNIEnv* jenv, JPy_ParamDescriptor* paramDescriptor, PyObject* pyArg)
 {
-    return JType_MatchPyArgAsJObject(jenv, paramDescriptor->type, pyArg);
+    int matchValue;
+
+    matchValue = JType_MatchPyArgAsJObject(jenv, paramDescriptor->type, pyArg);
+    if (matchValue == 0 && paramDescriptor->isNumpy
+        && !JObj_Check(pyArg) && !JWeakObj_Check(pyArg) && !JPy_IS_STR(pyArg)
+        && (PyObject_CheckBuffer(pyArg) || PySequence_Check(pyArg))) {
+        // A buffer of another item type or size, which numpy casts to the component type
+        return 10;
+    }
+    return matchValue;
 }
 
 int JType_MatchVarArgPyArgAsJObjectParam(JNIEnv* jenv, JPy_ParamDescriptor* paramDescriptor, PyObject* pyArg, int idx)
@@ -2012,6 +2127,7 @@ int JType_ConvertVarArgPyArgToJObjectArg(JNIEnv* jenv, JPy_ParamDescriptor* para
 
             value->l = jArray;
             disposer->data = pyBuffer;
+            JPy_MemStats_AddArgBuffer(pyBuffer->len);
             disposer->DisposeArg = paramDescriptor->isMutable ? JType_DisposeWritableBufferArg : JType_DisposeReadOnlyBufferArg;
         } else {
             jobject objectRef;
@@ -2075,6 +2191,19 @@ int JType_MatchPyArgAsJObject(JNIEnv* jenv, JPy_JType* paramType, PyObject* pyAr
         return 0;
     }
 
+    if (JWeakObj_Check(pyArg)) {
+        // pyArg is a weak reference to a Java object, which may have been collected
+        JPy_JWeakObj* weakObj = (JPy_JWeakObj*) pyArg;
+        if ((*jenv)->IsSameObject(jenv, weakObj->weakRef, NULL)) {
+            // Let the conversion raise a ReferenceError
+            return 1;
+        }
+        if ((*jenv)->IsInstanceOf(jenv, weakObj->weakRef, paramType->classRef)) {
+            return weakObj->type == paramType ? 100 : 10;
+        }
+        return 0;
+    }
+
     // pyArg is not a Java object
 
     if (paramComponentType != NULL) {
@@ -2256,6 +2385,17 @@ int JType_ConvertPyArgToJObjectArg(JNIEnv* jenv, JPy_ParamDescriptor* paramDescr
 
         JPy_JType* paramType = paramDescriptor->type;
         JPy_JType* paramComponentType = paramType->componentType;
+        PyObject* castArg = NULL;
+
+        if (paramDescriptor->isNumpy && paramComponentType != NULL && paramComponentType->isPrimitive) {
+            // Let numpy cast the items to the component type. If a copy is made, it is kept alive by
+            // the buffer until the argument is disposed, and a mutable argument modifies only the copy.
+            castArg = JPy_Numpy_AsContiguousArray(pyArg, paramComponentType);
+            if (castArg == NULL) {
+                return -1;
+            }
+            pyArg = castArg;
+        }
 
         if (paramComponentType != NULL && paramComponentType->isPrimitive && PyObject_CheckBuffer(pyArg)) {
             Py_buffer* pyBuffer;
@@ -2267,15 +2407,19 @@ int JType_ConvertPyArgToJObjectArg(JNIEnv* jenv, JPy_ParamDescriptor* paramDescr
 
             pyBuffer = PyMem_New(Py_buffer, 1);
             if (pyBuffer == NULL) {
+                Py_XDECREF(castArg);
                 PyErr_NoMemory();
                 return -1;
             }
 
             flags = paramDescriptor->isMutable ? PyBUF_WRITABLE : PyBUF_SIMPLE;
             if (PyObject_GetBuffer(pyArg, pyBuffer, flags) < 0) {
+                Py_XDECREF(castArg);
                 PyMem_Del(pyBuffer);
                 return -1;
             }
+            // The buffer holds its own reference to the cast array
+            Py_XDECREF(castArg);
 
             itemCount = pyBuffer->len / pyBuffer->itemsize;
 
@@ -2344,6 +2488,7 @@ int JType_ConvertPyArgToJObjectArg(JNIEnv* jenv, JPy_ParamDescriptor* paramDescr
 
             value->l = jArray;
             disposer->data = pyBuffer;
+            JPy_MemStats_AddArgBuffer(pyBuffer->len);
             disposer->DisposeArg = paramDescriptor->isMutable ? JType_DisposeWritableBufferArg : JType_DisposeReadOnlyBufferArg;
         } else {
             jobject objectRef;
@@ -2379,6 +2524,7 @@ void JType_DisposeReadOnlyBufferArg(JNIEnv* jenv, jvalue* value, void* data)
     JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "JType_DisposeReadOnlyBufferArg: pyBuffer=%p, jArray=%p\n", pyBuffer, jArray);
 
     if (pyBuffer != NULL) {
+        JPy_MemStats_RemoveArgBuffer(pyBuffer->len);
         PyBuffer_Release(pyBuffer);
         PyMem_Del(pyBuffer);
     }
@@ -2407,9 +2553,11 @@ void JType_DisposeWritableBufferArg(JNIEnv* jenv, jvalue* value, void* data)
             (*jenv)->ReleasePrimitiveArrayCritical(jenv, jArray, arrayItems, 0);
         }
         JPy_DELETE_LOCAL_REF(jArray);
+        JPy_MemStats_RemoveArgBuffer(pyBuffer->len);
         PyBuffer_Release(pyBuffer);
         PyMem_Del(pyBuffer);
     } else if (pyBuffer != NULL) {
+        JPy_MemStats_RemoveArgBuffer(pyBuffer->len);
         PyBuffer_Release(pyBuffer);
         PyMem_Del(pyBuffer);
     } else if (jArray != NULL) {
@@ -2538,7 +2686,7 @@ void JType_dealloc(JPy_JType* self)
     self->javaName = NULL;
 
     if (jenv != NULL && self->classRef != NULL) {
-        (*jenv)->DeleteGlobalRef(jenv, self->classRef);
+        JPy_DeleteGlobalRef(jenv, self->classRef, JPy_GREF_CLASS);
         self->classRef = NULL;
     }
 
@@ -2548,6 +2696,9 @@ void JType_dealloc(JPy_JType* self)
     JPy_XDECREF(self->componentType);
     self->componentType = NULL;
 
+    JPy_XDECREF(self->translation);
+    self->translation = NULL;
+
     Py_TYPE(self)->tp_free((PyObject*) self);
 }
 
@@ -52,6 +52,18 @@ typedef struct JPy_JType
     char isResolving;
     // If TRUE, all the class constructors and methods have already been resolved.
     char isResolved;
+    // The number of live instances of this type holding a JNI global reference, see jpy_memstats.h
+    Py_ssize_t globalRefCount;
+    // If TRUE, wrappers of this type are looked up in the identity cache, see jpy_idcache.h
+    char isIdentityCached;
+    // If TRUE, hashCode() is called only once per wrapper of this type and then cached, see jpy.cache_hash()
+    char isHashCached;
+    // Never 0, incremented when caching is turned off, which invalidates the hash codes cached by wrappers before
+    unsigned int hashEpoch;
+    // The callable from jpy.type_translations applied to wrappers of this type, NULL if none, see jpy_typetrans.h
+    PyObject* translation;
+    // The value of JPy_TypeTranslations_Version when 'translation' was looked up
+    unsigned int translationVersion;
 }
 JPy_JType;
 
@@ -98,6 +110,10 @@ typedef struct JPy_ReturnDescriptor
      * If JPy_ParamDescriptor.isReturnIndex == FALSE it will be -1.
      */
     jint paramIndex;
+    /**
+     * If TRUE, array return values are converted to numpy arrays, see JMethod.set_return_numpy().
+     */
+    jboolean isNumpy;
 }
 JPy_ReturnDescriptor;
 
@@ -110,6 +126,8 @@ typedef struct JPy_ParamDescriptor
     jboolean isMutable;
     jboolean isOutput;
     jboolean isReturn;
+    // Cast arguments with numpy to the primitive array type, see JMethod.set_param_numpy()
+    jboolean isNumpy;
     JPy_MatchPyArg MatchPyArg;
     JPy_MatchVarArgPyArg MatchVarArgPyArg;
     JPy_ConvertPyArg ConvertPyArg;
@@ -120,6 +138,18 @@ JPy_ParamDescriptor;
 
 int JType_Check(PyObject* obj);
 
+/**
+ * Returns non-zero if 'type' is 'baseType' or one of its subclasses. Interfaces are not considered
+ * subclasses of java.lang.Object here, although it is their 'superType'.
+ */
+int JType_IsSubtypeOf(JPy_JType* type, JPy_JType* baseType);
+
+/**
+ * Enables or disables caching the hash codes of wrappers of the given type and its loaded subclasses.
+ * Types loaded later inherit the setting from their superclass.
+ */
+void JType_SetHashCached(JPy_JType* type, int enabled);
+
 JPy_JType* JType_GetTypeForObject(JNIEnv* jenv, jobject objectRef, jboolean resolve);
 JPy_JType* JType_GetTypeForName(JNIEnv* jenv, const char* typeName, jboolean resolve);
 JPy_JType* JType_GetType(JNIEnv* jenv, jclass classRef, jboolean resolve);
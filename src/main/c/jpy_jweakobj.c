@@ -0,0 +1,242 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_jtype.h"
+#include "jpy_jobj.h"
+#include "jpy_jweakobj.h"
+#include "jpy_memstats.h"
+
+
+PyObject* JWeakObj_New(JNIEnv* jenv, JPy_JObj* obj)
+{
+    JPy_JWeakObj* self;
+    jint identityHash;
+
+    identityHash = (*jenv)->CallStaticIntMethod(jenv, JPy_System_JClass, JPy_System_IdentityHashCode_SMID, obj->objectRef);
+    JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
+
+    self = PyObject_New(JPy_JWeakObj, &JWeakObj_Type);
+    if (self == NULL) {
+        return NULL;
+    }
+
+    self->type = (JPy_JType*) Py_TYPE(obj);
+    JPy_INCREF(self->type);
+    self->identityHash = identityHash;
+    self->weakRef = JPy_NewWeakGlobalRef(jenv, obj->objectRef);
+    if (self->weakRef == NULL) {
+        JPy_DECREF(self);
+        return PyErr_NoMemory();
+    }
+
+    return (PyObject*) self;
+}
+
+jobject JWeakObj_NewLocalRef(JNIEnv* jenv, JPy_JWeakObj* self)
+{
+    // Returns NULL if the object has been collected, so this is also the safe liveness check
+    return (*jenv)->NewLocalRef(jenv, self->weakRef);
+}
+
+/**
+ * Returns a new JObj wrapper of the referenced object, or NULL without an error set if it has been collected.
+ */
+static PyObject* JWeakObj_Resolve(JNIEnv* jenv, JPy_JWeakObj* self)
+{
+    jobject objectRef;
+    PyObject* obj;
+
+    objectRef = JWeakObj_NewLocalRef(jenv, self);
+    if (objectRef == NULL) {
+        return NULL;
+    }
+    obj = JObj_FromType(jenv, self->type, objectRef);
+    JPy_DELETE_LOCAL_REF(objectRef);
+    return obj;
+}
+
+/**
+ * The JWeakObj type's tp_call slot. Python: obj = weak_obj()
+ */
+static PyObject* JWeakObj_call(JPy_JWeakObj* self, PyObject* args, PyObject* kwds)
+{
+    JNIEnv* jenv;
+    PyObject* obj;
+
+    if (!PyArg_ParseTuple(args, ":__call__")) {
+        return NULL;
+    }
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+
+    obj = JWeakObj_Resolve(jenv, self);
+    if (obj == NULL && !PyErr_Occurred()) {
+        return Py_BuildValue("");
+    }
+    return obj;
+}
+
+/**
+ * The JWeakObj type's tp_getattro slot. Attributes other than the own ones are looked up on a
+ * temporary wrapper of the referenced object.
+ */
+static PyObject* JWeakObj_getattro(JPy_JWeakObj* self, PyObject* name)
+{
+    JNIEnv* jenv;
+    PyObject* obj;
+    PyObject* value;
+
+    value = PyObject_GenericGetAttr((PyObject*) self, name);
+    if (value != NULL || !PyErr_ExceptionMatches(PyExc_AttributeError)) {
+        return value;
+    }
+    PyErr_Clear();
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+
+    obj = JWeakObj_Resolve(jenv, self);
+    if (obj == NULL) {
+        if (!PyErr_Occurred()) {
+            PyErr_Format(PyExc_ReferenceError, "weakly referenced Java object of type '%s' no longer exists", self->type->javaName);
+        }
+        return NULL;
+    }
+    value = PyObject_GetAttr(obj, name);
+    JPy_DECREF(obj);
+    return value;
+}
+
+static PyObject* JWeakObj_get_alive(JPy_JWeakObj* self, void* closure)
+{
+    JNIEnv* jenv;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+    return PyBool_FromLong(!(*jenv)->IsSameObject(jenv, self->weakRef, NULL));
+}
+
+static PyObject* JWeakObj_get_type(JPy_JWeakObj* self, void* closure)
+{
+    JPy_INCREF(self->type);
+    return (PyObject*) self->type;
+}
+
+static long JWeakObj_hash(JPy_JWeakObj* self)
+{
+    // -1 is reserved for errors
+    return self->identityHash == -1 ? -2 : self->identityHash;
+}
+
+/**
+ * The JWeakObj type's tp_richcompare slot. Weak objects are equal if they refer to the same Java
+ * object, or if they are identical once it has been collected.
+ */
+static PyObject* JWeakObj_richcompare(PyObject* self, PyObject* other, int opid)
+{
+    JNIEnv* jenv;
+    jweak ref1;
+    jweak ref2;
+    int same;
+
+    if ((opid != Py_EQ && opid != Py_NE) || !JWeakObj_Check(other)) {
+        Py_INCREF(Py_NotImplemented);
+        return Py_NotImplemented;
+    }
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+
+    ref1 = ((JPy_JWeakObj*) self)->weakRef;
+    ref2 = ((JPy_JWeakObj*) other)->weakRef;
+    same = self == other
+           || ((*jenv)->IsSameObject(jenv, ref1, ref2) && !(*jenv)->IsSameObject(jenv, ref1, NULL));
+    return PyBool_FromLong(opid == Py_EQ ? same : !same);
+}
+
+static PyObject* JWeakObj_repr(JPy_JWeakObj* self)
+{
+    JNIEnv* jenv;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+    return JPy_FROM_FORMAT("<jpy.JWeakObj at %p; %s '%s'>", self,
+                           (*jenv)->IsSameObject(jenv, self->weakRef, NULL) ? "dead" : "to",
+                           self->type->javaName);
+}
+
+static void JWeakObj_dealloc(JPy_JWeakObj* self)
+{
+    JNIEnv* jenv;
+
+    if (self->weakRef != NULL) {
+        jenv = JPy_GetJNIEnv();
+        if (jenv != NULL) {
+            JPy_DeleteWeakGlobalRef(jenv, self->weakRef);
+        }
+        self->weakRef = NULL;
+    }
+    JPy_XDECREF(self->type);
+
+    Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+static PyGetSetDef JWeakObj_getset[] = {
+    {"alive", (getter) JWeakObj_get_alive, NULL, "True until the referenced Java object has been garbage collected", NULL},
+    {"type", (getter) JWeakObj_get_type, NULL, "The Java type of the referenced object", NULL},
+    {NULL}  /* Sentinel */
+};
+
+PyTypeObject JWeakObj_Type =
+{
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "jpy.JWeakObj",                             /* tp_name */
+    sizeof (JPy_JWeakObj),                      /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor) JWeakObj_dealloc,              /* tp_dealloc */
+    NULL,                                       /* tp_print */
+    NULL,                                       /* tp_getattr */
+    NULL,                                       /* tp_setattr */
+    NULL,                                       /* tp_reserved */
+    (reprfunc) JWeakObj_repr,                   /* tp_repr */
+    NULL,                                       /* tp_as_number */
+    NULL,                                       /* tp_as_sequence */
+    NULL,                                       /* tp_as_mapping */
+    (hashfunc) JWeakObj_hash,                   /* tp_hash  */
+    (ternaryfunc) JWeakObj_call,                /* tp_call */
+    NULL,                                       /* tp_str */
+    (getattrofunc) JWeakObj_getattro,           /* tp_getattro */
+    NULL,                                       /* tp_setattro */
+    NULL,                                       /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                         /* tp_flags */
+    "Weak reference to a Java object, see jpy.weak()",   /* tp_doc */
+    NULL,                                       /* tp_traverse */
+    NULL,                                       /* tp_clear */
+    (richcmpfunc) JWeakObj_richcompare,         /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    NULL,                                       /* tp_iter */
+    NULL,                                       /* tp_iternext */
+    NULL,                                       /* tp_methods */
+    NULL,                                       /* tp_members */
+    JWeakObj_getset,                            /* tp_getset */
+    NULL,                                       /* tp_base */
+    NULL,                                       /* tp_dict */
+    NULL,                                       /* tp_descr_get */
+    NULL,                                       /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    NULL,                                       /* tp_init */
+    NULL,                                       /* tp_alloc */
+    NULL,                                       /* tp_new */
+};
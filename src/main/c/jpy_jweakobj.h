@@ -0,0 +1,69 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#ifndef JPY_JWEAKOBJ_H
+#define JPY_JWEAKOBJ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+
+struct JPy_JType;
+struct JPy_JObj;
+
+/**
+ * A weak reference to a Java object, created by jpy.weak(obj).
+ *
+ * Unlike JObj, it holds a JNI weak global reference, so it doesn't keep the Java object alive.
+ * Calling it returns a JObj wrapper of the object, or None if the object has been garbage collected.
+ * Attributes other than its own are looked up on such a temporary wrapper, and passed as an argument
+ * to a Java method, it is resolved to a strong local reference for the duration of the call only.
+ * Weak objects hash and compare by the identity of the Java object.
+ */
+typedef struct JPy_JWeakObj
+{
+    PyObject_HEAD
+    jweak weakRef;
+    // The Java type of the referenced object
+    struct JPy_JType* type;
+    // System.identityHashCode() of the referenced object
+    jint identityHash;
+}
+JPy_JWeakObj;
+
+extern PyTypeObject JWeakObj_Type;
+
+/**
+ * Creates a new weak reference to the Java object wrapped by obj. Returns a new reference.
+ */
+PyObject* JWeakObj_New(JNIEnv* jenv, struct JPy_JObj* obj);
+
+/**
+ * Returns a new local reference to the referenced Java object, or NULL if it has been garbage collected.
+ */
+jobject JWeakObj_NewLocalRef(JNIEnv* jenv, JPy_JWeakObj* self);
+
+#define JWeakObj_Check(obj) PyObject_TypeCheck(obj, &JWeakObj_Type)
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_JWEAKOBJ_H */
@@ -0,0 +1,304 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_jtype.h"
+#include "jpy_conv.h"
+#include "jpy_mapproxy.h"
+#include "jpy_memstats.h"
+
+int JPy_LazyMapNamespaces = 0;
+
+
+PyObject* MapProxy_New(JNIEnv* jenv, jobject mapRef)
+{
+    JPy_MapProxy* proxy;
+
+    proxy = (JPy_MapProxy*) PyObject_CallObject((PyObject*) &MapProxy_Type, NULL);
+    if (proxy == NULL) {
+        return NULL;
+    }
+
+    proxy->loaded = PyDict_New();
+    proxy->absent = PyDict_New();
+    proxy->deleted = PyDict_New();
+    if (proxy->loaded == NULL || proxy->absent == NULL || proxy->deleted == NULL) {
+        JPy_DECREF(proxy);
+        return NULL;
+    }
+
+    proxy->mapRef = JPy_NewGlobalRef(jenv, mapRef, JPy_GREF_MAP);
+    if (proxy->mapRef == NULL) {
+        JPy_DECREF(proxy);
+        return PyErr_NoMemory();
+    }
+
+    return (PyObject*) proxy;
+}
+
+/**
+ * Looks up the given key in the Java Map and caches the converted value in the proxy.
+ * Returns a borrowed reference, or NULL if the key is not in the Java Map or an error occurred.
+ */
+static PyObject* MapProxy_Load(JPy_MapProxy* self, PyObject* key)
+{
+    JNIEnv* jenv;
+    jstring jKey;
+    jobject jValue;
+    jboolean found;
+    PyObject* value;
+
+    if (!JPy_IS_STR(key) || self->mapRef == NULL || PyDict_GetItem(self->absent, key) != NULL) {
+        return NULL;
+    }
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+
+    if (JPy_AsJString(jenv, key, &jKey) < 0) {
+        return NULL;
+    }
+
+    jValue = (*jenv)->CallObjectMethod(jenv, self->mapRef, JPy_Map_get_MID, jKey);
+    if ((*jenv)->ExceptionCheck(jenv)) {
+        JPy_DELETE_LOCAL_REF(jKey);
+        JPy_HandleJavaException(jenv);
+        return NULL;
+    }
+
+    if (jValue == NULL) {
+        // get() doesn't tell a missing key from a null value
+        found = (*jenv)->CallBooleanMethod(jenv, self->mapRef, JPy_Map_containsKey_MID, jKey);
+        JPy_DELETE_LOCAL_REF(jKey);
+        JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
+        if (!found) {
+            // NULL without an error means "not found", so a failure to remember the miss must keep its error set
+            if (PyDict_SetItem(self->absent, key, Py_None) < 0) {
+                return NULL;
+            }
+            return NULL;
+        }
+        value = JPy_FROM_JNULL();
+    } else {
+        JPy_DELETE_LOCAL_REF(jKey);
+        value = JPy_FromJObject(jenv, jValue);
+        JPy_DELETE_LOCAL_REF(jValue);
+        if (value == NULL) {
+            return NULL;
+        }
+    }
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "MapProxy_Load: loaded key '%s' from Java Map\n", JPy_AS_UTF8(key));
+
+    if (PyDict_SetItem((PyObject*) self, key, value) < 0 || PyDict_SetItem(self->loaded, key, value) < 0) {
+        JPy_DECREF(value);
+        return NULL;
+    }
+    JPy_DECREF(value);
+    return value;
+}
+
+static PyObject* MapProxy_subscript(JPy_MapProxy* self, PyObject* key)
+{
+    PyObject* value;
+
+    value = PyDict_GetItem((PyObject*) self, key);
+    if (value == NULL) {
+        value = MapProxy_Load(self, key);
+        if (value == NULL) {
+            if (!PyErr_Occurred()) {
+                PyErr_SetObject(PyExc_KeyError, key);
+            }
+            return NULL;
+        }
+    }
+
+    JPy_INCREF(value);
+    return value;
+}
+
+static int MapProxy_ass_subscript(JPy_MapProxy* self, PyObject* key, PyObject* value)
+{
+    if (value != NULL) {
+        if (PyDict_SetItem((PyObject*) self, key, value) < 0) {
+            return -1;
+        }
+        if (PyDict_GetItem(self->absent, key) != NULL && PyDict_DelItem(self->absent, key) < 0) {
+            return -1;
+        }
+        if (PyDict_GetItem(self->deleted, key) != NULL && PyDict_DelItem(self->deleted, key) < 0) {
+            return -1;
+        }
+        return 0;
+    }
+
+    if (PyDict_GetItem((PyObject*) self, key) == NULL && MapProxy_Load(self, key) == NULL) {
+        if (!PyErr_Occurred()) {
+            PyErr_SetObject(PyExc_KeyError, key);
+        }
+        return -1;
+    }
+    if (PyDict_DelItem((PyObject*) self, key) < 0) {
+        return -1;
+    }
+    if (JPy_IS_STR(key)) {
+        if (PyDict_SetItem(self->absent, key, Py_None) < 0 || PyDict_SetItem(self->deleted, key, Py_None) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int MapProxy_contains(JPy_MapProxy* self, PyObject* key)
+{
+    if (PyDict_GetItem((PyObject*) self, key) != NULL) {
+        return 1;
+    }
+    if (MapProxy_Load(self, key) != NULL) {
+        return 1;
+    }
+    return PyErr_Occurred() ? -1 : 0;
+}
+
+static PyObject* MapProxy_get(JPy_MapProxy* self, PyObject* args)
+{
+    PyObject* key;
+    PyObject* defaultValue = Py_None;
+    PyObject* value;
+
+    if (!PyArg_ParseTuple(args, "O|O:get", &key, &defaultValue)) {
+        return NULL;
+    }
+
+    value = PyDict_GetItem((PyObject*) self, key);
+    if (value == NULL) {
+        value = MapProxy_Load(self, key);
+        if (value == NULL) {
+            if (PyErr_Occurred()) {
+                return NULL;
+            }
+            value = defaultValue;
+        }
+    }
+
+    JPy_INCREF(value);
+    return value;
+}
+
+static int MapProxy_traverse(JPy_MapProxy* self, visitproc visit, void* arg)
+{
+    Py_VISIT(self->loaded);
+    Py_VISIT(self->absent);
+    Py_VISIT(self->deleted);
+    return PyDict_Type.tp_traverse((PyObject*) self, visit, arg);
+}
+
+static int MapProxy_clear(JPy_MapProxy* self)
+{
+    Py_CLEAR(self->loaded);
+    Py_CLEAR(self->absent);
+    Py_CLEAR(self->deleted);
+    return PyDict_Type.tp_clear((PyObject*) self);
+}
+
+static void MapProxy_dealloc(JPy_MapProxy* self)
+{
+    JNIEnv* jenv;
+
+    PyObject_GC_UnTrack(self);
+    Py_CLEAR(self->loaded);
+    Py_CLEAR(self->absent);
+    Py_CLEAR(self->deleted);
+
+    if (self->mapRef != NULL) {
+        jenv = JPy_GetJNIEnv();
+        if (jenv != NULL) {
+            JPy_DeleteGlobalRef(jenv, self->mapRef, JPy_GREF_MAP);
+        }
+        self->mapRef = NULL;
+    }
+
+    PyDict_Type.tp_dealloc((PyObject*) self);
+}
+
+static PyMappingMethods MapProxy_as_mapping = {
+    NULL,                                       /* mp_length (inherited) */
+    (binaryfunc) MapProxy_subscript,            /* mp_subscript */
+    (objobjargproc) MapProxy_ass_subscript,     /* mp_ass_subscript */
+};
+
+static PySequenceMethods MapProxy_as_sequence = {
+    NULL,                                       /* sq_length */
+    NULL,                                       /* sq_concat */
+    NULL,                                       /* sq_repeat */
+    NULL,                                       /* sq_item */
+    NULL,                                       /* was_sq_slice */
+    NULL,                                       /* sq_ass_item */
+    NULL,                                       /* was_sq_ass_slice */
+    (objobjproc) MapProxy_contains,             /* sq_contains */
+    NULL,                                       /* sq_inplace_concat */
+    NULL,                                       /* sq_inplace_repeat */
+};
+
+static PyMethodDef MapProxy_methods[] = {
+    {"get", (PyCFunction) MapProxy_get, METH_VARARGS, "D.get(k[,d]) -> D[k] if k in D, else d. Looks up k in the Java Map if not yet loaded."},
+    {NULL}  /* Sentinel */
+};
+
+PyTypeObject MapProxy_Type =
+{
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "jpy.MapProxy",                             /* tp_name */
+    sizeof (JPy_MapProxy),                      /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor) MapProxy_dealloc,              /* tp_dealloc */
+    NULL,                                       /* tp_print */
+    NULL,                                       /* tp_getattr */
+    NULL,                                       /* tp_setattr */
+    NULL,                                       /* tp_reserved */
+    NULL,                                       /* tp_repr */
+    NULL,                                       /* tp_as_number */
+    &MapProxy_as_sequence,                      /* tp_as_sequence */
+    &MapProxy_as_mapping,                       /* tp_as_mapping */
+    NULL,                                       /* tp_hash  */
+    NULL,                                       /* tp_call */
+    NULL,                                       /* tp_str */
+    NULL,                                       /* tp_getattro */
+    NULL,                                       /* tp_setattro */
+    NULL,                                       /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,    /* tp_flags */
+    "Lazily loaded namespace backed by a Java Map",   /* tp_doc */
+    (traverseproc) MapProxy_traverse,           /* tp_traverse */
+    (inquiry) MapProxy_clear,                   /* tp_clear */
+    NULL,                                       /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    NULL,                                       /* tp_iter */
+    NULL,                                       /* tp_iternext */
+    MapProxy_methods,                           /* tp_methods */
+    NULL,                                       /* tp_members */
+    NULL,                                       /* tp_getset */
+    &PyDict_Type,                               /* tp_base */
+    NULL,                                       /* tp_dict */
+    NULL,                                       /* tp_descr_get */
+    NULL,                                       /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    NULL,                                       /* tp_init */
+    NULL,                                       /* tp_alloc */
+    NULL,                                       /* tp_new */
+};
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#ifndef JPY_MAPPROXY_H
+#define JPY_MAPPROXY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+
+/**
+ * A dict subclass used as globals/locals namespace for code executed with a Java Map.
+ *
+ * Entries are converted from the Java Map only when they are looked up and are then cached in the
+ * dict itself. The 'loaded' dict remembers the Python values obtained from the Java Map, so that
+ * only new or rebound entries need to be written back. Keys in 'absent' are known not to be in the
+ * Java Map (or have been deleted by Python); keys in 'deleted' must be removed from the Java Map.
+ */
+typedef struct JPy_MapProxy
+{
+    PyDictObject dict;
+    // Global reference to the java.util.Map<String, Object>
+    jobject mapRef;
+    PyObject* loaded;
+    PyObject* absent;
+    PyObject* deleted;
+}
+JPy_MapProxy;
+
+extern PyTypeObject MapProxy_Type;
+
+/**
+ * If non-zero, Java Maps passed as globals/locals to PyLib.executeCode()/executeScript() are
+ * wrapped by a MapProxy instead of being copied into a new dictionary.
+ */
+extern int JPy_LazyMapNamespaces;
+
+/**
+ * Creates a new MapProxy for the given java.util.Map<String, Object>. Returns a new reference.
+ */
+PyObject* MapProxy_New(JNIEnv* jenv, jobject mapRef);
+
+#define MapProxy_Check(obj) PyObject_TypeCheck(obj, &MapProxy_Type)
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_MAPPROXY_H */
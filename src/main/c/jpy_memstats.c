@@ -0,0 +1,298 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_jtype.h"
+#include "jpy_conv.h"
+#include "jpy_memstats.h"
+#include "jpy_idcache.h"
+
+jlong JPy_GlobalRefLimit = 0;
+jlong JPy_BufferBytesLimit = 0;
+
+static const char* JPy_MemStats_KindNames[JPy_GREF_KIND_COUNT] = {
+    "object",
+    "class",
+    "exception",
+    "map",
+};
+
+static jlong JPy_MemStats_GlobalRefs[JPy_GREF_KIND_COUNT];
+static jlong JPy_MemStats_GlobalRefCount = 0;
+static jlong JPy_MemStats_GlobalRefPeak = 0;
+static jlong JPy_MemStats_GlobalRefsCreated = 0;
+static jlong JPy_MemStats_GlobalRefsDeleted = 0;
+static jlong JPy_MemStats_WeakGlobalRefCount = 0;
+
+static jlong JPy_MemStats_ArrayBuffers = 0;
+static jlong JPy_MemStats_ArrayBufferBytes = 0;
+static jlong JPy_MemStats_ArrayBufferCopiedBytes = 0;
+static jlong JPy_MemStats_ArgBuffers = 0;
+static jlong JPy_MemStats_ArgBufferBytes = 0;
+static jlong JPy_MemStats_ArgBufferPeak = 0;
+static jlong JPy_MemStats_BufferBytesPeak = 0;
+
+static int JPy_MemStats_GlobalRefAlertArmed = 1;
+static int JPy_MemStats_BufferAlertArmed = 1;
+static jlong JPy_MemStats_Alerts = 0;
+
+
+/**
+ * Issues a RuntimeWarning the first time value exceeds limit, and re-arms the alert once value fell
+ * below 90% of the limit again.
+ */
+static void JPy_MemStats_CheckLimit(jlong value, jlong limit, int* armed, const char* what)
+{
+    PyObject* type;
+    PyObject* error;
+    PyObject* traceback;
+    char message[256];
+
+    if (limit <= 0) {
+        return;
+    }
+    if (!*armed) {
+        if (value < limit - limit / 10) {
+            *armed = 1;
+        }
+        return;
+    }
+    if (value <= limit) {
+        return;
+    }
+
+    // Disarm first, the warning may run Python code which releases further references
+    *armed = 0;
+    JPy_MemStats_Alerts++;
+    PyOS_snprintf(message, sizeof (message), "jpy: %s (%lld) exceeded the limit of %lld",
+                  what, (long long) value, (long long) limit);
+    JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "JPy_MemStats_CheckLimit: %s\n", message);
+
+    // The alert must not fail the operation which crossed the limit
+    PyErr_Fetch(&type, &error, &traceback);
+    if (PyErr_WarnEx(PyExc_RuntimeWarning, message, 1) < 0) {
+        PyErr_Clear();
+    }
+    PyErr_Restore(type, error, traceback);
+}
+
+static void JPy_MemStats_BufferBytesChanged(void)
+{
+    jlong bytes = JPy_MemStats_ArrayBufferBytes + JPy_MemStats_ArgBufferBytes;
+    if (bytes > JPy_MemStats_BufferBytesPeak) {
+        JPy_MemStats_BufferBytesPeak = bytes;
+    }
+    JPy_MemStats_CheckLimit(bytes, JPy_BufferBytesLimit, &JPy_MemStats_BufferAlertArmed, "native buffer bytes");
+}
+
+jobject JPy_NewGlobalRef(JNIEnv* jenv, jobject ref, int kind)
+{
+    jobject globalRef;
+
+    globalRef = (*jenv)->NewGlobalRef(jenv, ref);
+    if (globalRef == NULL) {
+        return NULL;
+    }
+    JPy_MemStats_GlobalRefs[kind]++;
+    JPy_MemStats_GlobalRefsCreated++;
+    JPy_MemStats_GlobalRefCount++;
+    if (JPy_MemStats_GlobalRefCount > JPy_MemStats_GlobalRefPeak) {
+        JPy_MemStats_GlobalRefPeak = JPy_MemStats_GlobalRefCount;
+    }
+    JPy_MemStats_CheckLimit(JPy_MemStats_GlobalRefCount, JPy_GlobalRefLimit, &JPy_MemStats_GlobalRefAlertArmed, "JNI global references");
+    return globalRef;
+}
+
+void JPy_DeleteGlobalRef(JNIEnv* jenv, jobject ref, int kind)
+{
+    if (ref == NULL) {
+        return;
+    }
+    (*jenv)->DeleteGlobalRef(jenv, ref);
+    JPy_MemStats_GlobalRefs[kind]--;
+    JPy_MemStats_GlobalRefsDeleted++;
+    JPy_MemStats_GlobalRefCount--;
+    JPy_MemStats_CheckLimit(JPy_MemStats_GlobalRefCount, JPy_GlobalRefLimit, &JPy_MemStats_GlobalRefAlertArmed, "JNI global references");
+}
+
+jweak JPy_NewWeakGlobalRef(JNIEnv* jenv, jobject ref)
+{
+    jweak weakRef;
+
+    weakRef = (*jenv)->NewWeakGlobalRef(jenv, ref);
+    if (weakRef != NULL) {
+        JPy_MemStats_WeakGlobalRefCount++;
+    }
+    return weakRef;
+}
+
+void JPy_DeleteWeakGlobalRef(JNIEnv* jenv, jweak ref)
+{
+    if (ref == NULL) {
+        return;
+    }
+    (*jenv)->DeleteWeakGlobalRef(jenv, ref);
+    JPy_MemStats_WeakGlobalRefCount--;
+}
+
+void JPy_MemStats_AddArrayBuffer(Py_ssize_t bytes, int isCopy)
+{
+    JPy_MemStats_ArrayBuffers++;
+    JPy_MemStats_ArrayBufferBytes += bytes;
+    if (isCopy) {
+        JPy_MemStats_ArrayBufferCopiedBytes += bytes;
+    }
+    JPy_MemStats_BufferBytesChanged();
+}
+
+void JPy_MemStats_RemoveArrayBuffer(Py_ssize_t bytes, int isCopy)
+{
+    JPy_MemStats_ArrayBuffers--;
+    JPy_MemStats_ArrayBufferBytes -= bytes;
+    if (isCopy) {
+        JPy_MemStats_ArrayBufferCopiedBytes -= bytes;
+    }
+    JPy_MemStats_BufferBytesChanged();
+}
+
+void JPy_MemStats_AddArgBuffer(Py_ssize_t bytes)
+{
+    JPy_MemStats_ArgBuffers++;
+    JPy_MemStats_ArgBufferBytes += bytes;
+    if (JPy_MemStats_ArgBuffers > JPy_MemStats_ArgBufferPeak) {
+        JPy_MemStats_ArgBufferPeak = JPy_MemStats_ArgBuffers;
+    }
+    JPy_MemStats_BufferBytesChanged();
+}
+
+void JPy_MemStats_RemoveArgBuffer(Py_ssize_t bytes)
+{
+    JPy_MemStats_ArgBuffers--;
+    JPy_MemStats_ArgBufferBytes -= bytes;
+    JPy_MemStats_BufferBytesChanged();
+}
+
+jlong JPy_MemStats_GetGlobalRefCount(void)
+{
+    return JPy_MemStats_GlobalRefCount;
+}
+
+static int JPy_MemStats_SetLong(PyObject* dict, const char* key, jlong value)
+{
+    PyObject* pyValue;
+    int result;
+
+    pyValue = JPy_FROM_JLONG(value);
+    if (pyValue == NULL) {
+        return -1;
+    }
+    result = PyDict_SetItemString(dict, key, pyValue);
+    JPy_DECREF(pyValue);
+    return result;
+}
+
+/**
+ * Returns a new dictionary mapping Java type names to the number of their live wrapped instances.
+ */
+static PyObject* JPy_MemStats_GetRefsByType(void)
+{
+    PyObject* dict;
+    PyObject* key;
+    PyObject* value;
+    Py_ssize_t pos = 0;
+    JPy_JType* type;
+
+    dict = PyDict_New();
+    if (dict == NULL || JPy_Types == NULL) {
+        return dict;
+    }
+    while (PyDict_Next(JPy_Types, &pos, &key, &value)) {
+        if (!JType_Check(value)) {
+            continue;
+        }
+        type = (JPy_JType*) value;
+        if (type->globalRefCount > 0 && JPy_MemStats_SetLong(dict, type->javaName, type->globalRefCount) < 0) {
+            JPy_DECREF(dict);
+            return NULL;
+        }
+    }
+    return dict;
+}
+
+PyObject* JPy_MemStats_Get(int resetPeaks)
+{
+    PyObject* stats;
+    PyObject* dict;
+    int i;
+
+    stats = PyDict_New();
+    if (stats == NULL) {
+        return NULL;
+    }
+    if (JPy_MemStats_SetLong(stats, "global_refs", JPy_MemStats_GlobalRefCount) < 0
+        || JPy_MemStats_SetLong(stats, "global_refs_peak", JPy_MemStats_GlobalRefPeak) < 0
+        || JPy_MemStats_SetLong(stats, "global_refs_created", JPy_MemStats_GlobalRefsCreated) < 0
+        || JPy_MemStats_SetLong(stats, "global_refs_deleted", JPy_MemStats_GlobalRefsDeleted) < 0
+        || JPy_MemStats_SetLong(stats, "weak_global_refs", JPy_MemStats_WeakGlobalRefCount) < 0
+        || JPy_MemStats_SetLong(stats, "array_buffers", JPy_MemStats_ArrayBuffers) < 0
+        || JPy_MemStats_SetLong(stats, "array_buffer_bytes", JPy_MemStats_ArrayBufferBytes) < 0
+        || JPy_MemStats_SetLong(stats, "array_buffer_copied_bytes", JPy_MemStats_ArrayBufferCopiedBytes) < 0
+        || JPy_MemStats_SetLong(stats, "arg_buffers", JPy_MemStats_ArgBuffers) < 0
+        || JPy_MemStats_SetLong(stats, "arg_buffers_peak", JPy_MemStats_ArgBufferPeak) < 0
+        || JPy_MemStats_SetLong(stats, "arg_buffer_bytes", JPy_MemStats_ArgBufferBytes) < 0
+        || JPy_MemStats_SetLong(stats, "buffer_bytes", JPy_MemStats_ArrayBufferBytes + JPy_MemStats_ArgBufferBytes) < 0
+        || JPy_MemStats_SetLong(stats, "buffer_bytes_peak", JPy_MemStats_BufferBytesPeak) < 0
+        || JPy_MemStats_SetLong(stats, "global_ref_limit", JPy_GlobalRefLimit) < 0
+        || JPy_MemStats_SetLong(stats, "buffer_bytes_limit", JPy_BufferBytesLimit) < 0
+        || JPy_MemStats_SetLong(stats, "alerts", JPy_MemStats_Alerts) < 0
+        || JPy_MemStats_SetLong(stats, "identity_cache_entries", JPy_IdentityCache_Size()) < 0) {
+        goto error;
+    }
+
+    dict = PyDict_New();
+    if (dict == NULL || PyDict_SetItemString(stats, "global_refs_by_kind", dict) < 0) {
+        JPy_XDECREF(dict);
+        goto error;
+    }
+    JPy_DECREF(dict);
+    for (i = 0; i < JPy_GREF_KIND_COUNT; i++) {
+        if (JPy_MemStats_SetLong(dict, JPy_MemStats_KindNames[i], JPy_MemStats_GlobalRefs[i]) < 0) {
+            goto error;
+        }
+    }
+
+    dict = JPy_MemStats_GetRefsByType();
+    if (dict == NULL || PyDict_SetItemString(stats, "global_refs_by_type", dict) < 0) {
+        JPy_XDECREF(dict);
+        goto error;
+    }
+    JPy_DECREF(dict);
+
+    if (resetPeaks) {
+        JPy_MemStats_GlobalRefPeak = JPy_MemStats_GlobalRefCount;
+        JPy_MemStats_ArgBufferPeak = JPy_MemStats_ArgBuffers;
+        JPy_MemStats_BufferBytesPeak = JPy_MemStats_ArrayBufferBytes + JPy_MemStats_ArgBufferBytes;
+    }
+    return stats;
+
+error:
+    JPy_DECREF(stats);
+    return NULL;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#ifndef JPY_MEMSTATS_H
+#define JPY_MEMSTATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+
+/**
+ * Accounting of the JNI global references and native buffers held by jpy.
+ *
+ * The counters are always on; they are updated by the thread holding the GIL, like the call metrics
+ * in jpy_metrics.h. Read them with jpy.diag.memory_stats() or PyLib.Diag.getMemoryStats().
+ */
+
+/**
+ * What a JNI global reference created by jpy is held for.
+ */
+#define JPy_GREF_OBJECT     0   // Java objects and arrays wrapped by JObj/JArray instances
+#define JPy_GREF_CLASS      1   // Java classes of JTypes and the classes cached in jpy_module.c
+#define JPy_GREF_EXCEPTION  2   // Java throwables held by jpy.JException instances
+#define JPy_GREF_MAP        3   // Java Maps backing MapProxy namespaces
+#define JPy_GREF_KIND_COUNT 4
+
+/**
+ * Limits for the number of live global references and the bytes of native buffers (exported array
+ * buffers plus Python buffers passed as Java arrays). When a limit is exceeded, a RuntimeWarning is
+ * issued. It is issued again only after the value fell below 90% of the limit. 0 means no limit.
+ */
+extern jlong JPy_GlobalRefLimit;
+extern jlong JPy_BufferBytesLimit;
+
+/**
+ * Creates a JNI global reference and counts it for the given kind. Returns NULL if the JVM is out of memory.
+ */
+jobject JPy_NewGlobalRef(JNIEnv* jenv, jobject ref, int kind);
+
+/**
+ * Deletes a JNI global reference created by JPy_NewGlobalRef() with the same kind.
+ */
+void JPy_DeleteGlobalRef(JNIEnv* jenv, jobject ref, int kind);
+
+/**
+ * Creates a JNI weak global reference and counts it. Weak global references are counted separately,
+ * they don't keep Java objects alive. Returns NULL if the JVM is out of memory.
+ */
+jweak JPy_NewWeakGlobalRef(JNIEnv* jenv, jobject ref);
+
+/**
+ * Deletes a JNI weak global reference created by JPy_NewWeakGlobalRef().
+ */
+void JPy_DeleteWeakGlobalRef(JNIEnv* jenv, jweak ref);
+
+/**
+ * Counts the elements of a Java primitive array held by a JArray while it exports its buffer.
+ * isCopy tells whether the JVM made a native copy of the elements.
+ */
+void JPy_MemStats_AddArrayBuffer(Py_ssize_t bytes, int isCopy);
+void JPy_MemStats_RemoveArrayBuffer(Py_ssize_t bytes, int isCopy);
+
+/**
+ * Counts a Py_buffer held while its content is passed to a Java method as a primitive array.
+ */
+void JPy_MemStats_AddArgBuffer(Py_ssize_t bytes);
+void JPy_MemStats_RemoveArgBuffer(Py_ssize_t bytes);
+
+/**
+ * The number of live JNI global references created by jpy. Can be called without the GIL.
+ */
+jlong JPy_MemStats_GetGlobalRefCount(void);
+
+/**
+ * Returns a new dictionary with the current counters and their high-water marks, and the number of
+ * live wrapped Java objects per Java type. If resetPeaks is non-zero, the high-water marks are
+ * reset to the current values afterwards.
+ */
+PyObject* JPy_MemStats_Get(int resetPeaks);
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_MEMSTATS_H */
@@ -0,0 +1,441 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_jtype.h"
+#include "jpy_jmethod.h"
+#include "jpy_conv.h"
+#include "jpy_metrics.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+int JPy_MetricsEnabled = 0;
+
+static const char* JPy_Metrics_PhaseNames[JPy_METRIC_PHASE_COUNT] = {
+    "overload_resolution",
+    "arg_conversion",
+    "java_execution",
+    "result_conversion",
+    "gil_wait",
+};
+
+static JPy_Histogram JPy_Metrics_Phases[JPy_METRIC_PHASE_COUNT];
+static JPy_Histogram JPy_Metrics_NativeGILWait;
+static jlong JPy_Metrics_Calls = 0;
+static jlong JPy_Metrics_Errors = 0;
+static JPy_MethodMetrics* JPy_Metrics_Methods = NULL;
+
+
+jlong JPy_NanoTime(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (jlong) ((double) counter.QuadPart * 1.0e9 / (double) frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (jlong) ts.tv_sec * 1000000000 + (jlong) ts.tv_nsec;
+#endif
+}
+
+static int JPy_Histogram_BucketIndex(jlong nanos)
+{
+    int msb = 0;
+    jlong v = nanos;
+
+    if (nanos < 4) {
+        return nanos < 0 ? 0 : (int) nanos;
+    }
+    while (v > 1) {
+        v >>= 1;
+        msb++;
+    }
+    return (msb - 1) * 4 + (int) ((nanos >> (msb - 2)) & 3);
+}
+
+/**
+ * Returns the largest value that falls into the given bucket.
+ */
+static jlong JPy_Histogram_BucketUpperBound(int index)
+{
+    int msb;
+
+    if (index < 3) {
+        return index;
+    }
+    if (index >= JPy_METRICS_HIST_BUCKETS - 1) {
+        return (jlong) (((unsigned long long) 1 << 63) - 1);
+    }
+    index++;
+    msb = index / 4 + 1;
+    return ((jlong) (4 + index % 4) << (msb - 2)) - 1;
+}
+
+static void JPy_Histogram_Record(JPy_Histogram* histogram, jlong nanos)
+{
+    if (nanos < 0) {
+        nanos = 0;
+    }
+    histogram->count++;
+    histogram->totalNanos += nanos;
+    if (nanos > histogram->maxNanos) {
+        histogram->maxNanos = nanos;
+    }
+    histogram->buckets[JPy_Histogram_BucketIndex(nanos)]++;
+}
+
+static jlong JPy_Histogram_Percentile(JPy_Histogram* histogram, double percentile)
+{
+    jlong rank;
+    jlong seen = 0;
+    jlong upperBound;
+    int i;
+
+    if (histogram->count == 0) {
+        return 0;
+    }
+    rank = (jlong) (percentile / 100.0 * (double) histogram->count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    for (i = 0; i < JPy_METRICS_HIST_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if (seen >= rank) {
+            upperBound = JPy_Histogram_BucketUpperBound(i);
+            return upperBound < histogram->maxNanos ? upperBound : histogram->maxNanos;
+        }
+    }
+    return histogram->maxNanos;
+}
+
+static int JPy_Metrics_SetLong(PyObject* dict, const char* key, jlong value)
+{
+    PyObject* pyValue;
+    int result;
+
+    pyValue = JPy_FROM_JLONG(value);
+    if (pyValue == NULL) {
+        return -1;
+    }
+    result = PyDict_SetItemString(dict, key, pyValue);
+    JPy_DECREF(pyValue);
+    return result;
+}
+
+static int JPy_Metrics_SetObject(PyObject* dict, const char* key, PyObject* value)
+{
+    int result;
+
+    if (value == NULL) {
+        return -1;
+    }
+    result = PyDict_SetItemString(dict, key, value);
+    JPy_DECREF(value);
+    return result;
+}
+
+/**
+ * Returns a new dictionary with the count, total, maximum, mean and percentiles of the histogram
+ * and a list of (upper bound, count) tuples for its non-empty buckets.
+ */
+static PyObject* JPy_Histogram_ToDict(JPy_Histogram* histogram)
+{
+    PyObject* dict;
+    PyObject* buckets;
+    PyObject* bucket;
+    int i;
+
+    dict = PyDict_New();
+    if (dict == NULL) {
+        return NULL;
+    }
+    if (JPy_Metrics_SetLong(dict, "count", histogram->count) < 0
+        || JPy_Metrics_SetLong(dict, "total_ns", histogram->totalNanos) < 0
+        || JPy_Metrics_SetLong(dict, "max_ns", histogram->maxNanos) < 0
+        || JPy_Metrics_SetObject(dict, "mean_ns", PyFloat_FromDouble(histogram->count > 0 ? (double) histogram->totalNanos / (double) histogram->count : 0.0)) < 0
+        || JPy_Metrics_SetLong(dict, "p50_ns", JPy_Histogram_Percentile(histogram, 50.0)) < 0
+        || JPy_Metrics_SetLong(dict, "p90_ns", JPy_Histogram_Percentile(histogram, 90.0)) < 0
+        || JPy_Metrics_SetLong(dict, "p99_ns", JPy_Histogram_Percentile(histogram, 99.0)) < 0) {
+        goto error;
+    }
+
+    buckets = PyList_New(0);
+    if (JPy_Metrics_SetObject(dict, "buckets", buckets) < 0) {
+        goto error;
+    }
+    for (i = 0; i < JPy_METRICS_HIST_BUCKETS; i++) {
+        if (histogram->buckets[i] != 0) {
+            bucket = Py_BuildValue("(LL)", (long long) JPy_Histogram_BucketUpperBound(i), (long long) histogram->buckets[i]);
+            if (bucket == NULL || PyList_Append(buckets, bucket) < 0) {
+                JPy_XDECREF(bucket);
+                goto error;
+            }
+            JPy_DECREF(bucket);
+        }
+    }
+    return dict;
+
+error:
+    JPy_DECREF(dict);
+    return NULL;
+}
+
+static JPy_MethodMetrics* JPy_Metrics_GetMethodMetrics(PyObject* method)
+{
+    JPy_JMethod* jMethod = (JPy_JMethod*) method;
+    JPy_MethodMetrics* metrics;
+
+    metrics = jMethod->metrics;
+    if (metrics == NULL) {
+        metrics = PyMem_New(JPy_MethodMetrics, 1);
+        if (metrics == NULL) {
+            // metrics are best effort
+            return NULL;
+        }
+        memset(metrics, 0, sizeof (JPy_MethodMetrics));
+        metrics->method = method;
+        metrics->next = JPy_Metrics_Methods;
+        JPy_Metrics_Methods = metrics;
+        jMethod->metrics = metrics;
+    }
+    return metrics;
+}
+
+void JPy_Metrics_RecordOverload(PyObject* method, jlong startTime)
+{
+    JPy_MethodMetrics* metrics;
+    jlong elapsed;
+
+    elapsed = JPy_NanoTime() - startTime;
+    JPy_Histogram_Record(&JPy_Metrics_Phases[JPy_METRIC_OVERLOAD_RESOLUTION], elapsed);
+    if (method != NULL) {
+        metrics = JPy_Metrics_GetMethodMetrics(method);
+        if (metrics != NULL) {
+            metrics->phaseNanos[JPy_METRIC_OVERLOAD_RESOLUTION] += elapsed;
+        }
+    }
+}
+
+void JPy_Metrics_RecordCall(PyObject* method, JPy_CallTimes* times, int failed)
+{
+    JPy_MethodMetrics* metrics;
+    jlong phaseNanos[JPy_METRIC_PHASE_COUNT];
+    jlong end;
+    int i;
+
+    end = JPy_NanoTime();
+    memset(phaseNanos, 0, sizeof (phaseNanos));
+    if (times->javaStart == 0) {
+        // failed to convert the arguments
+        phaseNanos[JPy_METRIC_ARG_CONVERSION] = end - times->start;
+    } else {
+        phaseNanos[JPy_METRIC_ARG_CONVERSION] = times->javaStart - times->start;
+        phaseNanos[JPy_METRIC_JAVA_EXECUTION] = times->javaEnd - times->javaStart;
+        phaseNanos[JPy_METRIC_GIL_WAIT] = times->resultStart - times->javaEnd;
+        phaseNanos[JPy_METRIC_RESULT_CONVERSION] = end - times->resultStart;
+    }
+
+    JPy_Metrics_Calls++;
+    if (failed) {
+        JPy_Metrics_Errors++;
+    }
+    for (i = JPy_METRIC_ARG_CONVERSION; i < JPy_METRIC_PHASE_COUNT; i++) {
+        if (i == JPy_METRIC_ARG_CONVERSION || times->javaStart != 0) {
+            JPy_Histogram_Record(&JPy_Metrics_Phases[i], phaseNanos[i]);
+        }
+    }
+
+    metrics = JPy_Metrics_GetMethodMetrics(method);
+    if (metrics != NULL) {
+        metrics->calls++;
+        if (failed) {
+            metrics->errors++;
+        }
+        for (i = JPy_METRIC_ARG_CONVERSION; i < JPy_METRIC_PHASE_COUNT; i++) {
+            metrics->phaseNanos[i] += phaseNanos[i];
+        }
+        JPy_Histogram_Record(&metrics->latency, end - times->start);
+    }
+}
+
+void JPy_Metrics_RecordNativeGILWait(jlong startTime)
+{
+    JPy_Histogram_Record(&JPy_Metrics_NativeGILWait, JPy_NanoTime() - startTime);
+}
+
+void JPy_Metrics_ReleaseMethod(JPy_MethodMetrics* metrics)
+{
+    JPy_MethodMetrics** link;
+
+    for (link = &JPy_Metrics_Methods; *link != NULL; link = &(*link)->next) {
+        if (*link == metrics) {
+            *link = metrics->next;
+            break;
+        }
+    }
+    PyMem_Del(metrics);
+}
+
+void JPy_Metrics_Reset(void)
+{
+    JPy_MethodMetrics* metrics;
+    JPy_MethodMetrics* next;
+    PyObject* method;
+
+    memset(JPy_Metrics_Phases, 0, sizeof (JPy_Metrics_Phases));
+    memset(&JPy_Metrics_NativeGILWait, 0, sizeof (JPy_Metrics_NativeGILWait));
+    JPy_Metrics_Calls = 0;
+    JPy_Metrics_Errors = 0;
+
+    for (metrics = JPy_Metrics_Methods; metrics != NULL; metrics = next) {
+        next = metrics->next;
+        method = metrics->method;
+        memset(metrics, 0, sizeof (JPy_MethodMetrics));
+        metrics->method = method;
+        metrics->next = next;
+    }
+}
+
+/**
+ * Returns a new string "<class>#<name>(<param types>)" identifying the method.
+ */
+static PyObject* JPy_Metrics_MethodKey(JPy_JMethod* method)
+{
+    const char* name;
+    char* chars;
+    size_t len;
+    PyObject* key;
+    int i;
+
+    name = JPy_AS_UTF8(method->name);
+    len = strlen(method->declaringClass->javaName) + strlen(name) + 3;
+    for (i = 0; i < method->paramCount; i++) {
+        len += strlen(method->paramDescriptors[i].type->javaName) + 1;
+    }
+    chars = PyMem_New(char, len);
+    if (chars == NULL) {
+        return PyErr_NoMemory();
+    }
+    strcpy(chars, method->declaringClass->javaName);
+    strcat(chars, "#");
+    strcat(chars, name);
+    strcat(chars, "(");
+    for (i = 0; i < method->paramCount; i++) {
+        if (i > 0) {
+            strcat(chars, ",");
+        }
+        strcat(chars, method->paramDescriptors[i].type->javaName);
+    }
+    strcat(chars, ")");
+    key = JPy_FROM_CSTR(chars);
+    PyMem_Del(chars);
+    return key;
+}
+
+static PyObject* JPy_Metrics_MethodToDict(JPy_MethodMetrics* metrics)
+{
+    PyObject* dict;
+    char name[64];
+    int i;
+
+    dict = PyDict_New();
+    if (dict == NULL) {
+        return NULL;
+    }
+    if (JPy_Metrics_SetLong(dict, "calls", metrics->calls) < 0
+        || JPy_Metrics_SetLong(dict, "errors", metrics->errors) < 0
+        || JPy_Metrics_SetObject(dict, "latency", JPy_Histogram_ToDict(&metrics->latency)) < 0) {
+        goto error;
+    }
+    for (i = 0; i < JPy_METRIC_PHASE_COUNT; i++) {
+        sprintf(name, "%s_ns", JPy_Metrics_PhaseNames[i]);
+        if (JPy_Metrics_SetLong(dict, name, metrics->phaseNanos[i]) < 0) {
+            goto error;
+        }
+    }
+    return dict;
+
+error:
+    JPy_DECREF(dict);
+    return NULL;
+}
+
+PyObject* JPy_Metrics_GetStats(int reset)
+{
+    PyObject* stats;
+    PyObject* methods;
+    PyObject* key;
+    JPy_MethodMetrics* metrics;
+    int i;
+
+    stats = PyDict_New();
+    if (stats == NULL) {
+        return NULL;
+    }
+    if (JPy_Metrics_SetObject(stats, "enabled", PyBool_FromLong(JPy_MetricsEnabled)) < 0
+        || JPy_Metrics_SetLong(stats, "calls", JPy_Metrics_Calls) < 0
+        || JPy_Metrics_SetLong(stats, "errors", JPy_Metrics_Errors) < 0
+        || JPy_Metrics_SetObject(stats, "native_gil_wait", JPy_Histogram_ToDict(&JPy_Metrics_NativeGILWait)) < 0) {
+        goto error;
+    }
+    for (i = 0; i < JPy_METRIC_PHASE_COUNT; i++) {
+        if (JPy_Metrics_SetObject(stats, JPy_Metrics_PhaseNames[i], JPy_Histogram_ToDict(&JPy_Metrics_Phases[i])) < 0) {
+            goto error;
+        }
+    }
+
+    methods = PyDict_New();
+    if (JPy_Metrics_SetObject(stats, "methods", methods) < 0) {
+        goto error;
+    }
+    for (metrics = JPy_Metrics_Methods; metrics != NULL; metrics = metrics->next) {
+        if (metrics->calls == 0 && metrics->phaseNanos[JPy_METRIC_OVERLOAD_RESOLUTION] == 0) {
+            continue;
+        }
+        key = JPy_Metrics_MethodKey((JPy_JMethod*) metrics->method);
+        if (key == NULL) {
+            goto error;
+        }
+        if (JPy_Metrics_SetObject(methods, JPy_AS_UTF8(key), JPy_Metrics_MethodToDict(metrics)) < 0) {
+            JPy_DECREF(key);
+            goto error;
+        }
+        JPy_DECREF(key);
+    }
+
+    if (reset) {
+        JPy_Metrics_Reset();
+    }
+    return stats;
+
+error:
+    JPy_DECREF(stats);
+    return NULL;
+}
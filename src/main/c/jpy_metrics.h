@@ -0,0 +1,138 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#ifndef JPY_METRICS_H
+#define JPY_METRICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+
+/**
+ * Call metrics of the Python-to-Java bridge.
+ *
+ * Metrics are always compiled in and switched on at runtime (jpy.diag.metrics, PyLib.Diag.setMetricsEnabled()).
+ * While switched off, the instrumented paths only test JPy_MetricsEnabled once. All counters are
+ * updated by the thread holding the GIL, which serializes the writers, so no atomics or locks are
+ * needed; jpy.stats() reads them under the GIL as well.
+ */
+
+/**
+ * Phases of a Java method call which are timed.
+ */
+#define JPy_METRIC_OVERLOAD_RESOLUTION  0
+#define JPy_METRIC_ARG_CONVERSION       1
+#define JPy_METRIC_JAVA_EXECUTION       2
+#define JPy_METRIC_RESULT_CONVERSION    3
+#define JPy_METRIC_GIL_WAIT             4
+#define JPy_METRIC_PHASE_COUNT          5
+
+/**
+ * Log-linear ("HDR-style") latency histogram: 4 sub-buckets for every power of two, so that the
+ * relative error of a bucket is at most 25% over the full range of nanosecond values.
+ */
+#define JPy_METRICS_HIST_BUCKETS 248
+
+typedef struct JPy_Histogram
+{
+    jlong count;
+    jlong totalNanos;
+    jlong maxNanos;
+    jlong buckets[JPy_METRICS_HIST_BUCKETS];
+}
+JPy_Histogram;
+
+/**
+ * Metrics of a single JMethod, allocated the first time the method is called while metrics are on.
+ */
+typedef struct JPy_MethodMetrics
+{
+    // All methods with metrics, most recently created first
+    struct JPy_MethodMetrics* next;
+    // Borrowed, the JMethod releases its metrics in its tp_dealloc
+    PyObject* method;
+    jlong calls;
+    jlong errors;
+    jlong phaseNanos[JPy_METRIC_PHASE_COUNT];
+    JPy_Histogram latency;
+}
+JPy_MethodMetrics;
+
+/**
+ * Timestamps taken during a single Java method call, see JMethod_InvokeMethod().
+ * A zero value means the phase wasn't reached.
+ */
+typedef struct JPy_CallTimes
+{
+    // Before the arguments are converted
+    jlong start;
+    // GIL released, Java method about to be called
+    jlong javaStart;
+    // Java method returned, GIL not yet reacquired
+    jlong javaEnd;
+    // GIL reacquired, result about to be converted
+    jlong resultStart;
+}
+JPy_CallTimes;
+
+extern int JPy_MetricsEnabled;
+
+/**
+ * Returns a monotonic timestamp in nanoseconds.
+ */
+jlong JPy_NanoTime(void);
+
+/**
+ * Records the time spent on finding the overload 'method' (may be NULL if none matched), given the
+ * timestamp taken before. GIL must be held.
+ */
+void JPy_Metrics_RecordOverload(PyObject* method, jlong startTime);
+
+/**
+ * Records a completed Java method call. GIL must be held.
+ */
+void JPy_Metrics_RecordCall(PyObject* method, JPy_CallTimes* times, int failed);
+
+/**
+ * Records the time a Java thread waited for the GIL when entering a PyLib native method, given the
+ * timestamp taken before. GIL must be held.
+ */
+void JPy_Metrics_RecordNativeGILWait(jlong startTime);
+
+/**
+ * Called from a JMethod's tp_dealloc. GIL must be held.
+ */
+void JPy_Metrics_ReleaseMethod(JPy_MethodMetrics* metrics);
+
+/**
+ * Returns a new dictionary holding the current metrics and optionally resets them. GIL must be held.
+ */
+PyObject* JPy_Metrics_GetStats(int reset);
+
+/**
+ * Resets all metrics. GIL must be held.
+ */
+void JPy_Metrics_Reset(void);
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_METRICS_H */
@@ -20,12 +20,26 @@
 #include "jpy_module.h"
 #include "jpy_diag.h"
 #include "jpy_verboseexcept.h"
+#include "jpy_mapproxy.h"
+#include "jpy_relqueue.h"
+#include "jpy_metrics.h"
+#include "jpy_profiler.h"
+#include "jpy_jexception.h"
 #include "jpy_jtype.h"
 #include "jpy_jmethod.h"
 #include "jpy_jfield.h"
 #include "jpy_jobj.h"
 #include "jpy_conv.h"
 #include "jpy_compat.h"
+#include "jpy_memstats.h"
+#include "jpy_idcache.h"
+#include "jpy_jweakobj.h"
+#include "jpy_typetrans.h"
+#include "jpy_jiterator.h"
+#include "jpy_jcollection.h"
+#include "jpy_jfieldproj.h"
+#include "jpy_numpy.h"
+#include "jpy_async.h"
 
 
 #include <stdlib.h>
@@ -38,6 +52,20 @@ PyObject* JPy_destroy_jvm(PyObject* self, PyObject* args);
 PyObject* JPy_get_type(PyObject* self, PyObject* args, PyObject* kwds);
 PyObject* JPy_cast(PyObject* self, PyObject* args);
 PyObject* JPy_array(PyObject* self, PyObject* args);
+PyObject* JPy_cache_identity(PyObject* self, PyObject* args, PyObject* kwds);
+PyObject* JPy_cache_hash(PyObject* self, PyObject* args, PyObject* kwds);
+PyObject* JPy_weak(PyObject* self, PyObject* args);
+PyObject* JPy_iterate(PyObject* self, PyObject* args, PyObject* kwds);
+PyObject* JPy_to_list(PyObject* self, PyObject* args);
+PyObject* JPy_to_dict(PyObject* self, PyObject* args);
+PyObject* JPy_fields(PyObject* self, PyObject* args);
+PyObject* JPy_to_numpy(PyObject* self, PyObject* args);
+PyObject* JPy_call_async(PyObject* self, PyObject* args);
+PyObject* JPy_as_future(PyObject* self, PyObject* args);
+PyObject* JPy_stats(PyObject* self, PyObject* args, PyObject* kwds);
+PyObject* JPy_start_profiler(PyObject* self, PyObject* args, PyObject* kwds);
+PyObject* JPy_stop_profiler(PyObject* self);
+PyObject* JPy_dump_profile(PyObject* self, PyObject* args);
 
 
 static PyMethodDef JPy_Functions[] = {
@@ -63,6 +91,72 @@ static PyMethodDef JPy_Functions[] = {
                     "array(name, init) - Return a new Java array of given Java type (type name or type object) and initializer (array length or sequence). "
                     "Possible primitive types are 'boolean', 'byte', 'char', 'short', 'int', 'long', 'float', and 'double'."},
 
+    {"cache_identity", (PyCFunction) JPy_cache_identity, METH_VARARGS|METH_KEYWORDS,
+                    "cache_identity(type, enabled=True) - Enable or disable the identity cache for the given Java type (type name or type object) "
+                    "and its subclasses. While enabled, a Java object passed to Python again yields the same live wrapper object, "
+                    "so that 'is' holds and no new JNI global reference is created."},
+
+    {"cache_hash",  (PyCFunction) JPy_cache_hash, METH_VARARGS|METH_KEYWORDS,
+                    "cache_hash(type, enabled=True) - Enable or disable caching the hash codes of wrappers of the given Java type "
+                    "(type name or type object) and its subclasses. Only use it for immutable types: while enabled, hash() calls "
+                    "hashCode() once per wrapper. Enabled by default for String, the boxed primitives, Class, BigInteger, BigDecimal, "
+                    "UUID and the java.time types Duration, Instant, LocalDate, LocalDateTime, LocalTime and ZonedDateTime."},
+
+    {"weak",        JPy_weak, METH_VARARGS,
+                    "weak(obj) - Return a weak reference to the given Java object, which doesn't keep it from being garbage collected. "
+                    "Call it to get the object, or None if it has been collected; its 'alive' attribute tells without creating a wrapper. "
+                    "Other attributes are looked up on the object, and it can be passed to Java methods expecting the object."},
+
+    {"iterate",     (PyCFunction) JPy_iterate, METH_VARARGS|METH_KEYWORDS,
+                    "iterate(obj, chunk_size=256) - Return a Python iterator over the given java.lang.Iterable or java.util.Iterator, "
+                    "which fetches chunk_size elements per Java call. With chunk_size=1, hasNext() and next() are called per element, "
+                    "so that a Java iterator is not advanced beyond the elements taken. iter(obj) is the same as iterate(obj) for "
+                    "Iterables, while Iterators are iterated element by element."},
+
+    {"to_list",     JPy_to_list, METH_VARARGS,
+                    "to_list(obj) - Return a new Python list with the elements of the given java.util.Collection, "
+                    "which are fetched with a single Java call."},
+
+    {"to_dict",     JPy_to_dict, METH_VARARGS,
+                    "to_dict(obj) - Return a new Python dict with the entries of the given java.util.Map, "
+                    "which are fetched with a single Java call."},
+
+    {"fields",      JPy_fields, METH_VARARGS,
+                    "fields(type, names) - Return a reusable projection of the named instance fields of the given Java type "
+                    "(type name or type object). Calling it with a Java object array, a java.util.Collection or a sequence of "
+                    "instances reads the fields of all objects in one native loop and returns a dict mapping each name to a column: "
+                    "a typed memoryview for primitive fields, a list otherwise."},
+
+    {"to_numpy",    JPy_to_numpy, METH_VARARGS,
+                    "to_numpy(obj) - Return a new numpy array with the items of the given Java primitive array, copied at once, "
+                    "or of the given Object[] or java.util.Collection of boxed numbers, unboxed by a single Java call into a bool, "
+                    "int64 or float64 (if there are nulls or floating point numbers) array. Requires numpy."},
+
+    {"call_async",  JPy_call_async, METH_VARARGS,
+                    "call_async(method, *args) - Call the given method of a Java object or type with the given arguments "
+                    "on a Java thread pool and return an asyncio.Future of the running event loop for its result. "
+                    "If the result is a java.util.concurrent.CompletionStage, the future is resolved with the value of the stage."},
+
+    {"as_future",   JPy_as_future, METH_VARARGS,
+                    "as_future(stage) - Return an asyncio.Future of the running event loop, which is resolved with the value "
+                    "of the given java.util.concurrent.CompletionStage, e.g. a CompletableFuture."},
+
+    {"stats",       (PyCFunction) JPy_stats, METH_VARARGS|METH_KEYWORDS,
+                    "stats(reset=False) - Return a dictionary with the call metrics of Java methods collected while jpy.diag.metrics is True: "
+                    "call counts and latency histograms of overload resolution, argument conversion, Java execution, result conversion and GIL waits, "
+                    "totals per Java method. Optionally resets the metrics."},
+
+    {"start_profiler", (PyCFunction) JPy_start_profiler, METH_VARARGS|METH_KEYWORDS,
+                    "start_profiler(capacity=65536) - Start recording Java methods called from Python and Python callables called from Java "
+                    "into a ring buffer keeping the last 'capacity' calls. Discards previously recorded calls."},
+
+    {"stop_profiler", (PyCFunction) JPy_stop_profiler, METH_NOARGS,
+                    "stop_profiler() - Stop recording calls. The recorded calls are kept."},
+
+    {"dump_profile", JPy_dump_profile, METH_VARARGS,
+                    "dump_profile(path) - Write the recorded calls to a Chrome trace JSON file, which can be opened with "
+                    "chrome://tracing, Perfetto or speedscope. Returns the number of recorded calls written."},
+
     {NULL, NULL, 0, NULL} /*Sentinel*/
 };
 
@@ -90,7 +184,7 @@ PyObject* JPy_Module = NULL;
 PyObject* JPy_Types = NULL;
 PyObject* JPy_Type_Callbacks = NULL;
 PyObject* JPy_Type_Translations = NULL;
-PyObject* JException_Type = NULL;
+PyObject* JPy_Exception_Types = NULL;
 
 // A global reference to a Java VM singleton.
 JavaVM* JPy_JVM = NULL;
@@ -141,6 +235,7 @@ jmethodID JPy_Object_Equals_MID = NULL;
 // java.lang.Class
 jclass JPy_Class_JClass = NULL;
 jmethodID JPy_Class_GetName_MID = NULL;
+jmethodID JPy_Class_GetInterfaces_MID = NULL;
 jmethodID JPy_Class_GetDeclaredConstructors_MID = NULL;
 jmethodID JPy_Class_GetDeclaredFields_MID = NULL;
 jmethodID JPy_Class_GetDeclaredMethods_MID = NULL;
@@ -174,8 +269,27 @@ jclass JPy_Map_Entry_JClass = NULL;
 jmethodID JPy_Map_entrySet_MID = NULL;
 jmethodID JPy_Map_put_MID = NULL;
 jmethodID JPy_Map_clear_MID = NULL;
+jmethodID JPy_Map_get_MID = NULL;
+jmethodID JPy_Map_containsKey_MID = NULL;
+jmethodID JPy_Map_remove_MID = NULL;
 jmethodID JPy_Map_Entry_getKey_MID = NULL;
 jmethodID JPy_Map_Entry_getValue_MID = NULL;
+jmethodID JPy_Map_size_MID = NULL;
+jmethodID JPy_Map_keySet_MID = NULL;
+// java.util.Collection
+jclass JPy_Collection_JClass = NULL;
+jmethodID JPy_Collection_size_MID = NULL;
+jmethodID JPy_Collection_contains_MID = NULL;
+jmethodID JPy_Collection_toArray_MID = NULL;
+// java.util.List
+jclass JPy_List_JClass = NULL;
+jmethodID JPy_List_get_MID = NULL;
+// java.util.concurrent.CompletionStage
+jclass JPy_CompletionStage_JClass = NULL;
+// java.util.concurrent.CompletableFuture
+jclass JPy_CompletableFuture_JClass = NULL;
+jmethodID JPy_CompletableFuture_Complete_MID = NULL;
+jmethodID JPy_CompletableFuture_CompleteExceptionally_MID = NULL;
 // java.util.Set
 jclass JPy_Set_JClass = NULL;
 jmethodID JPy_Set_Iterator_MID = NULL;
@@ -190,6 +304,10 @@ jclass JPy_UnsupportedOperationException_JClass = NULL;
 jclass JPy_FileNotFoundException_JClass = NULL;
 jclass JPy_KeyError_JClass = NULL;
 jclass JPy_StopIteration_JClass = NULL;
+jclass JPy_PyException_JClass = NULL;
+jmethodID JPy_KeyError_Init_MID = NULL;
+jmethodID JPy_StopIteration_Init_MID = NULL;
+jmethodID JPy_PyException_Init_MID = NULL;
 
 // java.lang.Boolean
 jclass JPy_Boolean_JClass = NULL;
@@ -226,6 +344,23 @@ jmethodID JPy_Number_DoubleValue_MID = NULL;
 
 jclass JPy_Void_JClass = NULL;
 jclass JPy_String_JClass = NULL;
+
+jclass JPy_System_JClass = NULL;
+jmethodID JPy_System_IdentityHashCode_SMID = NULL;
+
+jclass JPy_Iterable_JClass = NULL;
+jmethodID JPy_Iterable_Iterator_MID = NULL;
+// Optional, NULL if org.jpy.JavaIteration is not on the classpath
+jclass JPy_JavaIteration_JClass = NULL;
+jmethodID JPy_JavaIteration_Fill_SMID = NULL;
+jmethodID JPy_JavaIteration_Entries_SMID = NULL;
+// Optional, NULL if org.jpy.JavaUnboxing is not on the classpath
+jclass JPy_JavaUnboxing_JClass = NULL;
+jmethodID JPy_JavaUnboxing_Unbox_SMID = NULL;
+// Optional, NULL if org.jpy.JavaAsync is not on the classpath
+jclass JPy_JavaAsync_JClass = NULL;
+jmethodID JPy_JavaAsync_Submit_SMID = NULL;
+jmethodID JPy_JavaAsync_WhenComplete_SMID = NULL;
 jclass JPy_PyObject_JClass = NULL;
 jclass JPy_PyDictWrapper_JClass = NULL;
 
@@ -351,9 +486,51 @@ PyMODINIT_FUNC JPY_MODULE_INIT_FUNC(void)
 
     /////////////////////////////////////////////////////////////////////////
 
-    JException_Type = PyErr_NewException("jpy.JException", NULL, NULL);
-    JPy_INCREF(JException_Type);
-    PyModule_AddObject(JPy_Module, "JException", JException_Type);
+    if (JException_InitType() < 0) {
+        JPY_RETURN(NULL);
+    }
+    JPy_INCREF(&JException_Type);
+    PyModule_AddObject(JPy_Module, "JException", (PyObject*) &JException_Type);
+
+    /////////////////////////////////////////////////////////////////////////
+
+    if (PyType_Ready(&JWeakObj_Type) < 0) {
+        JPY_RETURN(NULL);
+    }
+    JPy_INCREF(&JWeakObj_Type);
+    PyModule_AddObject(JPy_Module, "JWeakObj", (PyObject*) &JWeakObj_Type);
+
+    /////////////////////////////////////////////////////////////////////////
+
+    if (PyType_Ready(&JIterator_Type) < 0) {
+        JPY_RETURN(NULL);
+    }
+    JPy_INCREF(&JIterator_Type);
+    PyModule_AddObject(JPy_Module, "JIterator", (PyObject*) &JIterator_Type);
+
+    /////////////////////////////////////////////////////////////////////////
+
+    if (PyType_Ready(&JFieldProjection_Type) < 0) {
+        JPY_RETURN(NULL);
+    }
+    JPy_INCREF(&JFieldProjection_Type);
+    PyModule_AddObject(JPy_Module, "JFieldProjection", (PyObject*) &JFieldProjection_Type);
+
+    /////////////////////////////////////////////////////////////////////////
+
+    if (PyType_Ready(&JAsyncQueue_Type) < 0) {
+        JPY_RETURN(NULL);
+    }
+    JPy_INCREF(&JAsyncQueue_Type);
+    PyModule_AddObject(JPy_Module, "JAsyncQueue", (PyObject*) &JAsyncQueue_Type);
+
+    /////////////////////////////////////////////////////////////////////////
+
+    if (PyType_Ready(&JAsyncTask_Type) < 0) {
+        JPY_RETURN(NULL);
+    }
+    JPy_INCREF(&JAsyncTask_Type);
+    PyModule_AddObject(JPy_Module, "JAsyncTask", (PyObject*) &JAsyncTask_Type);
 
     /////////////////////////////////////////////////////////////////////////
 
@@ -369,12 +546,24 @@ PyMODINIT_FUNC JPY_MODULE_INIT_FUNC(void)
 
     /////////////////////////////////////////////////////////////////////////
 
-    JPy_Type_Translations = PyDict_New();
+    if (TypeTranslations_InitType() < 0) {
+        JPY_RETURN(NULL);
+    }
+    JPy_Type_Translations = PyObject_CallObject((PyObject*) &TypeTranslations_Type, NULL);
+    if (JPy_Type_Translations == NULL) {
+        JPY_RETURN(NULL);
+    }
     JPy_INCREF(JPy_Type_Translations);
     PyModule_AddObject(JPy_Module, JPy_MODULE_ATTR_NAME_TYPE_TRANSLATIONS, JPy_Type_Translations);
 
     /////////////////////////////////////////////////////////////////////////
 
+    JPy_Exception_Types = PyDict_New();
+    JPy_INCREF(JPy_Exception_Types);
+    PyModule_AddObject(JPy_Module, JPy_MODULE_ATTR_NAME_EXCEPTION_TYPES, JPy_Exception_Types);
+
+    /////////////////////////////////////////////////////////////////////////
+
     if (PyType_Ready(&Diag_Type) < 0) {
         JPY_RETURN(NULL);
     }
@@ -394,6 +583,14 @@ PyMODINIT_FUNC JPY_MODULE_INIT_FUNC(void)
         PyModule_AddObject(JPy_Module, "VerboseExceptions", pyVerboseExceptions);
     }
 
+    if (PyType_Ready(&MapProxy_Type) < 0) {
+        JPY_RETURN(NULL);
+    }
+
+    if (JPy_RelQueue_Init() < 0) {
+        JPY_RETURN(NULL);
+    }
+
     /////////////////////////////////////////////////////////////////////////
 
     if (JPy_JVM != NULL) {
@@ -585,6 +782,53 @@ PyObject* JPy_cast(PyObject* self, PyObject* args)
     JPy_FRAME(PyObject*, NULL, JPy_cast_internal(jenv, self, args), 16)
 }
 
+PyObject* JPy_stats(PyObject* self, PyObject* args, PyObject* kwds)
+{
+    static char* keywords[] = {"reset", NULL};
+    int reset = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|i:stats", keywords, &reset)) {
+        return NULL;
+    }
+
+    return JPy_Metrics_GetStats(reset);
+}
+
+PyObject* JPy_start_profiler(PyObject* self, PyObject* args, PyObject* kwds)
+{
+    static char* keywords[] = {"capacity", NULL};
+    Py_ssize_t capacity = JPy_PROFILER_DEFAULT_CAPACITY;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|n:start_profiler", keywords, &capacity)) {
+        return NULL;
+    }
+    if (JPy_Profiler_Start(capacity) < 0) {
+        return NULL;
+    }
+    return Py_BuildValue("");
+}
+
+PyObject* JPy_stop_profiler(PyObject* self)
+{
+    JPy_Profiler_Stop();
+    return Py_BuildValue("");
+}
+
+PyObject* JPy_dump_profile(PyObject* self, PyObject* args)
+{
+    const char* path;
+    Py_ssize_t count;
+
+    if (!PyArg_ParseTuple(args, "s:dump_profile", &path)) {
+        return NULL;
+    }
+    count = JPy_Profiler_Dump(path);
+    if (count < 0) {
+        return NULL;
+    }
+    return PyLong_FromSsize_t(count);
+}
+
 PyObject* JPy_array_internal(JNIEnv* jenv, PyObject* self, PyObject* args)
 {
     JPy_JType* componentType;
@@ -660,6 +904,293 @@ PyObject* JPy_array(PyObject* self, PyObject* args)
     JPy_FRAME(PyObject*, NULL, JPy_array_internal(jenv, self, args), 16)
 }
 
+PyObject* JPy_cache_identity_internal(JNIEnv* jenv, PyObject* self, PyObject* args, PyObject* kwds)
+{
+    static char* keywords[] = {"type", "enabled", NULL};
+    JPy_JType* type;
+    PyObject* objType;
+    int enabled;
+
+    enabled = 1; // True
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|i:cache_identity", keywords, &objType, &enabled)) {
+        return NULL;
+    }
+
+    if (JPy_IS_STR(objType)) {
+        const char* typeName;
+        typeName = JPy_AS_UTF8(objType);
+        type = JType_GetTypeForName(jenv, typeName, JNI_FALSE);
+        if (type == NULL) {
+            return NULL;
+        }
+    } else if (JType_Check(objType)) {
+        type = (JPy_JType*) objType;
+    } else {
+        PyErr_SetString(PyExc_ValueError, "cache_identity: argument 1 (type) must be a type name or Java type object");
+        return NULL;
+    }
+
+    if (type->isPrimitive) {
+        PyErr_SetString(PyExc_ValueError, "cache_identity: argument 1 (type) must not be a primitive type");
+        return NULL;
+    }
+
+    JPy_IdentityCache_SetEnabled(type, enabled);
+    return Py_BuildValue("");
+}
+
+PyObject* JPy_cache_identity(PyObject* self, PyObject* args, PyObject* kwds)
+{
+    JPy_FRAME(PyObject*, NULL, JPy_cache_identity_internal(jenv, self, args, kwds), 16)
+}
+
+PyObject* JPy_cache_hash_internal(JNIEnv* jenv, PyObject* self, PyObject* args, PyObject* kwds)
+{
+    static char* keywords[] = {"type", "enabled", NULL};
+    JPy_JType* type;
+    PyObject* objType;
+    int enabled;
+
+    enabled = 1; // True
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|i:cache_hash", keywords, &objType, &enabled)) {
+        return NULL;
+    }
+
+    if (JPy_IS_STR(objType)) {
+        const char* typeName;
+        typeName = JPy_AS_UTF8(objType);
+        type = JType_GetTypeForName(jenv, typeName, JNI_FALSE);
+        if (type == NULL) {
+            return NULL;
+        }
+    } else if (JType_Check(objType)) {
+        type = (JPy_JType*) objType;
+    } else {
+        PyErr_SetString(PyExc_ValueError, "cache_hash: argument 1 (type) must be a type name or Java type object");
+        return NULL;
+    }
+
+    if (type->isPrimitive) {
+        PyErr_SetString(PyExc_ValueError, "cache_hash: argument 1 (type) must not be a primitive type");
+        return NULL;
+    }
+
+    JType_SetHashCached(type, enabled);
+    return Py_BuildValue("");
+}
+
+PyObject* JPy_cache_hash(PyObject* self, PyObject* args, PyObject* kwds)
+{
+    JPy_FRAME(PyObject*, NULL, JPy_cache_hash_internal(jenv, self, args, kwds), 16)
+}
+
+PyObject* JPy_fields_internal(JNIEnv* jenv, PyObject* self, PyObject* args)
+{
+    JPy_JType* type;
+    PyObject* objType;
+    PyObject* names;
+
+    if (!PyArg_ParseTuple(args, "OO:fields", &objType, &names)) {
+        return NULL;
+    }
+
+    if (JPy_IS_STR(objType)) {
+        const char* typeName;
+        typeName = JPy_AS_UTF8(objType);
+        type = JType_GetTypeForName(jenv, typeName, JNI_FALSE);
+        if (type == NULL) {
+            return NULL;
+        }
+    } else if (JType_Check(objType)) {
+        type = (JPy_JType*) objType;
+    } else {
+        PyErr_SetString(PyExc_ValueError, "fields: argument 1 (type) must be a type name or Java type object");
+        return NULL;
+    }
+
+    if (type->isPrimitive || type->componentType != NULL) {
+        PyErr_SetString(PyExc_ValueError, "fields: argument 1 (type) must not be a primitive or array type");
+        return NULL;
+    }
+
+    return JFieldProjection_New(jenv, type, names);
+}
+
+PyObject* JPy_fields(PyObject* self, PyObject* args)
+{
+    JPy_FRAME(PyObject*, NULL, JPy_fields_internal(jenv, self, args), 16)
+}
+
+PyObject* JPy_to_numpy_internal(JNIEnv* jenv, PyObject* self, PyObject* args)
+{
+    PyObject* obj;
+
+    if (!PyArg_ParseTuple(args, "O:to_numpy", &obj)) {
+        return NULL;
+    }
+
+    if (!JObj_Check(obj)) {
+        PyErr_SetString(PyExc_ValueError, "to_numpy: argument 1 (obj) must be a Java array or java.util.Collection");
+        return NULL;
+    }
+
+    return JPy_Numpy_FromJObject(jenv, ((JPy_JObj*) obj)->objectRef, (JPy_JType*) Py_TYPE(obj));
+}
+
+PyObject* JPy_to_numpy(PyObject* self, PyObject* args)
+{
+    JPy_FRAME(PyObject*, NULL, JPy_to_numpy_internal(jenv, self, args), 16)
+}
+
+PyObject* JPy_call_async_internal(JNIEnv* jenv, PyObject* self, PyObject* args)
+{
+    PyObject* method;
+    PyObject* methodArgs;
+    PyObject* future;
+
+    if (PyTuple_Size(args) < 1) {
+        PyErr_SetString(PyExc_TypeError, "call_async: missing argument 1 (method)");
+        return NULL;
+    }
+    method = PyTuple_GetItem(args, 0);
+    methodArgs = PyTuple_GetSlice(args, 1, PyTuple_Size(args));
+    if (methodArgs == NULL) {
+        return NULL;
+    }
+    future = JPy_AsyncCall_Submit(jenv, method, methodArgs);
+    JPy_DECREF(methodArgs);
+    return future;
+}
+
+PyObject* JPy_call_async(PyObject* self, PyObject* args)
+{
+    JPy_FRAME(PyObject*, NULL, JPy_call_async_internal(jenv, self, args), 16)
+}
+
+PyObject* JPy_as_future_internal(JNIEnv* jenv, PyObject* self, PyObject* args)
+{
+    PyObject* stage;
+
+    if (!PyArg_ParseTuple(args, "O:as_future", &stage)) {
+        return NULL;
+    }
+    return JPy_AsyncCall_AsFuture(jenv, stage);
+}
+
+PyObject* JPy_as_future(PyObject* self, PyObject* args)
+{
+    JPy_FRAME(PyObject*, NULL, JPy_as_future_internal(jenv, self, args), 16)
+}
+
+PyObject* JPy_weak(PyObject* self, PyObject* args)
+{
+    JNIEnv* jenv;
+    PyObject* obj;
+
+    if (!PyArg_ParseTuple(args, "O:weak", &obj)) {
+        return NULL;
+    }
+
+    if (JWeakObj_Check(obj)) {
+        JPy_INCREF(obj);
+        return obj;
+    }
+    if (!JObj_Check(obj)) {
+        PyErr_SetString(PyExc_ValueError, "weak: argument 1 (obj) must be a Java object");
+        return NULL;
+    }
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+    return JWeakObj_New(jenv, (JPy_JObj*) obj);
+}
+
+PyObject* JPy_iterate_internal(JNIEnv* jenv, PyObject* self, PyObject* args, PyObject* kwds)
+{
+    static char* keywords[] = {"obj", "chunk_size", NULL};
+    PyObject* obj;
+    jobject objectRef;
+    jobject iteratorRef;
+    int chunkSize;
+
+    chunkSize = JPy_ITER_CHUNK_SIZE;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|i:iterate", keywords, &obj, &chunkSize)) {
+        return NULL;
+    }
+
+    if (chunkSize < 1) {
+        PyErr_SetString(PyExc_ValueError, "iterate: argument 2 (chunk_size) must be positive");
+        return NULL;
+    }
+    if (!JObj_Check(obj)) {
+        PyErr_SetString(PyExc_ValueError, "iterate: argument 1 (obj) must be a java.lang.Iterable or java.util.Iterator");
+        return NULL;
+    }
+
+    objectRef = ((JPy_JObj*) obj)->objectRef;
+    if ((*jenv)->IsInstanceOf(jenv, objectRef, JPy_Iterator_JClass)) {
+        return JIterator_New(jenv, objectRef, chunkSize);
+    }
+    if (!(*jenv)->IsInstanceOf(jenv, objectRef, JPy_Iterable_JClass)) {
+        PyErr_SetString(PyExc_ValueError, "iterate: argument 1 (obj) must be a java.lang.Iterable or java.util.Iterator");
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    iteratorRef = (*jenv)->CallObjectMethod(jenv, objectRef, JPy_Iterable_Iterator_MID);
+    Py_END_ALLOW_THREADS
+    JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
+    if (iteratorRef == NULL) {
+        PyErr_SetString(PyExc_TypeError, "java.lang.Iterable.iterator() returned null");
+        return NULL;
+    }
+    return JIterator_New(jenv, iteratorRef, chunkSize);
+}
+
+PyObject* JPy_iterate(PyObject* self, PyObject* args, PyObject* kwds)
+{
+    JPy_FRAME(PyObject*, NULL, JPy_iterate_internal(jenv, self, args, kwds), 16)
+}
+
+PyObject* JPy_to_list_internal(JNIEnv* jenv, PyObject* self, PyObject* args)
+{
+    PyObject* obj;
+
+    if (!PyArg_ParseTuple(args, "O:to_list", &obj)) {
+        return NULL;
+    }
+    if (!JObj_Check(obj) || !(*jenv)->IsInstanceOf(jenv, ((JPy_JObj*) obj)->objectRef, JPy_Collection_JClass)) {
+        PyErr_SetString(PyExc_ValueError, "to_list: argument 1 (obj) must be a java.util.Collection");
+        return NULL;
+    }
+
+    return JPy_CollectionToList(jenv, ((JPy_JObj*) obj)->objectRef);
+}
+
+PyObject* JPy_to_list(PyObject* self, PyObject* args)
+{
+    JPy_FRAME(PyObject*, NULL, JPy_to_list_internal(jenv, self, args), 16)
+}
+
+PyObject* JPy_to_dict_internal(JNIEnv* jenv, PyObject* self, PyObject* args)
+{
+    PyObject* obj;
+
+    if (!PyArg_ParseTuple(args, "O:to_dict", &obj)) {
+        return NULL;
+    }
+    if (!JObj_Check(obj) || !(*jenv)->IsInstanceOf(jenv, ((JPy_JObj*) obj)->objectRef, JPy_Map_JClass)) {
+        PyErr_SetString(PyExc_ValueError, "to_dict: argument 1 (obj) must be a java.util.Map");
+        return NULL;
+    }
+
+    return JPy_MapToDict(jenv, ((JPy_JObj*) obj)->objectRef);
+}
+
+PyObject* JPy_to_dict(PyObject* self, PyObject* args)
+{
+    JPy_FRAME(PyObject*, NULL, JPy_to_dict_internal(jenv, self, args), 16)
+}
+
 JPy_JType* JPy_GetNonObjectJType(JNIEnv* jenv, jclass classRef)
 {
     jclass primClassRef;
@@ -705,7 +1236,7 @@ jclass JPy_GetClass(JNIEnv* jenv, const char* name)
         return NULL;
     }
 
-    globalClassRef = (*jenv)->NewGlobalRef(jenv, localClassRef);
+    globalClassRef = JPy_NewGlobalRef(jenv, localClassRef, JPy_GREF_CLASS);
     JPy_DELETE_LOCAL_REF(localClassRef);
     if (globalClassRef == NULL) {
         PyErr_NoMemory();
@@ -777,6 +1308,7 @@ int initGlobalPyObjectVars(JNIEnv* jenv)
     JPy_JType *dictType;
     JPy_JType *keyErrorType;
     JPy_JType *stopIterationType;
+    JPy_JType *pyExceptionType;
 
     JPy_JPyObject = JType_GetTypeForName(jenv, "org.jpy.PyObject", JNI_FALSE);
     if (JPy_JPyObject == NULL) {
@@ -812,6 +1344,7 @@ int initGlobalPyObjectVars(JNIEnv* jenv)
         return -1;
     } else {
         JPy_KeyError_JClass = keyErrorType->classRef;
+        DEFINE_METHOD(JPy_KeyError_Init_MID, JPy_KeyError_JClass, "<init>", "(J)V");
     }
 
     stopIterationType = JType_GetTypeForName(jenv, "org.jpy.StopIteration", JNI_FALSE);
@@ -820,6 +1353,48 @@ int initGlobalPyObjectVars(JNIEnv* jenv)
         return -1;
     } else {
         JPy_StopIteration_JClass = stopIterationType->classRef;
+        DEFINE_METHOD(JPy_StopIteration_Init_MID, JPy_StopIteration_JClass, "<init>", "(J)V");
+    }
+
+    pyExceptionType = JType_GetTypeForName(jenv, "org.jpy.PyException", JNI_FALSE);
+    if (pyExceptionType == NULL) {
+        PyErr_Clear();
+        return -1;
+    } else {
+        JPy_PyException_JClass = pyExceptionType->classRef;
+        DEFINE_METHOD(JPy_PyException_Init_MID, JPy_PyException_JClass, "<init>", "(J)V");
+    }
+
+    // Used to iterate and convert Java collections with few Java calls, see jpy_jiterator.h and jpy_jcollection.h
+    JPy_JavaIteration_JClass = JPy_GetClass(jenv, "org/jpy/JavaIteration");
+    if (JPy_JavaIteration_JClass == NULL) {
+        (*jenv)->ExceptionClear(jenv);
+        PyErr_Clear();
+        return -1;
+    } else {
+        DEFINE_STATIC_METHOD(JPy_JavaIteration_Fill_SMID, JPy_JavaIteration_JClass, "fill", "(Ljava/util/Iterator;[Ljava/lang/Object;)I");
+        DEFINE_STATIC_METHOD(JPy_JavaIteration_Entries_SMID, JPy_JavaIteration_JClass, "entries", "(Ljava/util/Map;)[Ljava/lang/Object;");
+    }
+
+    // Used to convert arrays of boxed numbers to numpy arrays with a single Java call, see jpy_numpy.h
+    JPy_JavaUnboxing_JClass = JPy_GetClass(jenv, "org/jpy/JavaUnboxing");
+    if (JPy_JavaUnboxing_JClass == NULL) {
+        (*jenv)->ExceptionClear(jenv);
+        PyErr_Clear();
+        return -1;
+    } else {
+        DEFINE_STATIC_METHOD(JPy_JavaUnboxing_Unbox_SMID, JPy_JavaUnboxing_JClass, "unbox", "([Ljava/lang/Object;)Ljava/lang/Object;");
+    }
+
+    // Used to run Java calls and await CompletionStages from asyncio, see jpy_async.h
+    JPy_JavaAsync_JClass = JPy_GetClass(jenv, "org/jpy/JavaAsync");
+    if (JPy_JavaAsync_JClass == NULL) {
+        (*jenv)->ExceptionClear(jenv);
+        PyErr_Clear();
+        return -1;
+    } else {
+        DEFINE_STATIC_METHOD(JPy_JavaAsync_Submit_SMID, JPy_JavaAsync_JClass, "submit", "(J)V");
+        DEFINE_STATIC_METHOD(JPy_JavaAsync_WhenComplete_SMID, JPy_JavaAsync_JClass, "whenComplete", "(Ljava/util/concurrent/CompletionStage;J)V");
     }
 
     return 0;
@@ -842,6 +1417,7 @@ int JPy_InitGlobalVars(JNIEnv* jenv)
 
     DEFINE_CLASS(JPy_Class_JClass, "java/lang/Class");
     DEFINE_METHOD(JPy_Class_GetName_MID, JPy_Class_JClass, "getName", "()Ljava/lang/String;");
+    DEFINE_METHOD(JPy_Class_GetInterfaces_MID, JPy_Class_JClass, "getInterfaces", "()[Ljava/lang/Class;");
     DEFINE_METHOD(JPy_Class_GetDeclaredConstructors_MID, JPy_Class_JClass, "getDeclaredConstructors", "()[Ljava/lang/reflect/Constructor;");
     DEFINE_METHOD(JPy_Class_GetDeclaredMethods_MID, JPy_Class_JClass, "getDeclaredMethods", "()[Ljava/lang/reflect/Method;");
     DEFINE_METHOD(JPy_Class_GetDeclaredFields_MID, JPy_Class_JClass, "getDeclaredFields", "()[Ljava/lang/reflect/Field;");
@@ -870,6 +1446,11 @@ int JPy_InitGlobalVars(JNIEnv* jenv)
     DEFINE_METHOD(JPy_Map_entrySet_MID, JPy_Map_JClass, "entrySet", "()Ljava/util/Set;");
     DEFINE_METHOD(JPy_Map_put_MID, JPy_Map_JClass, "put", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
     DEFINE_METHOD(JPy_Map_clear_MID, JPy_Map_JClass, "clear", "()V");
+    DEFINE_METHOD(JPy_Map_get_MID, JPy_Map_JClass, "get", "(Ljava/lang/Object;)Ljava/lang/Object;");
+    DEFINE_METHOD(JPy_Map_containsKey_MID, JPy_Map_JClass, "containsKey", "(Ljava/lang/Object;)Z");
+    DEFINE_METHOD(JPy_Map_remove_MID, JPy_Map_JClass, "remove", "(Ljava/lang/Object;)Ljava/lang/Object;");
+    DEFINE_METHOD(JPy_Map_size_MID, JPy_Map_JClass, "size", "()I");
+    DEFINE_METHOD(JPy_Map_keySet_MID, JPy_Map_JClass, "keySet", "()Ljava/util/Set;");
 
     DEFINE_CLASS(JPy_Map_Entry_JClass, "java/util/Map$Entry");
     DEFINE_METHOD(JPy_Map_Entry_getKey_MID, JPy_Map_Entry_JClass, "getKey", "()Ljava/lang/Object;");
@@ -883,6 +1464,22 @@ int JPy_InitGlobalVars(JNIEnv* jenv)
     DEFINE_CLASS(JPy_Iterator_JClass, "java/util/Iterator");
     DEFINE_METHOD(JPy_Iterator_next_MID, JPy_Iterator_JClass, "next", "()Ljava/lang/Object;");
     DEFINE_METHOD(JPy_Iterator_hasNext_MID, JPy_Iterator_JClass, "hasNext", "()Z");
+    // java.lang.Iterable, JType_InitSlots() gives its subtypes the Python iterator protocol
+    DEFINE_CLASS(JPy_Iterable_JClass, "java/lang/Iterable");
+    DEFINE_METHOD(JPy_Iterable_Iterator_MID, JPy_Iterable_JClass, "iterator", "()Ljava/util/Iterator;");
+    // java.util.Collection and java.util.List, JType_InitSlots() gives lists the Python sequence protocol
+    DEFINE_CLASS(JPy_Collection_JClass, "java/util/Collection");
+    DEFINE_METHOD(JPy_Collection_size_MID, JPy_Collection_JClass, "size", "()I");
+    DEFINE_METHOD(JPy_Collection_contains_MID, JPy_Collection_JClass, "contains", "(Ljava/lang/Object;)Z");
+    DEFINE_METHOD(JPy_Collection_toArray_MID, JPy_Collection_JClass, "toArray", "()[Ljava/lang/Object;");
+    DEFINE_CLASS(JPy_List_JClass, "java/util/List");
+    DEFINE_METHOD(JPy_List_get_MID, JPy_List_JClass, "get", "(I)Ljava/lang/Object;");
+    // java.util.concurrent.CompletionStage, awaited by jpy.call_async() and jpy.as_future()
+    DEFINE_CLASS(JPy_CompletionStage_JClass, "java/util/concurrent/CompletionStage");
+    // java.util.concurrent.CompletableFuture, completed with the results of Python coroutines run for Java callers
+    DEFINE_CLASS(JPy_CompletableFuture_JClass, "java/util/concurrent/CompletableFuture");
+    DEFINE_METHOD(JPy_CompletableFuture_Complete_MID, JPy_CompletableFuture_JClass, "complete", "(Ljava/lang/Object;)Z");
+    DEFINE_METHOD(JPy_CompletableFuture_CompleteExceptionally_MID, JPy_CompletableFuture_JClass, "completeExceptionally", "(Ljava/lang/Throwable;)Z");
 
     DEFINE_CLASS(JPy_RuntimeException_JClass, "java/lang/RuntimeException");
     DEFINE_CLASS(JPy_OutOfMemoryError_JClass, "java/lang/OutOfMemoryError");
@@ -925,6 +1522,10 @@ int JPy_InitGlobalVars(JNIEnv* jenv)
     DEFINE_CLASS(JPy_Void_JClass, "java/lang/Void");
 
     DEFINE_CLASS(JPy_String_JClass, "java/lang/String");
+
+    DEFINE_CLASS(JPy_System_JClass, "java/lang/System");
+    DEFINE_STATIC_METHOD(JPy_System_IdentityHashCode_SMID, JPy_System_JClass, "identityHashCode", "(Ljava/lang/Object;)I");
+
     DEFINE_CLASS(JPy_Throwable_JClass, "java/lang/Throwable");
     DEFINE_CLASS(JPy_StackTraceElement_JClass, "java/lang/StackTraceElement");
 
@@ -976,24 +1577,33 @@ int JPy_InitGlobalVars(JNIEnv* jenv)
 void JPy_ClearGlobalVars(JNIEnv* jenv)
 {
     if (jenv != NULL) {
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Comparable_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Object_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Class_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Constructor_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Method_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Field_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_RuntimeException_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Boolean_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Character_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Byte_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Short_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Integer_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Long_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Float_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Double_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Number_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_Void_JClass);
-        (*jenv)->DeleteGlobalRef(jenv, JPy_String_JClass);
+        JPy_DeleteGlobalRef(jenv, JPy_Comparable_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Object_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Class_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Constructor_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Method_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Field_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_RuntimeException_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Boolean_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Character_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Byte_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Short_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Integer_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Long_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Float_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Double_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Number_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Void_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_String_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_System_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Iterable_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_JavaIteration_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_JavaUnboxing_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_Collection_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_List_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_CompletionStage_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_CompletableFuture_JClass, JPy_GREF_CLASS);
+        JPy_DeleteGlobalRef(jenv, JPy_JavaAsync_JClass, JPy_GREF_CLASS);
     }
 
     JPy_Comparable_JClass = NULL;
@@ -1014,11 +1624,21 @@ void JPy_ClearGlobalVars(JNIEnv* jenv)
     JPy_Number_JClass = NULL;
     JPy_Void_JClass = NULL;
     JPy_String_JClass = NULL;
+    JPy_System_JClass = NULL;
+    JPy_Iterable_JClass = NULL;
+    JPy_JavaIteration_JClass = NULL;
+    JPy_JavaUnboxing_JClass = NULL;
+    JPy_Collection_JClass = NULL;
+    JPy_List_JClass = NULL;
+    JPy_CompletionStage_JClass = NULL;
+    JPy_CompletableFuture_JClass = NULL;
+    JPy_JavaAsync_JClass = NULL;
 
     JPy_Object_ToString_MID = NULL;
     JPy_Object_HashCode_MID = NULL;
     JPy_Object_Equals_MID = NULL;
     JPy_Class_GetName_MID = NULL;
+    JPy_Class_GetInterfaces_MID = NULL;
     JPy_Class_GetDeclaredConstructors_MID = NULL;
     JPy_Class_GetDeclaredFields_MID = NULL;
     JPy_Class_GetDeclaredMethods_MID = NULL;
@@ -1049,6 +1669,21 @@ void JPy_ClearGlobalVars(JNIEnv* jenv)
     JPy_Number_IntValue_MID = NULL;
     JPy_Number_LongValue_MID = NULL;
     JPy_Number_DoubleValue_MID = NULL;
+    JPy_System_IdentityHashCode_SMID = NULL;
+    JPy_Iterable_Iterator_MID = NULL;
+    JPy_JavaIteration_Fill_SMID = NULL;
+    JPy_JavaIteration_Entries_SMID = NULL;
+    JPy_JavaUnboxing_Unbox_SMID = NULL;
+    JPy_JavaAsync_Submit_SMID = NULL;
+    JPy_JavaAsync_WhenComplete_SMID = NULL;
+    JPy_Map_size_MID = NULL;
+    JPy_Map_keySet_MID = NULL;
+    JPy_Collection_size_MID = NULL;
+    JPy_Collection_contains_MID = NULL;
+    JPy_Collection_toArray_MID = NULL;
+    JPy_List_get_MID = NULL;
+    JPy_CompletableFuture_Complete_MID = NULL;
+    JPy_CompletableFuture_CompleteExceptionally_MID = NULL;
     JPy_PyObject_GetPointer_MID = NULL;
     JPy_PyObject_UnwrapProxy_SMID = NULL;
 
@@ -1094,206 +1729,40 @@ void JPy_ClearGlobalVars(JNIEnv* jenv)
     JPy_JPyModule = NULL;
 }
 
-#define AT_STRING "\tat "
-#define AT_STRLEN 4
-#define CAUSED_BY_STRING "caused by "
-#define CAUSED_BY_STRLEN 10
-#define ELIDED_STRING_MAX_SIZE 30
-
 void JPy_HandleJavaException(JNIEnv* jenv)
 {
     jthrowable error = (*jenv)->ExceptionOccurred(jenv);
     if (error != NULL) {
-        jstring message;
-        int allocError = 0;
+        PyObject* pyException;
 
         if (JPy_DiagFlags != 0) {
             (*jenv)->ExceptionDescribe(jenv);
         }
+        (*jenv)->ExceptionClear(jenv);
 
-        if (JPy_VerboseExceptions) {
-            char *stackTraceString;
-            size_t stackTraceLength = 0;
-            jthrowable cause = error;
-            jarray enclosingElements = NULL;
-            jint enclosingSize = 0;
-
-            stackTraceString = strdup("");
-
-            do {
-                /* We want the type and the detail string, which is actually what a Throwable toString() does by
-                 * default, as does the default printStackTrace(). */
-                jint ii;
-
-                jarray stackTrace;
-                jint stackTraceElements;
-                jint lastElementToPrint;
-                jint enclosingIndex;
-
-                if (stackTraceLength > 0) {
-                    char *newStackString;
-
-                    newStackString = realloc(stackTraceString, CAUSED_BY_STRLEN + 1 + stackTraceLength);
-                    if (newStackString == NULL) {
-                        allocError = 1;
-                        break;
-                    }
-                    stackTraceString = newStackString;
-                    strcat(stackTraceString, CAUSED_BY_STRING);
-                    stackTraceLength += CAUSED_BY_STRLEN;
-                }
-
-                message = (jstring) (*jenv)->CallObjectMethod(jenv, cause, JPy_Object_ToString_MID);
-                if (message != NULL) {
-                    const char *messageChars = (*jenv)->GetStringUTFChars(jenv, message, NULL);
-                    if (messageChars != NULL) {
-                        char *newStackString;
-                        size_t len = strlen(messageChars);
-
-                        newStackString = realloc(stackTraceString, len + 2 + stackTraceLength);
-                        if (newStackString == NULL) {
-                            (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
-                            allocError = 1;
-                            break;
-                        }
-
-                        stackTraceString = newStackString;
-                        strcat(stackTraceString, messageChars);
-                        stackTraceString[stackTraceLength + len] = '\n';
-                        stackTraceString[stackTraceLength + len + 1] = '\0';
-                        stackTraceLength += (len + 1);
-
-                        (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
-                    } else {
-                        allocError = 1;
-                        break;
-                    }
-                    JPy_DELETE_LOCAL_REF(message);
-                }
-
-                /* We should assemble a string based on the stack trace. */
-                stackTrace = (*jenv)->CallObjectMethod(jenv, cause, JPy_Throwable_getStackTrace_MID);
-                stackTraceElements = (*jenv)->GetArrayLength(jenv, stackTrace);
-                lastElementToPrint = stackTraceElements - 1;
-                enclosingIndex = enclosingSize - 1;
-
-                while (lastElementToPrint >= 0 && enclosingIndex >= 0) {
-                    jobject thisElement = (*jenv)->GetObjectArrayElement(jenv, stackTrace, lastElementToPrint);
-                    jobject thatElement = (*jenv)->GetObjectArrayElement(jenv, enclosingElements, enclosingIndex);
-
-                    // if they are equal, let's decrement, otherwise we break
-                    jboolean  equal = (*jenv)->CallBooleanMethod(jenv, thisElement, JPy_Object_Equals_MID, thatElement);
-                    if (!equal) {
-                        break;
-                    }
-
-                    lastElementToPrint--;
-                    enclosingIndex--;
-                }
-
-                for (ii = 0; ii <= lastElementToPrint; ++ii) {
-                    jobject traceElement = (*jenv)->GetObjectArrayElement(jenv, stackTrace, ii);
-                    if (traceElement != NULL) {
-                        message = (jstring) (*jenv)->CallObjectMethod(jenv, traceElement, JPy_Object_ToString_MID);
-                        if (message != NULL) {
-                            size_t len;
-                            char *newStackString;
-                            const char *messageChars = (*jenv)->GetStringUTFChars(jenv, message, NULL);
-                            if (messageChars == NULL) {
-                                allocError = 1;
-                                break;
-                            }
-
-                            len = strlen(messageChars);
-
-                            newStackString = realloc(stackTraceString, len + 2 + AT_STRLEN + stackTraceLength);
-                            if (newStackString == NULL) {
-                                (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
-                                allocError = 1;
-                                break;
-                            }
-
-                            stackTraceString = newStackString;
-                            strcat(stackTraceString, AT_STRING);
-                            strcat(stackTraceString, messageChars);
-                            stackTraceString[stackTraceLength + len + AT_STRLEN] = '\n';
-                            stackTraceString[stackTraceLength + len + AT_STRLEN + 1] = '\0';
-                            stackTraceLength += (len + 1 + AT_STRLEN);
-
-                            (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
-                        }
-
-                    }
-                }
-
-                if (lastElementToPrint < stackTraceElements - 1) {
-                    int written;
-                    char *newStackString = realloc(stackTraceString, stackTraceLength + ELIDED_STRING_MAX_SIZE);
-                    if (newStackString == NULL) {
-                        allocError = 1;
-                        break;
-                    }
-
-                    stackTraceString = newStackString;
-                    stackTraceString[stackTraceLength + ELIDED_STRING_MAX_SIZE - 1] = '\0';
-
-                    written = snprintf(stackTraceString + stackTraceLength, ELIDED_STRING_MAX_SIZE - 1, "\t... %d more\n", (stackTraceElements - lastElementToPrint) - 1);
-                    if (written > (ELIDED_STRING_MAX_SIZE - 1)) {
-                        stackTraceLength += (ELIDED_STRING_MAX_SIZE - 1);
-                    } else {
-                        stackTraceLength += written;
-                    }
-                }
-
-                /** So we can eliminate extra entries. */
-                enclosingElements = stackTrace;
-                enclosingSize = stackTraceElements;
-
-                /** Now the next cause. */
-                cause = (*jenv)->CallObjectMethod(jenv, cause, JPy_Throwable_getCause_MID);
-            } while (cause != NULL && !allocError);
-
-            if (allocError == 0 && stackTraceString != NULL) {
-                PyErr_Format(PyExc_RuntimeError, "%s", stackTraceString);
-            } else {
-                PyErr_SetString(PyExc_RuntimeError,
-                                "Java VM exception occurred, but failed to allocate message text");
-            }
-            free(stackTraceString);
-        } else {
-            message = (jstring) (*jenv)->CallObjectMethod(jenv, error, JPy_Object_ToString_MID);
-            if (message != NULL) {
-                const char *messageChars;
-
-                messageChars = (*jenv)->GetStringUTFChars(jenv, message, NULL);
-                if (messageChars != NULL) {
-                    PyErr_Format(PyExc_RuntimeError, "%s", messageChars);
-                    (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
-                } else {
-                    PyErr_SetString(PyExc_RuntimeError,
-                                    "Java VM exception occurred, but failed to allocate message text");
-                }
-                JPy_DELETE_LOCAL_REF(message);
-            } else {
-                PyErr_SetString(PyExc_RuntimeError, "Java VM exception occurred, no message");
-            }
+        // The message is formatted lazily, see jpy_jexception.h
+        pyException = JException_New(jenv, error, JPy_VerboseExceptions);
+        if (pyException != NULL) {
+            PyErr_SetObject((PyObject*) Py_TYPE(pyException), pyException);
+            JPy_DECREF(pyException);
         }
 
         JPy_DELETE_LOCAL_REF(error);
-        (*jenv)->ExceptionClear(jenv);
     }
 }
 
 void JPy_free()
 {
     JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "JPy_free: freeing module data...\n");
+    JPy_Async_Free();
     JPy_ClearGlobalVars(NULL);
+    JPy_Numpy_Free();
 
     JPy_Module = NULL;
     JPy_Types = NULL;
     JPy_Type_Callbacks = NULL;
     JPy_Type_Translations = NULL;
-    JException_Type = NULL;
+    JPy_Exception_Types = NULL;
 
     JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "JPy_free: done freeing module data\n");
 }
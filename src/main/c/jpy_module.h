@@ -56,7 +56,7 @@ extern PyObject* JPy_Module;
 extern PyObject* JPy_Types;
 extern PyObject* JPy_Type_Callbacks;
 extern PyObject* JPy_Type_Translations;
-extern PyObject* JException_Type;
+extern PyObject* JPy_Exception_Types;
 
 extern JavaVM* JPy_JVM;
 extern jboolean JPy_MustDestroyJVM;
@@ -67,6 +67,7 @@ extern jboolean JPy_MustDestroyJVM;
 #define JPy_MODULE_ATTR_NAME_TYPES "types"
 #define JPy_MODULE_ATTR_NAME_TYPE_CALLBACKS "type_callbacks"
 #define JPy_MODULE_ATTR_NAME_TYPE_TRANSLATIONS "type_translations"
+#define JPy_MODULE_ATTR_NAME_EXCEPTION_TYPES "exception_types"
 
 
 /**
@@ -165,9 +166,13 @@ extern jclass JPy_Object_JClass;
 extern jmethodID JPy_Object_ToString_MID;
 extern jmethodID JPy_Object_HashCode_MID;
 extern jmethodID JPy_Object_Equals_MID;
+extern jclass JPy_Throwable_JClass;
+extern jmethodID JPy_Throwable_getStackTrace_MID;
+extern jmethodID JPy_Throwable_getCause_MID;
 // java.lang.Class
 extern jclass JPy_Class_JClass;
 extern jmethodID JPy_Class_GetName_MID;
+extern jmethodID JPy_Class_GetInterfaces_MID;
 extern jmethodID JPy_Class_GetDeclaredConstructors_MID;
 extern jmethodID JPy_Class_GetDeclaredFields_MID;
 extern jmethodID JPy_Class_GetDeclaredMethods_MID;
@@ -197,8 +202,27 @@ extern jclass JPy_Map_Entry_JClass;
 extern jmethodID JPy_Map_entrySet_MID;
 extern jmethodID JPy_Map_put_MID;
 extern jmethodID JPy_Map_clear_MID;
+extern jmethodID JPy_Map_get_MID;
+extern jmethodID JPy_Map_containsKey_MID;
+extern jmethodID JPy_Map_remove_MID;
 extern jmethodID JPy_Map_Entry_getKey_MID;
 extern jmethodID JPy_Map_Entry_getValue_MID;
+extern jmethodID JPy_Map_size_MID;
+extern jmethodID JPy_Map_keySet_MID;
+// java.util.Collection
+extern jclass JPy_Collection_JClass;
+extern jmethodID JPy_Collection_size_MID;
+extern jmethodID JPy_Collection_contains_MID;
+extern jmethodID JPy_Collection_toArray_MID;
+// java.util.List
+extern jclass JPy_List_JClass;
+extern jmethodID JPy_List_get_MID;
+// java.util.concurrent.CompletionStage
+extern jclass JPy_CompletionStage_JClass;
+// java.util.concurrent.CompletableFuture
+extern jclass JPy_CompletableFuture_JClass;
+extern jmethodID JPy_CompletableFuture_Complete_MID;
+extern jmethodID JPy_CompletableFuture_CompleteExceptionally_MID;
 // java.util.Set
 extern jclass JPy_Set_JClass;
 extern jmethodID JPy_Set_Iterator_MID;
@@ -213,6 +237,10 @@ extern jclass JPy_FileNotFoundException_JClass;
 extern jclass JPy_UnsupportedOperationException_JClass;
 extern jclass JPy_KeyError_JClass;
 extern jclass JPy_StopIteration_JClass;
+extern jclass JPy_PyException_JClass;
+extern jmethodID JPy_KeyError_Init_MID;
+extern jmethodID JPy_StopIteration_Init_MID;
+extern jmethodID JPy_PyException_Init_MID;
 
 extern jclass JPy_Boolean_JClass;
 extern jmethodID JPy_Boolean_ValueOf_SMID;
@@ -250,6 +278,20 @@ extern jmethodID JPy_Number_DoubleValue_MID;
 extern jclass JPy_String_JClass;
 extern jclass JPy_Void_JClass;
 
+extern jclass JPy_System_JClass;
+extern jmethodID JPy_System_IdentityHashCode_SMID;
+
+extern jclass JPy_Iterable_JClass;
+extern jmethodID JPy_Iterable_Iterator_MID;
+extern jclass JPy_JavaIteration_JClass;
+extern jmethodID JPy_JavaIteration_Fill_SMID;
+extern jmethodID JPy_JavaIteration_Entries_SMID;
+extern jclass JPy_JavaUnboxing_JClass;
+extern jmethodID JPy_JavaUnboxing_Unbox_SMID;
+extern jclass JPy_JavaAsync_JClass;
+extern jmethodID JPy_JavaAsync_Submit_SMID;
+extern jmethodID JPy_JavaAsync_WhenComplete_SMID;
+
 extern jclass JPy_PyObject_JClass;
 extern jmethodID JPy_PyObject_GetPointer_MID;
 extern jmethodID JPy_PyObject_UnwrapProxy_SMID;
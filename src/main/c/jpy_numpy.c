@@ -0,0 +1,182 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_jtype.h"
+#include "jpy_numpy.h"
+
+
+// The numpy module, NULL until imported by JPy_Numpy_Import()
+static PyObject* JPy_Numpy = NULL;
+
+int JPy_Numpy_Import(void)
+{
+    if (JPy_Numpy == NULL) {
+        JPy_Numpy = PyImport_ImportModule("numpy");
+        if (JPy_Numpy == NULL) {
+            return -1;
+        }
+        JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JPy_Numpy_Import: numpy imported\n");
+    }
+    return 0;
+}
+
+void JPy_Numpy_Free(void)
+{
+    Py_CLEAR(JPy_Numpy);
+}
+
+const char* JPy_Numpy_GetTypeCode(JPy_JType* type)
+{
+    if (type == JPy_JBoolean) {
+        return "?";
+    } else if (type == JPy_JByte) {
+        return "b";
+    } else if (type == JPy_JChar) {
+        return "H";
+    } else if (type == JPy_JShort) {
+        return "h";
+    } else if (type == JPy_JInt) {
+        return "i";
+    } else if (type == JPy_JLong) {
+        return "q";
+    } else if (type == JPy_JFloat) {
+        return "f";
+    } else if (type == JPy_JDouble) {
+        return "d";
+    }
+    return NULL;
+}
+
+/**
+ * Copies a Java primitive array into a new numpy array with a single Get<T>ArrayRegion call.
+ */
+static PyObject* JPy_Numpy_FromJArray(JNIEnv* jenv, jarray arrayRef, JPy_JType* componentType)
+{
+    PyObject* array;
+    Py_buffer view;
+    const char* typeCode;
+    jsize length;
+
+    typeCode = JPy_Numpy_GetTypeCode(componentType);
+    if (typeCode == NULL) {
+        PyErr_Format(PyExc_RuntimeError, "jpy: internal error: illegal primitive Java type %s", componentType->javaName);
+        return NULL;
+    }
+
+    length = (*jenv)->GetArrayLength(jenv, arrayRef);
+    array = PyObject_CallMethod(JPy_Numpy, "empty", "(ns)", (Py_ssize_t) length, typeCode);
+    if (array == NULL) {
+        return NULL;
+    }
+    if (PyObject_GetBuffer(array, &view, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS) < 0) {
+        JPy_DECREF(array);
+        return NULL;
+    }
+
+    if (componentType == JPy_JBoolean) {
+        (*jenv)->GetBooleanArrayRegion(jenv, arrayRef, 0, length, (jboolean*) view.buf);
+    } else if (componentType == JPy_JByte) {
+        (*jenv)->GetByteArrayRegion(jenv, arrayRef, 0, length, (jbyte*) view.buf);
+    } else if (componentType == JPy_JChar) {
+        (*jenv)->GetCharArrayRegion(jenv, arrayRef, 0, length, (jchar*) view.buf);
+    } else if (componentType == JPy_JShort) {
+        (*jenv)->GetShortArrayRegion(jenv, arrayRef, 0, length, (jshort*) view.buf);
+    } else if (componentType == JPy_JInt) {
+        (*jenv)->GetIntArrayRegion(jenv, arrayRef, 0, length, (jint*) view.buf);
+    } else if (componentType == JPy_JLong) {
+        (*jenv)->GetLongArrayRegion(jenv, arrayRef, 0, length, (jlong*) view.buf);
+    } else if (componentType == JPy_JFloat) {
+        (*jenv)->GetFloatArrayRegion(jenv, arrayRef, 0, length, (jfloat*) view.buf);
+    } else {
+        (*jenv)->GetDoubleArrayRegion(jenv, arrayRef, 0, length, (jdouble*) view.buf);
+    }
+    PyBuffer_Release(&view);
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "JPy_Numpy_FromJArray: copied %d items of type %s\n", (int) length, componentType->javaName);
+    return array;
+}
+
+PyObject* JPy_Numpy_FromJObject(JNIEnv* jenv, jobject objectRef, JPy_JType* type)
+{
+    PyObject* result;
+    JPy_JType* unboxedType;
+    jobject arrayRef;
+    jobject unboxedRef;
+
+    if (JPy_Numpy_Import() < 0) {
+        return NULL;
+    }
+
+    if (type->componentType != NULL && type->componentType->isPrimitive) {
+        return JPy_Numpy_FromJArray(jenv, objectRef, type->componentType);
+    }
+
+    if (type->componentType != NULL) {
+        arrayRef = (*jenv)->NewLocalRef(jenv, objectRef);
+    } else if ((*jenv)->IsInstanceOf(jenv, objectRef, JPy_Collection_JClass)) {
+        Py_BEGIN_ALLOW_THREADS
+        arrayRef = (*jenv)->CallObjectMethod(jenv, objectRef, JPy_Collection_toArray_MID);
+        Py_END_ALLOW_THREADS
+        JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
+    } else {
+        PyErr_Format(PyExc_ValueError, "cannot convert a Java '%s' to a numpy array", type->javaName);
+        return NULL;
+    }
+    if (arrayRef == NULL) {
+        return PyErr_NoMemory();
+    }
+
+    if (JPy_JavaUnboxing_JClass == NULL) {
+        JPy_DELETE_LOCAL_REF(arrayRef);
+        PyErr_SetString(PyExc_RuntimeError, "jpy: class org.jpy.JavaUnboxing not found, jpy.jar must be on the class path");
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    unboxedRef = (*jenv)->CallStaticObjectMethod(jenv, JPy_JavaUnboxing_JClass, JPy_JavaUnboxing_Unbox_SMID, arrayRef);
+    Py_END_ALLOW_THREADS
+    JPy_DELETE_LOCAL_REF(arrayRef);
+    JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
+
+    unboxedType = JType_GetTypeForObject(jenv, unboxedRef, JNI_FALSE);
+    if (unboxedType == NULL) {
+        JPy_DELETE_LOCAL_REF(unboxedRef);
+        return NULL;
+    }
+    result = JPy_Numpy_FromJArray(jenv, unboxedRef, unboxedType->componentType);
+    JPy_DELETE_LOCAL_REF(unboxedRef);
+    return result;
+}
+
+PyObject* JPy_Numpy_AsContiguousArray(PyObject* pyArg, JPy_JType* componentType)
+{
+    const char* typeCode;
+
+    if (JPy_Numpy_Import() < 0) {
+        return NULL;
+    }
+    typeCode = JPy_Numpy_GetTypeCode(componentType);
+    if (typeCode == NULL) {
+        PyErr_Format(PyExc_RuntimeError, "jpy: internal error: illegal primitive Java type %s", componentType->javaName);
+        return NULL;
+    }
+    return PyObject_CallMethod(JPy_Numpy, "ascontiguousarray", "(Os)", pyArg, typeCode);
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+#ifndef JPY_NUMPY_H
+#define JPY_NUMPY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+
+/**
+ * Optional numpy conversions. numpy is not a build or runtime dependency of jpy: it is imported on first
+ * use, and the conversions are only applied where enabled, i.e. by jpy.to_numpy(), for method return values
+ * with JMethod.set_return_numpy() and for method parameters with JMethod.set_param_numpy().
+ */
+
+/**
+ * Imports numpy unless already imported. Returns -1 and sets an ImportError if numpy is not available.
+ */
+int JPy_Numpy_Import(void);
+
+/**
+ * Releases the imported numpy module, called by JPy_free() before the interpreter is finalized.
+ */
+void JPy_Numpy_Free(void);
+
+/**
+ * Returns the numpy type code of the given primitive type, e.g. "i" for JPy_JInt, or NULL if it is not primitive.
+ */
+const char* JPy_Numpy_GetTypeCode(JPy_JType* type);
+
+/**
+ * Creates a new numpy array from a Java primitive array with a single bulk copy, or from an Object[]
+ * or java.util.Collection of boxed numbers unboxed by a single Java call, see org.jpy.JavaUnboxing.
+ * Returns a new reference.
+ */
+PyObject* JPy_Numpy_FromJObject(JNIEnv* jenv, jobject objectRef, JPy_JType* type);
+
+/**
+ * Converts a numpy array of any dtype or any other sequence to a C-contiguous numpy array of the given
+ * primitive component type, casting the items in a vectorized way. Returns a new reference, which is
+ * 'pyArg' itself if it already is such an array.
+ */
+PyObject* JPy_Numpy_AsContiguousArray(PyObject* pyArg, JPy_JType* componentType);
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_NUMPY_H */
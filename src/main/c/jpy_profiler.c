@@ -0,0 +1,330 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_jtype.h"
+#include "jpy_jmethod.h"
+#include "jpy_metrics.h"
+#include "jpy_profiler.h"
+#include <pythread.h>
+#include <stdio.h>
+#include <string.h>
+
+int JPy_ProfilerEnabled = 0;
+
+typedef struct JPy_ProfilerEvent
+{
+    jlong startTime;
+    jlong duration;
+    unsigned long threadId;
+    // New reference to the JMethod or Python callable, NULL for an unused slot
+    PyObject* subject;
+    int direction;
+}
+JPy_ProfilerEvent;
+
+// Ring buffer, only accessed by the GIL holder
+static JPy_ProfilerEvent* JPy_Profiler_Events = NULL;
+static Py_ssize_t JPy_Profiler_Capacity = 0;
+static Py_ssize_t JPy_Profiler_Next = 0;
+static jlong JPy_Profiler_Recorded = 0;
+static jlong JPy_Profiler_StartTime = 0;
+// Set while JPy_Profiler_Dump() reads the ring buffer, recording is paused then
+static int JPy_Profiler_Dumping = 0;
+// Whether to resume recording after the dump
+static int JPy_Profiler_Resume = 0;
+
+
+static void JPy_Profiler_Clear(void)
+{
+    Py_ssize_t i;
+    PyObject* subject;
+
+    for (i = 0; i < JPy_Profiler_Capacity; i++) {
+        subject = JPy_Profiler_Events[i].subject;
+        JPy_Profiler_Events[i].subject = NULL;
+        JPy_XDECREF(subject);
+    }
+    JPy_Profiler_Next = 0;
+    JPy_Profiler_Recorded = 0;
+}
+
+int JPy_Profiler_Start(Py_ssize_t capacity)
+{
+    JPy_ProfilerEvent* events;
+
+    if (capacity <= 0) {
+        PyErr_SetString(PyExc_ValueError, "profiler capacity must be positive");
+        return -1;
+    }
+    if (JPy_Profiler_Dumping) {
+        PyErr_SetString(PyExc_RuntimeError, "cannot restart the profiler while its profile is being dumped");
+        return -1;
+    }
+
+    JPy_ProfilerEnabled = 0;
+    JPy_Profiler_Clear();
+    if (capacity != JPy_Profiler_Capacity) {
+        events = PyMem_New(JPy_ProfilerEvent, capacity);
+        if (events == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        memset(events, 0, capacity * sizeof (JPy_ProfilerEvent));
+        PyMem_Del(JPy_Profiler_Events);
+        JPy_Profiler_Events = events;
+        JPy_Profiler_Capacity = capacity;
+    }
+
+    JPy_Profiler_StartTime = JPy_NanoTime();
+    JPy_ProfilerEnabled = 1;
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JPy_Profiler_Start: recording up to %d events\n", (int) capacity);
+    return 0;
+}
+
+void JPy_Profiler_Stop(void)
+{
+    JPy_ProfilerEnabled = 0;
+    JPy_Profiler_Resume = 0;
+}
+
+void JPy_Profiler_Record(int direction, PyObject* subject, jlong startTime)
+{
+    JPy_ProfilerEvent* event;
+    PyObject* oldSubject;
+
+    if (JPy_Profiler_Events == NULL || subject == NULL) {
+        return;
+    }
+
+    event = JPy_Profiler_Events + JPy_Profiler_Next;
+    oldSubject = event->subject;
+    JPy_INCREF(subject);
+    event->subject = subject;
+    event->startTime = startTime;
+    event->duration = JPy_NanoTime() - startTime;
+    event->threadId = PyThread_get_thread_ident();
+    event->direction = direction;
+    JPy_Profiler_Next = (JPy_Profiler_Next + 1) % JPy_Profiler_Capacity;
+    JPy_Profiler_Recorded++;
+    // Released last, a destructor may call back into Java and record another event
+    JPy_XDECREF(oldSubject);
+}
+
+/**
+ * Returns a new string naming the event's subject: "<class>#<method>" for Java methods,
+ * "<module>.<qualified name>" for Python callables.
+ */
+static PyObject* JPy_Profiler_GetName(JPy_ProfilerEvent* event)
+{
+    PyObject* subject;
+    PyObject* module;
+    PyObject* name;
+    PyObject* fullName;
+
+    if (event->direction == JPy_PROFILER_PYTHON_TO_JAVA) {
+        JPy_JMethod* method = (JPy_JMethod*) event->subject;
+        return JPy_FROM_FORMAT("%s#%s", method->declaringClass->javaName, JPy_AS_UTF8(method->name));
+    }
+
+    // Looking up the attributes may run Python code which releases the GIL, keep the subject alive
+    // even if its slot gets reused meanwhile
+    subject = event->subject;
+    JPy_INCREF(subject);
+    name = PyObject_GetAttrString(subject, "__qualname__");
+    if (name == NULL) {
+        PyErr_Clear();
+        name = PyObject_GetAttrString(subject, "__name__");
+    }
+    if (name == NULL || !JPy_IS_STR(name)) {
+        PyErr_Clear();
+        JPy_XDECREF(name);
+        fullName = PyObject_Repr(subject);
+        JPy_DECREF(subject);
+        return fullName;
+    }
+    module = PyObject_GetAttrString(subject, "__module__");
+    JPy_DECREF(subject);
+    if (module == NULL || !JPy_IS_STR(module)) {
+        PyErr_Clear();
+        JPy_XDECREF(module);
+        return name;
+    }
+    fullName = JPy_FROM_FORMAT("%s.%s", JPy_AS_UTF8(module), JPy_AS_UTF8(name));
+    JPy_DECREF(module);
+    JPy_DECREF(name);
+    return fullName;
+}
+
+/**
+ * Returns a new list of Chrome trace events: a complete ("X") event per recorded call, timestamps in
+ * microseconds since the profiler was started, and a thread name ("M") event per thread. Threads are
+ * numbered in the order they first appear. The number of calls is stored in 'callCount'.
+ */
+static PyObject* JPy_Profiler_GetTraceEvents(Py_ssize_t* callCount)
+{
+    PyObject* traceEvents;
+    PyObject* threadIds;
+    PyObject* threadKey;
+    PyObject* tid;
+    PyObject* name;
+    PyObject* traceEvent;
+    JPy_ProfilerEvent* event;
+    Py_ssize_t count;
+    Py_ssize_t first;
+    Py_ssize_t i;
+
+    traceEvents = PyList_New(0);
+    threadIds = PyDict_New();
+    if (traceEvents == NULL || threadIds == NULL) {
+        goto error;
+    }
+
+    count = JPy_Profiler_Recorded < JPy_Profiler_Capacity ? (Py_ssize_t) JPy_Profiler_Recorded : JPy_Profiler_Capacity;
+    first = JPy_Profiler_Recorded < JPy_Profiler_Capacity ? 0 : JPy_Profiler_Next;
+    for (i = 0; i < count; i++) {
+        event = JPy_Profiler_Events + (first + i) % JPy_Profiler_Capacity;
+
+        threadKey = PyLong_FromUnsignedLong(event->threadId);
+        if (threadKey == NULL) {
+            goto error;
+        }
+        tid = PyDict_GetItem(threadIds, threadKey);
+        if (tid == NULL) {
+            tid = JPy_FROM_CLONG(PyDict_Size(threadIds) + 1);
+            if (tid == NULL || PyDict_SetItem(threadIds, threadKey, tid) < 0) {
+                JPy_XDECREF(tid);
+                JPy_DECREF(threadKey);
+                goto error;
+            }
+            JPy_DECREF(tid);
+            traceEvent = Py_BuildValue("{s:s,s:s,s:i,s:O,s:{s:N}}",
+                                       "name", "thread_name", "ph", "M", "pid", 1, "tid", tid,
+                                       "args", "name", JPy_FROM_FORMAT("thread-%lu", event->threadId));
+            if (traceEvent == NULL || PyList_Append(traceEvents, traceEvent) < 0) {
+                JPy_XDECREF(traceEvent);
+                JPy_DECREF(threadKey);
+                goto error;
+            }
+            JPy_DECREF(traceEvent);
+        }
+        JPy_DECREF(threadKey);
+
+        name = JPy_Profiler_GetName(event);
+        if (name == NULL) {
+            goto error;
+        }
+        traceEvent = Py_BuildValue("{s:N,s:s,s:s,s:d,s:d,s:i,s:O}",
+                                   "name", name,
+                                   "cat", event->direction == JPy_PROFILER_PYTHON_TO_JAVA ? "java" : "python",
+                                   "ph", "X",
+                                   "ts", (double) (event->startTime - JPy_Profiler_StartTime) / 1000.0,
+                                   "dur", (double) event->duration / 1000.0,
+                                   "pid", 1,
+                                   "tid", tid);
+        if (traceEvent == NULL || PyList_Append(traceEvents, traceEvent) < 0) {
+            JPy_XDECREF(traceEvent);
+            goto error;
+        }
+        JPy_DECREF(traceEvent);
+    }
+
+    JPy_DECREF(threadIds);
+    *callCount = count;
+    return traceEvents;
+
+error:
+    JPy_XDECREF(traceEvents);
+    JPy_XDECREF(threadIds);
+    return NULL;
+}
+
+Py_ssize_t JPy_Profiler_Dump(const char* path)
+{
+    PyObject* traceEvents = NULL;
+    PyObject* trace = NULL;
+    PyObject* jsonModule = NULL;
+    PyObject* json = NULL;
+    const char* jsonChars;
+    size_t jsonLen;
+    FILE* file;
+    Py_ssize_t callCount;
+    Py_ssize_t count = -1;
+    int err;
+
+    if (JPy_Profiler_Dumping) {
+        PyErr_SetString(PyExc_RuntimeError, "the profile is already being dumped");
+        return -1;
+    }
+    // Nothing is recorded while dumping, so that no call made on the way (e.g. by a Python
+    // object's __qualname__ property calling Java, or by another thread while the GIL is released)
+    // overwrites and releases the events being read
+    JPy_Profiler_Resume = JPy_ProfilerEnabled;
+    JPy_ProfilerEnabled = 0;
+    JPy_Profiler_Dumping = 1;
+
+    traceEvents = JPy_Profiler_GetTraceEvents(&callCount);
+    if (traceEvents == NULL) {
+        goto error;
+    }
+    trace = Py_BuildValue("{s:O,s:s,s:{s:L}}", "traceEvents", traceEvents, "displayTimeUnit", "ns",
+                          "otherData", "recorded_events", (long long) JPy_Profiler_Recorded);
+    if (trace == NULL) {
+        goto error;
+    }
+
+    jsonModule = PyImport_ImportModule("json");
+    if (jsonModule == NULL) {
+        goto error;
+    }
+    json = PyObject_CallMethod(jsonModule, "dumps", "O", trace);
+    if (json == NULL) {
+        goto error;
+    }
+    jsonChars = JPy_AS_UTF8(json);
+    if (jsonChars == NULL) {
+        goto error;
+    }
+    jsonLen = strlen(jsonChars);
+
+    file = fopen(path, "wb");
+    if (file == NULL) {
+        PyErr_SetFromErrnoWithFilename(PyExc_IOError, path);
+        goto error;
+    }
+    err = fwrite(jsonChars, 1, jsonLen, file) != jsonLen;
+    err = fclose(file) != 0 || err;
+    if (err) {
+        PyErr_SetFromErrnoWithFilename(PyExc_IOError, path);
+        goto error;
+    }
+
+    count = callCount;
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JPy_Profiler_Dump: wrote %d calls to '%s'\n", (int) count, path);
+
+error:
+    JPy_XDECREF(traceEvents);
+    JPy_XDECREF(trace);
+    JPy_XDECREF(jsonModule);
+    JPy_XDECREF(json);
+    JPy_Profiler_Dumping = 0;
+    JPy_ProfilerEnabled = JPy_Profiler_Resume;
+    return count;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#ifndef JPY_PROFILER_H
+#define JPY_PROFILER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+
+/**
+ * Profiler hook for calls crossing the Python/Java boundary.
+ *
+ * While started (jpy.start_profiler(), PyLib.Diag.startProfiler()), every Java method called from
+ * Python (JMethod_InvokeMethod) and every Python callable called from Java (PyLib_CallAndReturnObject)
+ * is recorded as a complete event - start time, duration, thread and the JMethod or Python callable -
+ * into a fixed size ring buffer, so that memory stays bounded and the oldest events are overwritten.
+ * jpy.dump_profile() writes the events as a Chrome trace JSON file, which chrome://tracing, Perfetto
+ * and speedscope can display as a flame graph mixing Python and Java frames.
+ *
+ * Events are recorded by the thread holding the GIL, which also guards the ring buffer. While stopped,
+ * the instrumented paths only test JPy_ProfilerEnabled.
+ */
+
+#define JPy_PROFILER_PYTHON_TO_JAVA 0
+#define JPy_PROFILER_JAVA_TO_PYTHON 1
+
+#define JPy_PROFILER_DEFAULT_CAPACITY 65536
+
+extern int JPy_ProfilerEnabled;
+
+/**
+ * Starts recording into a cleared ring buffer with room for 'capacity' events. GIL must be held.
+ * Returns 0 on success, -1 and sets a Python error otherwise.
+ */
+int JPy_Profiler_Start(Py_ssize_t capacity);
+
+/**
+ * Stops recording. The recorded events are kept until the profiler is started again.
+ */
+void JPy_Profiler_Stop(void);
+
+/**
+ * Records a call that began at 'startTime' (see JPy_NanoTime()) and ends now. 'subject' is the
+ * JMethod (direction JPy_PROFILER_PYTHON_TO_JAVA) or Python callable (JPy_PROFILER_JAVA_TO_PYTHON)
+ * being called. GIL must be held.
+ */
+void JPy_Profiler_Record(int direction, PyObject* subject, jlong startTime);
+
+/**
+ * Writes the recorded events as Chrome trace JSON to the file at 'path'. GIL must be held.
+ * Returns the number of recorded calls written, without the thread name metadata events,
+ * or -1 and sets a Python error.
+ */
+Py_ssize_t JPy_Profiler_Dump(const char* path);
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_PROFILER_H */
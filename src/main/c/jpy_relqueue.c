@@ -0,0 +1,285 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_relqueue.h"
+#include "jpy_metrics.h"
+#include <pythread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JPy_RELQUEUE_INITIAL_CAPACITY 1024
+#define JPy_RELQUEUE_RETAINED_CAPACITY 65536
+
+volatile Py_ssize_t JPy_RelQueue_Depth = 0;
+
+// Guards the ring buffer and the statistics
+static PyThread_type_lock JPy_RelQueue_Lock = NULL;
+// Ring buffer of pending references, capacity is always a power of two
+static PyObject** JPy_RelQueue_Items = NULL;
+static Py_ssize_t JPy_RelQueue_Capacity = 0;
+static Py_ssize_t JPy_RelQueue_Head = 0;
+// Set while no interpreter is running, pushes are rejected then
+static int JPy_RelQueue_Closed = 0;
+
+// Only accessed by the GIL holder
+static PyObject* JPy_RelQueue_DrainBuffer[JPy_RELQUEUE_MAX_DRAIN];
+static int JPy_RelQueue_Draining = 0;
+
+static jlong JPy_RelQueue_MaxDepth = 0;
+static jlong JPy_RelQueue_Enqueued = 0;
+static jlong JPy_RelQueue_Released = 0;
+static jlong JPy_RelQueue_Drains = 0;
+static jlong JPy_RelQueue_DrainNanos = 0;
+static jlong JPy_RelQueue_MaxDrainNanos = 0;
+
+
+int JPy_RelQueue_Init(void)
+{
+    if (JPy_RelQueue_Lock == NULL) {
+        JPy_RelQueue_Lock = PyThread_allocate_lock();
+        if (JPy_RelQueue_Lock == NULL) {
+            return -1;
+        }
+    }
+    PyThread_acquire_lock(JPy_RelQueue_Lock, WAIT_LOCK);
+    JPy_RelQueue_Closed = 0;
+    PyThread_release_lock(JPy_RelQueue_Lock);
+    return 0;
+}
+
+Py_ssize_t JPy_RelQueue_Close(void)
+{
+    Py_ssize_t discarded;
+
+    if (JPy_RelQueue_Lock == NULL) {
+        return 0;
+    }
+
+    PyThread_acquire_lock(JPy_RelQueue_Lock, WAIT_LOCK);
+    discarded = JPy_RelQueue_Depth;
+    JPy_RelQueue_Closed = 1;
+    JPy_RelQueue_Head = 0;
+    JPy_RelQueue_Depth = 0;
+    PyThread_release_lock(JPy_RelQueue_Lock);
+
+    if (discarded > 0) {
+        JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "JPy_RelQueue_Close: discarded %d references\n", (int) discarded);
+    }
+    return discarded;
+}
+
+/**
+ * Makes room for at least minCapacity references. Must be called with the queue lock held.
+ */
+static int JPy_RelQueue_Grow(Py_ssize_t minCapacity)
+{
+    PyObject** items;
+    Py_ssize_t capacity;
+    Py_ssize_t i;
+
+    capacity = JPy_RelQueue_Capacity > 0 ? JPy_RelQueue_Capacity : JPy_RELQUEUE_INITIAL_CAPACITY;
+    while (capacity < minCapacity) {
+        capacity *= 2;
+    }
+
+    // Called without the GIL, so don't use the PyMem_* allocators
+    items = (PyObject**) malloc(capacity * sizeof (PyObject*));
+    if (items == NULL) {
+        return -1;
+    }
+    for (i = 0; i < JPy_RelQueue_Depth; i++) {
+        items[i] = JPy_RelQueue_Items[(JPy_RelQueue_Head + i) & (JPy_RelQueue_Capacity - 1)];
+    }
+    free(JPy_RelQueue_Items);
+
+    JPy_RelQueue_Items = items;
+    JPy_RelQueue_Capacity = capacity;
+    JPy_RelQueue_Head = 0;
+    return 0;
+}
+
+Py_ssize_t JPy_RelQueue_Push(const jlong* pointers, Py_ssize_t count)
+{
+    Py_ssize_t depth;
+    Py_ssize_t tail;
+    Py_ssize_t i;
+
+    if (JPy_RelQueue_Lock == NULL) {
+        return -1;
+    }
+
+    PyThread_acquire_lock(JPy_RelQueue_Lock, WAIT_LOCK);
+
+    if (JPy_RelQueue_Closed) {
+        PyThread_release_lock(JPy_RelQueue_Lock);
+        return -1;
+    }
+
+    depth = JPy_RelQueue_Depth;
+    if (depth + count > JPy_RelQueue_Capacity && JPy_RelQueue_Grow(depth + count) < 0) {
+        PyThread_release_lock(JPy_RelQueue_Lock);
+        return -1;
+    }
+
+    tail = JPy_RelQueue_Head + depth;
+    for (i = 0; i < count; i++) {
+        JPy_RelQueue_Items[(tail + i) & (JPy_RelQueue_Capacity - 1)] = (PyObject*) pointers[i];
+    }
+    depth += count;
+    JPy_RelQueue_Depth = depth;
+    JPy_RelQueue_Enqueued += count;
+    if (depth > JPy_RelQueue_MaxDepth) {
+        JPy_RelQueue_MaxDepth = depth;
+    }
+
+    PyThread_release_lock(JPy_RelQueue_Lock);
+    return depth;
+}
+
+/**
+ * Moves up to maxCount references from the head of the queue into the drain buffer.
+ */
+static Py_ssize_t JPy_RelQueue_Take(Py_ssize_t maxCount)
+{
+    Py_ssize_t count;
+    Py_ssize_t i;
+
+    PyThread_acquire_lock(JPy_RelQueue_Lock, WAIT_LOCK);
+
+    count = JPy_RelQueue_Depth;
+    if (count > maxCount) {
+        count = maxCount;
+    }
+    for (i = 0; i < count; i++) {
+        JPy_RelQueue_DrainBuffer[i] = JPy_RelQueue_Items[(JPy_RelQueue_Head + i) & (JPy_RelQueue_Capacity - 1)];
+    }
+    JPy_RelQueue_Head = (JPy_RelQueue_Head + count) & (JPy_RelQueue_Capacity - 1);
+    JPy_RelQueue_Depth -= count;
+
+    // Give back the memory of a large burst once it has been worked off
+    if (JPy_RelQueue_Depth == 0 && JPy_RelQueue_Capacity > JPy_RELQUEUE_RETAINED_CAPACITY) {
+        free(JPy_RelQueue_Items);
+        JPy_RelQueue_Items = NULL;
+        JPy_RelQueue_Capacity = 0;
+        JPy_RelQueue_Head = 0;
+    }
+
+    PyThread_release_lock(JPy_RelQueue_Lock);
+    return count;
+}
+
+Py_ssize_t JPy_RelQueue_Drain(Py_ssize_t maxCount)
+{
+    PyObject* pyObject;
+    PyObject* errType;
+    PyObject* errValue;
+    PyObject* errTraceback;
+    Py_ssize_t refCount;
+    Py_ssize_t remaining;
+    Py_ssize_t released;
+    Py_ssize_t count;
+    Py_ssize_t i;
+    jlong startTime;
+    jlong elapsed;
+
+    // A destructor run by the drain may release the GIL, and another thread may try to drain
+    // on its way out of a native call. Only one drain at a time may use the drain buffer.
+    if (JPy_RelQueue_Lock == NULL || JPy_RelQueue_Draining) {
+        return 0;
+    }
+    JPy_RelQueue_Draining = 1;
+
+    startTime = JPy_NanoTime();
+    remaining = maxCount;
+    released = 0;
+
+    // Destructors must not see (or clear) an error that is pending in the calling code
+    PyErr_Fetch(&errType, &errValue, &errTraceback);
+
+    while (remaining != 0) {
+        count = JPy_RelQueue_Take(remaining < 0 || remaining > JPy_RELQUEUE_MAX_DRAIN ? JPy_RELQUEUE_MAX_DRAIN : remaining);
+        if (count == 0) {
+            break;
+        }
+        for (i = 0; i < count; i++) {
+            pyObject = JPy_RelQueue_DrainBuffer[i];
+            refCount = pyObject->ob_refcnt;
+            if (refCount <= 0) {
+                JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "JPy_RelQueue_Drain: error: refCount <= 0: pyObject=%p, refCount=%d\n", pyObject, refCount);
+            } else {
+                JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "JPy_RelQueue_Drain: pyObject=%p, refCount=%d, type='%s'\n", pyObject, refCount, Py_TYPE(pyObject)->tp_name);
+                JPy_DECREF(pyObject);
+            }
+        }
+        released += count;
+        if (remaining > 0) {
+            remaining -= count;
+        }
+    }
+
+    PyErr_Restore(errType, errValue, errTraceback);
+
+    if (released > 0) {
+        elapsed = JPy_NanoTime() - startTime;
+        PyThread_acquire_lock(JPy_RelQueue_Lock, WAIT_LOCK);
+        JPy_RelQueue_Released += released;
+        JPy_RelQueue_Drains++;
+        JPy_RelQueue_DrainNanos += elapsed;
+        if (elapsed > JPy_RelQueue_MaxDrainNanos) {
+            JPy_RelQueue_MaxDrainNanos = elapsed;
+        }
+        PyThread_release_lock(JPy_RelQueue_Lock);
+        JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "JPy_RelQueue_Drain: released %d references in %lld ns\n", (int) released, (long long) elapsed);
+    }
+
+    JPy_RelQueue_Draining = 0;
+    return released;
+}
+
+void JPy_RelQueue_DrainPending(void)
+{
+    Py_ssize_t count;
+
+    count = JPy_RelQueue_Depth / 4;
+    if (count < JPy_RELQUEUE_MIN_DRAIN) {
+        count = JPy_RELQUEUE_MIN_DRAIN;
+    } else if (count > JPy_RELQUEUE_MAX_DRAIN) {
+        count = JPy_RELQUEUE_MAX_DRAIN;
+    }
+    JPy_RelQueue_Drain(count);
+}
+
+void JPy_RelQueue_GetStats(jlong* stats)
+{
+    if (JPy_RelQueue_Lock == NULL) {
+        memset(stats, 0, JPy_RELQUEUE_STAT_COUNT * sizeof (jlong));
+        return;
+    }
+    PyThread_acquire_lock(JPy_RelQueue_Lock, WAIT_LOCK);
+    stats[JPy_RELQUEUE_STAT_DEPTH] = JPy_RelQueue_Depth;
+    stats[JPy_RELQUEUE_STAT_MAX_DEPTH] = JPy_RelQueue_MaxDepth;
+    stats[JPy_RELQUEUE_STAT_ENQUEUED] = JPy_RelQueue_Enqueued;
+    stats[JPy_RELQUEUE_STAT_RELEASED] = JPy_RelQueue_Released;
+    stats[JPy_RELQUEUE_STAT_DRAINS] = JPy_RelQueue_Drains;
+    stats[JPy_RELQUEUE_STAT_DRAIN_NANOS] = JPy_RelQueue_DrainNanos;
+    stats[JPy_RELQUEUE_STAT_MAX_DRAIN_NANOS] = JPy_RelQueue_MaxDrainNanos;
+    PyThread_release_lock(JPy_RelQueue_Lock);
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#ifndef JPY_RELQUEUE_H
+#define JPY_RELQUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+
+/**
+ * The release queue collects PyObject references which Java wants to give up (PyObject.close() and
+ * the PyObject reference queue) without having to acquire the GIL. The queue itself is guarded by
+ * a plain PyThread lock which is held only for pushing and popping pointers, never while running
+ * Python code. It is drained opportunistically by whichever thread holds the GIL when it leaves a
+ * PyLib native method (see JPy_END_GIL_STATE), so that the references are released in batches
+ * instead of each paying for its own GIL round trip.
+ */
+
+/**
+ * Indices of the values returned by JPy_RelQueue_GetStats().
+ */
+#define JPy_RELQUEUE_STAT_DEPTH          0
+#define JPy_RELQUEUE_STAT_MAX_DEPTH      1
+#define JPy_RELQUEUE_STAT_ENQUEUED       2
+#define JPy_RELQUEUE_STAT_RELEASED       3
+#define JPy_RELQUEUE_STAT_DRAINS         4
+#define JPy_RELQUEUE_STAT_DRAIN_NANOS    5
+#define JPy_RELQUEUE_STAT_MAX_DRAIN_NANOS 6
+#define JPy_RELQUEUE_STAT_COUNT          7
+
+/**
+ * Number of pending references. Written under the queue lock, read without it as a cheap hint.
+ */
+extern volatile Py_ssize_t JPy_RelQueue_Depth;
+
+/**
+ * Creates the queue lock and (re-)opens the queue for pushes. Must be called before any other
+ * function of the release queue, and again after JPy_RelQueue_Close() when a new interpreter starts.
+ * Returns 0 on success, -1 otherwise.
+ */
+int JPy_RelQueue_Init(void);
+
+/**
+ * Rejects all further pushes and discards the references still in the queue, because they must
+ * not be released once the interpreter they belong to is finalized.
+ * Returns the number of discarded references.
+ */
+Py_ssize_t JPy_RelQueue_Close(void);
+
+/**
+ * Appends the given references to the queue. The GIL is not required.
+ * Returns the queue depth after the push, or -1 if the references could not be queued, in which
+ * case the caller remains responsible for releasing them.
+ */
+Py_ssize_t JPy_RelQueue_Push(const jlong* pointers, Py_ssize_t count);
+
+/**
+ * Releases up to maxCount queued references, or all of them if maxCount is negative.
+ * The GIL must be held. Returns the number of released references.
+ */
+Py_ssize_t JPy_RelQueue_Drain(Py_ssize_t maxCount);
+
+/**
+ * Releases a part of the queued references whose size adapts to the current backlog: a quarter of
+ * the queue, but at least JPy_RELQUEUE_MIN_DRAIN and at most JPy_RELQUEUE_MAX_DRAIN references.
+ * The GIL must be held.
+ */
+void JPy_RelQueue_DrainPending(void);
+
+/**
+ * Copies the queue statistics into the given array of JPy_RELQUEUE_STAT_COUNT elements.
+ */
+void JPy_RelQueue_GetStats(jlong* stats);
+
+#define JPy_RELQUEUE_MIN_DRAIN 64
+#define JPy_RELQUEUE_MAX_DRAIN 8192
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_RELQUEUE_H */
@@ -0,0 +1,279 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_jtype.h"
+#include "jpy_conv.h"
+#include "jpy_typetrans.h"
+
+// Starts at 1, so that the translationVersion 0 of new JTypes is outdated
+unsigned int JPy_TypeTranslations_Version = 1;
+
+
+/**
+ * Calls the dict method of the given name on self and counts the modification.
+ */
+static PyObject* TypeTranslations_Forward(PyObject* self, const char* name, PyObject* args, PyObject* kwds)
+{
+    PyObject* method;
+    PyObject* methodArgs;
+    PyObject* result;
+    Py_ssize_t i;
+    Py_ssize_t n;
+
+    method = PyObject_GetAttrString((PyObject*) &PyDict_Type, name);
+    if (method == NULL) {
+        return NULL;
+    }
+
+    n = args != NULL ? PyTuple_Size(args) : 0;
+    methodArgs = PyTuple_New(n + 1);
+    if (methodArgs == NULL) {
+        JPy_DECREF(method);
+        return NULL;
+    }
+    JPy_INCREF(self);
+    PyTuple_SET_ITEM(methodArgs, 0, self);
+    for (i = 0; i < n; i++) {
+        PyObject* arg = PyTuple_GET_ITEM(args, i);
+        JPy_INCREF(arg);
+        PyTuple_SET_ITEM(methodArgs, i + 1, arg);
+    }
+
+    result = PyObject_Call(method, methodArgs, kwds);
+    JPy_DECREF(methodArgs);
+    JPy_DECREF(method);
+
+    JPy_TypeTranslations_Version++;
+    return result;
+}
+
+static PyObject* TypeTranslations_update(PyObject* self, PyObject* args, PyObject* kwds)
+{
+    return TypeTranslations_Forward(self, "update", args, kwds);
+}
+
+static PyObject* TypeTranslations_setdefault(PyObject* self, PyObject* args)
+{
+    return TypeTranslations_Forward(self, "setdefault", args, NULL);
+}
+
+static PyObject* TypeTranslations_pop(PyObject* self, PyObject* args)
+{
+    return TypeTranslations_Forward(self, "pop", args, NULL);
+}
+
+static PyObject* TypeTranslations_popitem(PyObject* self)
+{
+    return TypeTranslations_Forward(self, "popitem", NULL, NULL);
+}
+
+static PyObject* TypeTranslations_clear(PyObject* self)
+{
+    return TypeTranslations_Forward(self, "clear", NULL, NULL);
+}
+
+static int TypeTranslations_ass_subscript(PyObject* self, PyObject* key, PyObject* value)
+{
+    JPy_TypeTranslations_Version++;
+    if (value != NULL) {
+        return PyDict_SetItem(self, key, value);
+    }
+    return PyDict_DelItem(self, key);
+}
+
+static PyObject* TypeTranslations_inplace_or(PyObject* self, PyObject* other)
+{
+    PyObject* args;
+    PyObject* result;
+
+    args = PyTuple_Pack(1, other);
+    if (args == NULL) {
+        return NULL;
+    }
+    result = TypeTranslations_Forward(self, "update", args, NULL);
+    JPy_DECREF(args);
+    if (result == NULL) {
+        return NULL;
+    }
+    JPy_DECREF(result);
+    JPy_INCREF(self);
+    return self;
+}
+
+static PyMappingMethods TypeTranslations_as_mapping = {
+    NULL,                                       /* mp_length (inherited) */
+    NULL,                                       /* mp_subscript (inherited) */
+    (objobjargproc) TypeTranslations_ass_subscript,   /* mp_ass_subscript */
+};
+
+// The layout differs between Python 2 and 3, nb_inplace_or is set in TypeTranslations_InitType()
+static PyNumberMethods TypeTranslations_as_number;
+
+static PyMethodDef TypeTranslations_methods[] = {
+    {"update", (PyCFunction) TypeTranslations_update, METH_VARARGS | METH_KEYWORDS, "See dict.update()"},
+    {"setdefault", (PyCFunction) TypeTranslations_setdefault, METH_VARARGS, "See dict.setdefault()"},
+    {"pop", (PyCFunction) TypeTranslations_pop, METH_VARARGS, "See dict.pop()"},
+    {"popitem", (PyCFunction) TypeTranslations_popitem, METH_NOARGS, "See dict.popitem()"},
+    {"clear", (PyCFunction) TypeTranslations_clear, METH_NOARGS, "See dict.clear()"},
+    {NULL}  /* Sentinel */
+};
+
+PyTypeObject TypeTranslations_Type =
+{
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "jpy.TypeTranslations",                     /* tp_name */
+    sizeof (PyDictObject),                      /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    NULL,                                       /* tp_dealloc (inherited) */
+    NULL,                                       /* tp_print */
+    NULL,                                       /* tp_getattr */
+    NULL,                                       /* tp_setattr */
+    NULL,                                       /* tp_reserved */
+    NULL,                                       /* tp_repr */
+    &TypeTranslations_as_number,                /* tp_as_number */
+    NULL,                                       /* tp_as_sequence */
+    &TypeTranslations_as_mapping,               /* tp_as_mapping */
+    NULL,                                       /* tp_hash  */
+    NULL,                                       /* tp_call */
+    NULL,                                       /* tp_str */
+    NULL,                                       /* tp_getattro */
+    NULL,                                       /* tp_setattro */
+    NULL,                                       /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                         /* tp_flags (Py_TPFLAGS_HAVE_GC is inherited) */
+    "Java type names mapped to callables translating wrapped Java objects, see jpy.type_translations",   /* tp_doc */
+    NULL,                                       /* tp_traverse (inherited) */
+    NULL,                                       /* tp_clear (inherited) */
+    NULL,                                       /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    NULL,                                       /* tp_iter */
+    NULL,                                       /* tp_iternext */
+    TypeTranslations_methods,                   /* tp_methods */
+    NULL,                                       /* tp_members */
+    NULL,                                       /* tp_getset */
+    &PyDict_Type,                               /* tp_base */
+    NULL,                                       /* tp_dict */
+    NULL,                                       /* tp_descr_get */
+    NULL,                                       /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    NULL,                                       /* tp_init */
+    NULL,                                       /* tp_alloc */
+    NULL,                                       /* tp_new */
+};
+
+int TypeTranslations_InitType(void)
+{
+    TypeTranslations_as_number.nb_inplace_or = (binaryfunc) TypeTranslations_inplace_or;
+    return PyType_Ready(&TypeTranslations_Type);
+}
+
+/**
+ * Looks up the names of the interfaces implemented by classRef, then those of their super-interfaces.
+ * Returns 1 and sets *value (borrowed) if an entry was found, 0 if not, -1 on errors.
+ */
+static int JType_FindTranslationOfInterfaces(JNIEnv* jenv, jclass classRef, PyObject** value)
+{
+    jobjectArray interfaces;
+    jclass interfaceRef;
+    PyObject* name;
+    jsize count;
+    jsize i;
+    int found;
+
+    interfaces = (*jenv)->CallObjectMethod(jenv, classRef, JPy_Class_GetInterfaces_MID);
+    JPy_ON_JAVA_EXCEPTION_RETURN(-1);
+    count = (*jenv)->GetArrayLength(jenv, interfaces);
+
+    found = 0;
+    for (i = 0; i < count && found == 0; i++) {
+        interfaceRef = (*jenv)->GetObjectArrayElement(jenv, interfaces, i);
+        name = JPy_FromTypeName(jenv, interfaceRef);
+        if (name == NULL) {
+            found = -1;
+        } else {
+            *value = PyDict_GetItem(JPy_Type_Translations, name);
+            found = *value != NULL;
+            JPy_DECREF(name);
+        }
+        JPy_DELETE_LOCAL_REF(interfaceRef);
+    }
+    for (i = 0; i < count && found == 0; i++) {
+        interfaceRef = (*jenv)->GetObjectArrayElement(jenv, interfaces, i);
+        found = JType_FindTranslationOfInterfaces(jenv, interfaceRef, value);
+        JPy_DELETE_LOCAL_REF(interfaceRef);
+    }
+
+    JPy_DELETE_LOCAL_REF(interfaces);
+    return found;
+}
+
+/**
+ * Returns 1 and sets *value (borrowed) if an entry was found for type, 0 if not, -1 on errors.
+ */
+static int JType_FindTranslation(JNIEnv* jenv, JPy_JType* type, PyObject** value)
+{
+    JPy_JType* t;
+    int found;
+
+    if (PyDict_Size(JPy_Type_Translations) == 0) {
+        return 0;
+    }
+
+    for (t = type; t != NULL; t = t->superType) {
+        *value = PyDict_GetItemString(JPy_Type_Translations, t->javaName);
+        if (*value != NULL) {
+            return 1;
+        }
+    }
+    for (t = type; t != NULL; t = t->superType) {
+        found = JType_FindTranslationOfInterfaces(jenv, t->classRef, value);
+        if (found != 0) {
+            return found;
+        }
+    }
+    return 0;
+}
+
+PyObject* JType_GetTranslation(JNIEnv* jenv, JPy_JType* type)
+{
+    PyObject* value;
+    int found;
+
+    if (type->translationVersion == JPy_TypeTranslations_Version) {
+        return type->translation;
+    }
+
+    value = NULL;
+    found = JType_FindTranslation(jenv, type, &value);
+    if (found < 0) {
+        return NULL;
+    }
+    if (found && !PyCallable_Check(value)) {
+        value = NULL;
+    }
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JType_GetTranslation: type->javaName=\"%s\", translation=%p\n", type->javaName, value);
+
+    Py_XINCREF(value);
+    JPy_XDECREF(type->translation);
+    type->translation = value;
+    type->translationVersion = JPy_TypeTranslations_Version;
+    return value;
+}
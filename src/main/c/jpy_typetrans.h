@@ -0,0 +1,60 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file was modified by Deephaven Data Labs.
+ *
+ */
+
+#ifndef JPY_TYPETRANS_H
+#define JPY_TYPETRANS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+
+struct JPy_JType;
+
+/**
+ * The type of jpy.type_translations, a dict subclass which counts its modifications in
+ * JPy_TypeTranslations_Version. This lets every JType cache the translation callable found for it
+ * and revalidate the cache by comparing a single number, instead of looking up its name each time
+ * an object is wrapped.
+ */
+extern PyTypeObject TypeTranslations_Type;
+
+/**
+ * Incremented whenever jpy.type_translations is modified.
+ */
+extern unsigned int JPy_TypeTranslations_Version;
+
+/**
+ * Readies TypeTranslations_Type. Returns 0 on success, -1 otherwise.
+ */
+int TypeTranslations_InitType(void);
+
+/**
+ * Returns the translation callable for objects of the given type (a borrowed reference), or NULL if
+ * there is none. The type's Java name is looked up first, then the names of its superclasses, then
+ * the names of the interfaces implemented by them. The first entry found wins; if it is not callable
+ * (e.g. None), the type has no translation. Returns NULL and sets a Python error if the lookup failed.
+ */
+PyObject* JType_GetTranslation(JNIEnv* jenv, struct JPy_JType* type);
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_TYPETRANS_H */
@@ -0,0 +1,68 @@
+package org.jpy;
+
+import java.util.concurrent.CompletionException;
+import java.util.concurrent.CompletionStage;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.LinkedBlockingQueue;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.ThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+
+/**
+ * Support for awaiting Java calls from Python's asyncio. {@code jpy.call_async()} prepares a Java
+ * method call and {@link #submit(long) submits} it to a pool of daemon threads, which perform the
+ * call natively ({@link PyLib#runAsyncCall(long)}) and post the result to a completion queue drained
+ * by the Python event loop. {@link CompletionStage}s are awaited with {@link #whenComplete(CompletionStage, long)}
+ * instead of blocking a thread. Not meant to be used by Java code.
+ * <p>
+ * The maximum number of threads is given by the system property {@code jpy.asyncThreads} and defaults
+ * to twice the number of processors, but at least 4. Idle threads terminate after a minute.
+ */
+final class JavaAsync {
+
+    private static final int MAX_THREADS = Integer.getInteger("jpy.asyncThreads",
+                                                              Math.max(4, 2 * Runtime.getRuntime().availableProcessors()));
+
+    private static final ExecutorService EXECUTOR = newExecutor();
+
+    private JavaAsync() {
+    }
+
+    /**
+     * Performs the native call on a thread of the pool.
+     *
+     * @param call the native call
+     */
+    static void submit(long call) {
+        EXECUTOR.execute(() -> PyLib.runAsyncCall(call));
+    }
+
+    /**
+     * Posts the outcome of the stage when it completes, on the thread completing it.
+     *
+     * @param stage the stage awaited by Python
+     * @param call  the native call
+     */
+    static void whenComplete(CompletionStage<?> stage, long call) {
+        stage.whenComplete((value, error) -> {
+            if (error instanceof CompletionException && error.getCause() != null) {
+                error = error.getCause();
+            }
+            PyLib.completeAsyncCall(call, value, error);
+        });
+    }
+
+    private static ExecutorService newExecutor() {
+        AtomicInteger threadCount = new AtomicInteger();
+        ThreadFactory threadFactory = runnable -> {
+            Thread thread = new Thread(runnable, "jpy-async-" + threadCount.incrementAndGet());
+            thread.setDaemon(true);
+            return thread;
+        };
+        ThreadPoolExecutor executor = new ThreadPoolExecutor(MAX_THREADS, MAX_THREADS, 60, TimeUnit.SECONDS,
+                                                             new LinkedBlockingQueue<>(), threadFactory);
+        executor.allowCoreThreadTimeOut(true);
+        return executor;
+    }
+}
@@ -0,0 +1,56 @@
+package org.jpy;
+
+import java.util.Arrays;
+import java.util.Iterator;
+import java.util.Map;
+
+/**
+ * Support for iterating Java collections from Python. When a Python loop iterates a
+ * {@link Iterable}, jpy calls {@link #fill(Iterator, Object[])} to fetch the elements in chunks,
+ * so that only one Java call is needed per chunk instead of calls of {@code hasNext()} and
+ * {@code next()} per element. Likewise, {@code jpy.to_dict()} fetches all entries of a map with
+ * a single call of {@link #entries(Map)}. Not meant to be used by Java code.
+ */
+final class JavaIteration {
+
+    private JavaIteration() {
+    }
+
+    /**
+     * Moves the next elements of the iterator into the buffer.
+     *
+     * @param iterator the iterator
+     * @param buffer   receives the elements, unused slots are set to null
+     * @return the number of elements stored, less than the buffer length if the iterator is exhausted
+     */
+    static int fill(Iterator<?> iterator, Object[] buffer) {
+        int count = 0;
+        while (count < buffer.length && iterator.hasNext()) {
+            buffer[count++] = iterator.next();
+        }
+        if (count < buffer.length) {
+            Arrays.fill(buffer, count, buffer.length, null);
+        }
+        return count;
+    }
+
+    /**
+     * Gets the keys and values of the map.
+     *
+     * @param map the map
+     * @return the keys and values, alternating
+     */
+    static Object[] entries(Map<?, ?> map) {
+        Object[] entries = new Object[2 * map.size()];
+        int count = 0;
+        for (Map.Entry<?, ?> entry : map.entrySet()) {
+            if (count == entries.length) {
+                // the map has grown meanwhile
+                entries = Arrays.copyOf(entries, 2 * entries.length + 2);
+            }
+            entries[count++] = entry.getKey();
+            entries[count++] = entry.getValue();
+        }
+        return count == entries.length ? entries : Arrays.copyOf(entries, count);
+    }
+}
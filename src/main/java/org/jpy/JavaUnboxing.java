@@ -0,0 +1,62 @@
+package org.jpy;
+
+/**
+ * Support for converting arrays of boxed numbers to numpy arrays. {@code jpy.to_numpy()} calls
+ * {@link #unbox(Object[])} so that the values are unboxed in a single Java call instead of
+ * converting every element to a Python object first. Not meant to be used by Java code.
+ */
+final class JavaUnboxing {
+
+    private JavaUnboxing() {
+    }
+
+    /**
+     * Unboxes the values into a primitive array: a {@code boolean[]} if all values are
+     * {@link Boolean}s, a {@code long[]} if all values are {@link Byte}s, {@link Short}s,
+     * {@link Integer}s or {@link Long}s, and a {@code double[]} for any other {@link Number}s.
+     * Null values are unboxed as {@code NaN}, which makes the result a {@code double[]}.
+     *
+     * @param values the boxed values
+     * @return the primitive array
+     * @throws IllegalArgumentException if a value is neither a {@link Number} nor a {@link Boolean},
+     *                                  or {@link Boolean}s are mixed with other values
+     */
+    static Object unbox(Object[] values) {
+        boolean allBooleans = true;
+        boolean allIntegers = true;
+        for (Object value : values) {
+            if (value instanceof Boolean) {
+                allIntegers = false;
+            } else if (value == null || value instanceof Number) {
+                allBooleans = false;
+                allIntegers &= value instanceof Byte || value instanceof Short || value instanceof Integer || value instanceof Long;
+            } else {
+                throw new IllegalArgumentException("cannot unbox a " + value.getClass().getName());
+            }
+        }
+
+        if (allBooleans && values.length > 0) {
+            boolean[] result = new boolean[values.length];
+            for (int i = 0; i < values.length; i++) {
+                result[i] = (Boolean) values[i];
+            }
+            return result;
+        }
+        if (allIntegers) {
+            long[] result = new long[values.length];
+            for (int i = 0; i < values.length; i++) {
+                result[i] = ((Number) values[i]).longValue();
+            }
+            return result;
+        }
+        double[] result = new double[values.length];
+        for (int i = 0; i < values.length; i++) {
+            Object value = values[i];
+            if (value instanceof Boolean) {
+                throw new IllegalArgumentException("cannot unbox Booleans mixed with numbers");
+            }
+            result[i] = value != null ? ((Number) value).doubleValue() : Double.NaN;
+        }
+        return result;
+    }
+}
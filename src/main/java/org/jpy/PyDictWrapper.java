@@ -20,7 +20,6 @@ package org.jpy;
 
 import java.util.*;
 import java.util.AbstractMap.SimpleImmutableEntry;
-import java.util.stream.Collectors;
 
 /**
  * A simple wrapper around PyObjects that are actually Python dictionaries, to present the most useful parts of a
@@ -42,9 +41,7 @@ public class PyDictWrapper implements Map<PyObject, PyObject>, AutoCloseable {
 
     @Override
     public int size() {
-        try (final PyObject pyObj = pyObject.callMethod("__len__")) {
-            return pyObj.getIntValue();
-        }
+        return PyLib.pyDictSize(pyObject.getPointer());
     }
 
     @Override
@@ -70,16 +67,12 @@ public class PyDictWrapper implements Map<PyObject, PyObject>, AutoCloseable {
 
     @Override
     public boolean containsValue(Object value) {
-        return values().contains(value);
+        return PyLib.pyDictContainsValue(pyObject.getPointer(), value, null);
     }
 
     @Override
     public PyObject get(Object key) {
-        try {
-            return getItem(key);
-        } catch (KeyError e) {
-            return null;
-        }
+        return PyLib.pyDictGetItem(pyObject.getPointer(), key, null);
     }
 
     /**
@@ -91,13 +84,7 @@ public class PyDictWrapper implements Map<PyObject, PyObject>, AutoCloseable {
 
     @Override
     public PyObject put(PyObject key, PyObject value) {
-        PyObject previous;
-        try {
-            // note: this is a BORROWED REFERENCE - todo
-            previous = getItem(key);
-        } catch (KeyError e) {
-            previous = null;
-        }
+        final PyObject previous = get(key);
         setItem(key, value);
         return previous;
     }
@@ -186,18 +173,13 @@ public class PyDictWrapper implements Map<PyObject, PyObject>, AutoCloseable {
      */
     @Override
     public Set<Entry<PyObject, PyObject>> entrySet() {
-        // todo: we'd prefer to use something like
-        // https://docs.python.org/2.7/c-api/dict.html#c.PyDict_Next
-        // https://docs.python.org/3/c-api/dict.html#c.PyDict_Next
-        // but that method signature is a bit weird on the java <-> python jni layer with PyObject
-        // reference return values...
-        try (final PyObject pyObj = PyLib.pyDictKeys(this.pyObject.getPointer())) {
-            return pyObj
-                .asList()
-                .stream()
-                .map(p -> new SimpleImmutableEntry<>(p, get(p)))
-                .collect(Collectors.toCollection(LinkedHashSet::new));
+        // keys and values are interleaved, fetched with PyDict_Next in a single native call
+        final PyObject[] items = PyLib.pyDictItems(this.pyObject.getPointer());
+        final Set<Entry<PyObject, PyObject>> entries = new LinkedHashSet<>(items.length);
+        for (int ii = 0; ii < items.length; ii += 2) {
+            entries.add(new SimpleImmutableEntry<>(items[ii], items[ii + 1]));
         }
+        return entries;
     }
 
     /**
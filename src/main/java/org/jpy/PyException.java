@@ -0,0 +1,49 @@
+package org.jpy;
+
+/**
+ * A Python exception raised into Java.
+ * <p>
+ * The exception keeps the Python exception object. Its message, which includes the Python traceback,
+ * is only formatted when {@link #getMessage()} is first called, so that code using Python exceptions
+ * for control flow, e.g. {@link KeyError} and {@link StopIteration}, doesn't pay for it.
+ * <p>
+ * Filling in the Java stack trace can be disabled by setting the system property
+ * {@code PyException.stack_trace} to {@code false}.
+ */
+public class PyException extends RuntimeException {
+    private static final boolean STACK_TRACE = Boolean.parseBoolean(System.getProperty("PyException.stack_trace", "true"));
+
+    private final transient PyObject value;
+    private volatile String message;
+
+    PyException(String message) {
+        super(message);
+        this.value = null;
+        this.message = message;
+    }
+
+    /**
+     * Called from JNI, takes over the reference to the Python exception object.
+     */
+    PyException(long pointer) {
+        super(null, null, true, STACK_TRACE);
+        this.value = new PyObject(pointer, true);
+    }
+
+    /**
+     * @return the Python exception object, or {@code null} if it is not available
+     */
+    public PyObject getValue() {
+        return value;
+    }
+
+    @Override
+    public String getMessage() {
+        String message = this.message;
+        if (message == null && value != null && PyLib.isPythonRunning()) {
+            message = PyLib.formatPythonException(value.getPointer());
+            this.message = message;
+        }
+        return message;
+    }
+}
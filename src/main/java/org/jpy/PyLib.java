@@ -22,6 +22,7 @@ package org.jpy;
 import java.io.File;
 import java.io.FileNotFoundException;
 import java.util.ArrayList;
+import java.util.concurrent.CompletableFuture;
 import java.util.function.Supplier;
 
 import static org.jpy.PyLibConfig.*;
@@ -81,6 +82,7 @@ public class PyLib {
 
         static {
             PyLib.loadLib();
+            initJavaFlags();
         }
 
         /**
@@ -116,6 +118,8 @@ public class PyLib {
          */
         public static final int F_ALL = 0xff;
 
+        private static volatile int javaFlags;
+
         /**
          * @return the current diagnostic flags.
          */
@@ -126,7 +130,136 @@ public class PyLib {
          *
          * @param flags the current diagnostic flags.
          */
-        public static native void setFlags(int flags);
+        public static void setFlags(int flags) {
+            setFlags0(flags);
+            javaFlags = flags;
+        }
+
+        /**
+         * @return the current diagnostic flags, without crossing into native code.
+         */
+        static int getJavaFlags() {
+            return javaFlags;
+        }
+
+        /**
+         * Called from native code when {@code jpy.diag.flags} is set from Python.
+         */
+        static void setJavaFlags(int flags) {
+            javaFlags = flags;
+        }
+
+        private static native void setFlags0(int flags);
+
+        /**
+         * Registers this class with native code so that changes of {@code jpy.diag.flags} made from Python
+         * are passed to {@link #setJavaFlags(int)}, and passes the current flags.
+         */
+        private static native void initJavaFlags();
+
+        /**
+         * @return whether the call metrics of Java methods called from Python are collected.
+         */
+        public static native boolean isMetricsEnabled();
+
+        /**
+         * Switches the collection of call metrics of Java methods called from Python on or off: call
+         * counts and latency histograms of overload resolution, argument conversion, Java execution,
+         * result conversion and GIL waits. Same as setting {@code jpy.diag.metrics} in Python.
+         *
+         * @param enabled whether metrics are collected.
+         */
+        public static native void setMetricsEnabled(boolean enabled);
+
+        /**
+         * Returns the call metrics collected so far as a Python dictionary, as returned by
+         * {@code jpy.stats()}. Python must be running.
+         *
+         * @param reset whether the metrics are reset after reading them.
+         * @return the metrics.
+         */
+        public static native PyObject getMetrics(boolean reset);
+
+        /**
+         * Returns the JNI global references and native buffers held by jpy as a Python dictionary, as
+         * returned by {@code jpy.diag.memory_stats()}: live global references in total, by kind and by
+         * Java type, bytes held by exported Java array buffers and by Python buffers passed as Java
+         * arrays, and their high-water marks. Python must be running.
+         *
+         * @param resetPeaks whether the high-water marks are reset to the current values after reading them.
+         * @return the memory statistics.
+         */
+        public static native PyObject getMemoryStats(boolean resetPeaks);
+
+        /**
+         * @return the number of live JNI global references created by jpy. Does not acquire the GIL.
+         */
+        public static native long getGlobalRefCount();
+
+        /**
+         * Issues a Python {@code RuntimeWarning} when the number of live JNI global references created by
+         * jpy exceeds the given limit. Same as {@code jpy.diag.global_ref_limit}.
+         *
+         * @param limit the limit, 0 for none.
+         */
+        public static native void setGlobalRefLimit(long limit);
+
+        /**
+         * Issues a Python {@code RuntimeWarning} when the native bytes held by exported Java array buffers
+         * and Python buffers passed as Java arrays exceed the given limit. Same as {@code jpy.diag.buffer_bytes_limit}.
+         *
+         * @param limit the limit in bytes, 0 for none.
+         */
+        public static native void setBufferBytesLimit(long limit);
+
+        /**
+         * Starts recording Java methods called from Python and Python callables called from Java into a
+         * ring buffer keeping the last {@code capacity} calls. Previously recorded calls are discarded.
+         * Same as {@code jpy.start_profiler(capacity)}. Python must be running.
+         *
+         * @param capacity the maximum number of calls kept.
+         */
+        public static native void startProfiler(int capacity);
+
+        /**
+         * Stops recording calls, the recorded calls are kept.
+         */
+        public static native void stopProfiler();
+
+        /**
+         * Writes the recorded calls to a Chrome trace JSON file, which can be opened with chrome://tracing,
+         * Perfetto or speedscope. Same as {@code jpy.dump_profile(path)}. Python must be running.
+         *
+         * @param path the file to write.
+         * @return the number of recorded calls written, without the thread name metadata events.
+         */
+        public static native int dumpProfile(String path);
+
+        /**
+         * Diagnostic messages are recorded as binary events into per-thread buffers and only formatted
+         * when they are drained. Returns and removes all recorded events, oldest first, formatted as
+         * {@code "<time_ns> [<thread_id>] <message>"}. Same as {@code jpy.diag.drain()}.
+         *
+         * @return the recorded diagnostic messages.
+         */
+        public static native String[] drainEvents();
+
+        /**
+         * Drains the recorded diagnostic events and appends them to the given file, one per line.
+         * Same as {@code jpy.diag.dump(path)}.
+         *
+         * @param path the file to append to.
+         * @return the number of events written.
+         */
+        public static native int dumpEvents(String path);
+
+        /**
+         * If set, diagnostic messages are printed to stdout immediately instead of being recorded,
+         * as in previous versions. Same as {@code jpy.diag.stdout}.
+         *
+         * @param enabled whether diagnostic messages are printed immediately.
+         */
+        public static native void setStdout(boolean enabled);
 
         private Diag() {
         }
@@ -272,6 +405,26 @@ public class PyLib {
     static native long executeScript
             (String file, int start, Object globals, Object locals) throws FileNotFoundException;
 
+    /**
+     * Controls how a Java {@code Map} passed as globals or locals to {@link #executeCode} and
+     * {@link #executeScript} is exposed to Python.
+     * <p>
+     * By default (disabled) the whole map is copied into a new Python dictionary before execution, and the map is
+     * cleared and re-populated from that dictionary afterwards. If enabled, Python sees a lazily loaded dictionary
+     * over the map: a value is converted only when Python looks its name up, and only names that have been
+     * assigned or deleted are written back. Note that iterating such a namespace (e.g. {@code globals().keys()})
+     * in Python only yields the names that have been accessed or assigned so far.
+     *
+     * @param enabled {@code true} to enable lazy map namespaces
+     */
+    public static native void setLazyMapNamespaces(boolean enabled);
+
+    /**
+     * @return {@code true} if lazy map namespaces are enabled.
+     * @see #setLazyMapNamespaces(boolean)
+     */
+    public static native boolean isLazyMapNamespaces();
+
     public static native PyObject getMainGlobals();
 
     /**
@@ -302,6 +455,78 @@ public class PyLib {
 
     static native void decRefs(long[] pointers, int len);
 
+    /**
+     * Puts the reference into the release queue without acquiring the GIL.
+     *
+     * @return the number of queued references, or -1 if the reference could not be queued
+     */
+    static native int enqueueDecRef(long pointer);
+
+    /**
+     * Puts the first {@code len} references into the release queue without acquiring the GIL.
+     *
+     * @return the number of queued references, or -1 if the references could not be queued
+     */
+    static native int enqueueDecRefs(long[] pointers, int len);
+
+    /**
+     * Acquires the GIL and releases all queued references.
+     *
+     * @return the number of released references
+     */
+    static native int drainDecRefs();
+
+    static native void getReleaseQueueStats(long[] stats);
+
+    /**
+     * Performs a Java method call prepared by {@code jpy.call_async()} on the calling thread, without
+     * holding the GIL, and posts the result to the completion queue of the Python event loop.
+     *
+     * @param call the native call
+     * @see JavaAsync#submit(long)
+     */
+    static native void runAsyncCall(long call);
+
+    /**
+     * Posts the outcome of a {@link java.util.concurrent.CompletionStage} awaited by Python to the
+     * completion queue of the Python event loop.
+     *
+     * @param call  the native call
+     * @param value the value, if completed normally
+     * @param error the cause, if completed exceptionally, otherwise {@code null}
+     * @see JavaAsync#whenComplete(java.util.concurrent.CompletionStage, long)
+     */
+    static native void completeAsyncCall(long call, Object value, Throwable error);
+
+    /**
+     * Schedules a call of the Python callable {@code name} of the given object on the event loop thread of jpy,
+     * which is started on first use. If the call returns an awaitable, e.g. a coroutine, it is awaited on the loop.
+     * Arguments which are {@link java.util.concurrent.CompletionStage}s are passed as futures of the loop.
+     * The future is completed from the loop thread with a new {@link PyObject} for the result, or exceptionally
+     * with a {@link PyException}.
+     *
+     * @param pointer    Identifies the Python object which contains the callable {@code name}.
+     * @param name       The name of the callable, or {@code null} to await the Python object itself.
+     * @param argCount   The argument count (length of the following {@code args} array).
+     * @param args       The arguments.
+     * @param paramTypes Optional array of parameter types for the conversion of the {@code args} into a Python tuple.
+     * @param future     The future to be completed.
+     */
+    static native void callAsync(long pointer,
+                                 String name,
+                                 int argCount,
+                                 Object[] args,
+                                 Class<?>[] paramTypes,
+                                 CompletableFuture<PyObject> future);
+
+    /**
+     * Formats the message of a Python exception object, including its traceback.
+     *
+     * @param pointer the Python exception object
+     * @return the message
+     */
+    static native String formatPythonException(long pointer);
+
     static native int getIntValue(long pointer);
 
     static native long getLongValue(long pointer);
@@ -368,6 +593,64 @@ public class PyLib {
      */
     static native <T> boolean pyDictContains(long dict, T key, Class<? extends T> keyClass);
 
+    /**
+     * https://docs.python.org/3/c-api/dict.html#c.PyDict_Size
+     * @return the number of items in the dictionary.
+     */
+    static native int pyDictSize(long dict);
+
+    /**
+     * Looks up key in dictionary dict, without raising a KeyError if it is missing.
+     *
+     * https://docs.python.org/3/c-api/dict.html#c.PyDict_GetItemWithError
+     *
+     * @param dict     the dictionary
+     * @param key      the key
+     * @param keyClass Optional type for converting the key to a Python object
+     * @return the value, or {@code null} if key is not in dict.
+     */
+    static native <T> PyObject pyDictGetItem(long dict, T key, Class<? extends T> keyClass);
+
+    /**
+     * Determine if dictionary dict contains a value equal to value, iterating with PyDict_Next.
+     *
+     * @param dict       the dictionary
+     * @param value      the value
+     * @param valueClass Optional type for converting the value to a Python object
+     * @return True iff value is in dict.values().
+     */
+    static native <T> boolean pyDictContainsValue(long dict, T value, Class<? extends T> valueClass);
+
+    /**
+     * Gets all items of a dictionary with a single native call.
+     *
+     * @param dict the dictionary
+     * @return the keys and values interleaved: {@code [k0, v0, k1, v1, ...]}.
+     */
+    static native PyObject[] pyDictItems(long dict);
+
+    /**
+     * https://docs.python.org/3/c-api/list.html#c.PyList_GET_SIZE
+     * @return the number of items in the list.
+     */
+    static native int pyListSize(long list);
+
+    /**
+     * https://docs.python.org/3/c-api/list.html#c.PyList_GetItem
+     * @return the item at position index.
+     */
+    static native PyObject pyListGetItem(long list, int index);
+
+    /**
+     * Gets a range of list items with a single native call.
+     *
+     * @param list  the list
+     * @param start the index of the first item
+     * @param count the maximum number of items
+     * @return the items {@code list[start:start + count]}; the array is shorter than count at the end of the list.
+     */
+    static native PyObject[] pyListGetItems(long list, int start, int count);
+
     static native <T> T[] getObjectArrayValue(long pointer, Class<? extends T> itemType);
 
     /**
@@ -487,6 +770,62 @@ public class PyLib {
                                            Class<?>[] paramTypes,
                                            Class<T> returnType);
 
+    /**
+     * Gets the Python attribute given by {@code name} of the Python object pointed to by {@code pointer}
+     * as a Java {@code int}, without creating a {@link PyObject} for it.
+     * A Java exception is thrown if the attribute value is not a Python int or doesn't fit into a Java {@code int}.
+     *
+     * @param pointer Identifies the Python object which contains the attribute {@code name}.
+     * @param name    The attribute name.
+     * @return The attribute value.
+     */
+    static native int getAttributeInt(long pointer, String name);
+
+    /**
+     * Like {@link #getAttributeInt(long, String)}, for Java {@code long} values.
+     */
+    static native long getAttributeLong(long pointer, String name);
+
+    /**
+     * Like {@link #getAttributeInt(long, String)}, for Java {@code double} values. Any Python object
+     * implementing {@code __float__} is accepted.
+     */
+    static native double getAttributeDouble(long pointer, String name);
+
+    /**
+     * Calls a Python callable and returns its result as a Java {@code int}, without creating a
+     * {@link PyObject} for it. The arguments are the same as for
+     * {@link #callAndReturnObject(long, boolean, String, int, Object[], Class[])}.
+     * A Java exception is thrown if the result is not a Python int or doesn't fit into a Java {@code int}.
+     */
+    static native int callForInt(long pointer,
+                                 boolean methodCall,
+                                 String name,
+                                 int argCount,
+                                 Object[] args,
+                                 Class<?>[] paramTypes);
+
+    /**
+     * Like {@link #callForInt(long, boolean, String, int, Object[], Class[])}, for Java {@code long} results.
+     */
+    static native long callForLong(long pointer,
+                                   boolean methodCall,
+                                   String name,
+                                   int argCount,
+                                   Object[] args,
+                                   Class<?>[] paramTypes);
+
+    /**
+     * Like {@link #callForInt(long, boolean, String, int, Object[], Class[])}, for Java {@code double} results.
+     * Any Python object implementing {@code __float__} is accepted.
+     */
+    static native double callForDouble(long pointer,
+                                       boolean methodCall,
+                                       String name,
+                                       int argCount,
+                                       Object[] args,
+                                       Class<?>[] paramTypes);
+
     private static void loadLib() {
         if (dllLoaded || dllProblem != null) {
             return;
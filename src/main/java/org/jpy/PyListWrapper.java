@@ -24,6 +24,14 @@ import java.util.*;
  * A simple wrapper around a Python List object that implements a java List of PyObjects.
  */
 public class PyListWrapper implements List<PyObject> {
+    /**
+     * The number of items the first native call of an {@link #iterator()} fetches. Subsequent calls double the
+     * number up to {@link #MAX_CHUNK_SIZE}, so that short loops stay cheap and long ones need few JNI crossings.
+     */
+    private static final int INITIAL_CHUNK_SIZE = Integer.parseInt(System.getProperty("PyListWrapper.initial_chunk_size", "64"));
+
+    private static final int MAX_CHUNK_SIZE = Integer.parseInt(System.getProperty("PyListWrapper.max_chunk_size", "65536"));
+
     // todo: https://docs.python.org/3/c-api/list.html vs https://docs.python.org/3/c-api/sequence.html
     private PyObject pyObject;
 
@@ -33,9 +41,7 @@ public class PyListWrapper implements List<PyObject> {
 
     @Override
     public int size() {
-        try (final PyObject len = this.pyObject.callMethod("__len__")) {
-            return len.getIntValue();
-        }
+        return PyLib.pyListSize(pyObject.getPointer());
     }
 
     @Override
@@ -55,45 +61,40 @@ public class PyListWrapper implements List<PyObject> {
 
     @Override
     public Iterator<PyObject> iterator() {
-        return new Iterator<PyObject>() {
-            int ii = 0;
-            int size = size();
-
-            @Override
-            public boolean hasNext() {
-                return ii < size;
-            }
+        return new ChunkedIterator(INITIAL_CHUNK_SIZE, MAX_CHUNK_SIZE);
+    }
 
-            @Override
-            public PyObject next() {
-                return get(ii++);
-            }
-        };
+    /**
+     * Returns an iterator which fetches {@code chunkSize} items per native call.
+     *
+     * @param chunkSize The number of items to fetch at once
+     * @return An iterator over the items of this list
+     */
+    public Iterator<PyObject> iterator(int chunkSize) {
+        if (chunkSize <= 0) {
+            throw new IllegalArgumentException("chunkSize must be positive");
+        }
+        return new ChunkedIterator(chunkSize, chunkSize);
     }
 
+    /**
+     * Gets all items with a single native call.
+     */
     @Override
     public PyObject[] toArray() {
-        int size = size();
-
-        PyObject [] result = new PyObject[size];
-        for (int ii = 0; ii < size; ++ii) {
-            result[ii] = get(ii);
-        }
-
-        return result;
+        return PyLib.pyListGetItems(pyObject.getPointer(), 0, Integer.MAX_VALUE);
     }
 
     @Override
     public <T> T[] toArray(T[] a) {
-        int size = size();
+        final PyObject[] items = toArray();
+        final int size = items.length;
 
         if (a.length < size) {
             a = Arrays.copyOf(a, size);
         }
-        for (int ii = 0; ii < size; ++ii) {
-            //noinspection unchecked
-            a[ii] = (T)get(ii);
-        }
+        //noinspection SuspiciousSystemArraycopy
+        System.arraycopy(items, 0, a, 0, size);
         if (a.length > size) {
             a[size] = null;
         }
@@ -162,8 +163,7 @@ public class PyListWrapper implements List<PyObject> {
 
     @Override
     public PyObject get(int index) {
-        // todo https://docs.python.org/3/c-api/list.html#c.PyList_GetItem
-        return pyObject.callMethod("__getitem__", index);
+        return PyLib.pyListGetItem(pyObject.getPointer(), index);
     }
 
     @Override
@@ -195,13 +195,13 @@ public class PyListWrapper implements List<PyObject> {
 
     @Override
     public int indexOf(Object o) {
-        int size = size();
+        int ii = 0;
 
-        for (int ii = 0; ii < size; ++ii) {
-            PyObject pyObject = get(ii);
+        for (PyObject pyObject : this) {
             if (pyObject == null ? o == null : pyObject.equals(o)) {
                 return ii;
             }
+            ++ii;
         }
 
         return -1;
@@ -209,10 +209,10 @@ public class PyListWrapper implements List<PyObject> {
 
     @Override
     public int lastIndexOf(Object o) {
-        int size = size();
+        final PyObject[] items = toArray();
 
-        for (int ii = size - 1; ii >= 0; --ii) {
-            PyObject pyObject = get(ii);
+        for (int ii = items.length - 1; ii >= 0; --ii) {
+            PyObject pyObject = items[ii];
             if (pyObject == null ? o == null : pyObject.equals(o)) {
                 return ii;
             }
@@ -247,10 +247,11 @@ public class PyListWrapper implements List<PyObject> {
             return "[]";
         }
         final StringBuilder builder = new StringBuilder("[");
-        final int displaySize = Math.min(size(), prefixLength);
-        builder.append(get(0).str());
+        final PyObject[] items = PyLib.pyListGetItems(pyObject.getPointer(), 0, Math.max(1, prefixLength));
+        final int displaySize = items.length;
+        builder.append(items[0].str());
         for (int ei = 1; ei < displaySize; ++ei) {
-            builder.append(", ").append(get(ei).str());
+            builder.append(", ").append(items[ei].str());
         }
         if (displaySize == size()) {
             builder.append(']');
@@ -259,4 +260,49 @@ public class PyListWrapper implements List<PyObject> {
         }
         return builder.toString();
     }
+
+    /**
+     * Fetches the list items in chunks with {@link PyLib#pyListGetItems(long, int, int)}, growing the chunk size
+     * from {@code initialChunkSize} up to {@code maxChunkSize}.
+     */
+    private class ChunkedIterator implements Iterator<PyObject> {
+        private final int maxChunkSize;
+        private int chunkSize;
+        private PyObject[] chunk = new PyObject[0];
+        private int chunkIndex = 0;
+        private int nextListIndex = 0;
+        private boolean exhausted = false;
+
+        ChunkedIterator(int initialChunkSize, int maxChunkSize) {
+            this.chunkSize = Math.max(1, initialChunkSize);
+            this.maxChunkSize = Math.max(this.chunkSize, maxChunkSize);
+        }
+
+        @Override
+        public boolean hasNext() {
+            if (chunkIndex < chunk.length) {
+                return true;
+            }
+            if (exhausted) {
+                return false;
+            }
+            chunk = PyLib.pyListGetItems(pyObject.getPointer(), nextListIndex, chunkSize);
+            chunkIndex = 0;
+            nextListIndex += chunk.length;
+            exhausted = chunk.length < chunkSize;
+            chunkSize = (int) Math.min((long) chunkSize * 2, maxChunkSize);
+            return chunk.length > 0;
+        }
+
+        @Override
+        public PyObject next() {
+            if (!hasNext()) {
+                throw new NoSuchElementException();
+            }
+            final PyObject item = chunk[chunkIndex];
+            // don't keep the item reachable longer than the caller does
+            chunk[chunkIndex++] = null;
+            return item;
+        }
+    }
 }
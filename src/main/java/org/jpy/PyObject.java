@@ -26,6 +26,7 @@ import java.lang.reflect.InvocationHandler;
 import java.lang.reflect.Proxy;
 import java.util.List;
 import java.util.Objects;
+import java.util.concurrent.CompletableFuture;
 import java.util.concurrent.atomic.AtomicReference;
 
 /**
@@ -61,6 +62,36 @@ public class PyObject implements AutoCloseable {
         return REFERENCES.asProxy().cleanupOnlyUseFromGIL();
     }
 
+    /**
+     * Enables or disables the release queue. If enabled, {@link #close()} and the cleanup of
+     * garbage collected PyObjects don't acquire the GIL, but queue the Python object for being
+     * released by the next thread that leaves a native call holding the GIL. The initial value is
+     * given by the system property {@code PyObject.release_queue}, which defaults to false.
+     *
+     * @param enabled true to enable the release queue
+     */
+    public static void setReleaseQueueEnabled(boolean enabled) {
+        PyObjectReleaseQueue.setEnabled(enabled);
+    }
+
+    public static boolean isReleaseQueueEnabled() {
+        return PyObjectReleaseQueue.isEnabled();
+    }
+
+    /**
+     * Releases all Python objects waiting in the release queue. Acquires the GIL.
+     *
+     * @return the number of released objects
+     */
+    public static int drainReleaseQueue() {
+        assertPythonRuns();
+        return PyLib.drainDecRefs();
+    }
+
+    public static ReleaseQueueStats getReleaseQueueStats() {
+        return PyObjectReleaseQueue.getStats();
+    }
+
     private final PyObjectState state;
 
     PyObject(long pointer) {
@@ -69,6 +100,14 @@ public class PyObject implements AutoCloseable {
 
     @SuppressWarnings("WeakerAccess")
     PyObject(long pointer, boolean fromJNI) {
+        this(pointer, fromJNI, true);
+    }
+
+    /**
+     * @param tracked if false, the object isn't registered for cleanup after garbage collection and
+     *                must be closed explicitly, see {@link #getAttributeScoped(String)}
+     */
+    private PyObject(long pointer, boolean fromJNI, boolean tracked) {
         state = new PyObjectState(pointer);
         if (fromJNI) {
             if (CLEANUP_ON_INIT && PyLib.hasGil()) {
@@ -79,7 +118,13 @@ public class PyObject implements AutoCloseable {
                 startCleanupThread();
             }
         }
-        registerSelfInto(REFERENCES);
+        if (tracked) {
+            registerSelfInto(REFERENCES);
+        }
+    }
+
+    private static PyObject scoped(long pointer) {
+        return pointer != 0 ? new PyObject(pointer, false, false) : null;
     }
 
     final void registerSelfInto(PyObjectReferences references) {
@@ -359,6 +404,60 @@ public class PyObject implements AutoCloseable {
         return PyLib.getAttributeValue(getPointer(), name, valueType);
     }
 
+    /**
+     * Gets the value of a Python attribute as a Java {@code int}. No {@link PyObject} is created for the attribute value.
+     *
+     * @param name A name of the Python attribute.
+     * @return The Python attribute value.
+     * @throws RuntimeException if the value is not a Python int or doesn't fit into a Java {@code int}
+     */
+    public int getIntAttribute(String name) {
+        assertPythonRuns();
+        Objects.requireNonNull(name, "name must not be null");
+        return PyLib.getAttributeInt(getPointer(), name);
+    }
+
+    /**
+     * Gets the value of a Python attribute as a Java {@code long}. No {@link PyObject} is created for the attribute value.
+     *
+     * @param name A name of the Python attribute.
+     * @return The Python attribute value.
+     * @throws RuntimeException if the value is not a Python int or doesn't fit into a Java {@code long}
+     */
+    public long getLongAttribute(String name) {
+        assertPythonRuns();
+        Objects.requireNonNull(name, "name must not be null");
+        return PyLib.getAttributeLong(getPointer(), name);
+    }
+
+    /**
+     * Gets the value of a Python attribute as a Java {@code double}. No {@link PyObject} is created for the attribute value.
+     *
+     * @param name A name of the Python attribute.
+     * @return The Python attribute value.
+     * @throws RuntimeException if the value cannot be converted into a Python float
+     */
+    public double getDoubleAttribute(String name) {
+        assertPythonRuns();
+        Objects.requireNonNull(name, "name must not be null");
+        return PyLib.getAttributeDouble(getPointer(), name);
+    }
+
+    /**
+     * Gets the Python value of a Python attribute like {@link #getAttribute(String)}, but the returned
+     * wrapper is not tracked for garbage collection. It is meant to be used in a try-with-resources
+     * statement and must be closed by the caller, otherwise the Python object is never released.
+     * This saves the bookkeeping that is otherwise needed for every {@link PyObject}.
+     *
+     * @param name A name of the Python attribute.
+     * @return A wrapper for the returned Python attribute value, which must be closed.
+     */
+    public PyObject getAttributeScoped(String name) {
+        assertPythonRuns();
+        Objects.requireNonNull(name, "name must not be null");
+        return scoped(PyLib.getAttributeObject(getPointer(), name));
+    }
+
     /**
      * Sets the value of a Python attribute from the given Java object.
      * <p>
@@ -450,6 +549,162 @@ public class PyObject implements AutoCloseable {
         return pointer != 0 ? new PyObject(pointer) : null;
     }
 
+    /**
+     * Call the callable Python method with the given name and arguments like {@link #callMethod(String, Object...)},
+     * but the returned wrapper is not tracked for garbage collection. It is meant to be used in a try-with-resources
+     * statement and must be closed by the caller, otherwise the Python object is never released.
+     *
+     * @param name A name of a Python attribute that evaluates to a callable object.
+     * @param args The arguments for the method call.
+     * @return A wrapper for the returned Python object, which must be closed.
+     */
+    public PyObject callMethodScoped(String name, Object... args) {
+        assertPythonRuns();
+        Objects.requireNonNull(name, "name must not be null");
+        return scoped(PyLib.callAndReturnObject(getPointer(), true, name, args.length, args, null));
+    }
+
+    /**
+     * Call the callable Python object with the given name and arguments like {@link #call(String, Object...)},
+     * but the returned wrapper is not tracked for garbage collection. It is meant to be used in a try-with-resources
+     * statement and must be closed by the caller, otherwise the Python object is never released.
+     *
+     * @param name A name of a Python attribute that evaluates to a callable object,
+     * @param args The arguments for the call.
+     * @return A wrapper for the returned Python object, which must be closed.
+     */
+    public PyObject callScoped(String name, Object... args) {
+        assertPythonRuns();
+        Objects.requireNonNull(name, "name must not be null");
+        return scoped(PyLib.callAndReturnObject(getPointer(), false, name, args.length, args, null));
+    }
+
+    /**
+     * Call the callable Python object with the given name and arguments on the event loop thread of jpy, and await
+     * the result if it is a coroutine or another awaitable, e.g. for an {@code async def} function. The calling thread
+     * is not blocked: the Python event loop runs many such calls concurrently on a single thread ("jpy-asyncio"),
+     * which is started on first use, and completes the returned future when the call is done.
+     * <p>
+     * Arguments are converted as by {@link #call(String, Object...)}, except that
+     * {@link java.util.concurrent.CompletionStage}s, e.g. {@link CompletableFuture}s, are passed as awaitable
+     * {@code asyncio.Future}s. Dependent stages registered without an executor run on the event loop thread,
+     * so use the {@code *Async} variants for blocking work.
+     *
+     * @param name A name of a Python attribute that evaluates to a callable object.
+     * @param args The arguments for the call.
+     * @return A future completed with a wrapper for the result, or exceptionally with a {@link PyException}.
+     */
+    public CompletableFuture<PyObject> callAsync(String name, Object... args) {
+        assertPythonRuns();
+        Objects.requireNonNull(name, "name must not be null");
+        CompletableFuture<PyObject> future = new CompletableFuture<>();
+        PyLib.callAsync(getPointer(), name, args.length, args, null, future);
+        return future;
+    }
+
+    /**
+     * Await this Python object, e.g. a coroutine object, on the event loop thread of jpy like
+     * {@link #callAsync(String, Object...)} does with the result of a call.
+     *
+     * @return A future completed with a wrapper for the result, or exceptionally with a {@link PyException}.
+     */
+    public CompletableFuture<PyObject> awaitAsync() {
+        assertPythonRuns();
+        CompletableFuture<PyObject> future = new CompletableFuture<>();
+        PyLib.callAsync(getPointer(), null, 0, null, null, future);
+        return future;
+    }
+
+    /**
+     * Call the callable Python method with the given name and arguments and return the result as a Java {@code int}.
+     * No {@link PyObject} is created for the result.
+     *
+     * @param name A name of a Python attribute that evaluates to a callable object.
+     * @param args The arguments for the method call.
+     * @return The result of the call.
+     * @throws RuntimeException if the result is not a Python int or doesn't fit into a Java {@code int}
+     */
+    public int callMethodForInt(String name, Object... args) {
+        assertPythonRuns();
+        Objects.requireNonNull(name, "name must not be null");
+        return PyLib.callForInt(getPointer(), true, name, args.length, args, null);
+    }
+
+    /**
+     * Call the callable Python method with the given name and arguments and return the result as a Java {@code long}.
+     * No {@link PyObject} is created for the result.
+     *
+     * @param name A name of a Python attribute that evaluates to a callable object.
+     * @param args The arguments for the method call.
+     * @return The result of the call.
+     * @throws RuntimeException if the result is not a Python int or doesn't fit into a Java {@code long}
+     */
+    public long callMethodForLong(String name, Object... args) {
+        assertPythonRuns();
+        Objects.requireNonNull(name, "name must not be null");
+        return PyLib.callForLong(getPointer(), true, name, args.length, args, null);
+    }
+
+    /**
+     * Call the callable Python method with the given name and arguments and return the result as a Java {@code double}.
+     * No {@link PyObject} is created for the result.
+     *
+     * @param name A name of a Python attribute that evaluates to a callable object.
+     * @param args The arguments for the method call.
+     * @return The result of the call.
+     * @throws RuntimeException if the result cannot be converted into a Python float
+     */
+    public double callMethodForDouble(String name, Object... args) {
+        assertPythonRuns();
+        Objects.requireNonNull(name, "name must not be null");
+        return PyLib.callForDouble(getPointer(), true, name, args.length, args, null);
+    }
+
+    /**
+     * Call the callable Python object with the given name and arguments and return the result as a Java {@code int}.
+     * No {@link PyObject} is created for the result.
+     *
+     * @param name A name of a Python attribute that evaluates to a callable object,
+     * @param args The arguments for the call.
+     * @return The result of the call.
+     * @throws RuntimeException if the result is not a Python int or doesn't fit into a Java {@code int}
+     */
+    public int callForInt(String name, Object... args) {
+        assertPythonRuns();
+        Objects.requireNonNull(name, "name must not be null");
+        return PyLib.callForInt(getPointer(), false, name, args.length, args, null);
+    }
+
+    /**
+     * Call the callable Python object with the given name and arguments and return the result as a Java {@code long}.
+     * No {@link PyObject} is created for the result.
+     *
+     * @param name A name of a Python attribute that evaluates to a callable object,
+     * @param args The arguments for the call.
+     * @return The result of the call.
+     * @throws RuntimeException if the result is not a Python int or doesn't fit into a Java {@code long}
+     */
+    public long callForLong(String name, Object... args) {
+        assertPythonRuns();
+        Objects.requireNonNull(name, "name must not be null");
+        return PyLib.callForLong(getPointer(), false, name, args.length, args, null);
+    }
+
+    /**
+     * Call the callable Python object with the given name and arguments and return the result as a Java {@code double}.
+     * No {@link PyObject} is created for the result.
+     *
+     * @param name A name of a Python attribute that evaluates to a callable object,
+     * @param args The arguments for the call.
+     * @return The result of the call.
+     * @throws RuntimeException if the result cannot be converted into a Python float
+     */
+    public double callForDouble(String name, Object... args) {
+        assertPythonRuns();
+        Objects.requireNonNull(name, "name must not be null");
+        return PyLib.callForDouble(getPointer(), false, name, args.length, args, null);
+    }
+
     public <T> T call(Class<T> returnType, String name, Class<?>[] paramTypes, Object[] args) {
         Objects.requireNonNull(returnType, "returnType must not be null");
         Objects.requireNonNull(name, "name must not be null");
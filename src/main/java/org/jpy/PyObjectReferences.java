@@ -33,6 +33,8 @@ class PyObjectReferences {
     private final ReferenceQueue<PyObject> referenceQueue;
     private final Map<Reference<PyObject>, PyObjectState> references;
     private final long[] buffer;
+    // enqueueReleases() runs without the GIL, so it can't share the buffer with the GIL cleanups
+    private final long[] releaseBuffer;
 
     PyObjectReferences() {
         this(DEFAULT_BATCH_CLOSE_SIZE);
@@ -45,6 +47,7 @@ class PyObjectReferences {
         referenceQueue = new ReferenceQueue<>();
         references = new ConcurrentHashMap<>();
         buffer = new long[batchCloseSize];
+        releaseBuffer = new long[batchCloseSize];
     }
 
     void register(PyObject pyObject) {
@@ -107,6 +110,25 @@ class PyObjectReferences {
         });
     }
 
+    /**
+     * Moves the references of collected PyObjects into the release queue. Does not need the GIL,
+     * but must only be invoked from the cleanup thread.
+     */
+    int enqueueReleases() {
+        int index = 0;
+        while (index < releaseBuffer.length) {
+            final Reference<? extends PyObject> reference = referenceQueue.poll();
+            if (reference == null) {
+                break;
+            }
+            index = appendIfNotClosed(releaseBuffer, index, reference);
+        }
+        if (index > 0) {
+            PyObjectReleaseQueue.releaseAll(releaseBuffer, index);
+        }
+        return index;
+    }
+
     private int appendIfNotClosed(long[] buffer, int index, Reference<? extends PyObject> reference) {
         reference.clear(); // helps GC proceed a bit faster for PhantomReference - guava Finalizer does this too
 
@@ -155,14 +177,28 @@ class PyObjectReferences {
          */
 
         final PyObjectCleanup proxy = asProxy();
+        long lastReleased = -1;
 
         while (!Thread.currentThread().isInterrupted()) {
-            // This blocks on the GIL, acquires the GIL, and then releases the GIL.
-            // For linux, acquiring the GIL involves a pthread_mutex_lock, which does not provide
-            // any fairness guarantees. As such, we need to be mindful of other python users/code,
-            // and ensure we don't overly acquire the GIL causing starvation issues, especially when
-            // there is no cleanup work to do.
-            final int size = proxy.cleanupOnlyUseFromGIL();
+            final int size;
+            if (PyObjectReleaseQueue.isEnabled()) {
+                // No GIL needed to hand the references over to the release queue. The queue is
+                // normally drained by the threads making python calls anyway; we only take the GIL
+                // ourselves if nobody has released anything since our last pass.
+                size = enqueueReleases();
+                final ReleaseQueueStats stats = PyObjectReleaseQueue.getStats();
+                if (stats.getDepth() > 0 && stats.getReleased() == lastReleased) {
+                    PyLib.drainDecRefs();
+                }
+                lastReleased = stats.getReleased();
+            } else {
+                // This blocks on the GIL, acquires the GIL, and then releases the GIL.
+                // For linux, acquiring the GIL involves a pthread_mutex_lock, which does not provide
+                // any fairness guarantees. As such, we need to be mindful of other python users/code,
+                // and ensure we don't overly acquire the GIL causing starvation issues, especially when
+                // there is no cleanup work to do.
+                size = proxy.cleanupOnlyUseFromGIL();
+            }
 
 
             // Although, it *does* make sense to potentially take the GIL in a tight loop when there
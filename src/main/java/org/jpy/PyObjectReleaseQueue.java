@@ -0,0 +1,67 @@
+package org.jpy;
+
+/**
+ * Hands {@code PyObject*} references that Java no longer needs over to the native release queue,
+ * so that closing a {@link PyObject} doesn't have to wait for the GIL.
+ *
+ * <p>The native queue is drained in batches by whichever thread holds the GIL when it returns from
+ * a {@link PyLib} native method, and by the PyObject cleanup thread if nobody else does. When the
+ * queue grows beyond {@code PyObject.release_queue_max_depth} references, the enqueuing thread
+ * drains it itself, so that producers can't outrun the release of their objects indefinitely.
+ */
+final class PyObjectReleaseQueue {
+
+    private static final int MAX_DEPTH = Integer.parseInt(System.getProperty("PyObject.release_queue_max_depth", "65536"));
+
+    private static volatile boolean enabled = Boolean.parseBoolean(System.getProperty("PyObject.release_queue", "false"));
+
+    private PyObjectReleaseQueue() {
+    }
+
+    static boolean isEnabled() {
+        return enabled;
+    }
+
+    static void setEnabled(boolean enabled) {
+        PyObjectReleaseQueue.enabled = enabled;
+    }
+
+    /**
+     * Releases the given reference, either right away or through the release queue.
+     */
+    static void release(long pointer) {
+        if (!enabled) {
+            PyLib.decRef(pointer);
+            return;
+        }
+        final int depth = PyLib.enqueueDecRef(pointer);
+        if (depth < 0) {
+            PyLib.decRef(pointer);
+        } else if (depth >= MAX_DEPTH) {
+            PyLib.drainDecRefs();
+        }
+    }
+
+    /**
+     * Releases the first {@code len} references of the given buffer, either right away or through
+     * the release queue.
+     */
+    static void releaseAll(long[] pointers, int len) {
+        if (!enabled) {
+            PyLib.decRefs(pointers, len);
+            return;
+        }
+        final int depth = PyLib.enqueueDecRefs(pointers, len);
+        if (depth < 0) {
+            PyLib.decRefs(pointers, len);
+        } else if (depth >= MAX_DEPTH) {
+            PyLib.drainDecRefs();
+        }
+    }
+
+    static ReleaseQueueStats getStats() {
+        final long[] stats = new long[ReleaseQueueStats.COUNT];
+        PyLib.getReleaseQueueStats(stats);
+        return new ReleaseQueueStats(stats);
+    }
+}
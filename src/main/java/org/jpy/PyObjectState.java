@@ -58,6 +58,6 @@ final class PyObjectState implements AutoCloseable {
             return;
         }
         // We are closing it
-        PyLib.decRef(pointerForClosure);
+        PyObjectReleaseQueue.release(pointerForClosure);
     }
 }
@@ -16,12 +16,15 @@
 
 package org.jpy;
 
+import java.lang.invoke.MethodHandle;
 import java.lang.invoke.MethodHandles;
 import java.lang.invoke.MethodHandles.Lookup;
 import java.lang.reflect.Constructor;
 import java.lang.reflect.InvocationHandler;
 import java.lang.reflect.Method;
 import java.util.Arrays;
+import java.util.IdentityHashMap;
+import java.util.Map;
 import org.jpy.PyLib.CallableKind;
 
 import static org.jpy.PyLib.assertPythonRuns;
@@ -30,6 +33,11 @@ import static org.jpy.PyLib.assertPythonRuns;
  * The {@code InvocationHandler} for used by the proxy instances created by the
  * {@link PyObject#createProxy(Class)} and {@link PyModule#createProxy(Class)}
  * methods.
+ * <p>
+ * Everything that can be derived from the invoked {@link Method} alone (the kind of call, the
+ * interned method name, parameter and return types and, for default methods, a method handle)
+ * is computed on the first invocation of a method and kept in a {@link Dispatch} entry that is
+ * shared by all proxies of the same proxy class.
  *
  * @author Norman Fomferra
  * @since 0.7
@@ -42,6 +50,15 @@ class PyProxyHandler implements InvocationHandler {
     
     private static Method toStringMethod;
 
+    private static final Object[] NO_ARGS = new Object[0];
+
+    private static final ClassValue<DispatchTable> DISPATCH_TABLES = new ClassValue<DispatchTable>() {
+        @Override
+        protected DispatchTable computeValue(Class<?> proxyClass) {
+            return new DispatchTable();
+        }
+    };
+
     static {
         try {
             hashCodeMethod = Object.class.getMethod("hashCode");
@@ -55,6 +72,9 @@ class PyProxyHandler implements InvocationHandler {
     private final PyObject pyObject;
     
     private final PyLib.CallableKind callableKind;
+
+    // the dispatch table of our proxy class, set on first invocation
+    private DispatchTable dispatchTable;
     
     public PyProxyHandler(PyObject pyObject, PyLib.CallableKind callableKind) {
         if (pyObject == null) {
@@ -68,62 +88,45 @@ class PyProxyHandler implements InvocationHandler {
     public Object invoke(Object proxyObject, Method method, Object[] args) throws Throwable {
         //assertPythonRuns(); // todo: get rid of this check to remove a call down into JNI?
 
-        if (method.isDefault()) {
-            // This allows our proxy-able interfaces to define default methods.
-            // Note: in this current implementation, defaults methods will always take precedence.
-            final Class<?> declaringClass = method.getDeclaringClass();
-
-            // https://blog.jooq.org/2018/03/28/correct-reflective-access-to-interface-default-methods-in-java-8-9-10/
+        DispatchTable table = dispatchTable;
+        if (table == null) {
+            table = DISPATCH_TABLES.get(proxyObject.getClass());
+            dispatchTable = table;
+        }
+        final Dispatch dispatch = table.get(method);
 
-            // note: the following throws an IllegalAccessException of the form no private access for invokespecial
-            //return MethodHandles.lookup()
-            //    .in(declaringClass)
-            //    .unreflectSpecial(method, declaringClass)
-            //    .bindTo(proxyObject)
-            //    .invokeWithArguments(args);
-
-            // Unfortunately, the following doesn't work w/ Java 9+. There should be some new api
-            // methods that work w/ Java 9+ though. (MethodHandles#privateLookupIn)
-            final Constructor<Lookup> constructor = Lookup.class
-                .getDeclaredConstructor(Class.class);
-            constructor.setAccessible(true);
-            return constructor
-                .newInstance(declaringClass)
-                .in(declaringClass)
-                .unreflectSpecial(method, declaringClass)
-                .bindTo(proxyObject)
-                .invokeWithArguments(args);
+        switch (dispatch.kind) {
+            case DEFAULT:
+                // This allows our proxy-able interfaces to define default methods.
+                // Note: in this current implementation, defaults methods will always take precedence.
+                return (Object) dispatch.defaultMethod().invokeExact(proxyObject, args != null ? args : NO_ARGS);
+            case HASH_CODE:
+                return callPythonHash();
+            case EQUALS:
+                return this.pyObject.eq(args[0]);
+            case TO_STRING:
+                return this.pyObject.str();
+            case CLOSE:
+                this.pyObject.close();
+                return null;
+            default:
+                break;
         }
 
         final long pointer = this.pyObject.getPointer();
 
-        if ((PyLib.Diag.getFlags() & PyLib.Diag.F_METH) != 0) {
-            System.out.printf("org.jpy.PyProxyHandler: invoke: %s(%s) on pyObject=%s in thread %s\n", method.getName(),
+        if ((PyLib.Diag.getJavaFlags() & PyLib.Diag.F_METH) != 0) {
+            System.out.printf("org.jpy.PyProxyHandler: invoke: %s(%s) on pyObject=%s in thread %s\n", dispatch.name,
                     Arrays.toString(args), Long.toHexString(pointer), Thread.currentThread());
         }
-        final String methodName = method.getName();
-        final Class<?> returnType = method.getReturnType();
-        if (method.equals(hashCodeMethod)) {
-            return callPythonHash();
-        } else if (method.equals(equalsMethod)) {
-            return this.pyObject.eq(args[0]);
-        } else if (method.equals(toStringMethod)) {
-            return this.pyObject.str();
-        } else if ("close".equals(method.getName())
-            && method.getParameterCount() == 0
-            && void.class.equals(method.getReturnType())
-            && AutoCloseable.class.isAssignableFrom(method.getDeclaringClass())) {
-            this.pyObject.close();
-            return null;
-        }
 
         return PyLib.callAndReturnValue(
             pointer,
             callableKind == CallableKind.METHOD,
-            methodName,
+            dispatch.name,
             args != null ? args.length : 0, args,
-            method.getParameterTypes(),
-            returnType);
+            dispatch.paramTypes,
+            dispatch.returnType);
     }
 
     PyObject getPyObject() {
@@ -138,4 +141,117 @@ class PyProxyHandler implements InvocationHandler {
     private int callPythonHash() {
         return Long.hashCode(this.pyObject.hash());
     }
+
+    private enum Kind {
+        DEFAULT, HASH_CODE, EQUALS, TO_STRING, CLOSE, CALL
+    }
+
+    /**
+     * What to do when a given interface method is invoked.
+     */
+    private static final class Dispatch {
+        final Kind kind;
+        final String name;
+        final Class<?>[] paramTypes;
+        final Class<?> returnType;
+        // (Object proxy, Object[] args)Object, for default methods only
+        private final MethodHandle defaultMethod;
+        private final Throwable defaultMethodError;
+
+        Dispatch(Method method) {
+            this.name = method.getName().intern();
+            this.paramTypes = method.getParameterTypes();
+            this.returnType = method.getReturnType();
+
+            MethodHandle handle = null;
+            Throwable error = null;
+            if (method.isDefault()) {
+                kind = Kind.DEFAULT;
+                try {
+                    handle = unreflectDefault(method);
+                    handle = handle.asFixedArity()
+                        .asType(handle.type().generic())
+                        .asSpreader(Object[].class, method.getParameterCount());
+                } catch (ReflectiveOperationException | RuntimeException e) {
+                    // reported on invocation, as it would be without caching
+                    error = e;
+                }
+            } else if (method.equals(hashCodeMethod)) {
+                kind = Kind.HASH_CODE;
+            } else if (method.equals(equalsMethod)) {
+                kind = Kind.EQUALS;
+            } else if (method.equals(toStringMethod)) {
+                kind = Kind.TO_STRING;
+            } else if ("close".equals(method.getName())
+                && method.getParameterCount() == 0
+                && void.class.equals(method.getReturnType())
+                && AutoCloseable.class.isAssignableFrom(method.getDeclaringClass())) {
+                kind = Kind.CLOSE;
+            } else {
+                kind = Kind.CALL;
+            }
+            this.defaultMethod = handle;
+            this.defaultMethodError = error;
+        }
+
+        MethodHandle defaultMethod() throws Throwable {
+            if (defaultMethodError != null) {
+                throw defaultMethodError;
+            }
+            return defaultMethod;
+        }
+
+        private static MethodHandle unreflectDefault(Method method) throws ReflectiveOperationException {
+            final Class<?> declaringClass = method.getDeclaringClass();
+
+            // https://blog.jooq.org/2018/03/28/correct-reflective-access-to-interface-default-methods-in-java-8-9-10/
+
+            // note: the following throws an IllegalAccessException of the form no private access for invokespecial
+            //return MethodHandles.lookup()
+            //    .in(declaringClass)
+            //    .unreflectSpecial(method, declaringClass)
+
+            Lookup lookup;
+            try {
+                // Java 9+
+                final Method privateLookupIn = MethodHandles.class.getMethod("privateLookupIn", Class.class, Lookup.class);
+                lookup = (Lookup) privateLookupIn.invoke(null, declaringClass, MethodHandles.lookup());
+            } catch (NoSuchMethodException e) {
+                // Java 8
+                final Constructor<Lookup> constructor = Lookup.class
+                    .getDeclaredConstructor(Class.class);
+                constructor.setAccessible(true);
+                lookup = constructor
+                    .newInstance(declaringClass)
+                    .in(declaringClass);
+            }
+            return lookup.unreflectSpecial(method, declaringClass);
+        }
+    }
+
+    /**
+     * The dispatch entries of a proxy class. {@code java.lang.reflect.Proxy} passes the same
+     * {@link Method} instances on every invocation, so after warm-up a lookup is a single
+     * identity hash lookup in an immutable map.
+     */
+    private static final class DispatchTable {
+        private volatile Map<Method, Dispatch> entries = new IdentityHashMap<>();
+
+        Dispatch get(Method method) {
+            final Dispatch dispatch = entries.get(method);
+            return dispatch != null ? dispatch : add(method);
+        }
+
+        private synchronized Dispatch add(Method method) {
+            Dispatch dispatch = entries.get(method);
+            if (dispatch == null) {
+                dispatch = new Dispatch(method);
+                // copy-on-write, readers never lock
+                final Map<Method, Dispatch> copy = new IdentityHashMap<>(entries);
+                copy.put(method, dispatch);
+                entries = copy;
+            }
+            return dispatch;
+        }
+    }
 }
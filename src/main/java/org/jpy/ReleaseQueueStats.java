@@ -0,0 +1,87 @@
+package org.jpy;
+
+/**
+ * A snapshot of the counters of the PyObject release queue.
+ *
+ * @see PyObject#getReleaseQueueStats()
+ */
+public final class ReleaseQueueStats {
+
+    // Make sure the following indices are the same as JPy_RELQUEUE_STAT_* in jpy_relqueue.h
+    static final int DEPTH = 0;
+    static final int MAX_DEPTH = 1;
+    static final int ENQUEUED = 2;
+    static final int RELEASED = 3;
+    static final int DRAINS = 4;
+    static final int DRAIN_NANOS = 5;
+    static final int MAX_DRAIN_NANOS = 6;
+    static final int COUNT = 7;
+
+    private final long[] stats;
+
+    ReleaseQueueStats(long[] stats) {
+        this.stats = stats;
+    }
+
+    /**
+     * @return the number of references currently waiting to be released
+     */
+    public long getDepth() {
+        return stats[DEPTH];
+    }
+
+    /**
+     * @return the largest number of references that have been waiting at the same time
+     */
+    public long getMaxDepth() {
+        return stats[MAX_DEPTH];
+    }
+
+    /**
+     * @return the total number of references put into the queue
+     */
+    public long getEnqueued() {
+        return stats[ENQUEUED];
+    }
+
+    /**
+     * @return the total number of references released from the queue
+     */
+    public long getReleased() {
+        return stats[RELEASED];
+    }
+
+    /**
+     * @return the number of times the queue has been drained
+     */
+    public long getDrains() {
+        return stats[DRAINS];
+    }
+
+    /**
+     * @return the total time spent draining the queue, in nanoseconds
+     */
+    public long getDrainNanos() {
+        return stats[DRAIN_NANOS];
+    }
+
+    /**
+     * @return the longest time a single drain took, in nanoseconds
+     */
+    public long getMaxDrainNanos() {
+        return stats[MAX_DRAIN_NANOS];
+    }
+
+    /**
+     * @return the average time a drain took, in nanoseconds
+     */
+    public double getAverageDrainNanos() {
+        return stats[DRAINS] == 0 ? 0.0 : (double) stats[DRAIN_NANOS] / stats[DRAINS];
+    }
+
+    @Override
+    public String toString() {
+        return String.format("ReleaseQueueStats{depth=%d, maxDepth=%d, enqueued=%d, released=%d, drains=%d, avgDrainNanos=%.0f, maxDrainNanos=%d}",
+                getDepth(), getMaxDepth(), getEnqueued(), getReleased(), getDrains(), getAverageDrainNanos(), getMaxDrainNanos());
+    }
+}
@@ -1,5 +1,10 @@
 package org.jpy;
 
+import java.io.File;
+import java.io.IOException;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.TimeUnit;
 import org.junit.Assert;
 import org.junit.Test;
 
@@ -35,4 +40,81 @@ public class LifeCycleTest {
             Assert.assertFalse(PyLib.isPythonRunning());
         }
     }
+
+    @Test
+    public void testReleaseQueueIsClearedOnStop() {
+        PyLib.startPython();
+        PyObject.setReleaseQueueEnabled(true);
+        try {
+            PyObject globals = PyLib.getMainGlobals();
+            final long pointer = globals.getPointer();
+            globals.close();
+            Assert.assertTrue(PyObject.getReleaseQueueStats().getDepth() > 0);
+
+            PyLib.stopPython();
+            Assert.assertEquals(0, PyObject.getReleaseQueueStats().getDepth());
+            if (!ON_WINDOWS) {
+                // references of a finalized interpreter are never queued
+                Assert.assertEquals(-1, PyLib.enqueueDecRef(pointer));
+            }
+
+            PyLib.startPython();
+            PyLib.getMainGlobals().close();
+            Assert.assertTrue(PyObject.getReleaseQueueStats().getDepth() > 0);
+            PyObject.drainReleaseQueue();
+            Assert.assertEquals(0, PyObject.getReleaseQueueStats().getDepth());
+        } finally {
+            PyObject.setReleaseQueueEnabled(false);
+            PyLib.stopPython();
+        }
+    }
+
+    @Test
+    public void testJavaCallCompletingAfterStop() throws IOException, InterruptedException {
+        final String importPath = new File("src/test/python/fixtures").getCanonicalPath();
+        PyLib.startPython(importPath);
+        PyModule.importModule("async_fixture").call("call_java_async_and_leave", 200);
+        PyLib.stopPython();
+        // the call completes without an interpreter
+        Thread.sleep(500);
+
+        PyLib.startPython(importPath);
+        try {
+            Assert.assertEquals("42", PyModule.importModule("async_fixture").call("call_java_async", 42).getStringValue());
+        } finally {
+            PyLib.stopPython();
+        }
+    }
+
+    @Test
+    public void testCallAsyncAcrossRestart() throws Exception {
+        final String importPath = new File("src/test/python/fixtures").getCanonicalPath();
+        for (int i = 0; i < 2; i++) {
+            PyLib.startPython(importPath);
+            try {
+                Assert.assertEquals(5, PyModule.importModule("async_fixture").callAsync("add", 2, 3).get(10, TimeUnit.SECONDS).getIntValue());
+            } finally {
+                PyLib.stopPython();
+            }
+        }
+    }
+
+    @Test
+    public void testPendingCallAsyncCompletesOnStop() throws Exception {
+        final String importPath = new File("src/test/python/fixtures").getCanonicalPath();
+        PyLib.startPython(importPath);
+        CompletableFuture<PyObject> future;
+        try {
+            future = PyModule.importModule("async_fixture").callAsync("sleep", 60);
+            Assert.assertFalse(future.isDone());
+        } finally {
+            PyLib.stopPython();
+        }
+        try {
+            future.get(10, TimeUnit.SECONDS);
+            Assert.fail();
+        } catch (ExecutionException e) {
+            Assert.assertTrue(e.getCause() instanceof RuntimeException);
+        }
+    }
 }
@@ -19,11 +19,17 @@ package org.jpy;
 import static org.junit.Assert.assertEquals;
 import static org.junit.Assert.assertFalse;
 import static org.junit.Assert.assertNotNull;
+import static org.junit.Assert.assertNull;
 import static org.junit.Assert.assertTrue;
 import static org.junit.Assert.fail;
 
+import java.io.File;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.util.Arrays;
 import java.util.Collection;
 import java.util.Collections;
+import java.util.Iterator;
 import java.util.Map;
 import org.junit.After;
 import org.junit.Before;
@@ -276,6 +282,203 @@ public class PyLibTest {
         }
     }
 
+    @Test
+    public void invalidPyListSize() {
+        PyObject pyValue = PyObject.executeCode("42", PyInputMode.EXPRESSION);
+        try {
+            PyLib.pyListSize(pyValue.getPointer());
+            fail("Expected exception");
+        } catch (UnsupportedOperationException e) {
+            // expected
+        }
+    }
+
+    @Test
+    public void testDictItems() {
+        PyObject dict = PyObject.executeCode("{'a': 1, 'b': 2}", PyInputMode.EXPRESSION);
+        PyDictWrapper wrapper = dict.asDict();
+
+        assertEquals(2, wrapper.size());
+        assertEquals(1, wrapper.get("a").getIntValue());
+        assertNull(wrapper.get("c"));
+        assertTrue(wrapper.containsValue(2));
+        assertFalse(wrapper.containsValue(3));
+
+        PyObject[] items = PyLib.pyDictItems(dict.getPointer());
+        assertEquals(4, items.length);
+        assertEquals("a", items[0].getStringValue());
+        assertEquals(1, items[1].getIntValue());
+        assertEquals(2, wrapper.entrySet().size());
+    }
+
+    @Test
+    public void testListChunks() {
+        PyObject list = PyObject.executeCode("list(range(1000))", PyInputMode.EXPRESSION);
+        PyListWrapper wrapper = (PyListWrapper) list.asList();
+
+        assertEquals(1000, wrapper.size());
+        assertEquals(999, wrapper.get(999).getIntValue());
+        assertEquals(1000, wrapper.toArray().length);
+        assertEquals(10, PyLib.pyListGetItems(list.getPointer(), 990, 100).length);
+        assertEquals(0, PyLib.pyListGetItems(list.getPointer(), 2000, 100).length);
+
+        int expected = 0;
+        Iterator<PyObject> it = wrapper.iterator(7);
+        while (it.hasNext()) {
+            assertEquals(expected++, it.next().getIntValue());
+        }
+        assertEquals(1000, expected);
+
+        expected = 0;
+        for (PyObject item : wrapper) {
+            assertEquals(expected++, item.getIntValue());
+        }
+        assertEquals(1000, expected);
+    }
+
+    @Test
+    public void testListToArray() {
+        final int n = 1000;
+        PyObject list = PyObject.executeCode("list(range(" + n + "))", PyInputMode.EXPRESSION);
+        PyListWrapper wrapper = (PyListWrapper) list.asList();
+
+        Object[] items = wrapper.toArray();
+        assertEquals(n, items.length);
+        for (int i = 0; i < n; i++) {
+            assertEquals(i, ((PyObject) items[i]).getIntValue());
+        }
+    }
+
+    @Test
+    public void testPythonExceptionMessage() {
+        PyObject dict = PyObject.executeCode("{'a': 1}", PyInputMode.EXPRESSION);
+        try {
+            dict.callMethod("__getitem__", "missing");
+            fail("Expected KeyError");
+        } catch (KeyError e) {
+            assertNotNull(e.getValue());
+            assertEquals("'missing'", e.getValue().callMethod("__str__").getStringValue());
+            assertTrue(e.getMessage(), e.getMessage().startsWith("Error in Python interpreter:\nType: <class 'KeyError'>"));
+        }
+
+        try {
+            PyObject.executeCode("1 / 0", PyInputMode.EXPRESSION);
+            fail("Expected PyException");
+        } catch (PyException e) {
+            assertTrue(e.getMessage(), e.getMessage().contains("ZeroDivisionError"));
+            assertTrue(e.getMessage(), e.getMessage().contains("Traceback (most recent call last):"));
+        }
+    }
+
+    @Test
+    public void testDictMiss() {
+        PyObject dict = PyObject.executeCode("{'a': 1}", PyInputMode.EXPRESSION);
+        PyDictWrapper wrapper = dict.asDict();
+
+        for (int i = 0; i < 100; i++) {
+            assertNull(wrapper.get("missing"));
+            try {
+                dict.callMethod("__getitem__", "missing");
+                fail("Expected KeyError");
+            } catch (KeyError e) {
+                // expected
+            }
+        }
+        assertEquals(1, wrapper.get("a").getIntValue());
+    }
+
+    @Test
+    public void testMetrics() {
+        PyLib.Diag.getMetrics(true);
+        PyLib.Diag.setMetricsEnabled(true);
+        try {
+            assertTrue(PyLib.Diag.isMetricsEnabled());
+            PyObject.executeCode("import jpy\ns = jpy.get_type('java.lang.String')('hello')\nfor i in range(10): s.length()",
+                PyInputMode.SCRIPT);
+        } finally {
+            PyLib.Diag.setMetricsEnabled(false);
+        }
+        assertFalse(PyLib.Diag.isMetricsEnabled());
+
+        PyDictWrapper metrics = PyLib.Diag.getMetrics(true).asDict();
+        assertTrue(metrics.get("calls").getIntValue() >= 10);
+        assertTrue(metrics.get("native_gil_wait").asDict().get("count").getIntValue() > 0);
+        PyDictWrapper methods = metrics.get("methods").asDict();
+        assertEquals(10, methods.get("java.lang.String#length()").asDict().get("calls").getIntValue());
+        assertEquals(0, PyLib.Diag.getMetrics(false).asDict().get("calls").getIntValue());
+    }
+
+    @Test
+    public void testDiagFlagsSetFromPython() {
+        try {
+            PyObject.executeCode("import jpy\njpy.diag.flags = jpy.diag.F_METH", PyInputMode.SCRIPT);
+            assertEquals(PyLib.Diag.F_METH, PyLib.Diag.getFlags());
+            assertEquals(PyLib.Diag.F_METH, PyLib.Diag.getJavaFlags());
+        } finally {
+            PyLib.Diag.setFlags(PyLib.Diag.F_OFF);
+        }
+        assertEquals(PyLib.Diag.F_OFF, PyLib.Diag.getJavaFlags());
+    }
+
+    @Test
+    public void testProfiler() throws Exception {
+        PyObject.executeCode("import jpy\n"
+            + "def py_func(n):\n"
+            + "    return jpy.get_type('java.lang.Integer').toString(n)\n", PyInputMode.SCRIPT);
+        PyModule main = PyModule.importModule("__main__");
+
+        File file = File.createTempFile("jpy_profile", ".json");
+        try {
+            PyLib.Diag.startProfiler(1024);
+            try {
+                for (int i = 0; i < 10; i++) {
+                    main.callMethod("py_func", i);
+                }
+            } finally {
+                PyLib.Diag.stopProfiler();
+            }
+            // ten Python calls, each calling Integer.toString()
+            assertEquals(20, PyLib.Diag.dumpProfile(file.getPath()));
+            String json = new String(Files.readAllBytes(file.toPath()), StandardCharsets.UTF_8);
+            assertTrue(json, json.contains("\"name\": \"__main__.py_func\""));
+            assertTrue(json, json.contains("\"name\": \"java.lang.Integer#toString\""));
+            assertTrue(json, json.contains("\"cat\": \"python\""));
+        } finally {
+            file.delete();
+        }
+    }
+
+    @Test
+    public void testDiagEvents() {
+        PyLib.Diag.drainEvents();
+        PyLib.Diag.setFlags(PyLib.Diag.F_EXEC);
+        try {
+            PyObject.executeCode("import jpy\njpy.get_type('java.lang.Integer').toString(7)\n", PyInputMode.SCRIPT);
+        } finally {
+            PyLib.Diag.setFlags(PyLib.Diag.F_OFF);
+        }
+        String[] events = PyLib.Diag.drainEvents();
+        boolean found = false;
+        for (String event : events) {
+            found |= event.contains("java.lang.Integer#toString");
+        }
+        assertTrue(Arrays.toString(events), found);
+        assertEquals(0, PyLib.Diag.drainEvents().length);
+    }
+
+    @Test
+    public void testMemoryStats() {
+        PyObject.executeCode("import jpy\njpy.get_type('java.lang.Object')()\n", PyInputMode.SCRIPT);
+        long count = PyLib.Diag.getGlobalRefCount();
+        PyObject.executeCode("_objects = [jpy.get_type('java.lang.Object')() for i in range(10)]\n", PyInputMode.SCRIPT);
+        assertEquals(count + 10, PyLib.Diag.getGlobalRefCount());
+        PyDictWrapper stats = PyLib.Diag.getMemoryStats(false).asDict();
+        assertEquals(count + 10, stats.get("global_refs").getLongValue());
+        assertTrue(stats.get("global_refs_by_type").asDict().containsKey("java.lang.Object"));
+        PyObject.executeCode("del _objects\n", PyInputMode.SCRIPT);
+        assertEquals(count, PyLib.Diag.getGlobalRefCount());
+    }
+
     @Test
     public void decRefs() {
         final long pyObject1 = PyLib.executeCode("4321", PyInputMode.EXPRESSION.value(), null, null);
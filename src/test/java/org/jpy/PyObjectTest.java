@@ -25,6 +25,7 @@ import org.jpy.fixtures.Processor;
 
 import java.io.File;
 import java.io.IOException;
+import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.HashMap;
 import java.util.Map;
@@ -165,7 +166,194 @@ public class PyObjectTest {
         assertEquals(6, localMap.get("y"));
         assertEquals(13, localMap.get("z"));
     }
-    
+
+    @Test
+    public void testLocals_LazyMap() throws Exception {
+        HashMap<String, Object> localMap = new HashMap<>();
+        localMap.put("x", 7);
+        localMap.put("y", 6);
+        localMap.put("gone", "bye");
+        localMap.put("untouched", new File("test.txt"));
+        PyLib.setLazyMapNamespaces(true);
+        try {
+            PyObject pyVoid = PyObject.executeCode(
+                    "" + "z = x + y\n" + "del gone\n" + "n = 'x' in locals() and 'nope' not in locals()",
+                    PyInputMode.SCRIPT, null, localMap);
+            assertEquals(null, pyVoid.getObjectValue());
+        } finally {
+            PyLib.setLazyMapNamespaces(false);
+        }
+
+        assertEquals(7, localMap.get("x"));
+        assertEquals(6, localMap.get("y"));
+        assertEquals(13, localMap.get("z"));
+        assertEquals(true, localMap.get("n"));
+        assertFalse(localMap.containsKey("gone"));
+        assertFalse(localMap.containsKey("nope"));
+        assertEquals(new File("test.txt"), localMap.get("untouched"));
+    }
+
+    @Test
+    public void testGlobalsAndLocals_LazyMap() throws Exception {
+        // With separate locals, Python reads names from the globals with the dict API, so they are copied eagerly
+        HashMap<String, Object> globals = new HashMap<>();
+        globals.put("a", 1);
+        HashMap<String, Object> locals = new HashMap<>();
+        locals.put("b", 2);
+        PyLib.setLazyMapNamespaces(true);
+        try {
+            PyObject.executeCode("c = a + b\ndel b\n", PyInputMode.SCRIPT, globals, locals).close();
+            PyObject.executeCode("d = a + 1\n", PyInputMode.SCRIPT, globals, globals).close();
+        } finally {
+            PyLib.setLazyMapNamespaces(false);
+        }
+        assertEquals(3, locals.get("c"));
+        assertFalse(locals.containsKey("b"));
+        assertEquals(1, globals.get("a"));
+        assertEquals(2, globals.get("d"));
+    }
+
+    @Test
+    public void testExecuteCode_LazyMapMatchesCopy() throws Exception {
+        HashMap<String, Object> globals = new HashMap<>();
+        for (int i = 0; i < 100; i++) {
+            globals.put("v" + i, i);
+        }
+        for (boolean lazy : new boolean[]{false, true}) {
+            globals.remove("r");
+            PyLib.setLazyMapNamespaces(lazy);
+            try {
+                PyObject.executeCode("r = v0 + v1 + v2 + v99", PyInputMode.SCRIPT, globals, null).close();
+            } finally {
+                PyLib.setLazyMapNamespaces(false);
+            }
+            assertEquals(102, globals.get("r"));
+            assertEquals(101, globals.size());
+            assertFalse(globals.containsKey("__builtins__"));
+        }
+    }
+
+    @Test
+    public void testReleaseQueue() throws Exception {
+        PyLib.Diag.setFlags(PyLib.Diag.F_OFF);
+        PyObject.drainReleaseQueue();
+        PyObject.setReleaseQueueEnabled(true);
+        try {
+            ReleaseQueueStats before = PyObject.getReleaseQueueStats();
+            PyObject obj = PyObject.executeCode("object()", PyInputMode.EXPRESSION);
+            obj.close();
+            obj.close();
+            ReleaseQueueStats after = PyObject.getReleaseQueueStats();
+            assertEquals(before.getEnqueued() + 1, after.getEnqueued());
+            PyObject.drainReleaseQueue();
+            assertEquals(0, PyObject.getReleaseQueueStats().getDepth());
+            assertEquals(after.getEnqueued(), PyObject.getReleaseQueueStats().getReleased());
+        } finally {
+            PyObject.setReleaseQueueEnabled(false);
+        }
+    }
+
+    @Test
+    public void testReleaseQueue_DrainedOnNativeCall() throws Exception {
+        PyLib.Diag.setFlags(PyLib.Diag.F_OFF);
+        PyObject.drainReleaseQueue();
+        PyObject.setReleaseQueueEnabled(true);
+        try {
+            PyObject list = PyObject.executeCode("[]", PyInputMode.EXPRESSION);
+            PyObject.executeCode("object()", PyInputMode.EXPRESSION).close();
+            ReleaseQueueStats before = PyObject.getReleaseQueueStats();
+            assertTrue(before.getDepth() > 0);
+            // any native call that takes the GIL releases pending references on its way out
+            list.callMethod("append", 1);
+            assertTrue(PyObject.getReleaseQueueStats().getReleased() > before.getReleased());
+        } finally {
+            PyObject.setReleaseQueueEnabled(false);
+        }
+    }
+
+    @Test
+    public void testReleaseQueue_MultiThreaded() throws Exception {
+        final int threadCount = 4;
+        final int n = 1000;
+        PyLib.Diag.setFlags(PyLib.Diag.F_OFF);
+        PyObject.drainReleaseQueue();
+        PyObject.setReleaseQueueEnabled(true);
+        try {
+            ReleaseQueueStats before = PyObject.getReleaseQueueStats();
+            ExecutorService executor = Executors.newFixedThreadPool(threadCount);
+            List<Callable<Void>> tasks = new java.util.ArrayList<>();
+            for (int t = 0; t < threadCount; t++) {
+                tasks.add(() -> {
+                    for (int i = 0; i < n; i++) {
+                        PyLib.getMainGlobals().close();
+                    }
+                    return null;
+                });
+            }
+            for (Future<Void> future : executor.invokeAll(tasks)) {
+                future.get();
+            }
+            executor.shutdown();
+            PyObject.drainReleaseQueue();
+            ReleaseQueueStats after = PyObject.getReleaseQueueStats();
+            assertEquals(before.getEnqueued() + threadCount * n, after.getEnqueued());
+            assertEquals(after.getEnqueued(), after.getReleased());
+            assertEquals(0, after.getDepth());
+        } finally {
+            PyObject.setReleaseQueueEnabled(false);
+        }
+    }
+
+    @Test
+    public void testScalarAttributesAndCalls() throws Exception {
+        PyObject obj = PyObject.executeCode("type('C', (), {'i': 42, 'l': 1 << 40, 'd': 2.5, 'twice': lambda self, x: 2 * x})()", PyInputMode.EXPRESSION);
+        assertEquals(42, obj.getIntAttribute("i"));
+        assertEquals(1L << 40, obj.getLongAttribute("l"));
+        assertEquals(2.5, obj.getDoubleAttribute("d"), 0.0);
+        assertEquals(42.0, obj.getDoubleAttribute("i"), 0.0);
+        assertEquals(84, obj.callMethodForInt("twice", 42));
+        assertEquals(1L << 41, obj.callMethodForLong("twice", 1L << 40));
+        assertEquals(5.0, obj.callMethodForDouble("twice", 2.5), 0.0);
+
+        PyModule builtins = PyModule.importModule("builtins");
+        assertEquals(3, builtins.callForInt("abs", -3));
+        assertEquals(1L << 40, builtins.callForLong("pow", 2, 40));
+        assertEquals(0.5, builtins.callForDouble("float", "0.5"), 0.0);
+
+        try {
+            obj.getIntAttribute("l");
+            fail();
+        } catch (RuntimeException e) {
+            assertTrue(e.getMessage().contains("OverflowError"));
+        }
+        try {
+            obj.getIntAttribute("missing");
+            fail();
+        } catch (RuntimeException e) {
+            assertTrue(e.getMessage().contains("AttributeError"));
+        }
+    }
+
+    @Test
+    public void testScoped() throws Exception {
+        PyObject obj = PyObject.executeCode("type('C', (), {'items': [1, 2, 3]})()", PyInputMode.EXPRESSION);
+        PyObject escaped;
+        try (PyObject items = obj.getAttributeScoped("items");
+             PyObject length = items.callScoped("__len__")) {
+            assertEquals(3, length.getIntValue());
+            try (PyObject copy = items.callMethodScoped("copy")) {
+                assertEquals(3, copy.callMethodForInt("__len__"));
+            }
+            escaped = items;
+        }
+        try {
+            escaped.getPointer();
+            fail();
+        } catch (IllegalStateException e) {
+            // expected, a scoped object is only valid in its scope
+        }
+    }
+
     @Test
     public void testExecuteScript_ErrorExpr() throws Exception {
         try {
@@ -264,6 +452,64 @@ public class PyObjectTest {
         // PyLib.Diag.setFlags(PyLib.Diag.F_OFF);
     }
 
+    @Test
+    public void testProxyRepeatedCalls() throws Exception {
+        final int n = 1000;
+        PyModule procModule = PyModule.importModule("proc_class");
+        PyObject procObj = procModule.call("Processor");
+        Processor processor = procObj.createProxy(Processor.class);
+        PyLib.Diag.setFlags(PyLib.Diag.F_OFF);
+        processor.setVal(0);
+        for (int i = 0; i < n; i++) {
+            processor.setVal(processor.getVal() + 1);
+        }
+        assertEquals(n, processor.getVal());
+    }
+
+    @Test
+    public void testCallAsync() throws Exception {
+        PyModule asyncModule = PyModule.importModule("async_fixture");
+        assertEquals(5, asyncModule.callAsync("add", 2, 3).get(10, TimeUnit.SECONDS).getIntValue());
+        assertEquals(8, asyncModule.callAsync("double", 4).get(10, TimeUnit.SECONDS).getIntValue());
+        assertEquals(7, asyncModule.call("make_coroutine", 7).awaitAsync().get(10, TimeUnit.SECONDS).getIntValue());
+    }
+
+    @Test
+    public void testCallAsyncConcurrently() throws Exception {
+        final int n = 100;
+        PyModule asyncModule = PyModule.importModule("async_fixture");
+        List<CompletableFuture<PyObject>> futures = new ArrayList<>();
+        for (int i = 0; i < n; i++) {
+            futures.add(asyncModule.callAsync("add", i, 1));
+        }
+        CompletableFuture.allOf(futures.toArray(new CompletableFuture[0])).get(30, TimeUnit.SECONDS);
+        for (int i = 0; i < n; i++) {
+            assertEquals(i + 1, futures.get(i).get().getIntValue());
+        }
+    }
+
+    @Test
+    public void testCallAsyncError() throws Exception {
+        PyModule asyncModule = PyModule.importModule("async_fixture");
+        try {
+            asyncModule.callAsync("fail", "boom").get(10, TimeUnit.SECONDS);
+            fail();
+        } catch (ExecutionException e) {
+            assertTrue(e.getCause() instanceof PyException);
+            assertTrue(e.getCause().getMessage().contains("boom"));
+        }
+    }
+
+    @Test
+    public void testCallAsyncAwaitsCompletableFutureArgument() throws Exception {
+        PyModule asyncModule = PyModule.importModule("async_fixture");
+        CompletableFuture<Integer> input = new CompletableFuture<>();
+        CompletableFuture<PyObject> result = asyncModule.callAsync("await_future", input);
+        assertFalse(result.isDone());
+        input.complete(42);
+        assertEquals(42, result.get(10, TimeUnit.SECONDS).getIntValue());
+    }
+
     @Test
     public void testUnwrapProxy() {
         PyModule procModule = PyModule.importModule("proc_class");
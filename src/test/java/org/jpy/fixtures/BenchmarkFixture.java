@@ -0,0 +1,157 @@
+package org.jpy.fixtures;
+
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * Call targets for the Python to Java benchmarks in jpy_benchmark.py. The methods do next to
+ * nothing, so that the measured time is dominated by the cost of crossing the bridge.
+ */
+@SuppressWarnings("UnusedDeclaration")
+public class BenchmarkFixture {
+
+    private int value;
+
+    // fields, read and written from Python
+
+    public int intField;
+    public String stringField = "hello";
+    public Object objectField = new Object();
+
+    // static methods by arity
+
+    public static void static0() {
+    }
+
+    public static int static1(int a) {
+        return a;
+    }
+
+    public static int static2(int a, int b) {
+        return a + b;
+    }
+
+    public static int static4(int a, int b, int c, int d) {
+        return a + b + c + d;
+    }
+
+    // instance methods by arity
+
+    public void instance0() {
+    }
+
+    public int instance1(int a) {
+        return a;
+    }
+
+    public int instance2(int a, int b) {
+        return a + b;
+    }
+
+    public int instance4(int a, int b, int c, int d) {
+        return a + b + c + d;
+    }
+
+    // argument kinds
+
+    public double primitiveArg(double a) {
+        return a;
+    }
+
+    public Object objectArg(Object a) {
+        return a;
+    }
+
+    public String stringArg(String a) {
+        return a;
+    }
+
+    public int getValue() {
+        return value;
+    }
+
+    public void setValue(int value) {
+        this.value = value;
+    }
+
+    // unique vs. overloaded
+
+    public int unique(int a) {
+        return a;
+    }
+
+    public int overloaded(int a) {
+        return a;
+    }
+
+    public long overloaded(long a) {
+        return a;
+    }
+
+    public double overloaded(double a) {
+        return a;
+    }
+
+    public String overloaded(String a) {
+        return a;
+    }
+
+    public Object overloaded(Object a) {
+        return a;
+    }
+
+    // varargs
+
+    public int varargs(int... values) {
+        return values.length;
+    }
+
+    public int varargsObjects(Object... values) {
+        return values.length;
+    }
+
+    // arrays, Python buffers (array.array, numpy) are passed to primitive array parameters
+
+    public int intArrayLength(int[] values) {
+        return values.length;
+    }
+
+    public int doubleArrayLength(double[] values) {
+        return values.length;
+    }
+
+    public double[] newDoubleArray(int length) {
+        return new double[length];
+    }
+
+    // collections, iterated from Python
+
+    public List<Integer> newArrayList(int size) {
+        List<Integer> list = new ArrayList<>(size);
+        for (int i = 0; i < size; i++) {
+            list.add(i);
+        }
+        return list;
+    }
+
+    public Map<Integer, Integer> newHashMap(int size) {
+        Map<Integer, Integer> map = new HashMap<>(2 * size);
+        for (int i = 0; i < size; i++) {
+            map.put(i, i);
+        }
+        return map;
+    }
+
+    // objects whose fields are read from Python
+
+    public static BenchmarkFixture[] newFixtures(int size) {
+        BenchmarkFixture[] fixtures = new BenchmarkFixture[size];
+        for (int i = 0; i < size; i++) {
+            fixtures[i] = new BenchmarkFixture();
+            fixtures[i].intField = i;
+        }
+        return fixtures;
+    }
+}
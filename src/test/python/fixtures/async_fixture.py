@@ -0,0 +1,57 @@
+import asyncio
+
+
+async def add(a, b):
+    await asyncio.sleep(0.01)
+    return a + b
+
+
+def double(a):
+    return 2 * a
+
+
+async def sleep(seconds):
+    await asyncio.sleep(seconds)
+
+
+async def fail(message):
+    await asyncio.sleep(0)
+    raise ValueError(message)
+
+
+async def await_future(future):
+    return await future
+
+
+def make_coroutine(value):
+    return add(value, 0)
+
+
+def call_java_async_and_leave(millis):
+    """Submits a Java call with jpy.call_async() and closes the event loop while the call is still running."""
+    import jpy
+    thread_type = jpy.get_type('java.lang.Thread')
+
+    async def submit():
+        jpy.call_async(thread_type.sleep, millis)
+
+    loop = asyncio.new_event_loop()
+    try:
+        loop.run_until_complete(submit())
+    finally:
+        loop.close()
+
+
+def call_java_async(value):
+    """Runs jpy.call_async() on a new event loop and returns the result."""
+    import jpy
+    string_type = jpy.get_type('java.lang.String')
+
+    async def call():
+        return await jpy.call_async(string_type.valueOf, value)
+
+    loop = asyncio.new_event_loop()
+    try:
+        return loop.run_until_complete(call())
+    finally:
+        loop.close()
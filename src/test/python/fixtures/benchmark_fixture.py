@@ -0,0 +1,48 @@
+# Python side of the JMH benchmarks in src/jmh/java/org/jpy/benchmarks
+
+
+def nop():
+    pass
+
+
+def identity(x):
+    return x
+
+
+def add3(a, b, c):
+    return a + b + c
+
+
+def greet(name):
+    return 'hello ' + name
+
+
+def make_list(n):
+    return list(range(n))
+
+
+def make_dict(n):
+    return dict(('key%d' % i, i) for i in range(n))
+
+
+class Counter:
+    def __init__(self):
+        self.value = 0
+
+    def increment(self):
+        self.value += 1
+        return self.value
+
+
+class Adder:
+    """Implements java.util.function.IntBinaryOperator"""
+
+    def applyAsInt(self, a, b):
+        return a + b
+
+
+class Greeter:
+    """Implements java.util.function.Function<String, String>"""
+
+    def apply(self, name):
+        return 'hello ' + name
@@ -0,0 +1,119 @@
+import os
+import types
+import unittest
+
+import jpyutil
+
+
+# The Arrow jars (arrow-vector, arrow-memory-netty, arrow-c-data and their dependencies) are taken from the
+# JPY_JVM_CLASSPATH environment variable. Arrow needs access to java.nio internals on Java 9 and later.
+_ARROW_JVM_OPTIONS = ['--add-opens=java.base/java.nio=ALL-UNNAMED'] if 'arrow' in os.environ.get('JPY_JVM_CLASSPATH', '') else []
+jpyutil.init_jvm(jvm_maxmem='512M', jvm_options=_ARROW_JVM_OPTIONS)
+import jpy
+
+try:
+    import pyarrow
+    import jpyarrow
+except ImportError:
+    pyarrow = None
+
+try:
+    jpy.get_type('org.apache.arrow.c.Data')
+    has_java_arrow = True
+except ValueError:
+    has_java_arrow = False
+
+
+@unittest.skipIf(pyarrow is None, 'pyarrow is not installed')
+@unittest.skipIf(not has_java_arrow, 'the Java Arrow C Data Interface is not on the class path (JPY_JVM_CLASSPATH)')
+class TestArrow(unittest.TestCase):
+
+    def setUp(self):
+        self.batch = pyarrow.RecordBatch.from_arrays([pyarrow.array([1, 2, None, 4], type=pyarrow.int64()),
+                                                      pyarrow.array([0.5, 1.5, 2.5, 3.5]),
+                                                      pyarrow.array(['a', 'b', None, 'd'])],
+                                                     names=['i', 'd', 's'])
+
+
+    def test_array_round_trip(self):
+        array = pyarrow.array([1, 2, None, 4], type=pyarrow.int32())
+        vector = jpyarrow.to_java(array)
+        try:
+            self.assertEqual(vector.getValueCount(), 4)
+            self.assertEqual(vector.get(1), 2)
+            self.assertTrue(vector.isNull(2))
+            self.assertEqual(jpyarrow.from_java(vector), array)
+        finally:
+            vector.close()
+
+
+    def test_record_batch_round_trip(self):
+        root = jpyarrow.to_java(self.batch)
+        try:
+            self.assertEqual(root.getRowCount(), 4)
+            self.assertEqual(root.getSchema().getFields().size(), 3)
+            self.assertEqual(root.getVector('d').get(3), 3.5)
+            self.assertEqual(jpyarrow.from_java(root), self.batch)
+        finally:
+            root.close()
+
+
+    def test_buffers_are_shared(self):
+        array = pyarrow.array(range(1000), type=pyarrow.int64())
+        vector = jpyarrow.to_java(array)
+        try:
+            self.assertEqual(vector.getDataBufferAddress(), array.buffers()[1].address)
+        finally:
+            vector.close()
+
+
+    def test_exported_data_outlives_java_vectors(self):
+        root = jpyarrow.to_java(self.batch)
+        batch = jpyarrow.from_java(root)
+        root.close()
+        self.assertEqual(batch, self.batch)
+
+
+    def test_table(self):
+        table = pyarrow.Table.from_batches([self.batch, self.batch])
+        roots = jpyarrow.to_java(table)
+        try:
+            self.assertEqual(len(roots), 2)
+            self.assertEqual(jpyarrow.table_from_java(roots), table)
+            self.assertEqual(jpyarrow.table_from_java(roots[0]), pyarrow.Table.from_batches([self.batch]))
+        finally:
+            for root in roots:
+                root.close()
+
+
+    def test_failed_import_releases_export(self):
+        child = jpyarrow.allocator().newChildAllocator('test_failed_import_releases_export', 0, 1 << 30)
+        vector = jpyarrow.to_java(pyarrow.array([1, 2, 3], type=pyarrow.int64()), java_allocator=child)
+
+        class FailingArray:
+            @staticmethod
+            def _import_from_c(array_address, schema_address):
+                raise RuntimeError('import failed')
+
+        # pyarrow's extension types can't be patched, so jpyarrow gets a stand-in for the module
+        jpyarrow.pyarrow = types.SimpleNamespace(Array=FailingArray)
+        try:
+            with self.assertRaises(RuntimeError):
+                jpyarrow.from_java(vector, java_allocator=child)
+        finally:
+            jpyarrow.pyarrow = pyarrow
+            vector.close()
+        self.assertEqual(child.getAllocatedMemory(), 0)
+        child.close()
+
+
+    def test_invalid_arguments(self):
+        with self.assertRaises(TypeError):
+            jpyarrow.to_java([1, 2, 3])
+        with self.assertRaises(TypeError):
+            jpyarrow.from_java(jpy.get_type('java.lang.String')('abc'))
+
+
+if __name__ == '__main__':
+    print('\nRunning ' + __file__)
+    unittest.main()
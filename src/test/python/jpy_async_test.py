@@ -0,0 +1,105 @@
+import asyncio
+import unittest
+
+import jpyutil
+
+
+jpyutil.init_jvm(jvm_maxmem='512M')
+import jpy
+
+
+def _run(coroutine_function):
+    loop = asyncio.new_event_loop()
+    try:
+        return loop.run_until_complete(coroutine_function())
+    finally:
+        loop.close()
+
+
+class TestAsync(unittest.TestCase):
+
+    def setUp(self):
+        self.String = jpy.get_type('java.lang.String')
+        self.Thread = jpy.get_type('java.lang.Thread')
+        self.Integer = jpy.get_type('java.lang.Integer')
+        self.CompletableFuture = jpy.get_type('java.util.concurrent.CompletableFuture')
+
+
+    def test_call_async_static_and_instance_methods(self):
+        async def main():
+            s = self.String('Hello')
+            return (await jpy.call_async(self.String.valueOf, 42),
+                    await jpy.call_async(self.Integer.parseInt, '17'),
+                    await jpy.call_async(s.concat, ' World'),
+                    await jpy.call_async(s.length),
+                    await jpy.call_async(self.Thread.sleep, 1))
+
+        self.assertEqual(_run(main), ('42', 17, 'Hello World', 5, None))
+
+
+    def test_call_async_runs_concurrently(self):
+        async def main():
+            futures = [jpy.call_async(self.Thread.sleep, 50) for _ in range(4)]
+            return await asyncio.gather(*futures)
+
+        self.assertEqual(_run(main), [None] * 4)
+
+
+    def test_call_async_many(self):
+        async def main():
+            futures = [jpy.call_async(self.Integer.toString, i) for i in range(1000)]
+            return await asyncio.gather(*futures)
+
+        self.assertEqual(_run(main), [str(i) for i in range(1000)])
+
+
+    def test_call_async_exception(self):
+        async def main():
+            with self.assertRaises(ValueError) as e:
+                await jpy.call_async(self.Integer.parseInt, 'x')
+            return e.exception
+
+        self.assertIn('NumberFormatException', str(_run(main)))
+
+
+    def test_call_async_awaits_completion_stage(self):
+        async def main():
+            return await jpy.call_async(self.CompletableFuture.completedFuture, 'done')
+
+        self.assertEqual(_run(main), 'done')
+
+
+    def test_as_future(self):
+        async def main():
+            completed = await jpy.as_future(self.CompletableFuture.completedFuture('done'))
+            pending = self.CompletableFuture()
+            future = jpy.as_future(pending)
+            self.assertFalse(future.done())
+            pending.complete('later')
+            later = await future
+            failed = self.CompletableFuture()
+            failed.completeExceptionally(jpy.get_type('java.lang.IllegalStateException')('failed'))
+            with self.assertRaises(jpy.JException):
+                await jpy.as_future(failed)
+            return completed, later
+
+        self.assertEqual(_run(main), ('done', 'later'))
+
+
+    def test_invalid_arguments(self):
+        async def main():
+            with self.assertRaises(ValueError):
+                jpy.call_async(len, [])
+            with self.assertRaises(ValueError):
+                jpy.as_future(self.String('no stage'))
+
+        _run(main)
+        if hasattr(asyncio, 'get_running_loop'):
+            # No running event loop
+            with self.assertRaises(RuntimeError):
+                jpy.call_async(self.String.valueOf, 1)
+
+
+if __name__ == '__main__':
+    print('\nRunning ' + __file__)
+    unittest.main()
@@ -0,0 +1,539 @@
+"""
+Benchmarks for calls from Python into Java through jpy.
+
+Each benchmark is timed like pyperf does it: the number of loops per sample is calibrated so that a
+sample takes at least --min-time seconds, a few warmup samples are discarded, and then --repeat
+samples are taken. Results are printed as a table and can be written as JSON to track regressions
+across releases:
+
+    python src/test/python/jpy_benchmark.py -o jpy-0.14.json
+    python src/test/python/jpy_benchmark.py --compare jpy-0.13.json -o jpy-0.14.json
+
+The Java fixtures must be compiled first (mvn test-compile). The Java to Python direction is
+covered by the JMH benchmarks in src/jmh/java (mvn -Pbenchmarks).
+"""
+
+import argparse
+import array
+import asyncio
+import json
+import math
+import platform
+import re
+import sys
+import time
+from functools import partial
+
+import jpyutil
+
+if hasattr(time, 'perf_counter'):
+    _timer = time.perf_counter
+else:
+    _timer = time.time
+
+JSON_FORMAT_VERSION = 1
+
+ARRAY_SIZES = (10, 1000, 100000)
+
+ITERATION_SIZES = (1000, 10000000)
+
+_benchmarks = []
+
+
+def _call_benchmark(name, make_call):
+    """
+    Registers a benchmark timing the zero-argument callable returned by make_call(jpy), which is called
+    once with the jpy module. Arguments are bound with functools.partial, which adds less overhead
+    than a lambda.
+    """
+    def setup(jpy):
+        return _time_calls(make_call(jpy)), None
+    _benchmarks.append((name, setup))
+
+
+def _loop_benchmark(name, make_call):
+    """
+    Like _call_benchmark(), but make_call(jpy, loop) also gets a new asyncio event loop, which is closed
+    once the benchmark has run.
+    """
+    def setup(jpy):
+        loop = asyncio.new_event_loop()
+        try:
+            return _time_calls(make_call(jpy, loop)), loop.close
+        except BaseException:
+            loop.close()
+            raise
+    _benchmarks.append((name, setup))
+
+
+def _time_calls(call):
+    def bench(loops):
+        it = range(loops)
+        t0 = _timer()
+        for _ in it:
+            call()
+        return _timer() - t0
+    return bench
+
+
+def _fixture_type(jpy):
+    return jpy.get_type('org.jpy.fixtures.BenchmarkFixture')
+
+
+def _fixture(jpy):
+    return _fixture_type(jpy)()
+
+
+# Static vs. instance methods by arity
+
+_call_benchmark('call/static/arity0', lambda jpy: _fixture_type(jpy).static0)
+_call_benchmark('call/static/arity1', lambda jpy: partial(_fixture_type(jpy).static1, 1))
+_call_benchmark('call/static/arity2', lambda jpy: partial(_fixture_type(jpy).static2, 1, 2))
+_call_benchmark('call/static/arity4', lambda jpy: partial(_fixture_type(jpy).static4, 1, 2, 3, 4))
+_call_benchmark('call/instance/arity0', lambda jpy: _fixture(jpy).instance0)
+_call_benchmark('call/instance/arity1', lambda jpy: partial(_fixture(jpy).instance1, 1))
+_call_benchmark('call/instance/arity2', lambda jpy: partial(_fixture(jpy).instance2, 1, 2))
+_call_benchmark('call/instance/arity4', lambda jpy: partial(_fixture(jpy).instance4, 1, 2, 3, 4))
+_call_benchmark('call/constructor', lambda jpy: _fixture_type(jpy))
+
+
+# Argument kinds
+
+_call_benchmark('args/primitive', lambda jpy: partial(_fixture(jpy).primitiveArg, 1.5))
+_call_benchmark('args/string', lambda jpy: partial(_fixture(jpy).stringArg, 'hello'))
+_call_benchmark('args/py_int_as_object', lambda jpy: partial(_fixture(jpy).objectArg, 42))
+_call_benchmark('args/py_str_as_object', lambda jpy: partial(_fixture(jpy).objectArg, 'hello'))
+
+
+_call_benchmark('args/java_object',
+                lambda jpy: partial(_fixture(jpy).objectArg, jpy.get_type('java.io.File')('path')))
+
+
+# Instance field access
+
+_call_benchmark('field/get_int', lambda jpy: partial(getattr, _fixture(jpy), 'intField'))
+_call_benchmark('field/set_int', lambda jpy: partial(setattr, _fixture(jpy), 'intField', 1))
+_call_benchmark('field/get_string', lambda jpy: partial(getattr, _fixture(jpy), 'stringField'))
+_call_benchmark('field/set_string', lambda jpy: partial(setattr, _fixture(jpy), 'stringField', 'hello'))
+_call_benchmark('field/get_object', lambda jpy: partial(getattr, _fixture(jpy), 'objectField'))
+
+
+def _set_object_field(jpy):
+    fixture = _fixture(jpy)
+    return partial(setattr, fixture, 'objectField', fixture.objectField)
+
+
+_call_benchmark('field/set_object', _set_object_field)
+
+
+# Overload resolution
+
+_call_benchmark('dispatch/unique', lambda jpy: partial(_fixture(jpy).unique, 1))
+_call_benchmark('dispatch/overloaded_int', lambda jpy: partial(_fixture(jpy).overloaded, 1))
+_call_benchmark('dispatch/overloaded_float', lambda jpy: partial(_fixture(jpy).overloaded, 1.5))
+_call_benchmark('dispatch/overloaded_str', lambda jpy: partial(_fixture(jpy).overloaded, 'a'))
+
+
+# Varargs
+
+_call_benchmark('varargs/int_0', lambda jpy: _fixture(jpy).varargs)
+_call_benchmark('varargs/int_3', lambda jpy: partial(_fixture(jpy).varargs, 1, 2, 3))
+_call_benchmark('varargs/object_3', lambda jpy: partial(_fixture(jpy).varargsObjects, 1, 'b', 3.0))
+
+
+# Java exceptions caught in Python, with and without formatting their message
+
+def _catch(call, arg, format_message):
+    try:
+        call(arg)
+    except RuntimeError as e:
+        if format_message:
+            str(e)
+
+
+def _exception_fixture(jpy):
+    return jpy.get_type('org.jpy.fixtures.ExceptionTestFixture')()
+
+
+_call_benchmark('exception/caught',
+                lambda jpy: partial(_catch, _exception_fixture(jpy).throwRteIfMessageIsNotNull, 'Evil!', False))
+_call_benchmark('exception/caught_and_formatted',
+                lambda jpy: partial(_catch, _exception_fixture(jpy).throwRteIfMessageIsNotNull, 'Evil!', True))
+
+
+# Overhead of jpy.diag.metrics on a cheap call, toggled once per batch of 100 calls
+
+def _call_batch_with_metrics(jpy, call, enabled):
+    jpy.diag.metrics = enabled
+    try:
+        for _ in range(100):
+            call()
+    finally:
+        jpy.diag.metrics = False
+        jpy.stats(reset=True)
+
+
+def _string_length(jpy):
+    return jpy.get_type('java.lang.String')('hello').length
+
+
+_call_benchmark('diag/metrics_off/100_calls', lambda jpy: partial(_call_batch_with_metrics, jpy, _string_length(jpy), False))
+_call_benchmark('diag/metrics_on/100_calls', lambda jpy: partial(_call_batch_with_metrics, jpy, _string_length(jpy), True))
+
+
+# Arrays and buffers by size
+
+def _register_array_benchmarks(size):
+    _call_benchmark('array/list_to_int_array/%d' % size,
+                    lambda jpy: partial(_fixture(jpy).intArrayLength, list(range(size))))
+    _call_benchmark('array/buffer_to_double_array/%d' % size,
+                    lambda jpy: partial(_fixture(jpy).doubleArrayLength, array.array('d', range(size))))
+    _call_benchmark('array/java_double_array/%d' % size,
+                    lambda jpy: partial(_fixture(jpy).doubleArrayLength, jpy.array('double', size)))
+    _call_benchmark('array/return_double_array/%d' % size,
+                    lambda jpy: partial(_fixture(jpy).newDoubleArray, size))
+
+
+for _size in ARRAY_SIZES:
+    _register_array_benchmarks(_size)
+
+
+# List and Map access through the sequence and mapping protocols vs. method calls, and bulk conversions
+
+_call_benchmark('collection/list_len', lambda jpy: partial(len, _fixture(jpy).newArrayList(1000)))
+_call_benchmark('collection/list_size', lambda jpy: _fixture(jpy).newArrayList(1000).size)
+_call_benchmark('collection/list_getitem', lambda jpy: partial(_fixture(jpy).newArrayList(1000).__getitem__, 500))
+_call_benchmark('collection/list_get', lambda jpy: partial(_fixture(jpy).newArrayList(1000).get, 500))
+_call_benchmark('collection/map_getitem', lambda jpy: partial(_fixture(jpy).newHashMap(1000).__getitem__, 500))
+_call_benchmark('collection/map_get', lambda jpy: partial(_fixture(jpy).newHashMap(1000).get, 500))
+_call_benchmark('collection/map_contains', lambda jpy: partial(_fixture(jpy).newHashMap(1000).__contains__, 500))
+_call_benchmark('collection/map_contains_key', lambda jpy: partial(_fixture(jpy).newHashMap(1000).containsKey, 500))
+_call_benchmark('collection/to_list/1000', lambda jpy: partial(jpy.to_list, _fixture(jpy).newArrayList(1000)))
+_call_benchmark('collection/to_dict/1000', lambda jpy: partial(jpy.to_dict, _fixture(jpy).newHashMap(1000)))
+
+
+# Java objects as keys of Python dicts, with and without cached hash codes
+
+HASH_SIZES = (1000, 1000000)
+
+
+def _new_strings(jpy, size):
+    String = jpy.get_type('java.lang.String')
+    return [String(str(i)) for i in range(size)]
+
+
+def _without_hash_cache(jpy, func, arg):
+    jpy.cache_hash('java.lang.String', False)
+    try:
+        func(arg)
+    finally:
+        jpy.cache_hash('java.lang.String', True)
+
+
+def _register_hash_benchmarks(size):
+    _call_benchmark('hash/dict_of_string_keys/%d' % size,
+                    lambda jpy: partial(dict.fromkeys, _new_strings(jpy, size)))
+    _call_benchmark('hash/dict_of_string_keys_uncached/%d' % size,
+                    lambda jpy: partial(_without_hash_cache, jpy, dict.fromkeys, _new_strings(jpy, size)))
+
+
+for _size in HASH_SIZES:
+    _register_hash_benchmarks(_size)
+
+
+# Iteration over Java collections by size. The 10M element runs show the per-element cost of
+# crossing the bridge.
+
+def _drain(iterator):
+    for _ in iterator:
+        pass
+
+
+def _drain_unchunked(jpy, iterable):
+    _drain(jpy.iterate(iterable, chunk_size=1))
+
+
+def _drain_manually(iterator_factory):
+    it = iterator_factory()
+    while it.hasNext():
+        it.next()
+
+
+def _register_iteration_benchmarks(size):
+    _call_benchmark('iterate/array_list/%d' % size,
+                    lambda jpy: partial(_drain, _fixture(jpy).newArrayList(size)))
+    _call_benchmark('iterate/array_list_unchunked/%d' % size,
+                    lambda jpy: partial(_drain_unchunked, jpy, _fixture(jpy).newArrayList(size)))
+    _call_benchmark('iterate/array_list_has_next/%d' % size,
+                    lambda jpy: partial(_drain_manually, _fixture(jpy).newArrayList(size).iterator))
+    _call_benchmark('iterate/hash_map_entries/%d' % size,
+                    lambda jpy: partial(_drain, _fixture(jpy).newHashMap(size).entrySet()))
+
+
+for _size in ITERATION_SIZES:
+    _register_iteration_benchmarks(_size)
+
+
+# Reading fields of many Java objects, attribute by attribute and with a jpy.fields() projection
+
+PROJECTION_SIZES = (1000, 100000)
+PROJECTION_FIELDS = ['intField', 'stringField']
+
+
+def _get_fields(objects, names):
+    return {name: [getattr(obj, name) for obj in objects] for name in names}
+
+
+def _register_projection_benchmarks(size):
+    _call_benchmark('fields/getattr/%d' % size,
+                    lambda jpy: partial(_get_fields, list(_fixture(jpy).newFixtures(size)), PROJECTION_FIELDS))
+    _call_benchmark('fields/projection/%d' % size,
+                    lambda jpy: partial(jpy.fields('org.jpy.fixtures.BenchmarkFixture', PROJECTION_FIELDS),
+                                        _fixture(jpy).newFixtures(size)))
+
+
+for _size in PROJECTION_SIZES:
+    _register_projection_benchmarks(_size)
+
+
+# numpy conversions of Java arrays and collections, registered only if numpy is installed
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+
+def _register_numpy_benchmarks(size):
+    _call_benchmark('numpy/double_array_to_list/%d' % size,
+                    lambda jpy: partial(list, jpy.array('double', size)))
+    _call_benchmark('numpy/double_array_to_numpy/%d' % size,
+                    lambda jpy: partial(jpy.to_numpy, jpy.array('double', size)))
+    _call_benchmark('numpy/boxed_list_to_list/%d' % size,
+                    lambda jpy: partial(jpy.to_list, _fixture(jpy).newArrayList(size)))
+    _call_benchmark('numpy/boxed_list_to_numpy/%d' % size,
+                    lambda jpy: partial(jpy.to_numpy, _fixture(jpy).newArrayList(size)))
+
+
+if numpy is not None:
+    for _size in ARRAY_SIZES:
+        _register_numpy_benchmarks(_size)
+
+
+# Many concurrent Java calls from an asyncio event loop, with jpy.call_async() and with the loop's default executor
+
+ASYNC_SIZES = (1000, 10000)
+
+
+def _gather_call_async(jpy, loop, method, size):
+    async def main():
+        return await asyncio.gather(*[jpy.call_async(method, i) for i in range(size)])
+    return loop.run_until_complete(main())
+
+
+def _gather_run_in_executor(loop, method, size):
+    async def main():
+        return await asyncio.gather(*[loop.run_in_executor(None, method, i) for i in range(size)])
+    return loop.run_until_complete(main())
+
+
+def _register_async_benchmarks(size):
+    _loop_benchmark('async/call_async/%d' % size,
+                    lambda jpy, loop: partial(_gather_call_async, jpy, loop, _fixture_type(jpy).static1, size))
+    _loop_benchmark('async/run_in_executor/%d' % size,
+                    lambda jpy, loop: partial(_gather_run_in_executor, loop, _fixture_type(jpy).static1, size))
+
+
+for _size in ASYNC_SIZES:
+    _register_async_benchmarks(_size)
+
+
+# Statistics
+
+def _median(values):
+    ordered = sorted(values)
+    n = len(ordered)
+    mid = n // 2
+    if n % 2:
+        return ordered[mid]
+    return (ordered[mid - 1] + ordered[mid]) / 2.0
+
+
+def _stdev(values):
+    if len(values) < 2:
+        return 0.0
+    mean = sum(values) / len(values)
+    return math.sqrt(sum((v - mean) ** 2 for v in values) / (len(values) - 1))
+
+
+def _calibrate(bench, min_time):
+    loops = 1
+    while True:
+        elapsed = bench(loops)
+        if elapsed >= min_time or loops >= 2 ** 30:
+            return loops
+        if elapsed <= 0:
+            loops *= 10
+        else:
+            # aim a bit above min_time, but never grow by more than 10x per step
+            loops = int(loops * min(10.0, max(2.0, 1.2 * min_time / elapsed)))
+
+
+def run_benchmark(bench, warmups, repeat, min_time):
+    """
+    Times one benchmark function and returns a result dictionary. All times are in seconds per call.
+    """
+    loops = _calibrate(bench, min_time)
+    for _ in range(warmups):
+        bench(loops)
+    values = [bench(loops) / loops for _ in range(repeat)]
+    return {
+        'loops': loops,
+        'warmups': warmups,
+        'values': values,
+        'mean': sum(values) / len(values),
+        'median': _median(values),
+        'stdev': _stdev(values),
+        'min': min(values),
+        'max': max(values),
+    }
+
+
+def _smallest_sizes(names):
+    """
+    Returns the names of the benchmarks which are not run with different sizes, and of those which are,
+    the ones with the smallest size. Sizes are the last component of a name, e.g. 'array/java_double_array/10'.
+    """
+    smallest = {}
+    for name in names:
+        match = re.match(r'^(.*)/(\d+)$', name)
+        if match:
+            size = int(match.group(2))
+            smallest[match.group(1)] = min(size, smallest.get(match.group(1), size))
+    selected = set()
+    for name in names:
+        match = re.match(r'^(.*)/(\d+)$', name)
+        if not match or int(match.group(2)) == smallest[match.group(1)]:
+            selected.add(name)
+    return selected
+
+
+def run(name_filter=None, warmups=3, repeat=10, min_time=0.1, verbose=True, smallest_only=False):
+    """
+    Runs the benchmarks whose names match the regular expression name_filter and returns the results
+    in the JSON structure written by --output. With smallest_only, benchmarks which are run with
+    different sizes are only run with the smallest one.
+    """
+    import jpy
+
+    pattern = re.compile(name_filter) if name_filter else None
+    selected = _smallest_sizes([name for name, _ in _benchmarks]) if smallest_only else None
+    results = []
+    for name, setup in _benchmarks:
+        if pattern and not pattern.search(name):
+            continue
+        if selected is not None and name not in selected:
+            continue
+        bench, close = setup(jpy)
+        try:
+            result = run_benchmark(bench, warmups, repeat, min_time)
+        finally:
+            if close is not None:
+                close()
+        result['name'] = name
+        results.append(result)
+        if verbose:
+            print('%-45s %12s +- %-10s (%d loops x %d)' % (name, _format_time(result['median']),
+                                                           _format_time(result['stdev']),
+                                                           result['loops'], repeat))
+
+    System = jpy.get_type('java.lang.System')
+    return {
+        'format_version': JSON_FORMAT_VERSION,
+        'metadata': {
+            'date': time.strftime('%Y-%m-%dT%H:%M:%S'),
+            'jpy_version': jpyutil.__version__,
+            'python_version': platform.python_version(),
+            'python_implementation': platform.python_implementation(),
+            'java_version': System.getProperty('java.version'),
+            'java_vm_name': System.getProperty('java.vm.name'),
+            'platform': platform.platform(),
+            'warmups': warmups,
+            'repeat': repeat,
+            'min_time': min_time,
+        },
+        'benchmarks': results,
+    }
+
+
+def compare(baseline, results, threshold):
+    """
+    Prints the change of the median of each benchmark against the baseline results and returns the
+    names of the benchmarks that got slower by more than the given factor.
+    """
+    base_medians = dict((b['name'], b['median']) for b in baseline['benchmarks'])
+    regressions = []
+    for result in results['benchmarks']:
+        base = base_medians.get(result['name'])
+        if not base:
+            continue
+        ratio = result['median'] / base
+        flag = ''
+        if ratio > threshold:
+            flag = '  SLOWER'
+            regressions.append(result['name'])
+        print('%-45s %12s -> %12s  x%.2f%s' % (result['name'], _format_time(base),
+                                               _format_time(result['median']), ratio, flag))
+    return regressions
+
+
+def _format_time(seconds):
+    if seconds >= 1e-3:
+        return '%.2f ms' % (seconds * 1e3)
+    if seconds >= 1e-6:
+        return '%.2f us' % (seconds * 1e6)
+    return '%.1f ns' % (seconds * 1e9)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description='Benchmarks for Python to Java calls through jpy.')
+    parser.add_argument('-o', '--output', help='write the results to this JSON file')
+    parser.add_argument('-b', '--filter', help='only run benchmarks whose names match this regular expression')
+    parser.add_argument('--warmups', type=int, default=3, help='number of warmup samples (default: 3)')
+    parser.add_argument('--repeat', type=int, default=10, help='number of samples (default: 10)')
+    parser.add_argument('--min-time', type=float, default=0.1, help='minimum seconds per sample (default: 0.1)')
+    parser.add_argument('--fast', action='store_true', help='1 warmup, 5 samples of at least 20 ms')
+    parser.add_argument('--smallest', action='store_true', help='only run the smallest size of sized benchmarks')
+    parser.add_argument('--compare', metavar='BASELINE', help='compare the medians with a previous JSON result')
+    parser.add_argument('--threshold', type=float, default=1.1,
+                        help='with --compare, exit with status 1 if a benchmark is slower by this factor (default: 1.1)')
+    parser.add_argument('--list', action='store_true', help='list the benchmark names and exit')
+    args = parser.parse_args(argv)
+
+    if args.list:
+        for name, _ in _benchmarks:
+            print(name)
+        return 0
+
+    if args.fast:
+        args.warmups, args.repeat, args.min_time = 1, 5, 0.02
+
+    jpyutil.init_jvm(jvm_maxmem='2G', jvm_classpath=['target/test-classes'])
+    results = run(name_filter=args.filter, warmups=args.warmups, repeat=args.repeat, min_time=args.min_time,
+                  smallest_only=args.smallest)
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(results, f, indent=2)
+
+    if args.compare:
+        with open(args.compare) as f:
+            baseline = json.load(f)
+        print()
+        if compare(baseline, results, args.threshold):
+            return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
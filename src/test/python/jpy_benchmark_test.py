@@ -0,0 +1,34 @@
+import unittest
+
+import jpyutil
+
+
+jpyutil.init_jvm(jvm_maxmem='512M', jvm_classpath=['target/test-classes'])
+import jpy
+
+
+class TestBenchmarkSuite(unittest.TestCase):
+
+    def test_benchmark_suite(self):
+        # Only checks that every benchmark runs and the results are well-formed, see jpy_benchmark.py
+        import json
+        import jpy_benchmark
+
+        results = jpy_benchmark.run(warmups=0, repeat=2, min_time=0.001, verbose=False, smallest_only=True)
+        results = json.loads(json.dumps(results))
+        self.assertEqual(results['format_version'], jpy_benchmark.JSON_FORMAT_VERSION)
+        self.assertIn('java_version', results['metadata'])
+        names = [b['name'] for b in results['benchmarks']]
+        self.assertIn('call/static/arity0', names)
+        self.assertIn('array/buffer_to_double_array/10', names)
+        self.assertNotIn('array/buffer_to_double_array/100000', names)
+        for b in results['benchmarks']:
+            self.assertEqual(len(b['values']), 2)
+            self.assertGreater(b['loops'], 0)
+            self.assertLessEqual(b['min'], b['median'])
+            self.assertLessEqual(b['median'], b['max'])
+
+
+if __name__ == '__main__':
+    print('\nRunning ' + __file__)
+    unittest.main()
@@ -36,6 +36,239 @@ class TestJavaArrays(unittest.TestCase):
         jpy.diag.flags += jpy.diag.F_MEM
         self.assertEqual(jpy.diag.flags, 12)
 
+    def test_metrics(self):
+        self.assertFalse(jpy.diag.metrics)
+        jpy.stats(reset=True)
+        String = jpy.get_type('java.lang.String')
+        s = String('hello')
+        s.length()
+        self.assertEqual(jpy.stats()['calls'], 0)
+
+        jpy.diag.metrics = True
+        try:
+            for i in range(100):
+                s.length()
+                s.substring(1, 3)
+            stats = jpy.stats()
+        finally:
+            jpy.diag.metrics = False
+
+        self.assertTrue(stats['enabled'])
+        self.assertEqual(stats['calls'], 200)
+        self.assertEqual(stats['errors'], 0)
+        for phase in ('overload_resolution', 'arg_conversion', 'java_execution', 'result_conversion', 'gil_wait'):
+            self.assertEqual(stats[phase]['count'], 200, phase)
+            self.assertLessEqual(stats[phase]['p50_ns'], stats[phase]['max_ns'])
+            self.assertEqual(sum(count for upper, count in stats[phase]['buckets']), 200)
+        length = stats['methods']['java.lang.String#length()']
+        self.assertEqual(length['calls'], 100)
+        self.assertEqual(length['latency']['count'], 100)
+        self.assertEqual(stats['methods']['java.lang.String#substring(int,int)']['calls'], 100)
+
+        stats = jpy.stats(reset=True)
+        self.assertEqual(stats['calls'], 200)
+        self.assertEqual(jpy.stats()['calls'], 0)
+        self.assertEqual(jpy.stats()['methods'], {})
+
+    def test_metrics_toggle(self):
+        String = jpy.get_type('java.lang.String')
+        s = String('hello')
+        jpy.stats(reset=True)
+        for enabled in (False, True, False):
+            jpy.diag.metrics = enabled
+            try:
+                for i in range(10):
+                    s.length()
+            finally:
+                jpy.diag.metrics = False
+        self.assertEqual(jpy.stats(reset=True)['calls'], 10)
+
+    def test_profiler(self):
+        import json
+        import os
+        import tempfile
+        String = jpy.get_type('java.lang.String')
+        s = String('hello')
+
+        jpy.start_profiler(capacity=16)
+        try:
+            for i in range(20):
+                s.length()
+            s.substring(1)
+        finally:
+            jpy.stop_profiler()
+        s.length()
+
+        fd, path = tempfile.mkstemp(suffix='.json')
+        os.close(fd)
+        try:
+            self.assertEqual(jpy.dump_profile(path), 16)
+            with open(path) as f:
+                trace = json.load(f)
+        finally:
+            os.remove(path)
+
+        self.assertEqual(trace['otherData']['recorded_events'], 21)
+        events = [e for e in trace['traceEvents'] if e['ph'] == 'X']
+        self.assertEqual(len(events), 16)
+        self.assertEqual(events[-1]['name'], 'java.lang.String#substring')
+        self.assertEqual(events[0]['name'], 'java.lang.String#length')
+        for event in events:
+            self.assertEqual(event['cat'], 'java')
+            self.assertGreaterEqual(event['dur'], 0)
+        self.assertEqual([e['name'] for e in trace['traceEvents'] if e['ph'] == 'M'], ['thread_name'])
+
+        with self.assertRaises(ValueError):
+            jpy.start_profiler(capacity=0)
+
+    def test_profiler_dump_while_recording(self):
+        import json
+        import os
+        import tempfile
+        s = jpy.get_type('java.lang.String')('hello')
+
+        def recorded_events(path):
+            jpy.dump_profile(path)
+            with open(path) as f:
+                return json.load(f)['otherData']['recorded_events']
+
+        fd, path = tempfile.mkstemp(suffix='.json')
+        os.close(fd)
+        jpy.start_profiler(capacity=4)
+        try:
+            s.length()
+            s.length()
+            self.assertEqual(recorded_events(path), 2)
+            # recording resumes after the dump
+            s.length()
+            self.assertEqual(recorded_events(path), 3)
+        finally:
+            jpy.stop_profiler()
+            os.remove(path)
+
+    def test_events(self):
+        import os
+        import tempfile
+        Integer = jpy.get_type('java.lang.Integer')
+        self.assertEqual(jpy.diag.stdout, False)
+        self.assertIsInstance(jpy.diag.dropped, int)
+        jpy.diag.drain()
+
+        jpy.diag.flags = jpy.diag.F_EXEC
+        try:
+            Integer.toString(42)
+        finally:
+            jpy.diag.flags = jpy.diag.F_OFF
+
+        events = jpy.diag.drain()
+        self.assertTrue(len(events) > 0)
+        for time_ns, thread_id, flags, message in events:
+            self.assertIsInstance(time_ns, int)
+            self.assertIsInstance(thread_id, int)
+            self.assertEqual(flags, jpy.diag.F_EXEC)
+            self.assertFalse(message.endswith('\n'))
+        times = [e[0] for e in events]
+        self.assertEqual(times, sorted(times))
+        self.assertIn('JMethod_InvokeMethod: calling static Java method java.lang.Integer#toString',
+                      [e[3] for e in events])
+        self.assertEqual(jpy.diag.drain(), [])
+
+        jpy.diag.flags = jpy.diag.F_EXEC
+        try:
+            Integer.toString(43)
+        finally:
+            jpy.diag.flags = jpy.diag.F_OFF
+        fd, path = tempfile.mkstemp(suffix='.log')
+        os.close(fd)
+        try:
+            count = jpy.diag.dump(path)
+            with open(path) as f:
+                lines = f.read().splitlines()
+        finally:
+            os.remove(path)
+        self.assertTrue(count > 0)
+        self.assertEqual(len(lines), count)
+        self.assertTrue(any('java.lang.Integer#toString' in line for line in lines))
+
+        with self.assertRaises(AttributeError):
+            jpy.diag.dropped = 0
+
+    def test_events_of_exited_threads(self):
+        import threading
+        Integer = jpy.get_type('java.lang.Integer')
+        jpy.diag.drain()
+
+        def record(i):
+            Integer.toString(i)
+
+        jpy.diag.flags = jpy.diag.F_EXEC
+        try:
+            # one thread after the other, each taking over the buffer of its predecessor
+            for i in range(20):
+                thread = threading.Thread(target=record, args=(i,))
+                thread.start()
+                thread.join()
+        finally:
+            jpy.diag.flags = jpy.diag.F_OFF
+
+        calls = [e for e in jpy.diag.drain() if 'java.lang.Integer#toString' in e[3]]
+        self.assertGreaterEqual(len(calls), 20)
+
+    def test_memory_stats(self):
+        import array
+        import gc
+        import warnings
+        ArrayList = jpy.get_type('java.util.ArrayList')
+        Arrays = jpy.get_type('java.util.Arrays')
+        # resolve the constructors first, which creates global references to their parameter types
+        ArrayList()
+
+        stats0 = jpy.diag.memory_stats()
+        lists = [ArrayList() for i in range(100)]
+        stats1 = jpy.diag.memory_stats()
+        self.assertEqual(stats1['global_refs'] - stats0['global_refs'], 100)
+        self.assertEqual(stats1['global_refs_by_kind']['object'] - stats0['global_refs_by_kind']['object'], 100)
+        self.assertGreaterEqual(stats1['global_refs_by_type']['java.util.ArrayList'], 100)
+        self.assertGreaterEqual(stats1['global_refs_peak'], stats1['global_refs'])
+        self.assertEqual(stats1['global_refs'], sum(stats1['global_refs_by_kind'].values()))
+        del lists
+        gc.collect()
+        self.assertEqual(jpy.diag.memory_stats()['global_refs'], stats0['global_refs'])
+
+        # exported array elements are held until the array is released
+        a = jpy.array('int', 1000)
+        m = memoryview(a)
+        stats1 = jpy.diag.memory_stats()
+        self.assertEqual(stats1['array_buffers'] - stats0['array_buffers'], 1)
+        self.assertEqual(stats1['array_buffer_bytes'] - stats0['array_buffer_bytes'], 4000)
+        m.release()
+        del m, a
+        gc.collect()
+        self.assertEqual(jpy.diag.memory_stats()['array_buffer_bytes'], stats0['array_buffer_bytes'])
+
+        # Python buffers passed as Java arrays are held during the call only
+        jpy.diag.memory_stats(reset_peaks=True)
+        Arrays.hashCode(array.array('i', range(100)))
+        stats1 = jpy.diag.memory_stats()
+        self.assertEqual(stats1['arg_buffers'], 0)
+        self.assertEqual(stats1['arg_buffers_peak'], 1)
+        self.assertGreaterEqual(stats1['buffer_bytes_peak'], 400)
+
+        jpy.diag.global_ref_limit = stats1['global_refs'] + 10
+        try:
+            with warnings.catch_warnings(record=True) as caught:
+                warnings.simplefilter('always')
+                lists = [ArrayList() for i in range(20)]
+            self.assertEqual(len([w for w in caught if issubclass(w.category, RuntimeWarning)]), 1)
+            self.assertIn('JNI global references', str(caught[0].message))
+            self.assertEqual(jpy.diag.memory_stats()['alerts'] - stats1['alerts'], 1)
+        finally:
+            jpy.diag.global_ref_limit = 0
+        del lists
+
+        with self.assertRaises(ValueError):
+            jpy.diag.buffer_bytes_limit = -1
+
 
 if __name__ == '__main__':
     print('\nRunning ' + __file__)
@@ -50,6 +50,63 @@ class TestExceptions(unittest.TestCase):
         with  self.assertRaises(RuntimeError, msg='Java IOException expected') as e:
             fixture.throwIoeIfMessageIsNotNull("Evil!")
         self.assertEqual(str(e.exception), 'java.io.IOException: Evil!')
+        self.assertEqual(repr(e.exception), "java.io.IOException('java.io.IOException: Evil!')")
+
+    def test_JException(self):
+        fixture = self.Fixture()
+
+        with self.assertRaises(jpy.JException) as e:
+            fixture.throwRteIfMessageIsNotNull("Evil!")
+        self.assertTrue(isinstance(e.exception, RuntimeError))
+        self.assertEqual(e.exception.args, ('java.lang.RuntimeException: Evil!',))
+        self.assertEqual(repr(e.exception), "java.lang.RuntimeException('java.lang.RuntimeException: Evil!')")
+        self.assertEqual(e.exception.java_exception.getMessage(), 'Evil!')
+
+        e = jpy.JException('raised by Python')
+        self.assertEqual(str(e), 'raised by Python')
+        self.assertIsNone(e.java_exception)
+
+    def test_ExceptionTypes(self):
+        fixture = self.Fixture()
+
+        with self.assertRaises(IndexError) as e:
+            fixture.throwAioobeIfIndexIsNotZero(1)
+        aioobe_type = type(e.exception)
+        self.assertEqual(aioobe_type.__name__, 'ArrayIndexOutOfBoundsException')
+        self.assertEqual(aioobe_type.__module__, 'java.lang')
+        self.assertTrue(isinstance(e.exception, jpy.JException))
+        self.assertEqual(str(e.exception), 'java.lang.ArrayIndexOutOfBoundsException: 1')
+
+        with self.assertRaises(IndexError) as e:
+            fixture.throwAioobeIfIndexIsNotZero(-1)
+        self.assertIs(type(e.exception), aioobe_type)
+
+        types = jpy.exception_types
+        self.assertIs(types['java.lang.ArrayIndexOutOfBoundsException'], aioobe_type)
+        self.assertTrue(issubclass(aioobe_type, types['java.lang.IndexOutOfBoundsException']))
+        self.assertTrue(issubclass(aioobe_type, types['java.lang.RuntimeException']))
+        self.assertTrue(issubclass(types['java.lang.Exception'], jpy.JException))
+
+        with self.assertRaises(jpy.JException) as e:
+            fixture.throwIoeIfMessageIsNotNull("Evil!")
+        self.assertIs(type(e.exception), types['java.io.IOException'])
+        self.assertFalse(isinstance(e.exception, IndexError))
+        self.assertFalse(isinstance(e.exception, types['java.lang.RuntimeException']))
+
+        with self.assertRaises(types['java.lang.NullPointerException']):
+            fixture.throwNpeIfArgIsNull(None)
+
+    def test_CaughtExceptionRepeatedly(self):
+        fixture = self.Fixture()
+        for verbose in (False, True):
+            jpy.VerboseExceptions.enabled = verbose
+            try:
+                for i in range(100):
+                    with self.assertRaises(RuntimeError) as e:
+                        fixture.throwRteIfMessageIsNotNull("Evil!")
+                self.assertIn('Evil!', str(e.exception))
+            finally:
+                jpy.VerboseExceptions.enabled = False
 
     # Checking the exceptions for differences (e.g. in white space) can be a huge pain, this helps)
     def hexdump(self, s):
@@ -98,6 +98,93 @@ class TestFields(unittest.TestCase):
         self.assertEqual(fixture.SObjInstField, 'ABC')
         self.assertEqual(fixture.lObjInstField, self.Thing(123))
 
+        fixture.SObjInstField = None
+        fixture.lObjInstField = None
+        self.assertEqual(fixture.SObjInstField, None)
+        self.assertEqual(fixture.lObjInstField, None)
+
+
+    def test_field_descriptors(self):
+        field = self.Fixture.iInstField
+        self.assertIsInstance(field, jpy.JField)
+        self.assertEqual(field.name, 'iInstField')
+        self.assertFalse(field.is_static)
+
+        fixture = self.Fixture()
+        fixture.iInstField = 42
+        self.assertEqual(field.__get__(fixture, self.Fixture), 42)
+        field.__set__(fixture, 43)
+        self.assertEqual(fixture.iInstField, 43)
+
+        with self.assertRaises(TypeError):
+            field.__get__(self.Thing(1), self.Thing)
+        with self.assertRaises(TypeError):
+            fixture.iInstField = 'A'
+        self.assertEqual(fixture.iInstField, 43)
+        with self.assertRaises(AttributeError):
+            del fixture.iInstField
+        with self.assertRaises(AttributeError):
+            fixture.noSuchField = 1
+
+
+    def test_fields_projection(self):
+        fixtures = []
+        for i in range(3):
+            fixture = self.Fixture()
+            fixture.zInstField = i % 2 == 1
+            fixture.cInstField = 65 + i
+            fixture.iInstField = 1000 * i
+            fixture.jInstField = 1234567890123456789 + i
+            fixture.dInstField = 0.5 * i
+            fixture.SObjInstField = 'S%d' % i
+            fixture.lObjInstField = self.Thing(i)
+            fixtures.append(fixture)
+
+        names = ['zInstField', 'cInstField', 'iInstField', 'jInstField', 'dInstField', 'SObjInstField', 'lObjInstField']
+        projection = jpy.fields('org.jpy.fixtures.FieldTestFixture', names)
+        self.assertIsInstance(projection, jpy.JFieldProjection)
+        self.assertEqual(projection.type, self.Fixture)
+        self.assertEqual(projection.names, tuple(names))
+
+        ArrayList = jpy.get_type('java.util.ArrayList')
+        array_list = ArrayList()
+        for fixture in fixtures:
+            array_list.add(fixture)
+
+        for objects in [jpy.array(self.Fixture, fixtures), array_list, fixtures]:
+            columns = projection(objects)
+            self.assertEqual(list(columns.keys()), names)
+            self.assertEqual(columns['zInstField'].format, '?')
+            self.assertEqual(columns['zInstField'].tolist(), [False, True, False])
+            self.assertEqual(columns['cInstField'].tolist(), [65, 66, 67])
+            self.assertEqual(columns['iInstField'].format, 'i')
+            self.assertEqual(columns['iInstField'].tolist(), [0, 1000, 2000])
+            self.assertEqual(columns['jInstField'].format, 'q')
+            self.assertEqual(columns['jInstField'].tolist(), [1234567890123456789, 1234567890123456790, 1234567890123456791])
+            self.assertEqual(columns['dInstField'].format, 'd')
+            self.assertEqual(columns['dInstField'].tolist(), [0.0, 0.5, 1.0])
+            self.assertEqual(columns['SObjInstField'], ['S0', 'S1', 'S2'])
+            self.assertEqual(columns['lObjInstField'], [self.Thing(0), self.Thing(1), self.Thing(2)])
+
+        columns = projection([])
+        self.assertEqual(len(columns['iInstField']), 0)
+        self.assertEqual(columns['SObjInstField'], [])
+
+        with self.assertRaises(ValueError):
+            projection([fixtures[0], self.Thing(1)])
+        with self.assertRaises(ValueError):
+            projection([fixtures[0], None])
+        with self.assertRaises(ValueError):
+            projection(jpy.array('int', 3))
+        with self.assertRaises(ValueError):
+            jpy.fields(self.Fixture, ['noSuchField'])
+        with self.assertRaises(ValueError):
+            jpy.fields(self.Fixture, ['i_STATIC_FIELD'])
+        with self.assertRaises(ValueError):
+            jpy.fields(self.Fixture, 'iInstField')
+        with self.assertRaises(ValueError):
+            jpy.fields('int', ['iInstField'])
+
 
 if __name__ == '__main__':
     print('\nRunning ' + __file__)
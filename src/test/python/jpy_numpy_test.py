@@ -0,0 +1,130 @@
+import unittest
+
+import jpyutil
+
+
+jpyutil.init_jvm(jvm_maxmem='512M')
+import jpy
+
+try:
+    import numpy as np
+except ImportError:
+    np = None
+
+
+def _find_method(overloaded_method, *param_type_names):
+    param_types = [jpy.get_type(name) for name in param_type_names]
+    for method in overloaded_method.methods:
+        if [method.get_param_type(i) for i in range(method.param_count)] == param_types:
+            return method
+    raise ValueError('method not found')
+
+
+@unittest.skipIf(np is None, 'numpy is not installed')
+class TestNumpy(unittest.TestCase):
+
+    def setUp(self):
+        self.ArrayList = jpy.get_type('java.util.ArrayList')
+        self.Arrays = jpy.get_type('java.util.Arrays')
+        self.BitSet = jpy.get_type('java.util.BitSet')
+
+
+    def new_list(self, *items):
+        values = self.ArrayList()
+        for item in items:
+            values.add(item)
+        return values
+
+
+    def test_to_numpy_primitive_arrays(self):
+        a = jpy.to_numpy(jpy.array('int', [1, 2, 3]))
+        self.assertIsInstance(a, np.ndarray)
+        self.assertEqual(a.dtype, np.int32)
+        self.assertEqual(a.tolist(), [1, 2, 3])
+
+        self.assertEqual(jpy.to_numpy(jpy.array('boolean', [True, False])).dtype, np.bool_)
+        self.assertEqual(jpy.to_numpy(jpy.array('byte', [1, -1])).tolist(), [1, -1])
+        self.assertEqual(jpy.to_numpy(jpy.array('char', [65, 66])).dtype, np.uint16)
+        self.assertEqual(jpy.to_numpy(jpy.array('short', [1, -1])).dtype, np.int16)
+        self.assertEqual(jpy.to_numpy(jpy.array('long', [2 ** 40])).tolist(), [2 ** 40])
+        self.assertEqual(jpy.to_numpy(jpy.array('float', [0.5])).dtype, np.float32)
+        self.assertEqual(jpy.to_numpy(jpy.array('double', [0.5, 1.5])).tolist(), [0.5, 1.5])
+        self.assertEqual(len(jpy.to_numpy(jpy.array('double', 0))), 0)
+
+
+    def test_to_numpy_boxed_numbers(self):
+        Integer = jpy.get_type('java.lang.Integer')
+        Double = jpy.get_type('java.lang.Double')
+        Boolean = jpy.get_type('java.lang.Boolean')
+
+        a = jpy.to_numpy(self.new_list(Integer(1), Integer(2), Integer(3)))
+        self.assertEqual(a.dtype, np.int64)
+        self.assertEqual(a.tolist(), [1, 2, 3])
+
+        a = jpy.to_numpy(jpy.array('java.lang.Integer', [Integer(1), None]))
+        self.assertEqual(a.dtype, np.float64)
+        self.assertEqual(a[0], 1.0)
+        self.assertTrue(np.isnan(a[1]))
+
+        a = jpy.to_numpy(self.new_list(Integer(1), Double(0.5)))
+        self.assertEqual(a.tolist(), [1.0, 0.5])
+
+        a = jpy.to_numpy(self.new_list(Boolean(True), Boolean(False)))
+        self.assertEqual(a.dtype, np.bool_)
+        self.assertEqual(a.tolist(), [True, False])
+
+        self.assertEqual(len(jpy.to_numpy(self.ArrayList())), 0)
+
+        with self.assertRaises(ValueError):
+            jpy.to_numpy(self.new_list('A'))
+        with self.assertRaises(ValueError):
+            jpy.to_numpy(self.new_list(Boolean(True), Integer(1)))
+        with self.assertRaises(ValueError):
+            jpy.to_numpy(jpy.get_type('java.lang.String')('A'))
+        with self.assertRaises(ValueError):
+            jpy.to_numpy([1, 2, 3])
+
+
+    def test_return_numpy(self):
+        method = _find_method(self.Arrays.copyOf, '[I', 'int')
+        self.assertFalse(method.is_return_numpy())
+        a = self.Arrays.copyOf(jpy.array('int', [1, 2, 3]), 2)
+        self.assertNotIsInstance(a, np.ndarray)
+
+        method.set_return_numpy(True)
+        try:
+            self.assertTrue(method.is_return_numpy())
+            a = self.Arrays.copyOf(jpy.array('int', [1, 2, 3]), 2)
+            self.assertIsInstance(a, np.ndarray)
+            self.assertEqual(a.dtype, np.int32)
+            self.assertEqual(a.tolist(), [1, 2])
+        finally:
+            method.set_return_numpy(False)
+
+        with self.assertRaises(ValueError):
+            _find_method(self.Arrays.hashCode, '[I').set_return_numpy(True)
+
+
+    def test_param_numpy(self):
+        method = _find_method(self.BitSet.valueOf, '[J')
+        self.assertFalse(method.is_param_numpy(0))
+
+        method.set_param_numpy(0, True)
+        try:
+            self.assertTrue(method.is_param_numpy(0))
+            # int32 and float64 items are cast to a long[] by numpy
+            self.assertEqual(str(self.BitSet.valueOf(np.array([5], dtype='int32'))), '{0, 2}')
+            self.assertEqual(str(self.BitSet.valueOf(np.array([5.0, 1.0]))), '{0, 2, 64}')
+            self.assertEqual(str(self.BitSet.valueOf(np.array([3], dtype='int64'))), '{0, 1}')
+        finally:
+            method.set_param_numpy(0, False)
+
+        with self.assertRaises(ValueError):
+            _find_method(self.Arrays.asList, '[Ljava.lang.Object;').set_param_numpy(0, True)
+        with self.assertRaises(IndexError):
+            method.set_param_numpy(1, True)
+
+
+if __name__ == '__main__':
+    print('\nRunning ' + __file__)
+    unittest.main()
@@ -175,6 +175,55 @@ class TestArrayList(unittest.TestCase):
         self.assertEqual(type(array[3]), type(f))
 
 
+    def test_sequence_protocol(self):
+        f = self.File('/usr/local/bibo')
+
+        array_list = self.ArrayList()
+        self.assertEqual(len(array_list), 0)
+        self.assertFalse(array_list)
+        array_list.add('A')
+        array_list.add(12)
+        array_list.add(None)
+        array_list.add(f)
+
+        self.assertEqual(len(array_list), 4)
+        self.assertTrue(array_list)
+        self.assertEqual(array_list[0], 'A')
+        self.assertEqual(array_list[1], 12)
+        self.assertIsNone(array_list[2])
+        self.assertEqual(array_list[3], f)
+        self.assertEqual(array_list[-1], f)
+        self.assertEqual(array_list[-4], 'A')
+        with self.assertRaises(IndexError):
+            array_list[4]
+        with self.assertRaises(IndexError):
+            array_list[-5]
+
+        self.assertIn('A', array_list)
+        self.assertIn(12, array_list)
+        self.assertIn(f, array_list)
+        self.assertNotIn('B', array_list)
+
+
+    def test_to_list(self):
+        array_list = self.ArrayList()
+        self.assertEqual(jpy.to_list(array_list), [])
+        for i in range(1000):
+            array_list.add(i)
+        array_list.add('A')
+        self.assertEqual(jpy.to_list(array_list), list(range(1000)) + ['A'])
+
+        hash_set = jpy.get_type('java.util.HashSet')(array_list)
+        items = jpy.to_list(hash_set)
+        self.assertEqual(len(items), 1001)
+        self.assertIn('A', items)
+
+        with self.assertRaises(ValueError):
+            jpy.to_list([1, 2])
+        with self.assertRaises(ValueError):
+            jpy.to_list(self.File('x'))
+
+
 class TestHashMap(unittest.TestCase):
     def setUp(self):
         self.HashMap = jpy.get_type('java.util.HashMap')
@@ -212,6 +261,300 @@ class TestHashMap(unittest.TestCase):
         self.assertEqual(hash_map.get(4), fa)
 
 
+    def test_mapping_protocol(self):
+        f = self.File('/usr/local/bibo')
+
+        hash_map = self.HashMap()
+        self.assertEqual(len(hash_map), 0)
+        self.assertFalse(hash_map)
+        hash_map.put('A', 1)
+        hash_map.put(2, f)
+        hash_map.put(f, 'B')
+        hash_map.put('N', None)
+
+        self.assertEqual(len(hash_map), 4)
+        self.assertTrue(hash_map)
+        self.assertEqual(hash_map['A'], 1)
+        self.assertEqual(hash_map[2], f)
+        self.assertEqual(hash_map[f], 'B')
+        self.assertIsNone(hash_map['N'])
+        with self.assertRaises(KeyError):
+            hash_map['X']
+
+        self.assertIn('A', hash_map)
+        self.assertIn('N', hash_map)
+        self.assertIn(f, hash_map)
+        self.assertNotIn('X', hash_map)
+        self.assertEqual(set(k for k in hash_map if k != f), {'A', 2, 'N'})
+
+
+    def test_to_dict(self):
+        f = self.File('/usr/local/bibo')
+
+        hash_map = self.HashMap()
+        self.assertEqual(jpy.to_dict(hash_map), {})
+        for i in range(1000):
+            hash_map.put(i, str(i))
+        hash_map.put('N', None)
+        hash_map.put('F', f)
+
+        d = jpy.to_dict(hash_map)
+        self.assertEqual(len(d), 1002)
+        self.assertEqual(d[999], '999')
+        self.assertIsNone(d['N'])
+        self.assertEqual(d['F'], f)
+
+        with self.assertRaises(ValueError):
+            jpy.to_dict({})
+        with self.assertRaises(ValueError):
+            jpy.to_dict(self.ArrayList())
+
+
+class TestIteration(unittest.TestCase):
+    def setUp(self):
+        self.ArrayList = jpy.get_type('java.util.ArrayList')
+        self.HashMap = jpy.get_type('java.util.HashMap')
+
+
+    def new_list(self, n):
+        array_list = self.ArrayList()
+        for i in range(n):
+            array_list.add(i)
+        return array_list
+
+
+    def test_iter_Iterable(self):
+        self.assertEqual(list(self.new_list(1000)), list(range(1000)))
+        self.assertEqual(list(self.ArrayList()), [])
+        self.assertEqual([x for x in self.new_list(3)], [0, 1, 2])
+
+        hash_map = self.HashMap()
+        hash_map.put('a', 1)
+        hash_map.put('b', 2)
+        entries = dict((e.getKey(), e.getValue()) for e in hash_map.entrySet())
+        self.assertEqual(entries, {'a': 1, 'b': 2})
+
+
+    def test_iter_Iterator(self):
+        iterator = self.new_list(3).iterator()
+        self.assertIs(iter(iterator), iterator)
+        self.assertEqual(next(iterator), 0)
+        self.assertEqual(list(iterator), [1, 2])
+        with self.assertRaises(StopIteration):
+            next(iterator)
+
+
+    def test_iterate(self):
+        for chunk_size in (1, 2, 7, 256, 10000):
+            it = jpy.iterate(self.new_list(1000), chunk_size=chunk_size)
+            self.assertEqual(it.chunk_size, chunk_size)
+            self.assertIs(iter(it), it)
+            self.assertEqual(list(it), list(range(1000)))
+            with self.assertRaises(StopIteration):
+                next(it)
+
+        # Chunks do not advance a Java iterator past the elements taken
+        iterator = self.new_list(10).iterator()
+        it = jpy.iterate(iterator, chunk_size=1)
+        self.assertEqual(next(it), 0)
+        self.assertEqual(iterator.next(), 1)
+
+
+    def test_iterate_errors(self):
+        with self.assertRaises(ValueError):
+            jpy.iterate(self.new_list(3), chunk_size=0)
+        with self.assertRaises(ValueError):
+            jpy.iterate([1, 2, 3])
+        with self.assertRaises(ValueError):
+            jpy.iterate(jpy.get_type('java.io.File')('x'))
+
+
+class TestIdentityCache(unittest.TestCase):
+    def setUp(self):
+        self.File = jpy.get_type('java.io.File')
+        self.ArrayList = jpy.get_type('java.util.ArrayList')
+        self.HashMap = jpy.get_type('java.util.HashMap')
+
+    def test_cache_identity(self):
+        import gc
+        entries0 = jpy.diag.memory_stats()['identity_cache_entries']
+        array_list = self.ArrayList()
+        jpy.cache_identity(self.File)
+        try:
+            f = self.File('test')
+            array_list.add(f)
+            array_list.add(self.File('test'))
+            self.assertIs(array_list.get(0), f)
+            self.assertIsNot(array_list.get(1), f)
+            self.assertEqual(array_list.get(1), f)
+
+            global_refs = jpy.diag.memory_stats()['global_refs']
+            for i in range(100):
+                self.assertIs(array_list.get(0), f)
+            self.assertEqual(jpy.diag.memory_stats()['global_refs'], global_refs)
+
+            # the cache doesn't keep wrappers alive
+            del f
+            gc.collect()
+            self.assertIs(array_list.get(0), array_list.get(0))
+            self.assertEqual(jpy.diag.memory_stats()['identity_cache_entries'], entries0)
+        finally:
+            jpy.cache_identity(self.File, False)
+
+        f = array_list.get(0)
+        self.assertIsNot(array_list.get(0), f)
+        self.assertEqual(array_list.get(0), f)
+
+    def test_cache_identity_of_subclasses(self):
+        jpy.cache_identity('java.util.AbstractList')
+        try:
+            array_list = self.ArrayList()
+            hash_map = self.HashMap()
+            hash_map.put('list', array_list)
+            self.assertIs(hash_map.get('list'), array_list)
+            hash_map.put('map', hash_map)
+            self.assertIsNot(hash_map.get('map'), hash_map)
+        finally:
+            jpy.cache_identity('java.util.AbstractList', enabled=False)
+        self.assertIsNot(hash_map.get('list'), array_list)
+
+    def test_cache_identity_errors(self):
+        with self.assertRaises(ValueError):
+            jpy.cache_identity('int')
+        with self.assertRaises(ValueError):
+            jpy.cache_identity(42)
+
+
+class TestHashCache(unittest.TestCase):
+    def setUp(self):
+        self.String = jpy.get_type('java.lang.String')
+        self.ArrayList = jpy.get_type('java.util.ArrayList')
+
+    def test_string_keys(self):
+        keys = [self.String(str(i)) for i in range(1000)]
+        d = dict.fromkeys(keys, 1)
+        self.assertEqual(len(d), 1000)
+        for i in range(1000):
+            key = self.String(str(i))
+            self.assertEqual(hash(key), hash(keys[i]))
+            self.assertEqual(d[key], 1)
+        self.assertNotIn(self.String('x'), d)
+
+        a = self.String('a')
+        self.assertTrue(a == a)
+        self.assertFalse(a != a)
+        self.assertTrue(a == self.String('a'))
+        self.assertTrue(a != self.String('b'))
+
+    def test_ordering_of_hashed_strings(self):
+        # differing cached hash codes only tell that objects are not equal, they don't order them
+        a = self.String('a')
+        b = self.String('b')
+        self.assertNotEqual(hash(a), hash(b))
+        self.assertTrue(a < b)
+        self.assertTrue(a <= b)
+        self.assertTrue(b > a)
+        self.assertTrue(b >= a)
+        self.assertFalse(a > b)
+        self.assertFalse(a == b)
+        self.assertTrue(a != b)
+        keys = [self.String(c) for c in 'dbeca']
+        for key in keys:
+            hash(key)
+        self.assertEqual([str(key) for key in sorted(keys)], ['a', 'b', 'c', 'd', 'e'])
+
+    def test_hash_minus_one(self):
+        # hashCode() == -1 must not be mistaken for an error
+        Integer = jpy.get_type('java.lang.Integer')
+        self.assertEqual(hash(Integer(-1)), hash(Integer(-1)))
+
+    def test_cache_hash(self):
+        array_list = self.ArrayList()
+        h0 = hash(array_list)
+        jpy.cache_hash(self.ArrayList)
+        try:
+            self.assertEqual(hash(array_list), h0)
+            array_list.add('A')
+            # a mutable type must not be registered, its cached hash code is stale
+            self.assertEqual(hash(array_list), h0)
+        finally:
+            jpy.cache_hash(self.ArrayList, enabled=False)
+        self.assertNotEqual(hash(array_list), h0)
+        self.assertEqual(hash(array_list), array_list.hashCode())
+
+    def test_cache_hash_reenabled(self):
+        array_list = self.ArrayList()
+        jpy.cache_hash(self.ArrayList)
+        try:
+            h0 = hash(array_list)
+            jpy.cache_hash(self.ArrayList, enabled=False)
+            array_list.add('A')
+            jpy.cache_hash(self.ArrayList)
+            # the hash code cached before caching was turned off is stale
+            self.assertNotEqual(hash(array_list), h0)
+            self.assertEqual(hash(array_list), array_list.hashCode())
+        finally:
+            jpy.cache_hash(self.ArrayList, enabled=False)
+
+    def test_cache_hash_errors(self):
+        with self.assertRaises(ValueError):
+            jpy.cache_hash('int')
+        with self.assertRaises(ValueError):
+            jpy.cache_hash(42)
+
+
+class TestWeak(unittest.TestCase):
+    def setUp(self):
+        self.File = jpy.get_type('java.io.File')
+        self.ArrayList = jpy.get_type('java.util.ArrayList')
+        self.System = jpy.get_type('java.lang.System')
+
+    def test_weak(self):
+        f = self.File('weak')
+        weak_refs = jpy.diag.memory_stats()['weak_global_refs']
+        w = jpy.weak(f)
+        self.assertEqual(jpy.diag.memory_stats()['weak_global_refs'], weak_refs + 1)
+        self.assertIsInstance(w, jpy.JWeakObj)
+        self.assertIs(jpy.weak(w), w)
+        self.assertIs(w.type, self.File)
+        self.assertTrue(w.alive)
+        self.assertEqual(w(), f)
+        self.assertEqual(w.getName(), 'weak')
+
+        # hashed and compared by identity of the Java object
+        self.assertEqual(w, jpy.weak(f))
+        self.assertEqual(hash(w), hash(jpy.weak(f)))
+        self.assertNotEqual(w, jpy.weak(self.File('weak')))
+        self.assertEqual({w: 1}[jpy.weak(f)], 1)
+
+        # passed to Java methods as the object itself
+        array_list = self.ArrayList()
+        array_list.add(w)
+        self.assertEqual(array_list.get(0), f)
+        self.assertTrue(array_list.contains(w))
+
+        del f
+        array_list.clear()
+        for i in range(10):
+            self.System.gc()
+            if not w.alive:
+                break
+        self.assertFalse(w.alive)
+        self.assertIsNone(w())
+        with self.assertRaises(ReferenceError):
+            w.getName()
+        with self.assertRaises(ReferenceError):
+            array_list.add(w)
+        self.assertEqual(w, w)
+
+        del w
+        self.assertEqual(jpy.diag.memory_stats()['weak_global_refs'], weak_refs)
+
+    def test_weak_errors(self):
+        with self.assertRaises(ValueError):
+            jpy.weak('weak')
+
+
 if __name__ == '__main__':
     print('\nRunning ' + __file__)
     unittest.main()
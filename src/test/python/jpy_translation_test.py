@@ -38,6 +38,35 @@ class TestTypeTranslation(unittest.TestCase):
         jpy.type_translations['org.jpy.fixtures.Thing'] = None
         self.assertEqual(fixture.makeThing(9).getValue(), 9)
 
+    def test_TranslationOfSupertypes(self):
+        HashMap = jpy.get_type('java.util.HashMap')
+        ArrayList = jpy.get_type('java.util.ArrayList')
+        hash_map = HashMap()
+        hash_map.put('list', ArrayList())
+        hash_map.put('map', HashMap())
+
+        def tag(tag):
+            return lambda type, obj: (tag, obj)
+
+        try:
+            # superclasses, then interfaces including their super-interfaces
+            jpy.type_translations['java.util.AbstractList'] = tag('AbstractList')
+            jpy.type_translations['java.util.Map'] = tag('Map')
+            self.assertEqual(hash_map.get('list')[0], 'AbstractList')
+            self.assertEqual(hash_map.get('map')[0], 'Map')
+
+            del jpy.type_translations['java.util.AbstractList']
+            jpy.type_translations.update({'java.util.Collection': tag('Collection')})
+            self.assertEqual(hash_map.get('list')[0], 'Collection')
+
+            # a non-callable entry disables translations inherited from supertypes
+            jpy.type_translations['java.util.ArrayList'] = None
+            self.assertEqual(type(hash_map.get('list')), ArrayList)
+        finally:
+            jpy.type_translations.clear()
+        self.assertEqual(type(hash_map.get('list')), ArrayList)
+        self.assertEqual(type(hash_map.get('map')), HashMap)
+
 
 if __name__ == '__main__':
     print('\nRunning ' + __file__)